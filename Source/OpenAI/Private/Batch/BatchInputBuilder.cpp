@@ -0,0 +1,274 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Batch/BatchInputBuilder.h"
+#include "Provider/OpenAIProvider.h"
+#include "IO/FileManifest.h"
+#include "Provider/JsonParsers/ChatParser.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBatchInputBuilder, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 WriteBufferSize = 4 * 1024 * 1024;
+
+FString SerializeBody(const FChatCompletion& ChatCompletion)
+{
+    if (!ChatCompletion.Stream)
+    {
+        return ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion);
+    }
+
+    // streaming is not supported by the Batch API
+    FChatCompletion NotStreamedCompletion = ChatCompletion;
+    NotStreamedCompletion.Stream = false;
+    return ChatParser::ChatCompletionToJsonRepresentation(NotStreamedCompletion);
+}
+
+FString SerializeBody(const FEmbeddings& Embeddings)
+{
+    TSharedPtr<FJsonObject> Json = FJsonObjectConverter::UStructToJsonObject(Embeddings);
+    UJsonFuncLib::RemoveEmptyArrays(Json);
+    FString Body;
+    UJsonFuncLib::JsonToString(Json, Body);
+    return UJsonFuncLib::RemoveOptionalValuesThatNotSet(Body);
+}
+
+TArray<uint8> MakeLine(const FString& CustomId, const FString& Endpoint, const FString& Body)
+{
+    FString Line;
+    const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Line);
+    Writer->WriteObjectStart();
+    Writer->WriteValue(TEXT("custom_id"), CustomId);
+    Writer->WriteValue(TEXT("method"), FString("POST"));
+    Writer->WriteValue(TEXT("url"), Endpoint);
+    // body is a pretty printed JSON, line breaks are not allowed inside of the JSONL line
+    Writer->WriteRawJSONValue(TEXT("body"), UOpenAIFuncLib::RemoveWhiteSpaces(Body));
+    Writer->WriteObjectEnd();
+    Writer->Close();
+
+    const FTCHARToUTF8 Converter(*Line, Line.Len());
+    return TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+}
+
+struct FUploadState
+{
+    TArray<FBatchSpec> Specs;
+    TArray<TStrongObjectPtr<UOpenAIProvider>> Providers;
+    int32 NumPending{};
+    bool AllUploaded{true};
+    FOnBatchSpecsReady OnCompleted;
+
+    void OnShardFinished(bool Uploaded)
+    {
+        AllUploaded &= Uploaded;
+        if (--NumPending > 0) return;
+
+        // providers hold the lambdas that own this state
+        const auto Callback = MoveTemp(OnCompleted);
+        const auto ReadySpecs = MoveTemp(Specs);
+        const bool Success = AllUploaded;
+        Providers.Empty();
+
+        Callback(ReadySpecs, Success);
+    }
+};
+}  // namespace
+
+FBatchInputBuilder::FBatchInputBuilder(EBatchEndpoint InEndpoint) : Endpoint(UOpenAIFuncLib::OpenAIBatchEndpointToString(InEndpoint)) {}
+
+void FBatchInputBuilder::Add(const TArray<FChatCompletion>& Requests, const TArray<FString>& InCustomIds)
+{
+    ensure(Endpoint.Equals(UOpenAIFuncLib::OpenAIBatchEndpointToString(EBatchEndpoint::ChatCompletions)));
+    AddRequests(Requests, InCustomIds);
+}
+
+void FBatchInputBuilder::Add(const TArray<FEmbeddings>& Requests, const TArray<FString>& InCustomIds)
+{
+    ensure(Endpoint.Equals(UOpenAIFuncLib::OpenAIBatchEndpointToString(EBatchEndpoint::Embeddings)));
+    AddRequests(Requests, InCustomIds);
+}
+
+template <typename RequestType>
+void FBatchInputBuilder::AddRequests(const TArray<RequestType>& Requests, const TArray<FString>& InCustomIds)
+{
+    check(Requests.Num() == InCustomIds.Num());
+
+    const int32 FirstIndex = Lines.Num();
+    CustomIds.Append(InCustomIds);
+    Lines.SetNum(FirstIndex + Requests.Num());
+
+    ParallelFor(Requests.Num(),
+        [&](int32 Index)  //
+        { Lines[FirstIndex + Index] = MakeLine(InCustomIds[Index], Endpoint, SerializeBody(Requests[Index])); });
+}
+
+void FBatchInputBuilder::AddLine(const FString& CustomId, FUtf8StringView Line)
+{
+    CustomIds.Add(CustomId);
+    Lines.Emplace(reinterpret_cast<const uint8*>(Line.GetData()), Line.Len());
+}
+
+void FBatchInputBuilder::SetLimits(int32 InMaxRequests, int64 InMaxBytes)
+{
+    MaxRequests = FMath::Clamp(InMaxRequests, 1, MaxRequestsPerFile);
+    MaxBytes = FMath::Clamp<int64>(InMaxBytes, 1, MaxBytesPerFile);
+}
+
+void FBatchInputBuilder::Reset()
+{
+    CustomIds.Reset();
+    Lines.Reset();
+}
+
+FString FBatchInputBuilder::DefaultOutputDir()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAI"), TEXT("Batch"));
+}
+
+bool FBatchInputBuilder::Build(TArray<FBatchInputShard>& Shards, const FString& FileNamePrefix, const FString& OutputDir) const
+{
+    Shards.Reset();
+    if (Lines.IsEmpty()) return true;
+
+    const FString Dir = OutputDir.IsEmpty() ? DefaultOutputDir() : OutputDir;
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (!PlatformFile.CreateDirectoryTree(*Dir))
+    {
+        UE_LOGFMT(LogBatchInputBuilder, Error, "Can't create directory: {0}", Dir);
+        return false;
+    }
+
+    // greedy split: a shard is closed when the next line doesn't fit into the limits
+    TArray<TTuple<int32, int32>> ShardRanges;
+    int32 ShardBegin{0};
+    int64 ShardBytes{0};
+    for (int32 Index = 0; Index < Lines.Num(); ++Index)
+    {
+        const int64 LineBytes = Lines[Index].Num() + 1;
+        if (LineBytes > MaxBytes)
+        {
+            UE_LOGFMT(LogBatchInputBuilder, Error, "Request {0} is bigger than the batch file limit", CustomIds[Index]);
+            return false;
+        }
+
+        const int32 ShardRequests = Index - ShardBegin;
+        if (ShardRequests == MaxRequests || ShardBytes + LineBytes > MaxBytes)
+        {
+            ShardRanges.Emplace(ShardBegin, Index);
+            ShardBegin = Index;
+            ShardBytes = 0;
+        }
+        ShardBytes += LineBytes;
+    }
+    ShardRanges.Emplace(ShardBegin, Lines.Num());
+
+    Shards.SetNum(ShardRanges.Num());
+    std::atomic<bool> AllWritten{true};
+    ParallelFor(ShardRanges.Num(),
+        [&](int32 ShardIndex)
+        {
+            const auto& [Begin, End] = ShardRanges[ShardIndex];
+            FBatchInputShard& Shard = Shards[ShardIndex];
+            Shard.Endpoint = Endpoint;
+            Shard.FilePath = FPaths::Combine(Dir, FString::Printf(TEXT("%s_%d.jsonl"), *FileNamePrefix, ShardIndex));
+            Shard.CustomIds.Append(&CustomIds[Begin], End - Begin);
+
+            TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*Shard.FilePath));
+            if (!FileHandle)
+            {
+                UE_LOGFMT(LogBatchInputBuilder, Error, "Can't open file for writing: {0}", Shard.FilePath);
+                AllWritten = false;
+                return;
+            }
+
+            TArray<uint8> WriteBuffer;
+            WriteBuffer.Reserve(WriteBufferSize);
+            const auto Flush = [&]()
+            {
+                const bool Written = FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+                Shard.NumBytes += WriteBuffer.Num();
+                WriteBuffer.Reset();
+                return Written;
+            };
+
+            for (int32 Index = Begin; Index < End; ++Index)
+            {
+                if (WriteBuffer.Num() + Lines[Index].Num() + 1 > WriteBufferSize && !Flush())
+                {
+                    UE_LOGFMT(LogBatchInputBuilder, Error, "Can't write file: {0}", Shard.FilePath);
+                    AllWritten = false;
+                    return;
+                }
+                WriteBuffer.Append(Lines[Index]);
+                WriteBuffer.Add('\n');
+            }
+
+            if (!Flush())
+            {
+                UE_LOGFMT(LogBatchInputBuilder, Error, "Can't write file: {0}", Shard.FilePath);
+                AllWritten = false;
+            }
+        });
+
+    return AllWritten;
+}
+
+void FBatchInputBuilder::Upload(const TArray<FBatchInputShard>& Shards, const FOpenAIAuth& Auth, const FOnBatchSpecsReady& OnCompleted,
+    const TSharedPtr<FFileManifest>& FileManifest, const TSubclassOf<UOpenAIProvider>& ProviderClass)
+{
+    check(IsInGameThread());
+
+    if (Shards.IsEmpty())
+    {
+        OnCompleted({}, true);
+        return;
+    }
+
+    const auto State = MakeShared<FUploadState>();
+    State->OnCompleted = OnCompleted;
+    State->NumPending = Shards.Num();
+    State->Specs.SetNum(Shards.Num());
+
+    for (int32 ShardIndex = 0; ShardIndex < Shards.Num(); ++ShardIndex)
+    {
+        FBatchSpec& Spec = State->Specs[ShardIndex];
+        Spec.Shard = Shards[ShardIndex];
+        Spec.CreateBatch.Endpoint = Shards[ShardIndex].Endpoint;
+        Spec.CreateBatch.Completion_Window = UOpenAIFuncLib::OpenAIBatchCompletionWindowToString(EBatchCompletionWindow::Window_24h);
+
+        UClass* Class = ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass();
+        auto* Provider = NewObject<UOpenAIProvider>(GetTransientPackage(), Class);
+        Provider->SetFileManifest(FileManifest);
+        State->Providers.Emplace(Provider);
+
+        Provider->OnUploadFileCompleted().AddLambda(
+            [State, ShardIndex](const FUploadFileResponse& Response)
+            {
+                State->Specs[ShardIndex].CreateBatch.Input_File_Id = Response.ID;
+                State->OnShardFinished(true);
+            });
+        Provider->OnRequestError().AddLambda(
+            [State, ShardIndex](const FString& URL, const FString& Content)
+            {
+                const FString& FilePath = State->Specs[ShardIndex].Shard.FilePath;
+                UE_LOGFMT(LogBatchInputBuilder, Error, "Can't upload batch file {0}: {1}", FilePath, Content);
+                State->OnShardFinished(false);
+            });
+
+        FUploadFile UploadFile;
+        UploadFile.File = Shards[ShardIndex].FilePath;
+        UploadFile.Purpose = UOpenAIFuncLib::OpenAIUploadFilePurposeToString(EUploadFilePurpose::Batch);
+        Provider->UploadFile(UploadFile, Auth);
+    }
+}
@@ -0,0 +1,486 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Batch/BatchOrchestrator.h"
+#include "Provider/OpenAIProvider.h"
+#include "Async/Async.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBatchOrchestrator, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr float TickInterval = 1.0f;
+constexpr int32 ListBatchPageSize = 100;
+constexpr int32 MaxListBatchPages = 10;
+
+bool IsTerminalStatus(const FString& Status)
+{
+    return Status.Equals("completed") || Status.Equals("failed") || Status.Equals("expired") || Status.Equals("cancelled");
+}
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// FBatchResults
+///////////////////////////////////////////////////////////////////////////////
+
+void FBatchResults::Add(const TSharedRef<const FBatchResultReader>& Reader, bool Succeeded)
+{
+    const int32 ReaderIndex = Readers.Add(Reader);
+    Index.Reserve(Index.Num() + Reader->Num());
+
+    for (int32 LineIndex = 0; LineIndex < Reader->Num(); ++LineIndex)
+    {
+        const FString& CustomId = Reader->GetCustomId(LineIndex);
+        if (CustomId.IsEmpty()) continue;
+
+        FEntry* Entry = Index.Find(CustomId);
+        if (!Entry)
+        {
+            Index.Add(CustomId, {ReaderIndex, LineIndex, Succeeded});
+            SucceededNum += Succeeded ? 1 : 0;
+            continue;
+        }
+
+        if (Entry->Succeeded && !Succeeded) continue;
+
+        SucceededNum += (Succeeded ? 1 : 0) - (Entry->Succeeded ? 1 : 0);
+        *Entry = {ReaderIndex, LineIndex, Succeeded};
+    }
+}
+
+bool FBatchResults::Succeeded(const FString& CustomId) const
+{
+    const FEntry* Entry = Index.Find(CustomId);
+    return Entry && Entry->Succeeded;
+}
+
+void FBatchResults::Reset()
+{
+    Readers.Reset();
+    Index.Reset();
+    SucceededNum = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// UBatchOrchestrator
+///////////////////////////////////////////////////////////////////////////////
+
+void UBatchOrchestrator::BeginDestroy()
+{
+    StopTicker();
+    Super::BeginDestroy();
+}
+
+void UBatchOrchestrator::SetPollingInterval(float MinInterval, float MaxInterval)
+{
+    MinPollInterval = FMath::Max(TickInterval, MinInterval);
+    MaxPollInterval = FMath::Max(MinPollInterval, MaxInterval);
+    PollInterval = MinPollInterval;
+}
+
+bool UBatchOrchestrator::IsRetryable(const FBatchResultHeader& Header)
+{
+    // requests without a response failed for the whole batch, only the expired ones can succeed later
+    return Header.Status_Code == 429 || Header.Status_Code >= 500 || Header.Error.Code.Equals("batch_expired");
+}
+
+TArray<FString> UBatchOrchestrator::FindRetryIds(
+    const FBatchInputShard& Shard, const FBatchResultReader& OutputReader, const FBatchResultReader& ErrorReader)
+{
+    // requests that are missing in both files were never processed, e.g. the batch expired
+    TArray<FString> RetryIds;
+    for (const FString& CustomId : Shard.CustomIds)
+    {
+        if (OutputReader.Contains(CustomId)) continue;
+
+        const int32 LineIndex = ErrorReader.FindLine(CustomId);
+        FBatchResultHeader Header;
+        if (LineIndex == INDEX_NONE || (ErrorReader.ParseHeader(LineIndex, Header) && IsRetryable(Header)))
+        {
+            RetryIds.Add(CustomId);
+        }
+    }
+    return RetryIds;
+}
+
+void UBatchOrchestrator::Submit(const FBatchInputBuilder& Builder, const FString& Name)
+{
+    // a submission while batches are running joins their results
+    if (!IsRunning())
+    {
+        Jobs.Reset();
+        Results.Reset();
+    }
+
+    TArray<FBatchInputShard> Shards;
+    if (!Builder.Build(Shards, Name))
+    {
+        ReportError(FString::Printf(TEXT("Can't build input files of the batch: %s"), *Name));
+        return;
+    }
+
+    bSubmitted = true;
+    bCancelled = false;
+    UploadAndCreate(Shards, Name, 0);
+}
+
+void UBatchOrchestrator::Cancel()
+{
+    bCancelled = true;
+    for (const FBatchJob& Job : Jobs)
+    {
+        if (Job.Finished || IsTerminalStatus(Job.Batch.Status)) continue;
+
+        auto* Provider = MakeProvider();
+        Provider->OnCancelBatchCompleted().AddWeakLambda(this,
+            [this, Provider](const FCancelBatchResponse& Response)  //
+            { ReleaseProvider(Provider); });
+        Provider->OnRequestError().AddWeakLambda(this,
+            [this, Provider](const FString& URL, const FString& Content)
+            {
+                ReportError(FString::Printf(TEXT("Can't cancel batch: %s"), *Content));
+                ReleaseProvider(Provider);
+            });
+        Provider->CancelBatch(Job.Batch.Id, Auth);
+    }
+
+    // cancelled status is picked up by the next poll
+    NextPollTime = FPlatformTime::Seconds();
+}
+
+bool UBatchOrchestrator::Tick(float DeltaTime)
+{
+    if (!bPollInProgress && HasActiveJobs() && FPlatformTime::Seconds() >= NextPollTime)
+    {
+        Poll();
+    }
+    return true;
+}
+
+void UBatchOrchestrator::Poll()
+{
+    bPollInProgress = true;
+    ListBatchPage({}, 0, MakeShared<TSet<FString>>(), MakeShared<bool>(false));
+}
+
+void UBatchOrchestrator::ListBatchPage(
+    const FString& After, int32 Page, TSharedRef<TSet<FString>> SeenBatches, TSharedRef<bool> AnyStatusChanged)
+{
+    FListBatch ListBatch;
+    ListBatch.Limit.Set(ListBatchPageSize);
+    if (!After.IsEmpty())
+    {
+        ListBatch.After.Set(After);
+    }
+
+    auto* Provider = MakeProvider();
+    Provider->OnListBatchCompleted().AddWeakLambda(this,
+        [this, Provider, Page, SeenBatches, AnyStatusChanged](const FListBatchResponse& Response)
+        {
+            ReleaseProvider(Provider);
+
+            for (const FOpenAIBatch& Batch : Response.Data)
+            {
+                SeenBatches->Add(Batch.Id);
+                *AnyStatusChanged |= UpdateJob(Batch);
+            }
+
+            // the list is sorted from the newest batch, tracked batches are usually on the first page
+            bool AllSeen{true};
+            for (const FBatchJob& Job : Jobs)
+            {
+                AllSeen &= Job.Finished || SeenBatches->Contains(Job.Batch.Id);
+            }
+
+            if (!AllSeen && Response.Has_More && Page + 1 < MaxListBatchPages)
+            {
+                ListBatchPage(Response.Last_Id, Page + 1, SeenBatches, AnyStatusChanged);
+                return;
+            }
+            RetrieveUnseenBatches(*SeenBatches, AnyStatusChanged);
+        });
+    Provider->OnRequestError().AddWeakLambda(this,
+        [this, Provider, SeenBatches, AnyStatusChanged](const FString& URL, const FString& Content)
+        {
+            UE_LOGFMT(LogBatchOrchestrator, Warning, "Can't list batches: {0}", Content);
+            ReleaseProvider(Provider);
+            RetrieveUnseenBatches(*SeenBatches, AnyStatusChanged);
+        });
+    Provider->ListBatch(ListBatch, Auth);
+}
+
+void UBatchOrchestrator::RetrieveUnseenBatches(const TSet<FString>& SeenBatches, TSharedRef<bool> AnyStatusChanged)
+{
+    TArray<FString> UnseenBatches;
+    for (const FBatchJob& Job : Jobs)
+    {
+        if (!Job.Finished && !SeenBatches.Contains(Job.Batch.Id))
+        {
+            UnseenBatches.Add(Job.Batch.Id);
+        }
+    }
+
+    if (UnseenBatches.IsEmpty())
+    {
+        FinishPoll(*AnyStatusChanged);
+        return;
+    }
+
+    const auto NumPending = MakeShared<int32>(UnseenBatches.Num());
+    const auto OnRetrieved = [this, NumPending, AnyStatusChanged]()
+    {
+        if (--(*NumPending) == 0)
+        {
+            FinishPoll(*AnyStatusChanged);
+        }
+    };
+
+    for (const FString& BatchId : UnseenBatches)
+    {
+        auto* Provider = MakeProvider();
+        Provider->OnRetrieveBatchCompleted().AddWeakLambda(this,
+            [this, Provider, AnyStatusChanged, OnRetrieved](const FRetrieveBatchResponse& Response)
+            {
+                ReleaseProvider(Provider);
+                *AnyStatusChanged |= UpdateJob(Response);
+                OnRetrieved();
+            });
+        Provider->OnRequestError().AddWeakLambda(this,
+            [this, Provider, BatchId, OnRetrieved](const FString& URL, const FString& Content)
+            {
+                UE_LOGFMT(LogBatchOrchestrator, Warning, "Can't retrieve batch {0}: {1}", BatchId, Content);
+                ReleaseProvider(Provider);
+                OnRetrieved();
+            });
+        Provider->RetrieveBatch(BatchId, Auth);
+    }
+}
+
+void UBatchOrchestrator::FinishPoll(bool AnyStatusChanged)
+{
+    PollInterval = AnyStatusChanged ? MinPollInterval : FMath::Min(PollInterval * 2.0f, MaxPollInterval);
+    NextPollTime = FPlatformTime::Seconds() + PollInterval;
+    bPollInProgress = false;
+    TryComplete();
+}
+
+bool UBatchOrchestrator::UpdateJob(const FOpenAIBatch& Batch)
+{
+    const int32 JobIndex = Jobs.IndexOfByPredicate([&](const FBatchJob& Job) { return !Job.Finished && Job.Batch.Id.Equals(Batch.Id); });
+    if (JobIndex == INDEX_NONE) return false;
+
+    FBatchJob& Job = Jobs[JobIndex];
+    const bool StatusChanged = !Job.Batch.Status.Equals(Batch.Status);
+    Job.Batch = Batch;
+    if (!StatusChanged) return false;
+
+    UE_LOGFMT(LogBatchOrchestrator, Display, "Batch {0} status: {1}", Batch.Id, Batch.Status);
+    BatchStatusChanged.Broadcast(Batch);
+
+    if (IsTerminalStatus(Batch.Status))
+    {
+        DownloadResults(JobIndex);
+    }
+    return true;
+}
+
+void UBatchOrchestrator::UploadAndCreate(const TArray<FBatchInputShard>& Shards, const FString& Name, int32 Attempt)
+{
+    ++NumPendingOperations;
+    FBatchInputBuilder::Upload(Shards, Auth,
+        [WeakThis = TWeakObjectPtr<UBatchOrchestrator>(this), Name, Attempt](const TArray<FBatchSpec>& Specs, bool AllUploaded)
+        {
+            if (!WeakThis.IsValid()) return;
+
+            for (const FBatchSpec& Spec : Specs)
+            {
+                if (Spec.CreateBatch.Input_File_Id.IsEmpty())
+                {
+                    WeakThis->ReportError(FString::Printf(TEXT("Can't upload batch file: %s"), *Spec.Shard.FilePath));
+                    continue;
+                }
+                WeakThis->CreateBatch(Spec, Name, Attempt);
+            }
+
+            --WeakThis->NumPendingOperations;
+            WeakThis->TryComplete();
+        },
+        nullptr, ProviderClass);
+}
+
+void UBatchOrchestrator::CreateBatch(const FBatchSpec& Spec, const FString& Name, int32 Attempt)
+{
+    ++NumPendingOperations;
+
+    auto* Provider = MakeProvider();
+    Provider->OnCreateBatchCompleted().AddWeakLambda(this,
+        [this, Provider, Spec, Name, Attempt](const FCreateBatchResponse& Response)
+        {
+            ReleaseProvider(Provider);
+            --NumPendingOperations;
+
+            FBatchJob& Job = Jobs.AddDefaulted_GetRef();
+            Job.Spec = Spec;
+            Job.Batch = Response;
+            Job.Name = Name;
+            Job.Attempt = Attempt;
+            BatchStatusChanged.Broadcast(Response);
+
+            PollInterval = MinPollInterval;
+            NextPollTime = FMath::Min(NextPollTime, FPlatformTime::Seconds() + PollInterval);
+            StartTicker();
+        });
+    Provider->OnRequestError().AddWeakLambda(this,
+        [this, Provider, Spec](const FString& URL, const FString& Content)
+        {
+            ReleaseProvider(Provider);
+            --NumPendingOperations;
+            ReportError(FString::Printf(TEXT("Can't create batch for %s: %s"), *Spec.Shard.FilePath, *Content));
+            TryComplete();
+        });
+    Provider->CreateBatch(Spec.CreateBatch, Auth);
+}
+
+void UBatchOrchestrator::DownloadResults(int32 JobIndex)
+{
+    ++NumPendingOperations;
+
+    const FOpenAIBatch& Batch = Jobs[JobIndex].Batch;
+    const FString ErrorFileId = Batch.Error_File_Id;
+    RetrieveFileContent(Batch.Output_File_Id,
+        [this, JobIndex, ErrorFileId](FString&& OutputContent)
+        {
+            RetrieveFileContent(ErrorFileId,
+                [this, JobIndex, OutputContent = MoveTemp(OutputContent)](FString&& ErrorContent) mutable
+                { OnResultsDownloaded(JobIndex, MoveTemp(OutputContent), MoveTemp(ErrorContent)); });
+        });
+}
+
+void UBatchOrchestrator::RetrieveFileContent(const FString& FileId, TFunction<void(FString&&)> OnRetrieved)
+{
+    if (FileId.IsEmpty())
+    {
+        OnRetrieved({});
+        return;
+    }
+
+    auto* Provider = MakeProvider();
+    Provider->OnRetrieveFileContentCompleted().AddWeakLambda(this,
+        [this, Provider, OnRetrieved](const FRetrieveFileContentResponse& Response)
+        {
+            ReleaseProvider(Provider);
+            OnRetrieved(CopyTemp(Response.Content));
+        });
+    Provider->OnRequestError().AddWeakLambda(this,
+        [this, Provider, FileId, OnRetrieved](const FString& URL, const FString& Content)
+        {
+            ReleaseProvider(Provider);
+            ReportError(FString::Printf(TEXT("Can't download batch file %s: %s"), *FileId, *Content));
+            OnRetrieved({});
+        });
+    Provider->RetrieveFileContent(FileId, Auth);
+}
+
+void UBatchOrchestrator::OnResultsDownloaded(int32 JobIndex, FString&& OutputContent, FString&& ErrorContent)
+{
+    const FBatchJob& Job = Jobs[JobIndex];
+    // validation failures are not fixed by a resubmission
+    const bool CanRetry = !bCancelled && Job.Attempt < MaxRetries && !Job.Batch.Status.Equals("failed");
+
+    Async(EAsyncExecution::ThreadPool,
+        [WeakThis = TWeakObjectPtr<UBatchOrchestrator>(this), JobIndex, Shard = Job.Spec.Shard, Name = Job.Name, Attempt = Job.Attempt,
+            BatchId = Job.Batch.Id, CanRetry, OutputContent = MoveTemp(OutputContent), ErrorContent = MoveTemp(ErrorContent)]()
+        {
+            const auto OutputReader = MakeShared<FBatchResultReader>();
+            const auto ErrorReader = MakeShared<FBatchResultReader>();
+            OutputReader->OpenFromString(OutputContent);
+            ErrorReader->OpenFromString(ErrorContent);
+
+            TArray<FBatchInputShard> RetryShards;
+            if (CanRetry)
+            {
+                const TArray<FString> RetryIds = FindRetryIds(Shard, *OutputReader, *ErrorReader);
+                FBatchResultReader InputReader;
+                if (!RetryIds.IsEmpty() && InputReader.Open(Shard.FilePath))
+                {
+                    FBatchInputBuilder Builder(Shard.Endpoint);
+                    for (const FString& CustomId : RetryIds)
+                    {
+                        const int32 LineIndex = InputReader.FindLine(CustomId);
+                        if (LineIndex != INDEX_NONE)
+                        {
+                            Builder.AddLine(CustomId, InputReader.GetLine(LineIndex));
+                        }
+                    }
+                    // the batch id keeps the retry files of the shards and of other jobs apart
+                    Builder.Build(RetryShards, FString::Printf(TEXT("%s_%s_retry%d"), *Name, *BatchId, Attempt + 1));
+                }
+            }
+
+            AsyncTask(ENamedThreads::GameThread,
+                [WeakThis, JobIndex, Name, Attempt, OutputReader, ErrorReader, RetryShards = MoveTemp(RetryShards)]()
+                {
+                    if (!WeakThis.IsValid()) return;
+
+                    WeakThis->Results.Add(ErrorReader, false);
+                    WeakThis->Results.Add(OutputReader, true);
+                    WeakThis->Jobs[JobIndex].Finished = true;
+                    --WeakThis->NumPendingOperations;
+
+                    if (!RetryShards.IsEmpty())
+                    {
+                        UE_LOGFMT(LogBatchOrchestrator, Display, "Resubmitting {0} file(s) of the batch {1}", RetryShards.Num(), Name);
+                        WeakThis->UploadAndCreate(RetryShards, Name, Attempt + 1);
+                    }
+                    WeakThis->TryComplete();
+                });
+        });
+}
+
+bool UBatchOrchestrator::HasActiveJobs() const
+{
+    return Jobs.ContainsByPredicate([](const FBatchJob& Job) { return !Job.Finished; });
+}
+
+void UBatchOrchestrator::TryComplete()
+{
+    if (!bSubmitted || IsRunning()) return;
+
+    bSubmitted = false;
+    StopTicker();
+    Completed.Broadcast(Results);
+}
+
+void UBatchOrchestrator::ReportError(const FString& ErrorText)
+{
+    UE_LOGFMT(LogBatchOrchestrator, Error, "{0}", ErrorText);
+    Error.Broadcast(ErrorText);
+}
+
+UOpenAIProvider* UBatchOrchestrator::MakeProvider()
+{
+    auto* Provider = NewObject<UOpenAIProvider>(this, ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass());
+    Provider->SetLogEnabled(bLogEnabled);
+    Providers.Add(Provider);
+    return Provider;
+}
+
+void UBatchOrchestrator::ReleaseProvider(UOpenAIProvider* Provider)
+{
+    Providers.RemoveSingleSwap(Provider);
+}
+
+void UBatchOrchestrator::StartTicker()
+{
+    if (TickerHandle.IsValid()) return;
+    TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::Tick), TickInterval);
+}
+
+void UBatchOrchestrator::StopTicker()
+{
+    if (!TickerHandle.IsValid()) return;
+    FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    TickerHandle.Reset();
+}
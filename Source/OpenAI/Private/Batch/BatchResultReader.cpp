@@ -0,0 +1,191 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Batch/BatchResultReader.h"
+#include "Provider/JsonParsers/EmbeddingParser.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Serialization/JsonSerializer.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBatchResultReader, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+FString UTF8ToString(FUtf8StringView View)
+{
+    const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(View.GetData()), View.Len());
+    return FString(Converter.Length(), Converter.Get());
+}
+
+bool IsJsonWhiteSpace(UTF8CHAR Char)
+{
+    return Char == ' ' || Char == '\t' || Char == '\r' || Char == '\n';
+}
+
+// custom_id is read without building a JSON DOM for the whole line, escaped ids fall back to the full parse
+bool ExtractCustomIdFast(FUtf8StringView Line, FString& CustomId)
+{
+    const FUtf8StringView Key(UTF8TEXTVIEW("\"custom_id\""));
+    const int32 KeyIndex = Line.Find(Key);
+    if (KeyIndex == INDEX_NONE) return false;
+
+    int32 Index = KeyIndex + Key.Len();
+    while (Index < Line.Len() && IsJsonWhiteSpace(Line[Index])) ++Index;
+    if (Index >= Line.Len() || Line[Index] != ':') return false;
+    ++Index;
+    while (Index < Line.Len() && IsJsonWhiteSpace(Line[Index])) ++Index;
+    if (Index >= Line.Len() || Line[Index] != '"') return false;
+    ++Index;
+
+    const int32 Start = Index;
+    while (Index < Line.Len() && Line[Index] != '"')
+    {
+        if (Line[Index] == '\\') return false;
+        ++Index;
+    }
+    if (Index >= Line.Len()) return false;
+
+    CustomId = UTF8ToString(Line.Mid(Start, Index - Start));
+    return true;
+}
+
+bool ExtractCustomIdSlow(FUtf8StringView Line, FString& CustomId)
+{
+    TSharedPtr<FJsonObject> Json;
+    if (!UJsonFuncLib::StringToJson(UTF8ToString(Line), Json) || !Json.IsValid()) return false;
+    return Json->TryGetStringField(TEXT("custom_id"), CustomId);
+}
+}  // namespace
+
+bool FBatchResultReader::Open(const FString& FilePath)
+{
+    return File.Open(FilePath) && BuildIndex();
+}
+
+bool FBatchResultReader::OpenFromString(const FString& Content)
+{
+    File.OpenFromString(Content);
+    return BuildIndex();
+}
+
+int32 FBatchResultReader::FindLine(const FString& CustomId) const
+{
+    const int32* LineIndex = CustomIdToLine.Find(CustomId);
+    return LineIndex ? *LineIndex : INDEX_NONE;
+}
+
+FUtf8StringView FBatchResultReader::GetLine(int32 LineIndex) const
+{
+    return File.View(Lines[LineIndex]);
+}
+
+bool FBatchResultReader::BuildIndex()
+{
+    Lines.Reset();
+    CustomIds.Reset();
+    CustomIdToLine.Reset();
+
+    File.SplitLines(Lines);
+
+    CustomIds.SetNum(Lines.Num());
+    std::atomic<int32> NumMalformed{0};
+    ParallelFor(Lines.Num(),
+        [&](int32 LineIndex)
+        {
+            const FUtf8StringView Line = GetLine(LineIndex);
+            if (!ExtractCustomIdFast(Line, CustomIds[LineIndex]) && !ExtractCustomIdSlow(Line, CustomIds[LineIndex]))
+            {
+                ++NumMalformed;
+            }
+        });
+
+    if (NumMalformed > 0)
+    {
+        UE_LOGFMT(LogBatchResultReader, Error, "{0} line(s) without custom_id", NumMalformed.load());
+    }
+
+    CustomIdToLine.Reserve(CustomIds.Num());
+    for (int32 LineIndex = 0; LineIndex < CustomIds.Num(); ++LineIndex)
+    {
+        if (CustomIds[LineIndex].IsEmpty()) continue;
+        if (CustomIdToLine.Contains(CustomIds[LineIndex]))
+        {
+            UE_LOGFMT(LogBatchResultReader, Warning, "Duplicated custom_id: {0}", CustomIds[LineIndex]);
+            continue;
+        }
+        CustomIdToLine.Add(CustomIds[LineIndex], LineIndex);
+    }
+
+    return NumMalformed == 0;
+}
+
+bool FBatchResultReader::ParseLine(int32 LineIndex, FBatchResultHeader& Header, TSharedPtr<FJsonObject>& Body) const
+{
+    TSharedPtr<FJsonObject> Json;
+    if (!UJsonFuncLib::StringToJson(UTF8ToString(GetLine(LineIndex)), Json) || !Json.IsValid())
+    {
+        UE_LOGFMT(LogBatchResultReader, Error, "JSON deserialization error, line: {0}", LineIndex);
+        return false;
+    }
+
+    Json->TryGetStringField(TEXT("id"), Header.Id);
+    Header.Custom_Id = CustomIds[LineIndex];
+
+    const TSharedPtr<FJsonObject>* ErrorObject = nullptr;
+    if (Json->TryGetObjectField(TEXT("error"), ErrorObject) && ErrorObject->IsValid())
+    {
+        FJsonObjectConverter::JsonObjectToUStruct(ErrorObject->ToSharedRef(), &Header.Error, 0, 0);
+        Header.HasError = true;
+    }
+
+    const TSharedPtr<FJsonObject>* ResponseObject = nullptr;
+    if (Json->TryGetObjectField(TEXT("response"), ResponseObject) && ResponseObject->IsValid())
+    {
+        (*ResponseObject)->TryGetNumberField(TEXT("status_code"), Header.Status_Code);
+        (*ResponseObject)->TryGetStringField(TEXT("request_id"), Header.Request_Id);
+
+        const TSharedPtr<FJsonObject>* BodyObject = nullptr;
+        if ((*ResponseObject)->TryGetObjectField(TEXT("body"), BodyObject) && BodyObject->IsValid())
+        {
+            Body = *BodyObject;
+
+            // failed requests report the API error inside of the body
+            const TSharedPtr<FJsonObject>* BodyErrorObject = nullptr;
+            if (!Header.HasError && Body->TryGetObjectField(TEXT("error"), BodyErrorObject) && BodyErrorObject->IsValid())
+            {
+                FJsonObjectConverter::JsonObjectToUStruct(BodyErrorObject->ToSharedRef(), &Header.Error, 0, 0);
+                Header.HasError = true;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool FBatchResultReader::BodyToStruct(const TSharedRef<FJsonObject>& Body, FEmbeddingsResponse& Struct)
+{
+    TMap<int32, TArray<float>> DecodedEmbeddings;
+    const TArray<TSharedPtr<FJsonValue>>* Data = nullptr;
+    if (Body->TryGetArrayField(TEXT("data"), Data))
+    {
+        for (int32 Index = 0; Index < Data->Num(); ++Index)
+        {
+            const TSharedPtr<FJsonObject>* DataObject = nullptr;
+            FString Base64;
+            if (!(*Data)[Index]->TryGetObject(DataObject) || !(*DataObject)->TryGetStringField(TEXT("embedding"), Base64)) continue;
+
+            if (!EmbeddingParser::DecodeBase64(Base64, DecodedEmbeddings.Add(Index))) return false;
+            (*DataObject)->RemoveField(TEXT("embedding"));
+        }
+    }
+
+    if (!FJsonObjectConverter::JsonObjectToUStruct(Body, &Struct, 0, 0)) return false;
+
+    for (auto& [Index, Embedding] : DecodedEmbeddings)
+    {
+        if (!Struct.Data.IsValidIndex(Index)) return false;
+        Struct.Data[Index].Embedding = MoveTemp(Embedding);
+    }
+    return true;
+}
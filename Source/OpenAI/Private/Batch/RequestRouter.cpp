@@ -0,0 +1,275 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Batch/RequestRouter.h"
+#include "Batch/BatchOrchestrator.h"
+#include "Provider/OpenAIProvider.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "Async/ParallelFor.h"
+#include "Misc/Guid.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogRequestRouter, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+template <typename RequestType>
+struct TRouteTraits;
+
+template <>
+struct TRouteTraits<FChatCompletion>
+{
+    using ResponseType = FChatCompletionResponse;
+    static constexpr EBatchEndpoint Endpoint = EBatchEndpoint::ChatCompletions;
+
+    static FOnCreateChatCompletionCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnCreateChatCompletionCompleted(); }
+
+    static void Send(UOpenAIProvider* Provider, const FChatCompletion& Request, const FOpenAIAuth& Auth)
+    {
+        // results are delivered as whole responses for both routes
+        FChatCompletion NotStreamedRequest = Request;
+        NotStreamedRequest.Stream = false;
+        Provider->CreateChatCompletion(NotStreamedRequest, Auth);
+    }
+};
+
+template <>
+struct TRouteTraits<FEmbeddings>
+{
+    using ResponseType = FEmbeddingsResponse;
+    static constexpr EBatchEndpoint Endpoint = EBatchEndpoint::Embeddings;
+
+    static FOnCreateEmbeddingsCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnCreateEmbeddingsCompleted(); }
+
+    static void Send(UOpenAIProvider* Provider, const FEmbeddings& Request, const FOpenAIAuth& Auth)
+    {
+        Provider->CreateEmbeddings(Request, Auth);
+    }
+};
+
+template <typename ResponseType>
+struct TSyncState
+{
+    TArray<TRoutedResult<ResponseType>> Results;
+    int32 NumPending{};
+    TFunction<void(const TArray<TRoutedResult<ResponseType>>&)> OnCompleted;
+
+    void OnRequestFinished()
+    {
+        if (--NumPending == 0)
+        {
+            OnCompleted(Results);
+        }
+    }
+};
+}  // namespace
+
+void URequestRouter::SetPolicy(const FRoutingPolicy& InPolicy)
+{
+    Policy = InPolicy;
+    Policy.MinBatchSize = FMath::Max(1, Policy.MinBatchSize);
+    Policy.MaxConcurrentRequests = FMath::Max(1, Policy.MaxConcurrentRequests);
+    PumpSyncQueue();
+}
+
+ERequestRoute URequestRouter::ChooseRoute(int32 NumRequests, const FTimespan& LatencyTolerance) const
+{
+    return NumRequests >= Policy.MinBatchSize && LatencyTolerance >= Policy.BatchLatencyThreshold  //
+               ? ERequestRoute::Batch
+               : ERequestRoute::Sync;
+}
+
+ERequestRoute URequestRouter::Submit(const TArray<FChatCompletion>& Requests, const TArray<FString>& CustomIds,
+    const FTimespan& LatencyTolerance, const FOnChatCompletionsRouted& OnCompleted)
+{
+    return Route<FChatCompletion, FChatCompletionResponse>(Requests, CustomIds, LatencyTolerance, OnCompleted);
+}
+
+ERequestRoute URequestRouter::Submit(const TArray<FEmbeddings>& Requests, const TArray<FString>& CustomIds,
+    const FTimespan& LatencyTolerance, const FOnEmbeddingsRouted& OnCompleted)
+{
+    return Route<FEmbeddings, FEmbeddingsResponse>(Requests, CustomIds, LatencyTolerance, OnCompleted);
+}
+
+TFuture<FChatCompletionResults> URequestRouter::SubmitAsync(
+    const TArray<FChatCompletion>& Requests, const TArray<FString>& CustomIds, const FTimespan& LatencyTolerance)
+{
+    const auto Promise = MakeShared<TPromise<FChatCompletionResults>>();
+    Submit(Requests, CustomIds, LatencyTolerance, [Promise](const FChatCompletionResults& Results) { Promise->SetValue(Results); });
+    return Promise->GetFuture();
+}
+
+TFuture<FEmbeddingsResults> URequestRouter::SubmitAsync(
+    const TArray<FEmbeddings>& Requests, const TArray<FString>& CustomIds, const FTimespan& LatencyTolerance)
+{
+    const auto Promise = MakeShared<TPromise<FEmbeddingsResults>>();
+    Submit(Requests, CustomIds, LatencyTolerance, [Promise](const FEmbeddingsResults& Results) { Promise->SetValue(Results); });
+    return Promise->GetFuture();
+}
+
+template <typename RequestType, typename ResponseType>
+ERequestRoute URequestRouter::Route(const TArray<RequestType>& Requests, const TArray<FString>& CustomIds,
+    const FTimespan& LatencyTolerance, const TFunction<void(const TArray<TRoutedResult<ResponseType>>&)>& OnCompleted)
+{
+    check(IsInGameThread());
+    check(Requests.Num() == CustomIds.Num());
+
+    if (Requests.IsEmpty())
+    {
+        OnCompleted({});
+        return ERequestRoute::Sync;
+    }
+
+    if (ChooseRoute(Requests.Num(), LatencyTolerance) == ERequestRoute::Batch)
+    {
+        if (SubmitBatch(Requests, CustomIds, OnCompleted)) return ERequestRoute::Batch;
+        UE_LOGFMT(LogRequestRouter, Warning, "Batch submission failed, {0} request(s) are sent directly", Requests.Num());
+    }
+
+    SubmitSync(Requests, CustomIds, OnCompleted);
+    return ERequestRoute::Sync;
+}
+
+template <typename RequestType, typename ResponseType>
+void URequestRouter::SubmitSync(const TArray<RequestType>& Requests, const TArray<FString>& CustomIds,
+    const TFunction<void(const TArray<TRoutedResult<ResponseType>>&)>& OnCompleted)
+{
+    using FTraits = TRouteTraits<RequestType>;
+
+    const auto State = MakeShared<TSyncState<ResponseType>>();
+    State->Results.SetNum(Requests.Num());
+    State->NumPending = Requests.Num();
+    State->OnCompleted = OnCompleted;
+
+    for (int32 Index = 0; Index < Requests.Num(); ++Index)
+    {
+        State->Results[Index].CustomId = CustomIds[Index];
+
+        SyncQueue.Enqueue(
+            [this, State, Index, Request = Requests[Index]]()
+            {
+                auto* Provider = NewObject<UOpenAIProvider>(this, ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass());
+                Providers.Add(Provider);
+
+                FTraits::OnCompleted(Provider).AddWeakLambda(this,
+                    [this, Provider, State, Index](const ResponseType& Response)
+                    {
+                        auto& Result = State->Results[Index];
+                        Result.Response = Response;
+                        Result.Succeeded = true;
+                        OnSyncRequestFinished(Provider);
+                        State->OnRequestFinished();
+                    });
+                Provider->OnRequestError().AddWeakLambda(this,
+                    [this, Provider, State, Index](const FString& URL, const FString& Content)
+                    {
+                        State->Results[Index].Error = Content;
+                        OnSyncRequestFinished(Provider);
+                        State->OnRequestFinished();
+                    });
+                FTraits::Send(Provider, Request, Auth);
+            });
+        ++NumQueued;
+    }
+
+    PumpSyncQueue();
+}
+
+template <typename RequestType, typename ResponseType>
+bool URequestRouter::SubmitBatch(const TArray<RequestType>& Requests, const TArray<FString>& CustomIds,
+    const TFunction<void(const TArray<TRoutedResult<ResponseType>>&)>& OnCompleted)
+{
+    using FTraits = TRouteTraits<RequestType>;
+
+    FBatchInputBuilder Builder(FTraits::Endpoint);
+    Builder.Add(Requests, CustomIds);
+
+    auto* Orchestrator = NewObject<UBatchOrchestrator>(this);
+    Orchestrator->SetAuth(Auth);
+    Orchestrator->SetProviderClass(ProviderClass);
+    const auto Finished = MakeShared<bool>(false);
+    Orchestrator->OnCompleted().AddWeakLambda(this,
+        [this, Orchestrator, Finished, Requests, CustomIds, OnCompleted](const FBatchResults& BatchResults)
+        {
+            *Finished = true;
+            Orchestrators.RemoveSingleSwap(Orchestrator);
+
+            TArray<TRoutedResult<ResponseType>> Results;
+            Results.SetNum(CustomIds.Num());
+            ParallelFor(CustomIds.Num(),
+                [&](int32 Index)
+                {
+                    auto& Result = Results[Index];
+                    Result.CustomId = CustomIds[Index];
+
+                    TBatchResult<ResponseType> BatchResult;
+                    if (!BatchResults.Find(Result.CustomId, BatchResult)) return;
+
+                    Result.Succeeded = BatchResult.Succeeded();
+                    Result.Error = BatchResult.Error.Message;
+                    Result.Response = MoveTemp(BatchResult.Body);
+                });
+
+            // upload or batch creation failed, or the batch expired: the rest goes the direct route
+            TArray<int32> Unprocessed;
+            for (int32 Index = 0; Index < CustomIds.Num(); ++Index)
+            {
+                if (!BatchResults.Contains(CustomIds[Index]))
+                {
+                    Unprocessed.Add(Index);
+                }
+            }
+            if (Unprocessed.IsEmpty())
+            {
+                OnCompleted(Results);
+                return;
+            }
+
+            UE_LOGFMT(LogRequestRouter, Warning, "{0} request(s) weren't processed by the batch and are sent directly", Unprocessed.Num());
+
+            TArray<RequestType> SyncRequests;
+            TArray<FString> SyncCustomIds;
+            for (const int32 Index : Unprocessed)
+            {
+                SyncRequests.Add(Requests[Index]);
+                SyncCustomIds.Add(CustomIds[Index]);
+            }
+            SubmitSync<RequestType, ResponseType>(SyncRequests, SyncCustomIds,
+                [Results = MoveTemp(Results), Unprocessed, OnCompleted](const TArray<TRoutedResult<ResponseType>>& SyncResults) mutable
+                {
+                    for (int32 SyncIndex = 0; SyncIndex < SyncResults.Num(); ++SyncIndex)
+                    {
+                        Results[Unprocessed[SyncIndex]] = SyncResults[SyncIndex];
+                    }
+                    OnCompleted(Results);
+                });
+        });
+
+    // file names must not collide with other batches that are still running
+    const FString Name = FString::Printf(TEXT("routed_%s"), *FGuid::NewGuid().ToString(EGuidFormats::Digits));
+    Orchestrator->Submit(Builder, Name);
+    // the orchestrator can finish right away, e.g. when the upload fails synchronously
+    if (!Orchestrator->IsRunning()) return *Finished;
+
+    Orchestrators.Add(Orchestrator);
+    return true;
+}
+
+void URequestRouter::PumpSyncQueue()
+{
+    TFunction<void()> Send;
+    while (NumInFlight < Policy.MaxConcurrentRequests && SyncQueue.Dequeue(Send))
+    {
+        --NumQueued;
+        ++NumInFlight;
+        Send();
+    }
+}
+
+void URequestRouter::OnSyncRequestFinished(UOpenAIProvider* Provider)
+{
+    Providers.RemoveSingleSwap(Provider);
+    --NumInFlight;
+    PumpSyncQueue();
+}
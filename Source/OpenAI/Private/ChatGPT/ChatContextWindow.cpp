@@ -0,0 +1,143 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "ChatGPT/ChatContextWindow.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "Provider/ModelRegistry.h"
+
+using namespace OpenAI;
+
+namespace
+{
+// https://cookbook.openai.com/examples/how_to_count_tokens_with_tiktoken
+constexpr int32 TokensPerMessage = 3;
+constexpr int32 TokensPerName = 1;
+constexpr int32 TokensPerImage = 85;
+
+FString MakeTranscriptLine(const FMessage& Message)
+{
+    FString Line = Message.Name.IsSet ? FString::Printf(TEXT("%s (%s): "), *Message.Role, *Message.Name.Value) : Message.Role + TEXT(": ");
+    Line.Append(Message.Content);
+    for (const FMessageContent& Content : Message.ContentArray)
+    {
+        Line.Append(Content.Text);
+    }
+    for (const FToolCalls& ToolCall : Message.Tool_Calls)
+    {
+        Line.Appendf(TEXT("[called %s(%s)]"), *ToolCall.Function.Name, *ToolCall.Function.Arguments);
+    }
+    return Line;
+}
+}  // namespace
+
+int32 FChatContextWindow::GetModelContextWindow(const FString& Model)
+{
+    return FModelRegistry::Get()->Find(Model).Context_Window;
+}
+
+int32 FChatContextWindow::CountMessageTokens(const FMessage& Message, const FTokenCounter& TokenCounter)
+{
+    int32 Tokens = TokensPerMessage + TokenCounter(Message.Role) + TokenCounter(Message.Content);
+    if (Message.Name.IsSet)
+    {
+        Tokens += TokensPerName + TokenCounter(Message.Name.Value);
+    }
+    for (const FMessageContent& Content : Message.ContentArray)
+    {
+        Tokens += Content.Type.Equals(TEXT("image_url")) ? TokensPerImage : TokenCounter(Content.Text);
+    }
+    for (const FToolCalls& ToolCall : Message.Tool_Calls)
+    {
+        Tokens += TokensPerMessage + TokenCounter(ToolCall.ID) + TokenCounter(ToolCall.Function.Name) +
+                  TokenCounter(ToolCall.Function.Arguments);
+    }
+    if (Message.Tool_Call_ID.IsSet)
+    {
+        Tokens += TokenCounter(Message.Tool_Call_ID.Value);
+    }
+    return Tokens;
+}
+
+bool FChatContextWindow::IsPinned(const FMessage& Message)
+{
+    return Message.Role.Equals(UOpenAIFuncLib::OpenAIRoleToString(ERole::System));
+}
+
+int32 FChatContextWindow::FindFirstKept(const FChatHistory& History, TArrayView<const int32> MessageTokens, int32 Budget)
+{
+    check(History.Num() == MessageTokens.Num());
+
+    int32 Remaining = Budget;
+    for (int32 Index = 0; Index < History.Num(); ++Index)
+    {
+        Remaining -= IsPinned(History[Index]) ? MessageTokens[Index] : 0;
+    }
+
+    int32 FirstKept = History.Num();
+    for (int32 Index = History.Num() - 1; Index >= 0; --Index)
+    {
+        if (IsPinned(History[Index])) continue;
+        if (FirstKept < History.Num() && MessageTokens[Index] > Remaining) break;
+
+        Remaining -= MessageTokens[Index];
+        FirstKept = Index;
+    }
+
+    // results of an evicted tool call would be rejected by the API
+    const FString ToolRole = UOpenAIFuncLib::OpenAIRoleToString(ERole::Tool);
+    while (FirstKept < History.Num() - 1 && History[FirstKept].Role.Equals(ToolRole))
+    {
+        ++FirstKept;
+    }
+    return FirstKept;
+}
+
+TArray<FMessage> FChatContextWindow::MakeMessages(const FChatHistory& History, int32 FirstKept, const FString& Summary)
+{
+    TArray<FMessage> Messages;
+    Messages.Reserve(History.Num() - FirstKept + 2);
+    for (int32 Index = 0; Index < FirstKept; ++Index)
+    {
+        if (IsPinned(History[Index]))
+        {
+            Messages.Add(History[Index]);
+        }
+    }
+
+    if (!Summary.IsEmpty())
+    {
+        FMessage& SummaryMessage = Messages.AddDefaulted_GetRef();
+        SummaryMessage.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::System);
+        SummaryMessage.Content = TEXT("Summary of the earlier conversation:\n") + Summary;
+    }
+
+    for (int32 Index = FirstKept; Index < History.Num(); ++Index)
+    {
+        Messages.Add(History[Index]);
+    }
+    return Messages;
+}
+
+TArray<FMessage> FChatContextWindow::MakeSummaryMessages(TArrayView<const FMessage> Evicted, const FString& PreviousSummary)
+{
+    FString Transcript;
+    if (!PreviousSummary.IsEmpty())
+    {
+        Transcript.Append(TEXT("Summary so far:\n")).Append(PreviousSummary).Append(TEXT("\n\n"));
+    }
+    Transcript.Append(TEXT("New messages:\n"));
+    for (const FMessage& Message : Evicted)
+    {
+        Transcript.Append(MakeTranscriptLine(Message)).AppendChar('\n');
+    }
+
+    TArray<FMessage> Messages;
+    FMessage& Instructions = Messages.AddDefaulted_GetRef();
+    Instructions.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::System);
+    Instructions.Content = TEXT("Update the summary of a conversation for the assistant that continues it. Keep names, facts, decisions, ")
+                           TEXT("promises and open questions, drop small talk. Answer with the summary only.");
+
+    FMessage& Request = Messages.AddDefaulted_GetRef();
+    Request.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::User);
+    Request.Content = MoveTemp(Transcript);
+    return Messages;
+}
@@ -2,45 +2,17 @@
 
 #include "ChatGPT/ChatGPT.h"
 #include "Provider/OpenAIProvider.h"
-#include "Algo/ForEach.h"
+#include "Provider/ChatStream.h"
+#include "Provider/ModelRegistry.h"
 #include "FuncLib/OpenAIFuncLib.h"
 #include "FuncLib/JsonFuncLib.h"
 #include "ChatGPT/BaseService.h"
+#include "Tokenizer/BPETokenizer.h"
 #include "Logging/StructuredLog.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogChatGPT, All, All);
 
-namespace
-{
-FString GatherChunkResponse(const TArray<FChatCompletionStreamResponse>& Responses)
-{
-    FString OutputString{};
-    Algo::ForEach(Responses, [&](const FChatCompletionStreamResponse& StreamResponse) {  //
-        Algo::ForEach(StreamResponse.Choices, [&](const FChatStreamChoice& Choice) {     //
-            OutputString.Append(Choice.Delta.Content);
-        });
-    });
-
-    return OutputString;
-}
-
-bool GatherFunctionResponse(const TArray<FChatCompletionStreamResponse>& Responses, FFunctionCommon& FunctionCall, FString& ID)
-{
-    bool NeedToCallFunction{false};
-    Algo::ForEach(Responses, [&](const FChatCompletionStreamResponse& StreamResponse) {  //
-        Algo::ForEach(StreamResponse.Choices, [&](const FChatStreamChoice& Choice) {     //
-            ID.Append(Choice.Delta.Tool_Calls.ID);
-            FunctionCall.Arguments.Append(Choice.Delta.Tool_Calls.Function.Arguments);
-            FunctionCall.Name.Append(Choice.Delta.Tool_Calls.Function.Name);
-            if (UOpenAIFuncLib::StringToOpenAIFinishReason(Choice.Finish_Reason) == EOpenAIFinishReason::Tool_Calls)
-            {
-                NeedToCallFunction = true;
-            }
-        });
-    });
-    return NeedToCallFunction;
-}
-}  // namespace
+using namespace OpenAI;
 
 UChatGPT::UChatGPT()
 {
@@ -52,28 +24,40 @@ UChatGPT::UChatGPT()
             HandleError(Content);
             HandleRequestCompletion();
         });
-    Provider->OnCreateChatCompletionStreamProgresses().AddLambda([&](const TArray<FChatCompletionStreamResponse>& Responses) {  //
-        const FString GatherdChunk = GatherChunkResponse(Responses);
-        UpdateAssistantMessage(GatherdChunk);
-    });
-    Provider->OnCreateChatCompletionStreamCompleted().AddLambda(
-        [&](const TArray<FChatCompletionStreamResponse>& Responses)  //
+    Provider->OnCreateChatCompletionStreamUpdated().AddLambda(
+        [&](const FChatStream& Stream, bool Completed)
         {
-            FFunctionCommon FunctionCall{};
-            FString ID;
-            if (GatherFunctionResponse(Responses, FunctionCall, ID))
+            const FChatStreamMessage* Message = Stream.FindMessage();
+            if (!Completed)
+            {
+                UpdateAssistantMessage(Message ? Message->Content : FString{});
+                return;
+            }
+
+            if (Message)
             {
-                if (!HandleFunctionCall(FunctionCall, ID))
-                {
-                    HandleError("");
-                    HandleRequestCompletion();
-                }
+                HandleResponseCompletion(Message->FinishReason, Message->ToolCalls);
             }
             else
             {
                 HandleRequestCompletion();
             }
         });
+    // models without streaming
+    Provider->OnCreateChatCompletionCompleted().AddLambda(
+        [&](const FChatCompletionResponse& Response)
+        {
+            if (Response.Choices.IsEmpty())
+            {
+                HandleRequestCompletion();
+                return;
+            }
+
+            const FChatChoice& Choice = Response.Choices[0];
+            UpdateAssistantMessage(Choice.Message.Content);
+            HandleResponseCompletion(
+                UOpenAIFuncLib::FindOpenAIFinishReason(Choice.Finish_Reason).Get(EOpenAIFinishReason::Null), Choice.Message.Tool_Calls);
+        });
 }
 
 void UChatGPT::SetLogEnabled(bool Enabled)
@@ -83,9 +67,11 @@ void UChatGPT::SetLogEnabled(bool Enabled)
 
 void UChatGPT::MakeRequest()
 {
+    const TSharedRef<const FModelRegistry> Registry = FModelRegistry::Get();
+    const FModelCapabilities& Model = Registry->Find(OpenAIModel);
+
     TArray<FTools> AvailableTools;
-    // tools are currently are not supported by vision models
-    if (!UOpenAIFuncLib::ModelSupportsVision(OpenAIModel))
+    if (Model.Tools)
     {
         for (const auto& Service : Services)
         {
@@ -95,19 +81,120 @@ void UChatGPT::MakeRequest()
 
     FChatCompletion ChatCompletion;
     ChatCompletion.Model = OpenAIModel;
-    ChatCompletion.Messages = ChatHistory;
-    ChatCompletion.Max_Completion_Tokens.Set(MaxCompletionTokens);
-    ChatCompletion.Stream = true;
+    const int32 CompletionTokens = GetCompletionTokens(Model);
+    ChatCompletion.Messages = MakeContextMessages(Model, CompletionTokens);
+    ChatCompletion.Max_Completion_Tokens.Set(CompletionTokens);
+    ChatCompletion.Stream = Model.Streaming;
     ChatCompletion.Tools = AvailableTools;
     Provider->CreateChatCompletion(ChatCompletion, Auth);
 }
 
+int32 UChatGPT::GetCompletionTokens(const FModelCapabilities& Model) const
+{
+    return Model.Max_Output_Tokens > 0 ? FMath::Min(MaxCompletionTokens, Model.Max_Output_Tokens) : MaxCompletionTokens;
+}
+
+TArray<FMessage> UChatGPT::MakeContextMessages(const FModelCapabilities& Model, int32 CompletionTokens)
+{
+    const FTokenCounter TokenCounter = FBPETokenizer::MakeTokenCounter(FBPETokenizer::GetEncodingForModel(OpenAIModel));
+    for (int32 Index = MessageTokens.Num(); Index < ChatHistory.Num(); ++Index)
+    {
+        MessageTokens.Add(FChatContextWindow::CountMessageTokens(ChatHistory[Index], TokenCounter));
+    }
+
+    const int32 ContextWindow = ContextPolicy.ContextWindowTokens > 0 ? ContextPolicy.ContextWindowTokens : Model.Context_Window;
+    int32 Budget = ContextWindow - CompletionTokens - ContextPolicy.ReservedTokens;
+    if (ContextPolicy.MaxHistoryTokens > 0)
+    {
+        Budget = FMath::Min(Budget, ContextPolicy.MaxHistoryTokens);
+    }
+    // the summary always takes its share, so the request size doesn't jump when it arrives
+    const bool bSummaryEnabled = !ContextPolicy.SummaryModel.IsEmpty();
+    if (bSummaryEnabled)
+    {
+        Budget -= ContextPolicy.MaxSummaryTokens;
+    }
+
+    const int32 FirstKept = FChatContextWindow::FindFirstKept(ChatHistory, MessageTokens, Budget);
+    if (bSummaryEnabled && FirstKept > NumSummarized)
+    {
+        RequestSummary(FirstKept);
+    }
+    return FChatContextWindow::MakeMessages(ChatHistory, FirstKept, ContextSummary);
+}
+
+void UChatGPT::RequestSummary(int32 FirstKept)
+{
+    if (bSummaryInProgress) return;
+
+    TArray<FMessage> Evicted;
+    for (int32 Index = NumSummarized; Index < FirstKept; ++Index)
+    {
+        if (!FChatContextWindow::IsPinned(ChatHistory[Index]))
+        {
+            Evicted.Add(ChatHistory[Index]);
+        }
+    }
+    if (Evicted.IsEmpty())
+    {
+        NumSummarized = FirstKept;
+        return;
+    }
+
+    if (!SummaryProvider)
+    {
+        SummaryProvider = NewObject<UOpenAIProvider>(this);
+        SummaryProvider->OnCreateChatCompletionCompleted().AddLambda(
+            [this](const FChatCompletionResponse& Response)
+            {
+                bSummaryInProgress = false;
+                if (PendingSummaryEnd == INDEX_NONE || Response.Choices.IsEmpty()) return;
+
+                ContextSummary = Response.Choices[0].Message.Content;
+                NumSummarized = PendingSummaryEnd;
+                PendingSummaryEnd = INDEX_NONE;
+            });
+        SummaryProvider->OnRequestError().AddLambda(
+            [this](const FString& URL, const FString& Content)
+            {
+                // the evicted messages are summarized with the next request
+                bSummaryInProgress = false;
+                PendingSummaryEnd = INDEX_NONE;
+                UE_LOGFMT(LogChatGPT, Warning, "Can't summarize the chat history: {0}", Content);
+            });
+    }
+
+    FChatCompletion Completion;
+    Completion.Model = ContextPolicy.SummaryModel;
+    Completion.Messages = FChatContextWindow::MakeSummaryMessages(Evicted, ContextSummary);
+    Completion.Max_Completion_Tokens.Set(ContextPolicy.MaxSummaryTokens);
+
+    bSummaryInProgress = true;
+    PendingSummaryEnd = FirstKept;
+    SummaryProvider->CreateChatCompletion(Completion, Auth);
+}
+
 void UChatGPT::HandleRequestCompletion()
 {
     ChatHistory.Add(AssistantMessage);
     RequestCompleted.Broadcast();
 }
 
+void UChatGPT::HandleResponseCompletion(EOpenAIFinishReason FinishReason, TConstArrayView<FToolCalls> ToolCalls)
+{
+    if (FinishReason != EOpenAIFinishReason::Tool_Calls || ToolCalls.IsEmpty())
+    {
+        HandleRequestCompletion();
+        return;
+    }
+
+    if (!HandleFunctionCall(ToolCalls[0].Function, ToolCalls[0].ID))
+    {
+        HandleError("");
+        HandleRequestCompletion();
+    }
+}
+
 void UChatGPT::UpdateAssistantMessage(const FString& Message, bool WasError)
 {
     AssistantMessage.Content = Message;
@@ -229,6 +316,8 @@ void UChatGPT::SetAuth(const FOpenAIAuth& OpenAIAuth)
 void UChatGPT::SetModel(const FString& Model)
 {
     OpenAIModel = Model;
+    // the model may use another encoding
+    MessageTokens.Reset();
 }
 
 FString UChatGPT::GetModel() const
@@ -241,6 +330,16 @@ void UChatGPT::SetMaxTokens(int32 Tokens)
     MaxCompletionTokens = Tokens;
 }
 
+void UChatGPT::SetContextPolicy(const FChatContextPolicy& Policy)
+{
+    ContextPolicy = Policy;
+}
+
+FString UChatGPT::GetContextSummary() const
+{
+    return ContextSummary;
+}
+
 void UChatGPT::AddMessage(const FMessage& Message)
 {
     ChatHistory.Add(Message);
@@ -258,10 +357,14 @@ FMessage UChatGPT::GetAssistantMessage() const
 
 void UChatGPT::ClearHistory()
 {
-    ChatHistory.Empty();
+    SetHistory(FChatHistory{});
 }
 
-TArray<FMessage> UChatGPT::GetHistory() const
+void UChatGPT::SetHistory(const FChatHistory& History)
 {
-    return ChatHistory;
+    ChatHistory = History;
+    MessageTokens.Empty();
+    ContextSummary.Empty();
+    NumSummarized = 0;
+    PendingSummaryEnd = INDEX_NONE;
 }
@@ -2,36 +2,46 @@
 
 #include "ChatGPT/ChatGPTWorld.h"
 #include "FuncLib/OpenAIFuncLib.h"
-#include "ChatGPT/ChatGPT.h"
+#include "ChatGPT/ChatSessionSubsystem.h"
 
 void AChatGPTWorld::BeginPlay()
 {
     Super::BeginPlay();
 
-    ChatGPT = NewObject<UChatGPT>();
-    check(ChatGPT);
+    ChatSessions = GetWorld()->GetSubsystem<UChatSessionSubsystem>();
+    check(ChatSessions);
 
-    ChatGPT->SetLogEnabled(true);
-    ChatGPT->SetMaxTokens(MaxTokens);
-    ChatGPT->SetModel(UOpenAIFuncLib::OpenAIMainModelToString(Model));
+    if (!ChatSessions->CreateSession(GetFName(), UOpenAIFuncLib::OpenAIMainModelToString(Model), MaxTokens)) return;
 
-    ChatGPT->OnRequestCompleted().AddUObject(this, &ThisClass::OnRequestCompleted);
-    ChatGPT->OnRequestUpdated().AddUObject(this, &ThisClass::OnRequestUpdated);
+    // the actor gets the events of its own session only
+    ChatSessions->OnSessionMessageCompleted(GetFName())->AddUObject(this, &ThisClass::OnRequestCompleted);
+    ChatSessions->OnSessionMessageUpdated(GetFName())->AddUObject(this, &ThisClass::OnRequestUpdated);
+}
+
+void AChatGPTWorld::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (ChatSessions)
+    {
+        // the events are removed with the session
+        ChatSessions->RemoveSession(GetFName());
+    }
+
+    Super::EndPlay(EndPlayReason);
 }
 
 void AChatGPTWorld::SetAuth(const FOpenAIAuth& Auth)
 {
-    if (ChatGPT)
+    if (ChatSessions)
     {
-        ChatGPT->SetAuth(Auth);
+        ChatSessions->SetAuth(Auth);
     }
 }
 
 void AChatGPTWorld::SetModel(const FString& ModelName)
 {
-    if (ChatGPT)
+    if (ChatSessions)
     {
-        ChatGPT->SetModel(ModelName);
+        ChatSessions->SetSessionModel(GetFName(), ModelName);
     }
 }
 
@@ -39,14 +49,7 @@ void AChatGPTWorld::MakeRequest(const FMessage& Message)
 {
     if (bIsInProgress) return;
 
-    bIsInProgress = true;
-
-    ChatGPT->AddMessage(Message);
-
-    const auto AssistantMessage = FMessage{UOpenAIFuncLib::OpenAIRoleToString(ERole::Assistant), {}};
-    ChatGPT->SetAssistantMessage(AssistantMessage);
-
-    ChatGPT->MakeRequest();
+    bIsInProgress = ChatSessions->MakeRequest(GetFName(), Message);
 }
 
 void AChatGPTWorld::OnRequestUpdated(const FMessage& Message, bool WasError)
@@ -55,8 +58,9 @@ void AChatGPTWorld::OnRequestUpdated(const FMessage& Message, bool WasError)
     OnGPTRequestUpdated.Broadcast(Message);
 }
 
-void AChatGPTWorld::OnRequestCompleted()
+void AChatGPTWorld::OnRequestCompleted(const FMessage& Message)
 {
     bIsInProgress = false;
+    LastMessage = Message;
     OnGPTRequestCompleted.Broadcast(LastMessage);
 }
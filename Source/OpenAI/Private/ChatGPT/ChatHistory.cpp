@@ -0,0 +1,130 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "ChatGPT/ChatHistory.h"
+
+using namespace OpenAI;
+
+FChatHistory::FChatHistory() : Root(MakeShared<FNode>()), Tail(MakeShared<FNode>()) {}
+
+FChatHistory::FChatHistory(TArrayView<const FMessage> Messages) : FChatHistory()
+{
+    for (const FMessage& Message : Messages)
+    {
+        Add(Message);
+    }
+}
+
+const FChatHistory::FMessageRef& FChatHistory::GetRef(int32 Index) const
+{
+    check(IsValidIndex(Index));
+    return Index >= TailOffset() ? Tail->Messages[Index & Mask] : FindLeaf(Index).Messages[Index & Mask];
+}
+
+const FChatHistory::FNode& FChatHistory::FindLeaf(int32 Index) const
+{
+    const FNode* Node = &Root.Get();
+    for (int32 Level = Shift; Level > 0; Level -= Bits)
+    {
+        Node = &Node->Children[(Index >> Level) & Mask].Get();
+    }
+    return *Node;
+}
+
+void FChatHistory::Add(const FMessage& Message)
+{
+    Add(MakeShared<FMessage>(Message));
+}
+
+void FChatHistory::Add(FMessage&& Message)
+{
+    Add(MakeShared<FMessage>(MoveTemp(Message)));
+}
+
+void FChatHistory::Add(const FMessageRef& Message)
+{
+    if (Count - TailOffset() < Width)
+    {
+        // snapshots keep their own tail
+        if (!Tail.IsUnique())
+        {
+            Tail = MakeShared<FNode>(*Tail);
+        }
+        Tail->Messages.Add(Message);
+        ++Count;
+        return;
+    }
+
+    // the full tail becomes a leaf of the trie
+    const FNodeRef Leaf = Tail;
+    if ((Count >> Bits) > (1 << Shift))
+    {
+        const auto NewRoot = MakeShared<FNode>();
+        NewRoot->Children.Add(Root);
+        NewRoot->Children.Add(MakePath(Shift, Leaf));
+        Root = NewRoot;
+        Shift += Bits;
+    }
+    else
+    {
+        Root = PushTail(Shift, Root, Leaf);
+    }
+
+    Tail = MakeShared<FNode>();
+    Tail->Messages.Reserve(Width);
+    Tail->Messages.Add(Message);
+    ++Count;
+}
+
+FChatHistory::FNodeRef FChatHistory::PushTail(int32 Level, const FNodeRef& Parent, const FNodeRef& Leaf) const
+{
+    const int32 ChildIndex = ((Count - 1) >> Level) & Mask;
+    const auto Node = MakeShared<FNode>(*Parent);
+    if (Level == Bits)
+    {
+        Node->Children.Add(Leaf);
+    }
+    else if (Node->Children.IsValidIndex(ChildIndex))
+    {
+        Node->Children[ChildIndex] = PushTail(Level - Bits, Node->Children[ChildIndex], Leaf);
+    }
+    else
+    {
+        Node->Children.Add(MakePath(Level - Bits, Leaf));
+    }
+    return Node;
+}
+
+FChatHistory::FNodeRef FChatHistory::MakePath(int32 Level, const FNodeRef& Leaf)
+{
+    if (Level == 0) return Leaf;
+
+    const auto Node = MakeShared<FNode>();
+    Node->Children.Add(MakePath(Level - Bits, Leaf));
+    return Node;
+}
+
+void FChatHistory::Reset()
+{
+    *this = FChatHistory();
+}
+
+FChatHistory FChatHistory::Left(int32 NumMessages) const
+{
+    NumMessages = FMath::Clamp(NumMessages, 0, Count);
+    if (NumMessages == Count) return *this;
+
+    FChatHistory History;
+    for (int32 Index = 0; Index < NumMessages; ++Index)
+    {
+        History.Add(GetRef(Index));
+    }
+    return History;
+}
+
+TArray<FMessage> FChatHistory::ToArray() const
+{
+    TArray<FMessage> Messages;
+    Messages.Reserve(Count);
+    ForEach([&](const FMessage& Message) { Messages.Add(Message); });
+    return Messages;
+}
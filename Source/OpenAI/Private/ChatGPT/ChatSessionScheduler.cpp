@@ -0,0 +1,137 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "ChatGPT/ChatSessionScheduler.h"
+
+using namespace OpenAI;
+
+void FChatSessionScheduler::SetMaxConcurrentRequests(int32 MaxRequests)
+{
+    MaxConcurrentRequests = FMath::Max(MaxRequests, 1);
+}
+
+void FChatSessionScheduler::SetHistoryMemoryBudget(int64 Bytes)
+{
+    HistoryMemoryBudget = FMath::Max<int64>(Bytes, 0);
+}
+
+void FChatSessionScheduler::Add(FName Session)
+{
+    if (Sessions.Contains(Session)) return;
+
+    Sessions.Add(Session).LastUsed = ++Clock;
+}
+
+void FChatSessionScheduler::Remove(FName Session)
+{
+    const FSessionState* State = Sessions.Find(Session);
+    if (!State) return;
+
+    if (State->bQueued)
+    {
+        Queue.RemoveSingle(Session);
+    }
+    if (State->bRunning)
+    {
+        --Running;
+    }
+    if (!State->bHibernated)
+    {
+        AwakeHistoryBytes -= State->HistoryBytes;
+    }
+    Sessions.Remove(Session);
+}
+
+bool FChatSessionScheduler::Enqueue(FName Session)
+{
+    FSessionState* State = Sessions.Find(Session);
+    if (!State || State->bQueued || State->bRunning) return false;
+
+    State->bQueued = true;
+    State->LastUsed = ++Clock;
+    Queue.Add(Session);
+    return true;
+}
+
+FName FChatSessionScheduler::StartNext()
+{
+    if (Running >= MaxConcurrentRequests || Queue.IsEmpty()) return NAME_None;
+
+    const FName Session = Queue[0];
+    Queue.RemoveAt(0);
+
+    FSessionState& State = Sessions.FindChecked(Session);
+    State.bQueued = false;
+    State.bRunning = true;
+    ++Running;
+    return Session;
+}
+
+void FChatSessionScheduler::Complete(FName Session)
+{
+    FSessionState* State = Sessions.Find(Session);
+    if (!State || !State->bRunning) return;
+
+    State->bRunning = false;
+    State->LastUsed = ++Clock;
+    --Running;
+}
+
+bool FChatSessionScheduler::IsBusy(FName Session) const
+{
+    const FSessionState* State = Sessions.Find(Session);
+    return State && (State->bQueued || State->bRunning);
+}
+
+void FChatSessionScheduler::Touch(FName Session, int64 HistoryBytes)
+{
+    FSessionState* State = Sessions.Find(Session);
+    if (!State) return;
+
+    if (!State->bHibernated)
+    {
+        AwakeHistoryBytes += HistoryBytes - State->HistoryBytes;
+    }
+    State->HistoryBytes = HistoryBytes;
+    State->LastUsed = ++Clock;
+}
+
+void FChatSessionScheduler::SetHibernated(FName Session, bool bHibernated)
+{
+    FSessionState* State = Sessions.Find(Session);
+    if (!State || State->bHibernated == bHibernated) return;
+
+    State->bHibernated = bHibernated;
+    AwakeHistoryBytes += bHibernated ? -State->HistoryBytes : State->HistoryBytes;
+}
+
+bool FChatSessionScheduler::IsHibernated(FName Session) const
+{
+    const FSessionState* State = Sessions.Find(Session);
+    return State && State->bHibernated;
+}
+
+TArray<FName> FChatSessionScheduler::FindSessionsToHibernate() const
+{
+    TArray<FName> Result;
+    if (HistoryMemoryBudget == 0 || AwakeHistoryBytes <= HistoryMemoryBudget) return Result;
+
+    TArray<TPair<uint64, FName>> Idle;
+    for (const auto& [Session, State] : Sessions)
+    {
+        if (!State.bHibernated && !State.bQueued && !State.bRunning && State.HistoryBytes > 0)
+        {
+            Idle.Emplace(State.LastUsed, Session);
+        }
+    }
+    Idle.Sort([](const TPair<uint64, FName>& A, const TPair<uint64, FName>& B) { return A.Key < B.Key; });
+
+    int64 Bytes = AwakeHistoryBytes;
+    for (const auto& [LastUsed, Session] : Idle)
+    {
+        if (Bytes <= HistoryMemoryBudget) break;
+
+        Bytes -= Sessions[Session].HistoryBytes;
+        Result.Add(Session);
+    }
+    return Result;
+}
@@ -0,0 +1,672 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "ChatGPT/ChatSessionSubsystem.h"
+#include "ChatGPT/ChatContextWindow.h"
+#include "ChatGPT/BaseService.h"
+#include "Provider/OpenAIProvider.h"
+#include "Provider/ChatStream.h"
+#include "Provider/ModelRegistry.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Tokenizer/BPETokenizer.h"
+#include "JsonObjectConverter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogChatSession, All, All);
+
+namespace OpenAI
+{
+struct FChatSession
+{
+    FString Model;
+    int32 MaxTokens{2000};
+
+    FChatHistory History;
+    /**
+      Tokens of the history messages, counted once when the messages are sent the first time.
+      They are kept while the history is hibernated and are reset when the history or the model changes.
+    */
+    TArray<int32> MessageTokens;
+    int64 HistoryBytes{0};
+    bool bHibernated{false};
+
+    FMessage AssistantMessage;
+
+    FOnChatSessionMessageUpdated OnUpdated;
+    FOnChatSessionMessageCompleted OnCompleted;
+};
+}  // namespace OpenAI
+
+using namespace OpenAI;
+
+namespace
+{
+/**
+  Letters, digits, '-' and '_' are kept and the rest are escaped with their code, so different names get different files.
+*/
+FString EscapeFileName(const FString& Name)
+{
+    FString FileName;
+    FileName.Reserve(Name.Len());
+    for (const TCHAR Char : Name)
+    {
+        if ((Char < 128 && FChar::IsAlnum(Char)) || Char == TEXT('-') || Char == TEXT('_'))
+        {
+            FileName.AppendChar(Char);
+        }
+        else
+        {
+            FileName.Appendf(TEXT("%%%04x"), static_cast<uint32>(Char));
+        }
+    }
+    return FileName;
+}
+
+int64 GetMessageBytes(const FMessage& Message)
+{
+    int64 Bytes = sizeof(FMessage) + Message.Content.GetAllocatedSize() + Message.Role.GetAllocatedSize() +
+                  Message.ContentArray.GetAllocatedSize() + Message.Tool_Calls.GetAllocatedSize();
+    for (const FMessageContent& Part : Message.ContentArray)
+    {
+        Bytes += Part.Text.GetAllocatedSize() + Part.Image_URL.URL.GetAllocatedSize();
+    }
+    for (const FToolCalls& ToolCall : Message.Tool_Calls)
+    {
+        Bytes += ToolCall.ID.GetAllocatedSize() + ToolCall.Function.Name.GetAllocatedSize() +
+                 ToolCall.Function.Arguments.GetAllocatedSize();
+    }
+    return Bytes;
+}
+
+bool SaveHistory(const FChatHistory& History, const FString& FilePath)
+{
+    TArray<TSharedPtr<FJsonValue>> Messages;
+    Messages.Reserve(History.Num());
+    History.ForEach([&](const FMessage& Message)
+        { Messages.Add(MakeShared<FJsonValueObject>(FJsonObjectConverter::UStructToJsonObject(Message))); });
+
+    TSharedPtr<FJsonObject> Json = MakeShared<FJsonObject>();
+    Json->SetArrayField(TEXT("messages"), Messages);
+
+    FString Content;
+    return UJsonFuncLib::JsonToString(Json, Content) && FFileHelper::SaveStringToFile(Content, *FilePath);
+}
+
+bool LoadHistory(const FString& FilePath, FChatHistory& History)
+{
+    FString Content;
+    TSharedPtr<FJsonObject> Json;
+    const TArray<TSharedPtr<FJsonValue>>* Messages = nullptr;
+    if (!FFileHelper::LoadFileToString(Content, *FilePath) || !UJsonFuncLib::StringToJson(Content, Json) ||
+        !Json->TryGetArrayField(TEXT("messages"), Messages))
+    {
+        return false;
+    }
+
+    History.Reset();
+    for (const TSharedPtr<FJsonValue>& Value : *Messages)
+    {
+        const TSharedPtr<FJsonObject>* MessageObject = nullptr;
+        FMessage Message;
+        if (!Value->TryGetObject(MessageObject) || !FJsonObjectConverter::JsonObjectToUStruct(MessageObject->ToSharedRef(), &Message))
+        {
+            return false;
+        }
+        History.Add(MoveTemp(Message));
+    }
+    return true;
+}
+}  // namespace
+
+void UChatSessionSubsystem::Deinitialize()
+{
+    for (UOpenAIProvider* Provider : Providers)
+    {
+        Provider->OnRequestError().RemoveAll(this);
+        Provider->OnCreateChatCompletionStreamUpdated().RemoveAll(this);
+        Provider->OnCreateChatCompletionCompleted().RemoveAll(this);
+    }
+    for (UBaseService* Service : Services)
+    {
+        Service->OnServiceDataRecieved().RemoveAll(this);
+        Service->OnServiceDataError().RemoveAll(this);
+    }
+
+    IFileManager::Get().DeleteDirectory(*GetSessionDir(), false, true);
+    Super::Deinitialize();
+}
+
+void UChatSessionSubsystem::SetAuth(const FOpenAIAuth& OpenAIAuth)
+{
+    Auth = OpenAIAuth;
+}
+
+void UChatSessionSubsystem::SetLogEnabled(bool Enabled)
+{
+    bLogEnabled = Enabled;
+    for (UOpenAIProvider* Provider : Providers)
+    {
+        Provider->SetLogEnabled(Enabled);
+    }
+}
+
+void UChatSessionSubsystem::SetMaxConcurrentRequests(int32 MaxRequests)
+{
+    Scheduler.SetMaxConcurrentRequests(MaxRequests);
+    ScheduleRequests();
+}
+
+void UChatSessionSubsystem::SetHistoryMemoryBudget(int64 Bytes)
+{
+    Scheduler.SetHistoryMemoryBudget(Bytes);
+    HibernateOverBudget();
+}
+
+bool UChatSessionSubsystem::CreateSession(FName SessionName, const FString& Model, int32 MaxTokens)
+{
+    if (SessionName.IsNone() || Sessions.Contains(SessionName))
+    {
+        UE_LOGFMT(LogChatSession, Error, "Session {0} can't be created, the name should be unique", SessionName);
+        return false;
+    }
+
+    const TSharedPtr<FChatSession> Session = MakeShared<FChatSession>();
+    Session->Model = Model;
+    Session->MaxTokens = MaxTokens;
+    Session->AssistantMessage.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::Assistant);
+    Sessions.Add(SessionName, Session);
+    Scheduler.Add(SessionName);
+    return true;
+}
+
+void UChatSessionSubsystem::RemoveSession(FName SessionName)
+{
+    if (!Sessions.Remove(SessionName)) return;
+
+    // the slot is busy until the response of the sent request comes, the response is dropped
+    for (FRequestSlot& Slot : Slots)
+    {
+        if (Slot.Session == SessionName)
+        {
+            Slot.Session = NAME_None;
+        }
+    }
+    ServiceCalls.RemoveAll([SessionName](const FServiceCall& Call) { return Call.Session == SessionName; });
+    Scheduler.Remove(SessionName);
+    IFileManager::Get().Delete(*GetSessionFilePath(SessionName), false, true, true);
+    ScheduleRequests();
+}
+
+bool UChatSessionSubsystem::HasSession(FName SessionName) const
+{
+    return Sessions.Contains(SessionName);
+}
+
+void UChatSessionSubsystem::SetSessionModel(FName SessionName, const FString& Model)
+{
+    if (const TSharedPtr<FChatSession>* Session = Sessions.Find(SessionName))
+    {
+        (*Session)->Model = Model;
+        // the model may use another encoding
+        (*Session)->MessageTokens.Reset();
+    }
+}
+
+bool UChatSessionSubsystem::AddMessage(FName SessionName, const FMessage& Message)
+{
+    FChatSession* Session = Wake(SessionName);
+    if (!Session) return false;
+
+    AddToHistory(SessionName, *Session, Message);
+    HibernateOverBudget();
+    return true;
+}
+
+bool UChatSessionSubsystem::MakeRequest(FName SessionName, const FMessage& Message)
+{
+    if (IsInProgress(SessionName)) return false;
+
+    FChatSession* Session = Wake(SessionName);
+    if (!Session) return false;
+
+    AddToHistory(SessionName, *Session, Message);
+    Session->AssistantMessage.Content.Empty();
+    Scheduler.Enqueue(SessionName);
+    ScheduleRequests();
+    HibernateOverBudget();
+    return true;
+}
+
+bool UChatSessionSubsystem::IsInProgress(FName SessionName) const
+{
+    const auto IsSessionCall = [SessionName](const FServiceCall& Call) { return Call.Session == SessionName; };
+    return Scheduler.IsBusy(SessionName) || ServiceCalls.ContainsByPredicate(IsSessionCall);
+}
+
+bool UChatSessionSubsystem::IsHibernated(FName SessionName) const
+{
+    return Scheduler.IsHibernated(SessionName);
+}
+
+FMessage UChatSessionSubsystem::GetAssistantMessage(FName SessionName) const
+{
+    const TSharedPtr<FChatSession>* Session = Sessions.Find(SessionName);
+    return Session ? (*Session)->AssistantMessage : FMessage{};
+}
+
+FOnChatSessionMessageUpdated* UChatSessionSubsystem::OnSessionMessageUpdated(FName SessionName)
+{
+    const TSharedPtr<FChatSession>* Session = Sessions.Find(SessionName);
+    return Session ? &(*Session)->OnUpdated : nullptr;
+}
+
+FOnChatSessionMessageCompleted* UChatSessionSubsystem::OnSessionMessageCompleted(FName SessionName)
+{
+    const TSharedPtr<FChatSession>* Session = Sessions.Find(SessionName);
+    return Session ? &(*Session)->OnCompleted : nullptr;
+}
+
+FChatHistory UChatSessionSubsystem::GetHistory(FName SessionName)
+{
+    const FChatSession* Session = Wake(SessionName);
+    return Session ? Session->History : FChatHistory{};
+}
+
+void UChatSessionSubsystem::SetHistory(FName SessionName, const FChatHistory& History)
+{
+    FChatSession* Session = Wake(SessionName);
+    if (!Session) return;
+
+    Session->History = History;
+    Session->MessageTokens.Empty();
+    Session->HistoryBytes = 0;
+    History.ForEach([&](const FMessage& Message) { Session->HistoryBytes += GetMessageBytes(Message); });
+    Scheduler.Touch(SessionName, Session->HistoryBytes);
+    HibernateOverBudget();
+}
+
+void UChatSessionSubsystem::ScheduleRequests()
+{
+    while (Scheduler.NumQueued() > 0)
+    {
+        const int32 Slot = FindFreeSlot();
+        if (Slot == INDEX_NONE) return;
+
+        const FName SessionName = Scheduler.StartNext();
+        if (SessionName.IsNone()) return;
+
+        SendRequest(Slot, SessionName);
+    }
+}
+
+int32 UChatSessionSubsystem::FindFreeSlot()
+{
+    const int32 FreeSlot = Slots.IndexOfByPredicate([](const FRequestSlot& Slot) { return !Slot.bBusy; });
+    if (FreeSlot != INDEX_NONE) return FreeSlot;
+    if (Providers.Num() >= Scheduler.GetMaxConcurrentRequests()) return INDEX_NONE;
+
+    UOpenAIProvider* Provider = NewObject<UOpenAIProvider>(this, ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass());
+    Provider->SetLogEnabled(bLogEnabled);
+    const int32 NewSlot = Providers.Add(Provider);
+    Slots.AddDefaulted();
+
+    Provider->OnRequestError().AddUObject(this, &ThisClass::OnRequestError, NewSlot);
+    Provider->OnCreateChatCompletionStreamUpdated().AddUObject(this, &ThisClass::OnStreamUpdated, NewSlot);
+    // models without streaming
+    Provider->OnCreateChatCompletionCompleted().AddUObject(this, &ThisClass::OnCompletionCompleted, NewSlot);
+    return NewSlot;
+}
+
+void UChatSessionSubsystem::SendRequest(int32 Slot, FName SessionName)
+{
+    FChatSession* Session = Wake(SessionName);
+    check(Session);
+
+    const TSharedRef<const FModelRegistry> Registry = FModelRegistry::Get();
+    const FModelCapabilities& Model = Registry->Find(Session->Model);
+
+    TArray<FTools> AvailableTools;
+    if (Model.Tools)
+    {
+        for (const auto& Service : Services)
+        {
+            AvailableTools.Add(FTools{UOpenAIFuncLib::OpenAIRoleToString(ERole::Function), Service->Function()});
+        }
+    }
+
+    const FTokenCounter TokenCounter = FBPETokenizer::MakeTokenCounter(Registry->GetEncoding(Session->Model));
+    for (int32 Index = Session->MessageTokens.Num(); Index < Session->History.Num(); ++Index)
+    {
+        Session->MessageTokens.Add(FChatContextWindow::CountMessageTokens(Session->History[Index], TokenCounter));
+    }
+
+    // sessions keep the most recent messages that fit the context window with the default margin
+    const FChatContextPolicy Policy;
+    const int32 CompletionTokens =
+        Model.Max_Output_Tokens > 0 ? FMath::Min(Session->MaxTokens, Model.Max_Output_Tokens) : Session->MaxTokens;
+    const int32 Budget = Model.Context_Window - CompletionTokens - Policy.ReservedTokens;
+    const int32 FirstKept = FChatContextWindow::FindFirstKept(Session->History, Session->MessageTokens, Budget);
+
+    FChatCompletion ChatCompletion;
+    ChatCompletion.Model = Session->Model;
+    ChatCompletion.Messages = FChatContextWindow::MakeMessages(Session->History, FirstKept, FString{});
+    ChatCompletion.Max_Completion_Tokens.Set(CompletionTokens);
+    ChatCompletion.Stream = Model.Streaming;
+    ChatCompletion.Tools = AvailableTools;
+
+    Slots[Slot] = FRequestSlot{SessionName, true};
+    Providers[Slot]->CreateChatCompletion(ChatCompletion, Auth);
+}
+
+FName UChatSessionSubsystem::FinishSlot(int32 Slot)
+{
+    const FName SessionName = Slots[Slot].Session;
+    Slots[Slot] = FRequestSlot{};
+    Scheduler.Complete(SessionName);
+    return SessionName;
+}
+
+void UChatSessionSubsystem::OnStreamUpdated(const FChatStream& Stream, bool Completed, int32 Slot)
+{
+    if (!Slots[Slot].bBusy) return;
+
+    const FChatStreamMessage* Message = Stream.FindMessage();
+    if (!Completed)
+    {
+        UpdateAssistantMessage(Slots[Slot].Session, Message ? Message->Content : FString{});
+        return;
+    }
+
+    const FName SessionName = FinishSlot(Slot);
+    if (Message)
+    {
+        HandleResponseCompletion(SessionName, Message->FinishReason, Message->ToolCalls);
+    }
+    else
+    {
+        HandleRequestCompletion(SessionName);
+    }
+    ScheduleRequests();
+}
+
+void UChatSessionSubsystem::OnCompletionCompleted(const FChatCompletionResponse& Response, int32 Slot)
+{
+    if (!Slots[Slot].bBusy) return;
+
+    const FName SessionName = FinishSlot(Slot);
+    if (Response.Choices.IsEmpty())
+    {
+        HandleRequestCompletion(SessionName);
+    }
+    else
+    {
+        const FChatChoice& Choice = Response.Choices[0];
+        UpdateAssistantMessage(SessionName, Choice.Message.Content);
+        HandleResponseCompletion(SessionName,
+            UOpenAIFuncLib::FindOpenAIFinishReason(Choice.Finish_Reason).Get(EOpenAIFinishReason::Null), Choice.Message.Tool_Calls);
+    }
+    ScheduleRequests();
+}
+
+void UChatSessionSubsystem::OnRequestError(const FString& URL, const FString& Content, int32 Slot)
+{
+    if (!Slots[Slot].bBusy) return;
+
+    const FName SessionName = FinishSlot(Slot);
+    HandleError(SessionName, Content);
+    HandleRequestCompletion(SessionName);
+    ScheduleRequests();
+}
+
+void UChatSessionSubsystem::HandleRequestCompletion(FName SessionName)
+{
+    if (!Wake(SessionName)) return;
+
+    // the listeners may remove the session
+    const TSharedPtr<FChatSession> Session = Sessions.FindRef(SessionName);
+    AddToHistory(SessionName, *Session, Session->AssistantMessage);
+    Session->OnCompleted.Broadcast(Session->AssistantMessage);
+    OnSessionCompleted.Broadcast(SessionName, Session->AssistantMessage);
+    HibernateOverBudget();
+}
+
+void UChatSessionSubsystem::HandleResponseCompletion(
+    FName SessionName, EOpenAIFinishReason FinishReason, TConstArrayView<FToolCalls> ToolCalls)
+{
+    if (FinishReason != EOpenAIFinishReason::Tool_Calls || ToolCalls.IsEmpty())
+    {
+        HandleRequestCompletion(SessionName);
+        return;
+    }
+
+    if (!HandleFunctionCall(SessionName, ToolCalls[0].Function, ToolCalls[0].ID))
+    {
+        HandleError(SessionName, "");
+        HandleRequestCompletion(SessionName);
+    }
+}
+
+void UChatSessionSubsystem::HandleError(FName SessionName, const FString& Content)
+{
+    const auto Message = UOpenAIFuncLib::GetErrorMessage(Content);
+    if (!Message.IsEmpty())
+    {
+        UpdateAssistantMessage(SessionName, Message, true);
+        return;
+    }
+
+    const auto Code = UOpenAIFuncLib::GetErrorCode(Content);
+    if (Code == EOpenAIResponseError::Unknown && !Content.IsEmpty())
+    {
+        UpdateAssistantMessage(SessionName, Content, true);
+        return;
+    }
+    UpdateAssistantMessage(SessionName, UOpenAIFuncLib::ResponseErrorToString(Code), true);
+}
+
+bool UChatSessionSubsystem::HandleFunctionCall(FName SessionName, const FFunctionCommon& FunctionCall, const FString& ID)
+{
+    FChatSession* Session = Wake(SessionName);
+    if (!Session) return false;
+
+    TSharedPtr<FJsonObject> Args;
+    if (!FunctionCall.Arguments.IsEmpty() && !UJsonFuncLib::StringToJson(FunctionCall.Arguments, Args))
+    {
+        UE_LOGFMT(LogChatSession, Error, "Can't parse args: {0}", FunctionCall.Arguments);
+        return false;
+    }
+
+    const auto* FoundService =
+        Services.FindByPredicate([&](const auto& Service) { return Service->FunctionName().Equals(FunctionCall.Name); });
+    if (!FoundService)
+    {
+        UE_LOGFMT(LogChatSession, Error, "Can't find function by name: [{0}]", FunctionCall.Name);
+        return false;
+    }
+
+    UE_LOGFMT(LogChatSession, Display, "Session {0} calls the function: [{1}] with args: {2}", SessionName, FunctionCall.Name,
+        FunctionCall.Arguments);
+
+    FMessage HistoryMessage;
+    HistoryMessage.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::Assistant);
+
+    FToolCalls ToolCalls;
+    ToolCalls.ID = ID;
+    ToolCalls.Type = UOpenAIFuncLib::OpenAIRoleToString(ERole::Function);
+    ToolCalls.Function.Name = FunctionCall.Name;
+    HistoryMessage.Tool_Calls.Add(ToolCalls);
+    AddToHistory(SessionName, *Session, HistoryMessage);
+
+    UBaseService* Service = FoundService->Get();
+    ServiceCalls.Add(FServiceCall{Service, ID, SessionName});
+    Service->Call(Args, ID);
+    return true;
+}
+
+void UChatSessionSubsystem::UpdateAssistantMessage(FName SessionName, const FString& Message, bool WasError)
+{
+    // the listeners may remove the session
+    const TSharedPtr<FChatSession> Session = Sessions.FindRef(SessionName);
+    if (!Session) return;
+
+    Session->AssistantMessage.Content = Message;
+    Session->OnUpdated.Broadcast(Session->AssistantMessage, WasError);
+    OnSessionUpdated.Broadcast(SessionName, Session->AssistantMessage, WasError);
+}
+
+void UChatSessionSubsystem::OnServiceDataRecieved(const FMessage& Message, const UBaseService* Service)
+{
+    // the result answers the tool call by its ID, a service that doesn't set it answers its oldest call
+    int32 Index = ServiceCalls.IndexOfByPredicate(
+        [&](const FServiceCall& Call) { return Call.Service == Service && Message.Tool_Call_ID.Value.Equals(Call.ToolID); });
+    if (Index == INDEX_NONE)
+    {
+        Index = ServiceCalls.IndexOfByPredicate([&](const FServiceCall& Call) { return Call.Service == Service; });
+    }
+    if (Index == INDEX_NONE) return;
+
+    const FName SessionName = ServiceCalls[Index].Session;
+    ServiceCalls.RemoveAt(Index);
+
+    FChatSession* Session = Wake(SessionName);
+    if (!Session) return;
+
+    AddToHistory(SessionName, *Session, Message);
+    Scheduler.Enqueue(SessionName);
+    ScheduleRequests();
+}
+
+void UChatSessionSubsystem::OnServiceDataError(const FString& ErrorMessage, const UBaseService* Service)
+{
+    const int32 Index = ServiceCalls.IndexOfByPredicate([&](const FServiceCall& Call) { return Call.Service == Service; });
+    if (Index == INDEX_NONE) return;
+
+    const FName SessionName = ServiceCalls[Index].Session;
+    ServiceCalls.RemoveAt(Index);
+
+    HandleError(SessionName, ErrorMessage);
+    HandleRequestCompletion(SessionName);
+}
+
+bool UChatSessionSubsystem::RegisterService(const TSubclassOf<UBaseService>& ServiceClass, const OpenAI::ServiceSecrets& Secrets)
+{
+    auto* Service = NewObject<UBaseService>(this, ServiceClass);
+    check(Service);
+    if (!Service->Init(Secrets))
+    {
+        UE_LOGFMT(LogChatSession, Error,
+            "Service {0} can't be init. API keys have probably not been loaded. Its functions are not available.", Service->Name());
+        return false;
+    }
+    Service->OnServiceDataRecieved().AddUObject(this, &ThisClass::OnServiceDataRecieved, static_cast<const UBaseService*>(Service));
+    Service->OnServiceDataError().AddUObject(this, &ThisClass::OnServiceDataError, static_cast<const UBaseService*>(Service));
+    Services.Add(Service);
+
+    UE_LOGFMT(LogChatSession, Display, "Service {0} was registered", Service->Name());
+    return true;
+}
+
+void UChatSessionSubsystem::UnRegisterService(const TSubclassOf<UBaseService>& ServiceClass)
+{
+    auto* FoundService = Services.FindByPredicate([ServiceClass](const auto& Item) { return Item && Item->IsA(ServiceClass); });
+    if (!FoundService)
+    {
+        UE_LOGFMT(LogChatSession, Warning, "Can't unregister service");
+        return;
+    }
+
+    UBaseService* Service = FoundService->Get();
+    Service->OnServiceDataRecieved().RemoveAll(this);
+    Service->OnServiceDataError().RemoveAll(this);
+    Services.Remove(Service);
+
+    // the sessions that wait for the service get an error
+    TArray<FName> Waiting;
+    for (int32 Index = ServiceCalls.Num() - 1; Index >= 0; --Index)
+    {
+        if (ServiceCalls[Index].Service == Service)
+        {
+            Waiting.Add(ServiceCalls[Index].Session);
+            ServiceCalls.RemoveAt(Index);
+        }
+    }
+    for (const FName SessionName : Waiting)
+    {
+        HandleError(SessionName, FString::Format(TEXT("Service {0} was unregistered"), {Service->Name()}));
+        HandleRequestCompletion(SessionName);
+    }
+
+    UE_LOGFMT(LogChatSession, Display, "Service {0} was unregistered", Service->Name());
+}
+
+FChatSession* UChatSessionSubsystem::Wake(FName SessionName)
+{
+    const TSharedPtr<FChatSession>* Found = Sessions.Find(SessionName);
+    if (!Found) return nullptr;
+
+    FChatSession* Session = Found->Get();
+    if (Session->bHibernated)
+    {
+        const FString FilePath = GetSessionFilePath(SessionName);
+        if (!LoadHistory(FilePath, Session->History))
+        {
+            UE_LOGFMT(LogChatSession, Error, "Can't load the history of session {0} from {1}, it starts over", SessionName, FilePath);
+            Session->History.Reset();
+            Session->MessageTokens.Reset();
+            Session->HistoryBytes = 0;
+        }
+        Session->bHibernated = false;
+        Scheduler.SetHibernated(SessionName, false);
+    }
+    Scheduler.Touch(SessionName, Session->HistoryBytes);
+    return Session;
+}
+
+void UChatSessionSubsystem::AddToHistory(FName SessionName, FChatSession& Session, const FMessage& Message)
+{
+    Session.History.Add(Message);
+    Session.HistoryBytes += GetMessageBytes(Message);
+    Scheduler.Touch(SessionName, Session.HistoryBytes);
+}
+
+void UChatSessionSubsystem::HibernateOverBudget()
+{
+    for (const FName SessionName : Scheduler.FindSessionsToHibernate())
+    {
+        if (!Hibernate(SessionName, *Sessions.FindChecked(SessionName)))
+        {
+            // the histories stay in memory until the disk is writable
+            return;
+        }
+    }
+}
+
+bool UChatSessionSubsystem::Hibernate(FName SessionName, FChatSession& Session)
+{
+    const FString FilePath = GetSessionFilePath(SessionName);
+    if (!SaveHistory(Session.History, FilePath))
+    {
+        UE_LOGFMT(LogChatSession, Error, "Can't hibernate session {0} to {1}", SessionName, FilePath);
+        return false;
+    }
+
+    Session.History.Reset();
+    Session.bHibernated = true;
+    Scheduler.SetHibernated(SessionName, true);
+    return true;
+}
+
+FString UChatSessionSubsystem::GetSessionFilePath(FName SessionName) const
+{
+    return FPaths::Combine(GetSessionDir(), EscapeFileName(SessionName.ToString()) + TEXT(".json"));
+}
+
+FString UChatSessionSubsystem::GetSessionDir() const
+{
+    // PIE clients of the same map have their own sessions
+    const FString WorldName = FString::Printf(TEXT("%s_%u"), *GetWorld()->GetName(), GetUniqueID());
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAI"), TEXT("Sessions"), WorldName);
+}
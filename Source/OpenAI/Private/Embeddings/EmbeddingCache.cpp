@@ -0,0 +1,421 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/EmbeddingCache.h"
+#include "IO/MappedFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEmbeddingCache, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr uint32 FileMagic = 0x534D4545;  // EEMS
+constexpr uint32 FileVersion = 1;
+constexpr int32 MinSlots = 1024;
+/**
+  Vectors start at 16-byte boundaries of the mapped slab.
+*/
+constexpr int64 RecordAlignment = 16;
+
+struct FFileHeader
+{
+    uint32 Magic;
+    uint32 Version;
+    uint64 Reserved;
+};
+
+struct FRecordHeader
+{
+    uint64 KeyLow;
+    uint64 KeyHigh;
+    int32 NumFloats;
+    uint32 Crc;
+};
+
+static_assert(sizeof(FFileHeader) % RecordAlignment == 0 && sizeof(FRecordHeader) % 8 == 0);
+
+constexpr int64 RecordHeaderSize = Align(static_cast<int64>(sizeof(FRecordHeader)), RecordAlignment);
+
+int64 GetRecordSize(int32 NumFloats)
+{
+    return RecordHeaderSize + Align(NumFloats * static_cast<int64>(sizeof(float)), RecordAlignment);
+}
+}  // namespace
+
+FEmbeddingCache::FEmbeddingCache(const FString& InFilePath) : FilePath(InFilePath)
+{
+    Load();
+}
+
+FEmbeddingCache::~FEmbeddingCache()
+{
+    Save();
+}
+
+FString FEmbeddingCache::DefaultFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAI"), TEXT("EmbeddingCache.slab"));
+}
+
+FString FEmbeddingCache::NormalizeInput(FStringView Input)
+{
+    FString Normalized(Input.TrimStartAndEnd());
+    Normalized.ReplaceInline(TEXT("\r\n"), TEXT("\n"), ESearchCase::CaseSensitive);
+    return Normalized;
+}
+
+FXxHash128 FEmbeddingCache::MakeKey(const FString& Model, int32 Dimensions, FStringView Input)
+{
+    const FTCHARToUTF8 Utf8Model(*Model, Model.Len());
+    const FString Normalized = NormalizeInput(Input);
+    const FTCHARToUTF8 Utf8Input(*Normalized, Normalized.Len());
+    const uint8 Separator = 0;
+
+    FXxHash128Builder Builder;
+    Builder.Update(Utf8Model.Get(), Utf8Model.Length());
+    Builder.Update(&Separator, sizeof(Separator));
+    Builder.Update(&Dimensions, sizeof(Dimensions));
+    Builder.Update(Utf8Input.Get(), Utf8Input.Length());
+    return Builder.Finalize();
+}
+
+int32 FEmbeddingCache::FindSlot(const FXxHash128& Key) const
+{
+    if (Slots.IsEmpty()) return INDEX_NONE;
+
+    const int32 Mask = Slots.Num() - 1;
+    for (int32 Index = static_cast<int32>(Key.HashLow) & Mask;; Index = (Index + 1) & Mask)
+    {
+        const FSlot& Slot = Slots[Index];
+        if (Slot.Location == EmptyLocation) return INDEX_NONE;
+        if (Slot.KeyLow == Key.HashLow && Slot.KeyHigh == Key.HashHigh) return Index;
+    }
+}
+
+void FEmbeddingCache::SetLocation(const FXxHash128& Key, int64 Location)
+{
+    // the load factor is kept under 1/2, so probing always ends at an empty slot
+    if ((NumKeys + 1) * 2 > Slots.Num())
+    {
+        Grow();
+    }
+
+    const int32 Mask = Slots.Num() - 1;
+    for (int32 Index = static_cast<int32>(Key.HashLow) & Mask;; Index = (Index + 1) & Mask)
+    {
+        FSlot& Slot = Slots[Index];
+        if (Slot.Location == EmptyLocation)
+        {
+            Slot = FSlot{Key.HashLow, Key.HashHigh, Location};
+            ++NumKeys;
+            return;
+        }
+        if (Slot.KeyLow == Key.HashLow && Slot.KeyHigh == Key.HashHigh)
+        {
+            Slot.Location = Location;
+            return;
+        }
+    }
+}
+
+void FEmbeddingCache::Grow()
+{
+    TArray<FSlot> OldSlots = MoveTemp(Slots);
+    Slots.Reset();
+    Slots.SetNum(FMath::Max(MinSlots, OldSlots.Num() * 2));
+    NumKeys = 0;
+
+    for (const FSlot& Slot : OldSlots)
+    {
+        if (Slot.Location == EmptyLocation) continue;
+        SetLocation(FXxHash128{Slot.KeyLow, Slot.KeyHigh}, Slot.Location);
+    }
+}
+
+bool FEmbeddingCache::Find(const FXxHash128& Key, TArray<float>& Vector) const
+{
+    FReadScopeLock ReadLock(Lock);
+
+    const int32 SlotIndex = FindSlot(Key);
+    if (SlotIndex == INDEX_NONE) return false;
+
+    const int64 Location = Slots[SlotIndex].Location;
+    if (Location < 0)
+    {
+        const FPendingVector& PendingVector = Pending[~Location];
+        Vector.Reset();
+        Vector.Append(PendingData.GetData() + PendingVector.First, PendingVector.Num);
+        return true;
+    }
+
+    // the slab may be unmapped after a failed save
+    if (!Slab || Location + RecordHeaderSize > Slab->GetSize()) return false;
+
+    FRecordHeader Header;
+    FMemory::Memcpy(&Header, Slab->GetData() + Location, sizeof(FRecordHeader));
+    if (Header.NumFloats <= 0 || Location + GetRecordSize(Header.NumFloats) > Slab->GetSize()) return false;
+
+    Vector.Reset();
+    Vector.Append(reinterpret_cast<const float*>(Slab->GetData() + Location + RecordHeaderSize), Header.NumFloats);
+    return true;
+}
+
+void FEmbeddingCache::Add(const FXxHash128& Key, TArrayView<const float> Vector)
+{
+    if (Vector.IsEmpty()) return;
+
+    FWriteScopeLock WriteLock(Lock);
+
+    SetLocation(Key, ~static_cast<int64>(Pending.Num()));
+    Pending.Add(FPendingVector{Key, PendingData.Num(), Vector.Num()});
+    PendingData.Append(Vector.GetData(), Vector.Num());
+}
+
+int32 FEmbeddingCache::Num() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return NumKeys;
+}
+
+void FEmbeddingCache::Reset()
+{
+    FWriteScopeLock WriteLock(Lock);
+
+    Slab.Reset();
+    Slots.Reset();
+    NumKeys = 0;
+    ValidSize = 0;
+    Pending.Reset();
+    PendingData.Reset();
+    IFileManager::Get().Delete(*FilePath, false, true, true);
+}
+
+bool FEmbeddingCache::MapSlab()
+{
+    Slab.Reset();
+    if (!FPaths::FileExists(FilePath)) return true;
+
+    auto NewSlab = MakeUnique<FMappedFile>();
+    if (!NewSlab->Open(FilePath)) return false;
+
+    FFileHeader Header{};
+    if (NewSlab->GetSize() >= static_cast<int64>(sizeof(FFileHeader)))
+    {
+        FMemory::Memcpy(&Header, NewSlab->GetData(), sizeof(FFileHeader));
+    }
+    if (Header.Magic != FileMagic || Header.Version != FileVersion)
+    {
+        UE_LOGFMT(LogEmbeddingCache, Error, "Unsupported embedding cache file: {0}", FilePath);
+        return false;
+    }
+
+    Slab = MoveTemp(NewSlab);
+    return true;
+}
+
+bool FEmbeddingCache::RemapSlab()
+{
+    if (MapSlab() && (Slab || ValidSize == 0)) return true;
+
+    UE_LOGFMT(LogEmbeddingCache, Warning, "Embedding cache can't be mapped, saved vectors are dropped until the next load: {0}", FilePath);
+    Slots.Reset();
+    NumKeys = 0;
+    for (int32 Index = 0; Index < Pending.Num(); ++Index)
+    {
+        SetLocation(Pending[Index].Key, ~static_cast<int64>(Index));
+    }
+    if (!FPaths::FileExists(FilePath))
+    {
+        ValidSize = 0;
+    }
+    return false;
+}
+
+bool FEmbeddingCache::Load()
+{
+    FWriteScopeLock WriteLock(Lock);
+
+    Slots.Reset();
+    NumKeys = 0;
+    ValidSize = 0;
+    Pending.Reset();
+    PendingData.Reset();
+    if (!MapSlab()) return false;
+    if (!Slab) return true;
+
+    // records are appended, so the first invalid one starts the torn tail of an interrupted save
+    int64 Offset = sizeof(FFileHeader);
+    while (Offset + RecordHeaderSize <= Slab->GetSize())
+    {
+        FRecordHeader Header;
+        FMemory::Memcpy(&Header, Slab->GetData() + Offset, sizeof(FRecordHeader));
+        if (Header.NumFloats <= 0 || Offset + GetRecordSize(Header.NumFloats) > Slab->GetSize()) break;
+
+        const uint8* VectorData = Slab->GetData() + Offset + RecordHeaderSize;
+        if (FCrc::MemCrc32(VectorData, Header.NumFloats * sizeof(float)) != Header.Crc) break;
+
+        SetLocation(FXxHash128{Header.KeyLow, Header.KeyHigh}, Offset);
+        Offset += GetRecordSize(Header.NumFloats);
+    }
+
+    // the next save truncates the file to the valid records before it appends
+    ValidSize = Offset;
+    if (Offset < Slab->GetSize())
+    {
+        UE_LOGFMT(LogEmbeddingCache, Warning, "Torn record at the end of the embedding cache is dropped: {0}", FilePath);
+    }
+
+    UE_LOGFMT(LogEmbeddingCache, Display, "{0} cached embedding(s) were loaded", NumKeys);
+    return true;
+}
+
+bool FEmbeddingCache::Save()
+{
+    FWriteScopeLock WriteLock(Lock);
+    if (Pending.IsEmpty()) return true;
+
+    // the slab can't be written while it's mapped on some platforms, found vectors are copies so nothing points into it
+    Slab.Reset();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+    TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*FilePath, true, true));
+    if (!FileHandle)
+    {
+        UE_LOGFMT(LogEmbeddingCache, Error, "Can't open file: {0}", FilePath);
+        RemapSlab();
+        return false;
+    }
+
+    // a torn tail of an interrupted or failed save is cut, otherwise the records after it would be lost on load
+    int64 Offset = ValidSize;
+    if (FileHandle->Size() != Offset && !FileHandle->Truncate(Offset))
+    {
+        UE_LOGFMT(LogEmbeddingCache, Error, "Can't truncate file: {0}", FilePath);
+        FileHandle.Reset();
+        RemapSlab();
+        return false;
+    }
+
+    bool Written = FileHandle->Seek(Offset);
+    if (Offset == 0)
+    {
+        const FFileHeader Header{FileMagic, FileVersion, 0};
+        Written &= FileHandle->Write(reinterpret_cast<const uint8*>(&Header), sizeof(FFileHeader));
+        Offset = sizeof(FFileHeader);
+    }
+
+    TArray<uint8> Record;
+    TArray<int64> Offsets;
+    for (const FPendingVector& PendingVector : Pending)
+    {
+        const float* Vector = PendingData.GetData() + PendingVector.First;
+        const FRecordHeader Header{PendingVector.Key.HashLow, PendingVector.Key.HashHigh, PendingVector.Num,
+            FCrc::MemCrc32(Vector, PendingVector.Num * sizeof(float))};
+
+        Record.Reset();
+        Record.SetNumZeroed(static_cast<int32>(GetRecordSize(PendingVector.Num)));
+        FMemory::Memcpy(Record.GetData(), &Header, sizeof(FRecordHeader));
+        FMemory::Memcpy(Record.GetData() + RecordHeaderSize, Vector, PendingVector.Num * sizeof(float));
+        Written &= FileHandle->Write(Record.GetData(), Record.Num());
+
+        Offsets.Add(Offset);
+        Offset += Record.Num();
+    }
+    Written &= FileHandle->Flush();
+    FileHandle.Reset();
+
+    if (!Written || !RemapSlab())
+    {
+        // the pending vectors stay in memory, the next save writes them over the torn records
+        UE_LOGFMT(LogEmbeddingCache, Error, "Can't save embedding cache: {0}", FilePath);
+        if (!Written)
+        {
+            RemapSlab();
+        }
+        return false;
+    }
+
+    for (int32 Index = 0; Index < Pending.Num(); ++Index)
+    {
+        SetLocation(Pending[Index].Key, Offsets[Index]);
+    }
+    ValidSize = Offset;
+    Pending.Reset();
+    PendingData.Reset();
+    return true;
+}
+
+FEmbeddingCacheLookup FEmbeddingCache::Lookup(const FEmbeddings& Request) const
+{
+    FEmbeddingCacheLookup Result;
+    Result.Model = Request.Model;
+    Result.InputToUnique.Reserve(Request.Input.Num());
+
+    const int32 Dimensions = Request.Dimensions.IsSet ? Request.Dimensions.Value : 0;
+    TMap<TTuple<uint64, uint64>, int32> UniqueIndices;
+    for (const FString& Input : Request.Input)
+    {
+        const FXxHash128 Key = MakeKey(Request.Model, Dimensions, Input);
+        if (const int32* UniqueIndex = UniqueIndices.Find({Key.HashLow, Key.HashHigh}))
+        {
+            Result.InputToUnique.Add(*UniqueIndex);
+            continue;
+        }
+
+        const int32 UniqueIndex = Result.UniqueKeys.Add(Key);
+        UniqueIndices.Add({Key.HashLow, Key.HashHigh}, UniqueIndex);
+        Result.InputToUnique.Add(UniqueIndex);
+
+        TArray<float>& Vector = Result.UniqueVectors.AddDefaulted_GetRef();
+        if (!Find(Key, Vector))
+        {
+            Result.MissInput.Add(Input);
+            Result.MissToUnique.Add(UniqueIndex);
+        }
+    }
+    return Result;
+}
+
+bool FEmbeddingCache::Resolve(FEmbeddingCacheLookup& Lookup, const FEmbeddingsResponse& MissResponse)
+{
+    bool Matches = true;
+    for (const FEmbeddingsData& Data : MissResponse.Data)
+    {
+        if (Data.Embedding.IsEmpty()) continue;
+        if (!Lookup.MissToUnique.IsValidIndex(Data.Index))
+        {
+            Matches = false;
+            continue;
+        }
+
+        const int32 UniqueIndex = Lookup.MissToUnique[Data.Index];
+        Lookup.UniqueVectors[UniqueIndex] = Data.Embedding;
+        Add(Lookup.UniqueKeys[UniqueIndex], Data.Embedding);
+    }
+    return Matches;
+}
+
+FEmbeddingsResponse FEmbeddingCache::MakeResponse(const FEmbeddingCacheLookup& Lookup, const FEmbeddingsResponse& MissResponse)
+{
+    FEmbeddingsResponse Response;
+    Response.Object = "list";
+    Response.Model = MissResponse.Model.IsEmpty() ? Lookup.Model : MissResponse.Model;
+    Response.Usage = MissResponse.Usage;
+
+    Response.Data.SetNum(Lookup.InputToUnique.Num());
+    for (int32 Index = 0; Index < Lookup.InputToUnique.Num(); ++Index)
+    {
+        FEmbeddingsData& Data = Response.Data[Index];
+        Data.Index = Index;
+        Data.Object = "embedding";
+        Data.Embedding = Lookup.UniqueVectors[Lookup.InputToUnique[Index]];
+    }
+    return Response;
+}
@@ -0,0 +1,76 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/EmbeddingIndex.h"
+
+using namespace OpenAI;
+
+UEmbeddingIndex* UEmbeddingIndex::CreateEmbeddingIndex(int32 Dimensions, int32 M, int32 EfConstruction, int32 EfSearch)
+{
+    FHNSWParams Params;
+    Params.M = M;
+    Params.EfConstruction = EfConstruction;
+    Params.EfSearch = EfSearch;
+    return CreateEmbeddingIndex(Dimensions, Params);
+}
+
+UEmbeddingIndex* UEmbeddingIndex::CreateEmbeddingIndex(int32 Dimensions, const FHNSWParams& Params)
+{
+    auto* EmbeddingIndex = NewObject<UEmbeddingIndex>();
+    EmbeddingIndex->Index = MakeUnique<FHNSWIndex>(Dimensions, Params);
+    return EmbeddingIndex;
+}
+
+bool UEmbeddingIndex::Add(int64 Id, const TArray<float>& Vector)
+{
+    return Index && Index->Add(Id, Vector);
+}
+
+bool UEmbeddingIndex::AddEmbeddings(const FEmbeddingsResponse& Response, int64 FirstId)
+{
+    if (!Index) return false;
+
+    TArray<int64> Ids;
+    TArray<float> Vectors;
+    Ids.Reserve(Response.Data.Num());
+    Vectors.Reserve(Response.Data.Num() * Index->GetDimensions());
+    for (const FEmbeddingsData& Data : Response.Data)
+    {
+        if (Data.Embedding.Num() < Index->GetDimensions()) return false;
+
+        Ids.Add(FirstId + Data.Index);
+        Vectors.Append(Data.Embedding.GetData(), Index->GetDimensions());
+    }
+    return Index->Build(Ids, Vectors);
+}
+
+TArray<FVectorSearchResult> UEmbeddingIndex::Search(const TArray<float>& Query, int32 K) const
+{
+    return Index ? Index->Search(Query, K) : TArray<FVectorSearchResult>{};
+}
+
+void UEmbeddingIndex::SetEfSearch(int32 EfSearch)
+{
+    if (Index)
+    {
+        Index->SetEfSearch(EfSearch);
+    }
+}
+
+int32 UEmbeddingIndex::Num() const
+{
+    return Index ? Index->Num() : 0;
+}
+
+bool UEmbeddingIndex::Save(const FString& FilePath) const
+{
+    return Index && Index->Save(FilePath);
+}
+
+bool UEmbeddingIndex::Load(const FString& FilePath)
+{
+    if (!Index)
+    {
+        Index = MakeUnique<FHNSWIndex>(1);
+    }
+    return Index->Load(FilePath);
+}
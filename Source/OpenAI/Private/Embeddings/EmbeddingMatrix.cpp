@@ -0,0 +1,275 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/EmbeddingMatrix.h"
+#include "Async/ParallelFor.h"
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 RowAlignment = 4;
+constexpr int32 RowsPerTask = 1024;
+
+template <typename FunctionType>
+void ForEachRowBlock(int32 NumRows, FunctionType&& Function)
+{
+    const int32 NumBlocks = FMath::DivideAndRoundUp(NumRows, RowsPerTask);
+    ParallelFor(NumBlocks,
+        [&](int32 Block)
+        {
+            const int32 First = Block * RowsPerTask;
+            const int32 Last = FMath::Min(First + RowsPerTask, NumRows);
+            for (int32 Row = First; Row < Last; ++Row)
+            {
+                Function(Row);
+            }
+        });
+}
+}  // namespace
+
+FEmbeddingMatrix::FEmbeddingMatrix(int32 InDimensions, EVectorMetric InMetric)
+    : Dimensions(FMath::Max(1, InDimensions)),
+      Stride(Align(Dimensions, RowAlignment)),
+      Metric(InMetric),
+      NumBinaryWords(VectorMath::NumBinaryWords(Dimensions))
+{
+}
+
+void FEmbeddingMatrix::Reserve(int32 NumVectors)
+{
+    Data.Reserve(static_cast<int64>(NumVectors) * Stride);
+}
+
+int32 FEmbeddingMatrix::Add(TArrayView<const float> Vector)
+{
+    if (Vector.Num() < Dimensions) return INDEX_NONE;
+
+    const int32 Index = NumRows++;
+    Data.AddZeroed(Stride);
+    float* Row = Data.GetData() + static_cast<int64>(Index) * Stride;
+    FMemory::Memcpy(Row, Vector.GetData(), Dimensions * sizeof(float));
+    if (Metric == EVectorMetric::Cosine)
+    {
+        VectorMath::Normalize(MakeArrayView(Row, Dimensions));
+    }
+
+    QuantizeRow(Index);
+    return Index;
+}
+
+void FEmbeddingMatrix::Reset()
+{
+    NumRows = 0;
+    Data.Reset();
+    Int8Data.Reset();
+    Int8Scales.Reset();
+    SquaredNorms.Reset();
+    BinaryData.Reset();
+}
+
+void FEmbeddingMatrix::SetQuantization(EVectorQuantization InQuantization)
+{
+    Quantization = InQuantization;
+    Int8Data.Reset();
+    Int8Scales.Reset();
+    SquaredNorms.Reset();
+    BinaryData.Reset();
+
+    if (Quantization == EVectorQuantization::Int8)
+    {
+        Int8Data.SetNumUninitialized(static_cast<int64>(NumRows) * Dimensions);
+        Int8Scales.SetNumUninitialized(NumRows);
+        SquaredNorms.SetNumUninitialized(NumRows);
+    }
+    else if (Quantization == EVectorQuantization::Binary)
+    {
+        BinaryData.SetNumUninitialized(static_cast<int64>(NumRows) * NumBinaryWords);
+    }
+    ParallelFor(NumRows, [this](int32 Index) { QuantizeRow(Index); });
+}
+
+void FEmbeddingMatrix::QuantizeRow(int32 Index)
+{
+    const float* Row = GetRowData(Index);
+    if (Quantization == EVectorQuantization::Int8)
+    {
+        if (Int8Scales.Num() <= Index)
+        {
+            Int8Data.AddUninitialized(Dimensions);
+            Int8Scales.AddUninitialized();
+            SquaredNorms.AddUninitialized();
+        }
+        Int8Scales[Index] = VectorMath::QuantizeInt8(Row, Dimensions, Int8Data.GetData() + static_cast<int64>(Index) * Dimensions);
+        SquaredNorms[Index] = VectorMath::Dot(Row, Row, Dimensions);
+    }
+    else if (Quantization == EVectorQuantization::Binary)
+    {
+        if (BinaryData.Num() < (static_cast<int64>(Index) + 1) * NumBinaryWords)
+        {
+            BinaryData.AddUninitialized(NumBinaryWords);
+        }
+        VectorMath::QuantizeBinary(Row, Dimensions, BinaryData.GetData() + static_cast<int64>(Index) * NumBinaryWords);
+    }
+}
+
+bool FEmbeddingMatrix::PrepareQuery(TArrayView<const float> Query, TArray<float, TAlignedHeapAllocator<16>>& Prepared) const
+{
+    if (Query.Num() < Dimensions) return false;
+
+    Prepared.SetNumZeroed(Stride);
+    FMemory::Memcpy(Prepared.GetData(), Query.GetData(), Dimensions * sizeof(float));
+    if (Metric == EVectorMetric::Cosine)
+    {
+        VectorMath::Normalize(MakeArrayView(Prepared.GetData(), Dimensions));
+    }
+    return true;
+}
+
+void FEmbeddingMatrix::Score(TArrayView<const float> Query, TArray<float>& Scores) const
+{
+    TArray<float, TAlignedHeapAllocator<16>> Prepared;
+    if (!PrepareQuery(Query, Prepared))
+    {
+        Scores.Reset();
+        return;
+    }
+    ScoreRows(Prepared.GetData(), nullptr, Scores);
+}
+
+void FEmbeddingMatrix::ScoreRows(const float* Query, const TArray<int32>* Rows, TArray<float>& Scores) const
+{
+    Scores.SetNumUninitialized(Rows ? Rows->Num() : NumRows);
+    ForEachRowBlock(Scores.Num(),
+        [&](int32 Index)
+        {
+            const int32 Row = Rows ? (*Rows)[Index] : Index;
+            // padding of both vectors is zero, whole registers are read
+            Scores[Index] = VectorMath::Score(Query, GetRowData(Row), Stride, Metric);
+        });
+}
+
+void FEmbeddingMatrix::ScoreQuantizedRows(const float* Query, const TArray<int32>* Rows, TArray<float>& Scores) const
+{
+    Scores.SetNumUninitialized(Rows ? Rows->Num() : NumRows);
+
+    if (Quantization == EVectorQuantization::Int8)
+    {
+        TArray<int8> QuantizedQuery;
+        QuantizedQuery.SetNumUninitialized(Dimensions);
+        const float QueryScale = VectorMath::QuantizeInt8(Query, Dimensions, QuantizedQuery.GetData());
+        const float QuerySquaredNorm = VectorMath::Dot(Query, Query, Dimensions);
+
+        ForEachRowBlock(Scores.Num(),
+            [&](int32 Index)
+            {
+                const int32 Row = Rows ? (*Rows)[Index] : Index;
+                const int32 QuantizedDot = VectorMath::DotInt8(QuantizedQuery.GetData(), GetInt8Row(Row), Dimensions);
+                const float Dot = QuantizedDot * QueryScale * Int8Scales[Row];
+                Scores[Index] = Metric == EVectorMetric::L2 ? -(QuerySquaredNorm + SquaredNorms[Row] - 2.0f * Dot) : Dot;
+            });
+        return;
+    }
+
+    TArray<uint64> QueryBits;
+    QueryBits.SetNumUninitialized(NumBinaryWords);
+    VectorMath::QuantizeBinary(Query, Dimensions, QueryBits.GetData());
+    ForEachRowBlock(Scores.Num(),
+        [&](int32 Index)
+        {
+            const int32 Row = Rows ? (*Rows)[Index] : Index;
+            Scores[Index] = -static_cast<float>(VectorMath::HammingDistance(QueryBits.GetData(), GetBinaryRow(Row), NumBinaryWords));
+        });
+}
+
+TArray<FScoredVector> FEmbeddingMatrix::TopK(TArrayView<const float> Query, int32 K, int32 Oversampling) const
+{
+    TArray<float, TAlignedHeapAllocator<16>> Prepared;
+    if (K <= 0 || !PrepareQuery(Query, Prepared)) return {};
+
+    return SelectRows(Prepared.GetData(), nullptr, K, Oversampling);
+}
+
+TArray<FScoredVector> FEmbeddingMatrix::TopK(TArrayView<const float> Query, int32 K, const FRoaringBitmap& Filter, int32 Oversampling) const
+{
+    TArray<float, TAlignedHeapAllocator<16>> Prepared;
+    if (K <= 0 || Filter.IsEmpty() || !PrepareQuery(Query, Prepared)) return {};
+
+    TArray<int32> Rows;
+    Rows.Reserve(FMath::Min<int64>(Filter.Num(), NumRows));
+    Filter.ForEach(
+        [&](uint32 Row)
+        {
+            if (Row < static_cast<uint32>(NumRows))
+            {
+                Rows.Add(static_cast<int32>(Row));
+            }
+        });
+
+    TArray<FScoredVector> Results = SelectRows(Prepared.GetData(), &Rows, K, Oversampling);
+    for (FScoredVector& Result : Results)
+    {
+        Result.Index = Rows[Result.Index];
+    }
+    return Results;
+}
+
+TArray<FScoredVector> FEmbeddingMatrix::SelectRows(const float* Query, const TArray<int32>* Rows, int32 K, int32 Oversampling) const
+{
+    TArray<float> Scores;
+    if (Quantization == EVectorQuantization::None)
+    {
+        ScoreRows(Query, Rows, Scores);
+        return SelectTopK(Scores, K);
+    }
+
+    ScoreQuantizedRows(Query, Rows, Scores);
+    const TArray<FScoredVector> Candidates = SelectTopK(Scores, K * FMath::Max(1, Oversampling));
+
+    // re-ranking with the full precision
+    TArray<float> CandidateScores;
+    CandidateScores.SetNumUninitialized(Candidates.Num());
+    for (int32 Index = 0; Index < Candidates.Num(); ++Index)
+    {
+        const int32 Row = Rows ? (*Rows)[Candidates[Index].Index] : Candidates[Index].Index;
+        CandidateScores[Index] = VectorMath::Score(Query, GetRowData(Row), Stride, Metric);
+    }
+
+    TArray<FScoredVector> Results = SelectTopK(CandidateScores, K);
+    for (FScoredVector& Result : Results)
+    {
+        Result.Index = Candidates[Result.Index].Index;
+    }
+    return Results;
+}
+
+TArray<FScoredVector> FEmbeddingMatrix::SelectTopK(TArrayView<const float> Scores, int32 K)
+{
+    K = FMath::Min(K, Scores.Num());
+    if (K <= 0) return {};
+
+    // min-heap of the best scores, the worst of them is on the top
+    const auto HeapPredicate = [](const FScoredVector& A, const FScoredVector& B) { return A.Score < B.Score; };
+    TArray<FScoredVector> Heap;
+    Heap.Reserve(K);
+    for (int32 Index = 0; Index < Scores.Num(); ++Index)
+    {
+        if (Heap.Num() < K)
+        {
+            Heap.HeapPush(FScoredVector{Index, Scores[Index]}, HeapPredicate);
+        }
+        else if (Scores[Index] > Heap.HeapTop().Score)
+        {
+            Heap.HeapPopDiscard(HeapPredicate);
+            Heap.HeapPush(FScoredVector{Index, Scores[Index]}, HeapPredicate);
+        }
+    }
+
+    Heap.Sort([](const FScoredVector& A, const FScoredVector& B) { return A.Score > B.Score; });
+    return Heap;
+}
+
+SIZE_T FEmbeddingMatrix::GetAllocatedSize() const
+{
+    return Data.GetAllocatedSize() + Int8Data.GetAllocatedSize() + Int8Scales.GetAllocatedSize() + SquaredNorms.GetAllocatedSize() +
+           BinaryData.GetAllocatedSize();
+}
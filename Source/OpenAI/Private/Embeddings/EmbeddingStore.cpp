@@ -0,0 +1,654 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/EmbeddingStore.h"
+#include "IO/AtomicFile.h"
+#include "Async/Async.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEmbeddingStore, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr uint32 MetaFileMagic = 0x4154454D;  // META
+constexpr uint32 MetaFileVersion = 1;
+
+/**
+  Every log record is [payload size][payload crc][payload].
+*/
+constexpr int32 RecordHeaderSize = 2 * sizeof(uint32);
+
+enum class ERecordType : uint8
+{
+    Insert,
+    Remove
+};
+
+TArray<uint8> MakeRecord(ERecordType Type, int64 Id, TArrayView<const float> Vector = {}, const FMetadataRow* Metadata = nullptr)
+{
+    TArray<uint8> Record;
+    FMemoryWriter Writer(Record);
+    Writer.Seek(RecordHeaderSize);
+
+    uint8 TypeValue = static_cast<uint8>(Type);
+    Writer << TypeValue << Id;
+    if (Type == ERecordType::Insert)
+    {
+        int32 NumValues = Vector.Num();
+        Writer << NumValues;
+        Writer.Serialize(const_cast<float*>(Vector.GetData()), NumValues * sizeof(float));
+        FMetadataRow MetadataCopy = *Metadata;
+        Writer << MetadataCopy;
+    }
+
+    const uint32 PayloadSize = static_cast<uint32>(Record.Num() - RecordHeaderSize);
+    const uint32 PayloadCrc = FCrc::MemCrc32(Record.GetData() + RecordHeaderSize, PayloadSize);
+    FMemory::Memcpy(Record.GetData(), &PayloadSize, sizeof(uint32));
+    FMemory::Memcpy(Record.GetData() + sizeof(uint32), &PayloadCrc, sizeof(uint32));
+    return Record;
+}
+
+/**
+  Generations of the files in the directory, e.g. Log_12.wal is 12.
+*/
+TArray<int64> FindGenerations(const FString& Directory, const FString& Prefix, const FString& Extension)
+{
+    TArray<FString> FileNames;
+    IFileManager::Get().FindFiles(FileNames, *FPaths::Combine(Directory, Prefix + TEXT("*.") + Extension), true, false);
+
+    TArray<int64> Generations;
+    for (const FString& FileName : FileNames)
+    {
+        const FString Number = FPaths::GetBaseFilename(FileName).RightChop(Prefix.Len());
+        if (!Number.IsEmpty() && Number.IsNumeric())
+        {
+            Generations.Add(FCString::Atoi64(*Number));
+        }
+    }
+    Generations.Sort();
+    return Generations;
+}
+}  // namespace
+
+struct FEmbeddingStore::FSegment
+{
+    /**
+      The snapshot is searched by the graph, the recent writes by brute force.
+    */
+    TUniquePtr<FHNSWIndex> Index;
+    TUniquePtr<FEmbeddingMatrix> Matrix;
+
+    TArray<int64> Ids;
+    TMap<int64, int32> Rows;
+    FMetadataTable Metadata;
+    FRoaringBitmap Tombstones;
+
+    int32 Num() const { return Ids.Num(); }
+    int32 NumLive() const { return Ids.Num() - static_cast<int32>(Tombstones.Num()); }
+
+    bool ContainsLive(int64 Id) const
+    {
+        const int32* Row = Rows.Find(Id);
+        return Row && !Tombstones.Contains(*Row);
+    }
+
+    bool Remove(int64 Id)
+    {
+        const int32* Row = Rows.Find(Id);
+        if (!Row || Tombstones.Contains(*Row)) return false;
+
+        Tombstones.Add(*Row);
+        return true;
+    }
+
+    void CopyVector(int32 Row, TArray<float>& Vector) const
+    {
+        if (Index)
+        {
+            Index->CopyVector(Row, Vector);
+            return;
+        }
+        Vector.Reset();
+        Vector.Append(Matrix->GetRow(Row).GetData(), Matrix->GetDimensions());
+    }
+
+    void Search(TArrayView<const float> Query, int32 K, const FMetadataFilter& Filter, TArray<FVectorSearchResult>& Results) const
+    {
+        if (Ids.IsEmpty()) return;
+
+        const bool bFiltered = !Filter.IsEmpty() || !Tombstones.IsEmpty();
+        FRoaringBitmap FilteredRows;
+        if (bFiltered)
+        {
+            FilteredRows = Metadata.Compile(Filter, Ids.Num());
+            FilteredRows.AndNot(Tombstones);
+            if (FilteredRows.IsEmpty()) return;
+        }
+
+        if (Index)
+        {
+            Results.Append(bFiltered ? Index->Search(Query, K, FilteredRows) : Index->Search(Query, K));
+            return;
+        }
+
+        for (const FScoredVector& Scored : bFiltered ? Matrix->TopK(Query, K, FilteredRows) : Matrix->TopK(Query, K))
+        {
+            Results.Add(FVectorSearchResult{Ids[Scored.Index], Scored.Score});
+        }
+    }
+};
+
+FEmbeddingStore::FEmbeddingStore(const FString& InDirectory, int32 InDimensions, const FEmbeddingStoreOptions& InOptions)
+    : Directory(InDirectory), Dimensions(FMath::Max(1, InDimensions)), Options(InOptions)
+{
+    Recent = MakeRecentSegment();
+}
+
+FEmbeddingStore::~FEmbeddingStore()
+{
+    WaitForCompaction();
+}
+
+FString FEmbeddingStore::GetSnapshotPath(int64 Generation, const TCHAR* Extension) const
+{
+    return FPaths::Combine(Directory, FString::Printf(TEXT("Snapshot_%lld.%s"), Generation, Extension));
+}
+
+FString FEmbeddingStore::GetLogPath(int64 Generation) const
+{
+    return FPaths::Combine(Directory, FString::Printf(TEXT("Log_%lld.wal"), Generation));
+}
+
+FString FEmbeddingStore::GetCurrentPath() const
+{
+    return FPaths::Combine(Directory, TEXT("Current"));
+}
+
+TSharedPtr<FEmbeddingStore::FSegment> FEmbeddingStore::MakeRecentSegment() const
+{
+    const TSharedPtr<FSegment> Segment = MakeShared<FSegment>();
+    Segment->Matrix = MakeUnique<FEmbeddingMatrix>(Dimensions, Options.IndexParams.Metric);
+    return Segment;
+}
+
+bool FEmbeddingStore::Open()
+{
+    FScopeLock ScopeLock(&WriteLock);
+    if (LogFile) return true;
+
+    IFileManager::Get().MakeDirectory(*Directory, true);
+
+    int64 SnapshotGeneration{0};
+    FString Current;
+    if (FFileHelper::LoadFileToString(Current, *GetCurrentPath()))
+    {
+        SnapshotGeneration = FCString::Atoi64(*Current.TrimStartAndEnd());
+        if (SnapshotGeneration > 0 && !LoadSnapshot(SnapshotGeneration))
+        {
+            UE_LOGFMT(LogEmbeddingStore, Error, "Can't load snapshot {0} of the embedding store: {1}", SnapshotGeneration, Directory);
+            return false;
+        }
+    }
+    else
+    {
+        SnapshotGeneration = RecoverSnapshot();
+    }
+
+    // logs before the snapshot are already in it, they are left by a crash after the compaction
+    int64 LastGeneration = SnapshotGeneration;
+    for (const int64 Generation : FindGenerations(Directory, TEXT("Log_"), TEXT("wal")))
+    {
+        if (Generation < SnapshotGeneration) continue;
+
+        // writes of the later logs depend on the skipped ones, so a damaged log isn't replayed past
+        if (!ReplayLog(GetLogPath(Generation)))
+        {
+            UE_LOGFMT(
+                LogEmbeddingStore, Error, "Log {0} of the embedding store is damaged, the store isn't opened: {1}", Generation, Directory);
+            return false;
+        }
+        LastGeneration = Generation;
+    }
+
+    // the last log may end with a torn record, so the writes go to a new one
+    if (!OpenLog(LastGeneration + 1)) return false;
+
+    DeleteObsoleteFiles(SnapshotGeneration);
+    LastCompactionTime = FDateTime::UtcNow();
+    UE_LOGFMT(LogEmbeddingStore, Display, "Embedding store is opened: {0} vector(s), {1} write(s) replayed", Num(), NumLoggedWrites);
+
+    StartCompactionIfNeeded();
+    return true;
+}
+
+int64 FEmbeddingStore::RecoverSnapshot()
+{
+    // Current is lost, e.g. by a crash while it was replaced with a non-atomic move,
+    // the newest snapshot that loads is the last one that was completed
+    const TArray<int64> Generations = FindGenerations(Directory, TEXT("Snapshot_"), TEXT("meta"));
+    for (int32 Index = Generations.Num() - 1; Index >= 0; --Index)
+    {
+        const int64 Generation = Generations[Index];
+        if (!LoadSnapshot(Generation)) continue;
+
+        UE_LOGFMT(LogEmbeddingStore, Warning, "Current snapshot is missing, snapshot {0} is recovered: {1}", Generation, Directory);
+        AtomicFile::Save(GetCurrentPath(), [Generation](const FString& Path)  //
+            { return FFileHelper::SaveStringToFile(LexToString(Generation), *Path); });
+        return Generation;
+    }
+    return 0;
+}
+
+bool FEmbeddingStore::LoadSnapshot(int64 Generation)
+{
+    const TSharedPtr<FSegment> Segment = MakeShared<FSegment>();
+    Segment->Index = MakeUnique<FHNSWIndex>(Dimensions, Options.IndexParams);
+    if (!Segment->Index->Load(GetSnapshotPath(Generation, TEXT("hnsw"))) || Segment->Index->GetDimensions() != Dimensions) return false;
+    Segment->Index->SetEfSearch(Options.IndexParams.EfSearch);
+
+    TArray<uint8> Data;
+    if (!FFileHelper::LoadFileToArray(Data, *GetSnapshotPath(Generation, TEXT("meta")))) return false;
+
+    FMemoryReader Reader(Data);
+    uint32 Magic{}, Version{};
+    int32 NumRows{};
+    Reader << Magic << Version << NumRows;
+    if (Reader.IsError() || Magic != MetaFileMagic || Version != MetaFileVersion || NumRows != Segment->Index->Num()) return false;
+
+    Segment->Ids.Reserve(NumRows);
+    Segment->Rows.Reserve(NumRows);
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        FMetadataRow Metadata;
+        Reader << Metadata;
+        if (Reader.IsError()) return false;
+
+        const int64 Id = Segment->Index->GetId(Row);
+        Segment->Ids.Add(Id);
+        Segment->Rows.Add(Id, Row);
+        if (!Metadata.IsEmpty())
+        {
+            Segment->Metadata.SetRow(Row, Metadata);
+        }
+    }
+
+    Snapshot = Segment;
+    return true;
+}
+
+bool FEmbeddingStore::ReplayLog(const FString& FilePath)
+{
+    TArray<uint8> Data;
+    if (!FFileHelper::LoadFileToArray(Data, *FilePath))
+    {
+        UE_LOGFMT(LogEmbeddingStore, Error, "Can't read log of the embedding store: {0}", FilePath);
+        return false;
+    }
+
+    FWriteScopeLock WriteScopeLock(Lock);
+    int64 Offset{0};
+    while (Offset + RecordHeaderSize <= Data.Num())
+    {
+        uint32 PayloadSize, PayloadCrc;
+        FMemory::Memcpy(&PayloadSize, Data.GetData() + Offset, sizeof(uint32));
+        FMemory::Memcpy(&PayloadCrc, Data.GetData() + Offset + sizeof(uint32), sizeof(uint32));
+
+        const uint8* Payload = Data.GetData() + Offset + RecordHeaderSize;
+        const int64 RecordEnd = Offset + RecordHeaderSize + PayloadSize;
+        if (RecordEnd > Data.Num() || FCrc::MemCrc32(Payload, PayloadSize) != PayloadCrc)
+        {
+            // a crash tears the last record only, a bad record followed by more data is a damaged file
+            if (RecordEnd < Data.Num())
+            {
+                UE_LOGFMT(LogEmbeddingStore, Error, "Bad record at {0} of {1}", Offset, FilePath);
+                return false;
+            }
+            UE_LOGFMT(LogEmbeddingStore, Warning, "Torn record at {0} of {1} is skipped", Offset, FilePath);
+            return true;
+        }
+
+        FMemoryReaderView Reader(MakeArrayView(Payload, PayloadSize));
+        uint8 TypeValue{};
+        int64 Id{};
+        Reader << TypeValue << Id;
+        if (TypeValue > static_cast<uint8>(ERecordType::Remove)) return false;
+
+        if (static_cast<ERecordType>(TypeValue) == ERecordType::Insert)
+        {
+            int32 NumValues{};
+            Reader << NumValues;
+            if (NumValues != Dimensions) return false;
+
+            TArray<float> Vector;
+            Vector.SetNumUninitialized(NumValues);
+            Reader.Serialize(Vector.GetData(), NumValues * sizeof(float));
+            FMetadataRow Metadata;
+            Reader << Metadata;
+            if (Reader.IsError()) return false;
+
+            ApplyInsert(Id, Vector, Metadata);
+        }
+        else
+        {
+            ApplyRemove(Id);
+        }
+
+        ++NumLoggedWrites;
+        Offset += RecordHeaderSize + PayloadSize;
+    }
+    return true;
+}
+
+bool FEmbeddingStore::OpenLog(int64 Generation)
+{
+    TUniquePtr<IFileHandle> NewLogFile(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*GetLogPath(Generation), true));
+    if (!NewLogFile)
+    {
+        UE_LOGFMT(LogEmbeddingStore, Error, "Can't open log of the embedding store: {0}", GetLogPath(Generation));
+        return false;
+    }
+
+    LogFile = MoveTemp(NewLogFile);
+    LogGeneration = Generation;
+    return true;
+}
+
+bool FEmbeddingStore::AppendToLog(const TArray<uint8>& Record)
+{
+    if (!LogFile || !LogFile->Write(Record.GetData(), Record.Num()) || !LogFile->Flush(Options.bFullFlush))
+    {
+        UE_LOGFMT(LogEmbeddingStore, Error, "Can't write log of the embedding store: {0}", GetLogPath(LogGeneration));
+        return false;
+    }
+    return true;
+}
+
+bool FEmbeddingStore::Insert(int64 Id, TArrayView<const float> Vector, const FMetadataRow& Metadata)
+{
+    if (Vector.Num() < Dimensions) return false;
+
+    // longer vectors are truncated
+    const TArrayView<const float> StoredVector = Vector.Left(Dimensions);
+    const TArray<uint8> Record = MakeRecord(ERecordType::Insert, Id, StoredVector, &Metadata);
+
+    FScopeLock ScopeLock(&WriteLock);
+    if (!AppendToLog(Record)) return false;
+
+    {
+        FWriteScopeLock WriteScopeLock(Lock);
+        ApplyInsert(Id, StoredVector, Metadata);
+    }
+    ++NumLoggedWrites;
+    StartCompactionIfNeeded();
+    return true;
+}
+
+bool FEmbeddingStore::Remove(int64 Id)
+{
+    FScopeLock ScopeLock(&WriteLock);
+    if (!Contains(Id) || !AppendToLog(MakeRecord(ERecordType::Remove, Id))) return false;
+
+    {
+        FWriteScopeLock WriteScopeLock(Lock);
+        ApplyRemove(Id);
+    }
+    ++NumLoggedWrites;
+    StartCompactionIfNeeded();
+    return true;
+}
+
+void FEmbeddingStore::ApplyInsert(int64 Id, TArrayView<const float> Vector, const FMetadataRow& Metadata)
+{
+    // the previous version is removed wherever it is
+    ApplyRemove(Id);
+
+    const int32 Row = Recent->Matrix->Add(Vector);
+    Recent->Ids.Add(Id);
+    Recent->Rows.Add(Id, Row);
+    if (!Metadata.IsEmpty())
+    {
+        Recent->Metadata.SetRow(Row, Metadata);
+    }
+}
+
+bool FEmbeddingStore::ApplyRemove(int64 Id)
+{
+    bool Removed{false};
+    for (const TSharedPtr<FSegment>& Segment : {Snapshot, Frozen, Recent})
+    {
+        if (Segment && Segment->Remove(Id))
+        {
+            Removed = true;
+        }
+    }
+
+    if (Removed && bCompacting)
+    {
+        RemovedWhileCompacting.Add(Id);
+    }
+    return Removed;
+}
+
+bool FEmbeddingStore::Contains(int64 Id) const
+{
+    FReadScopeLock ReadScopeLock(Lock);
+    for (const TSharedPtr<FSegment>& Segment : {Snapshot, Frozen, Recent})
+    {
+        if (Segment && Segment->ContainsLive(Id)) return true;
+    }
+    return false;
+}
+
+int32 FEmbeddingStore::Num() const
+{
+    FReadScopeLock ReadScopeLock(Lock);
+    int32 NumLive{0};
+    for (const TSharedPtr<FSegment>& Segment : {Snapshot, Frozen, Recent})
+    {
+        NumLive += Segment ? Segment->NumLive() : 0;
+    }
+    return NumLive;
+}
+
+TArray<FVectorSearchResult> FEmbeddingStore::Search(TArrayView<const float> Query, int32 K, const FMetadataFilter& Filter) const
+{
+    if (K <= 0 || Query.Num() < Dimensions) return {};
+
+    TArray<FVectorSearchResult> Results;
+    {
+        FReadScopeLock ReadScopeLock(Lock);
+        for (const TSharedPtr<FSegment>& Segment : {Snapshot, Frozen, Recent})
+        {
+            if (Segment)
+            {
+                Segment->Search(Query, K, Filter, Results);
+            }
+        }
+    }
+
+    // an id is live in one segment only, so the merged results have no duplicates
+    Results.Sort([](const FVectorSearchResult& A, const FVectorSearchResult& B) { return A.Score > B.Score; });
+    if (Results.Num() > K)
+    {
+        Results.SetNum(K);
+    }
+    return Results;
+}
+
+bool FEmbeddingStore::IsCompacting() const
+{
+    return bCompacting;
+}
+
+void FEmbeddingStore::WaitForCompaction()
+{
+    if (Compaction.IsValid())
+    {
+        Compaction.Wait();
+    }
+}
+
+void FEmbeddingStore::Compact()
+{
+    FScopeLock ScopeLock(&WriteLock);
+    if (LogFile && !bCompacting && NumLoggedWrites > 0)
+    {
+        StartCompaction();
+    }
+}
+
+void FEmbeddingStore::StartCompactionIfNeeded()
+{
+    if (bCompacting || NumLoggedWrites == 0) return;
+
+    if (NumLoggedWrites >= Options.CompactionThreshold || FDateTime::UtcNow() - LastCompactionTime >= Options.CompactionInterval)
+    {
+        StartCompaction();
+    }
+}
+
+void FEmbeddingStore::StartCompaction()
+{
+    // the next writes go to the next log, the compacted snapshot replaces the current one and all previous logs
+    const int64 Generation = LogGeneration + 1;
+    if (!OpenLog(Generation)) return;
+
+    NumLoggedWrites = 0;
+    LastCompactionTime = FDateTime::UtcNow();
+
+    // tombstones are copied, they can change while the compaction runs
+    TArray<TPair<TSharedPtr<const FSegment>, FRoaringBitmap>> Sources;
+    {
+        FWriteScopeLock WriteScopeLock(Lock);
+        Frozen = Recent;
+        Recent = MakeRecentSegment();
+        RemovedWhileCompacting.Reset();
+        bCompacting = true;
+
+        if (Snapshot)
+        {
+            Sources.Emplace(Snapshot, Snapshot->Tombstones);
+        }
+        Sources.Emplace(Frozen, Frozen->Tombstones);
+    }
+
+    Compaction = Async(EAsyncExecution::ThreadPool,
+        [this, Generation, Sources = MoveTemp(Sources)]() mutable { RunCompaction(Generation, MoveTemp(Sources)); });
+}
+
+void FEmbeddingStore::RunCompaction(int64 Generation, TArray<TPair<TSharedPtr<const FSegment>, FRoaringBitmap>> Sources)
+{
+    const TSharedPtr<FSegment> Compacted = MakeShared<FSegment>();
+    TArray<float> Vectors;
+    TArray<float> Vector;
+    for (const auto& [Segment, Tombstones] : Sources)
+    {
+        for (int32 Row = 0; Row < Segment->Num(); ++Row)
+        {
+            if (Tombstones.Contains(Row)) continue;
+
+            Segment->CopyVector(Row, Vector);
+            Vectors.Append(Vector);
+
+            const int64 Id = Segment->Ids[Row];
+            const int32 CompactedRow = Compacted->Ids.Add(Id);
+            Compacted->Rows.Add(Id, CompactedRow);
+            const FMetadataRow Metadata = Segment->Metadata.GetRow(Row);
+            if (!Metadata.IsEmpty())
+            {
+                Compacted->Metadata.SetRow(CompactedRow, Metadata);
+            }
+        }
+    }
+    // the old snapshot can be mapped from the file that is deleted below
+    Sources.Empty();
+
+    Compacted->Index = MakeUnique<FHNSWIndex>(Dimensions, Options.IndexParams);
+    Compacted->Index->Build(Compacted->Ids, Vectors);
+
+    // if the snapshot isn't saved, the logs of the previous one are kept and replayed on the next open
+    const bool Saved = SaveSnapshot(Generation, *Compacted);
+
+    {
+        FWriteScopeLock WriteScopeLock(Lock);
+        for (const int64 Id : RemovedWhileCompacting)
+        {
+            Compacted->Remove(Id);
+        }
+        RemovedWhileCompacting.Reset();
+        Snapshot = Compacted;
+        Frozen.Reset();
+    }
+
+    UE_LOGFMT(LogEmbeddingStore, Display, "Embedding store is compacted: {0} vector(s), snapshot {1}", Compacted->Num(), Generation);
+    if (Saved)
+    {
+        DeleteObsoleteFiles(Generation);
+    }
+
+    // the next compaction can't start before the files are deleted, it would write a newer snapshot
+    bCompacting = false;
+}
+
+bool FEmbeddingStore::SaveSnapshot(int64 Generation, const FSegment& Segment) const
+{
+    TArray<uint8> Data;
+    FMemoryWriter Writer(Data);
+    uint32 Magic = MetaFileMagic;
+    uint32 Version = MetaFileVersion;
+    int32 NumRows = Segment.Num();
+    Writer << Magic << Version << NumRows;
+    for (int32 Row = 0; Row < NumRows; ++Row)
+    {
+        FMetadataRow Metadata = Segment.Metadata.GetRow(Row);
+        Writer << Metadata;
+    }
+
+    const auto SaveMeta = [&Data](const FString& Path) { return FFileHelper::SaveArrayToFile(Data, *Path); };
+    const auto SaveCurrent = [Generation](const FString& Path) { return FFileHelper::SaveStringToFile(LexToString(Generation), *Path); };
+
+    // the snapshot becomes current when both of its files are complete
+    const bool Saved = Segment.Index->Save(GetSnapshotPath(Generation, TEXT("hnsw"))) &&
+                       AtomicFile::Save(GetSnapshotPath(Generation, TEXT("meta")), SaveMeta) &&
+                       AtomicFile::Save(GetCurrentPath(), SaveCurrent);
+
+    if (!Saved)
+    {
+        UE_LOGFMT(LogEmbeddingStore, Error, "Can't save snapshot {0} of the embedding store: {1}", Generation, Directory);
+    }
+    return Saved;
+}
+
+void FEmbeddingStore::DeleteObsoleteFiles(int64 Generation) const
+{
+    IFileManager& FileManager = IFileManager::Get();
+    for (const int64 LogFileGeneration : FindGenerations(Directory, TEXT("Log_"), TEXT("wal")))
+    {
+        if (LogFileGeneration < Generation)
+        {
+            FileManager.Delete(*GetLogPath(LogFileGeneration));
+        }
+    }
+
+    for (const TCHAR* Extension : {TEXT("hnsw"), TEXT("meta")})
+    {
+        for (const int64 SnapshotGeneration : FindGenerations(Directory, TEXT("Snapshot_"), Extension))
+        {
+            if (SnapshotGeneration != Generation)
+            {
+                FileManager.Delete(*GetSnapshotPath(SnapshotGeneration, Extension));
+            }
+        }
+    }
+}
@@ -0,0 +1,309 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/EmbeddingsDriver.h"
+#include "Embeddings/EmbeddingCache.h"
+#include "Provider/OpenAIProvider.h"
+#include "Tokenizer/BPETokenizer.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Containers/Ticker.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEmbeddingsDriver, All, All);
+
+namespace OpenAI
+{
+struct FEmbeddingsJob
+{
+    /**
+      Request without the input, the input is sliced per request.
+    */
+    FEmbeddings Request;
+    TArray<FString> Input;
+    TArray<FEmbeddingsSlice> Slices;
+    /**
+      Inputs that are over the token limits, they aren't sent.
+    */
+    TArray<int32> Rejected;
+
+    FEmbeddingsResponse Response;
+    int32 NumPending{};
+    bool Failed{false};
+    FOnEmbeddingsDriven OnCompleted;
+};
+}  // namespace OpenAI
+
+using namespace OpenAI;
+
+UEmbeddingsDriver::UEmbeddingsDriver() : TokenCounter(FBPETokenizer::MakeTokenCounter(EBPEEncoding::Cl100kBase)) {}
+
+void UEmbeddingsDriver::SetOptions(const FEmbeddingsDriverOptions& InOptions)
+{
+    Options = InOptions;
+    Options.MaxInputsPerRequest = FMath::Max(1, Options.MaxInputsPerRequest);
+    Options.MaxTokensPerRequest = FMath::Max(1, Options.MaxTokensPerRequest);
+    Options.MaxTokensPerInput = FMath::Max(1, Options.MaxTokensPerInput);
+    Options.MaxConcurrentRequests = FMath::Max(1, Options.MaxConcurrentRequests);
+    Options.MaxRetries = FMath::Max(0, Options.MaxRetries);
+    Options.RetryDelay = FMath::Max(FTimespan::Zero(), Options.RetryDelay);
+    PumpSendQueue();
+}
+
+void UEmbeddingsDriver::CreateEmbeddings(const FEmbeddings& Embeddings, const FOnEmbeddingsDriven& OnCompleted)
+{
+    check(IsInGameThread());
+
+    const auto Job = MakeShared<FEmbeddingsJob>();
+    Job->Request = Embeddings;
+    Job->Input = MoveTemp(Job->Request.Input);
+    Job->Request.Input.Reset();
+    Job->OnCompleted = OnCompleted;
+
+    TSharedPtr<FEmbeddingCacheLookup> Lookup;
+    if (EmbeddingCache.IsValid())
+    {
+        // the misses are embedded and spliced with the hits back in the order of the input
+        Lookup = MakeShared<FEmbeddingCacheLookup>();
+        Job->OnCompleted = [Cache = EmbeddingCache.ToSharedRef(), Lookup, OnCompleted](const FEmbeddingsResponse& Response, bool Succeeded)
+        {
+            Cache->Resolve(*Lookup, Response);
+            Async(EAsyncExecution::ThreadPool, [Cache]() { Cache->Save(); });
+            OnCompleted(FEmbeddingCache::MakeResponse(*Lookup, Response), Succeeded);
+        };
+    }
+
+    // token counting of a big corpus takes a while with a real tokenizer
+    Async(EAsyncExecution::ThreadPool,
+        [WeakThis = TWeakObjectPtr<UEmbeddingsDriver>(this), Job, Options = Options, TokenCounter = TokenCounter,
+            Cache = EmbeddingCache, Lookup]()
+        {
+            if (Cache.IsValid())
+            {
+                Job->Request.Input = MoveTemp(Job->Input);
+                *Lookup = Cache->Lookup(Job->Request);
+                Job->Request.Input.Reset();
+                Job->Input = Lookup->MissInput;
+                UE_LOGFMT(LogEmbeddingsDriver, Display, "{0} of {1} input(s) are embedded, the rest are cached or duplicates",
+                    Job->Input.Num(), Lookup->InputToUnique.Num());
+            }
+            Job->Slices = SplitInput(Job->Input, Options, TokenCounter, &Job->Rejected);
+            AsyncTask(ENamedThreads::GameThread,
+                [WeakThis, Job]()
+                {
+                    if (!WeakThis.IsValid()) return;
+                    WeakThis->EnqueueJob(Job);
+                });
+        });
+}
+
+TArray<FEmbeddingsSlice> UEmbeddingsDriver::SplitInput(
+    const TArray<FString>& Input, const FEmbeddingsDriverOptions& Options, const FTokenCounter& TokenCounter, TArray<int32>* Rejected)
+{
+    TArray<int32> Tokens;
+    Tokens.SetNumUninitialized(Input.Num());
+    ParallelFor(Input.Num(), [&](int32 Index) { Tokens[Index] = TokenCounter(Input[Index]); });
+
+    TArray<FEmbeddingsSlice> Slices;
+    FEmbeddingsSlice Slice;
+    int64 SliceTokens{0};
+    const int32 MaxTokensPerInput = FMath::Min(Options.MaxTokensPerInput, Options.MaxTokensPerRequest);
+    for (int32 Index = 0; Index < Input.Num(); ++Index)
+    {
+        // an input over the limit fails the whole request, so it isn't packed with the valid ones
+        if (Tokens[Index] > MaxTokensPerInput)
+        {
+            if (Slice.Num > 0)
+            {
+                Slices.Add(Slice);
+            }
+            Slice = FEmbeddingsSlice{Index + 1, 0};
+            SliceTokens = 0;
+            if (Rejected)
+            {
+                Rejected->Add(Index);
+            }
+            continue;
+        }
+
+        const bool SliceIsFull = Slice.Num >= Options.MaxInputsPerRequest || SliceTokens + Tokens[Index] > Options.MaxTokensPerRequest;
+        if (Slice.Num > 0 && SliceIsFull)
+        {
+            Slices.Add(Slice);
+            Slice = FEmbeddingsSlice{Index, 0};
+            SliceTokens = 0;
+        }
+        ++Slice.Num;
+        SliceTokens += Tokens[Index];
+    }
+
+    if (Slice.Num > 0)
+    {
+        Slices.Add(Slice);
+    }
+    return Slices;
+}
+
+bool UEmbeddingsDriver::IsRetryable(const FString& ErrorContent)
+{
+    // 5xx of the gateways and network errors come without the JSON error of the API
+    TSharedPtr<FJsonObject> Json;
+    const TSharedPtr<FJsonObject>* Error = nullptr;
+    if (!UJsonFuncLib::StringToJson(ErrorContent, Json) || !Json->TryGetObjectField(TEXT("error"), Error)) return true;
+
+    FString Type, Code;
+    (*Error)->TryGetStringField(TEXT("type"), Type);
+    (*Error)->TryGetStringField(TEXT("code"), Code);
+    if (Code.Equals(TEXT("insufficient_quota"))) return false;
+    return Code.Equals(TEXT("rate_limit_exceeded")) || Type.Equals(TEXT("requests")) || Type.Equals(TEXT("tokens")) ||
+           Type.Equals(TEXT("server_error"));
+}
+
+bool UEmbeddingsDriver::MergeSlice(FEmbeddingsResponse& Merged, const FEmbeddingsSlice& Slice, const FEmbeddingsResponse& Response)
+{
+    if (Response.Data.Num() != Slice.Num) return false;
+
+    for (const FEmbeddingsData& Data : Response.Data)
+    {
+        if (Data.Index < 0 || Data.Index >= Slice.Num) return false;
+    }
+
+    for (const FEmbeddingsData& Data : Response.Data)
+    {
+        FEmbeddingsData& MergedData = Merged.Data[Slice.First + Data.Index];
+        MergedData = Data;
+        MergedData.Index = Slice.First + Data.Index;
+    }
+
+    Merged.Usage.Prompt_Tokens += Response.Usage.Prompt_Tokens;
+    Merged.Usage.Total_Tokens += Response.Usage.Total_Tokens;
+    if (Merged.Model.IsEmpty())
+    {
+        Merged.Model = Response.Model;
+    }
+    return true;
+}
+
+void UEmbeddingsDriver::EnqueueJob(const TSharedRef<FEmbeddingsJob>& Job)
+{
+    Job->Response.Object = "list";
+    Job->Response.Data.SetNum(Job->Input.Num());
+    for (int32 Index = 0; Index < Job->Input.Num(); ++Index)
+    {
+        Job->Response.Data[Index].Index = Index;
+    }
+
+    if (!Job->Rejected.IsEmpty())
+    {
+        const FString Rejected = FString::JoinBy(Job->Rejected, TEXT(", "), [](int32 Index) { return FString::FromInt(Index); });
+        UE_LOGFMT(LogEmbeddingsDriver, Error, "Input(s) {0} are over the token limit of one input and aren't sent", Rejected);
+        Job->Failed = true;
+    }
+
+    if (Job->Slices.IsEmpty())
+    {
+        Job->OnCompleted(Job->Response, !Job->Failed);
+        return;
+    }
+
+    UE_LOGFMT(LogEmbeddingsDriver, Display, "{0} input(s) are split into {1} request(s)", Job->Input.Num(), Job->Slices.Num());
+
+    Job->NumPending = Job->Slices.Num();
+    for (int32 SliceIndex = 0; SliceIndex < Job->Slices.Num(); ++SliceIndex)
+    {
+        EnqueueSlice(Job, SliceIndex, 0);
+    }
+    PumpSendQueue();
+}
+
+void UEmbeddingsDriver::EnqueueSlice(const TSharedRef<FEmbeddingsJob>& Job, int32 SliceIndex, int32 Attempt)
+{
+    SendQueue.Enqueue([this, Job, SliceIndex, Attempt]() { SendSlice(Job, SliceIndex, Attempt); });
+    ++NumQueued;
+}
+
+void UEmbeddingsDriver::RetrySlice(const TSharedRef<FEmbeddingsJob>& Job, int32 SliceIndex, int32 Attempt)
+{
+    // exponential backoff, a rate limited API isn't hit again at once
+    const double Delay = Options.RetryDelay.GetTotalSeconds() * FMath::Pow(2.0, Attempt - 1);
+    if (Delay <= 0.0)
+    {
+        EnqueueSlice(Job, SliceIndex, Attempt);
+        PumpSendQueue();
+        return;
+    }
+
+    FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this,
+                                             [this, Job, SliceIndex, Attempt](float)
+                                             {
+                                                 EnqueueSlice(Job, SliceIndex, Attempt);
+                                                 PumpSendQueue();
+                                                 return false;
+                                             }),
+        static_cast<float>(Delay));
+}
+
+void UEmbeddingsDriver::SendSlice(const TSharedRef<FEmbeddingsJob>& Job, int32 SliceIndex, int32 Attempt)
+{
+    const FEmbeddingsSlice& Slice = Job->Slices[SliceIndex];
+    FEmbeddings Request = Job->Request;
+    Request.Input.Append(Job->Input.GetData() + Slice.First, Slice.Num);
+
+    auto* Provider = NewObject<UOpenAIProvider>(this, ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass());
+    Providers.Add(Provider);
+
+    Provider->OnCreateEmbeddingsCompleted().AddWeakLambda(this,
+        [this, Provider, Job, SliceIndex](const FEmbeddingsResponse& Response)
+        {
+            if (!MergeSlice(Job->Response, Job->Slices[SliceIndex], Response))
+            {
+                UE_LOGFMT(LogEmbeddingsDriver, Error, "Response of request {0} doesn't match its inputs", SliceIndex);
+                Job->Failed = true;
+            }
+            OnRequestFinished(Provider);
+            OnSliceFinished(Job);
+        });
+    Provider->OnRequestError().AddWeakLambda(this,
+        [this, Provider, Job, SliceIndex, Attempt](const FString& URL, const FString& Content)
+        {
+            if (Attempt < Options.MaxRetries && IsRetryable(Content))
+            {
+                UE_LOGFMT(LogEmbeddingsDriver, Warning, "Request {0} failed, retrying: {1}", SliceIndex, Content);
+                OnRequestFinished(Provider);
+                RetrySlice(Job, SliceIndex, Attempt + 1);
+                return;
+            }
+
+            UE_LOGFMT(LogEmbeddingsDriver, Error, "Request {0} failed: {1}", SliceIndex, Content);
+            Job->Failed = true;
+            OnRequestFinished(Provider);
+            OnSliceFinished(Job);
+        });
+    Provider->CreateEmbeddings(Request, Auth);
+}
+
+void UEmbeddingsDriver::OnSliceFinished(const TSharedRef<FEmbeddingsJob>& Job)
+{
+    if (--Job->NumPending == 0)
+    {
+        Job->OnCompleted(Job->Response, !Job->Failed);
+    }
+}
+
+void UEmbeddingsDriver::PumpSendQueue()
+{
+    TFunction<void()> Send;
+    while (NumInFlight < Options.MaxConcurrentRequests && SendQueue.Dequeue(Send))
+    {
+        --NumQueued;
+        ++NumInFlight;
+        Send();
+    }
+}
+
+void UEmbeddingsDriver::OnRequestFinished(UOpenAIProvider* Provider)
+{
+    Providers.RemoveSingleSwap(Provider);
+    --NumInFlight;
+    PumpSendQueue();
+}
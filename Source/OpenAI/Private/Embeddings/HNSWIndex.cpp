@@ -0,0 +1,693 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/HNSWIndex.h"
+#include "IO/MappedFile.h"
+#include "IO/AtomicFile.h"
+#include "Async/ParallelFor.h"
+#include "Containers/StaticArray.h"
+#include "HAL/FileManager.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/ScopeRWLock.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogHNSWIndex, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr uint32 FileMagic = 0x57534E48;  // HNSW
+constexpr uint32 FileVersion = 1;
+constexpr int64 SectionAlignment = 64;
+constexpr int32 NumSections = 6;
+constexpr int32 RowAlignment = 4;
+constexpr int32 NumLinkLocks = 4096;
+constexpr int32 MaxNodeLevel = 16;
+/**
+  Bound of M in the loaded files, the sizes of the link blocks can't overflow.
+*/
+constexpr int32 MaxFileM = 1024;
+
+struct FFileHeader
+{
+    uint32 Magic;
+    uint32 Version;
+    int32 Dimensions;
+    int32 M;
+    int32 EfConstruction;
+    int32 EfSearch;
+    int32 Metric;
+    int32 Seed;
+    int32 NumNodes;
+    int32 EntryPoint;
+    int32 MaxLevel;
+    int32 Padding;
+    int64 NumUpperLinks;
+    int64 SectionOffsets[NumSections];
+};
+
+/**
+  Visited marks are reused between the searches of a thread, a new generation invalidates all marks at once.
+*/
+struct FVisitedNodes
+{
+    TArray<uint32> Marks;
+    uint32 Generation{0};
+
+    void Reset(int32 NumNodes)
+    {
+        if (Marks.Num() < NumNodes)
+        {
+            Marks.SetNumZeroed(NumNodes);
+        }
+        if (++Generation == 0)
+        {
+            FMemory::Memzero(Marks.GetData(), Marks.Num() * sizeof(uint32));
+            Generation = 1;
+        }
+    }
+
+    bool Visit(int32 Node)
+    {
+        if (Marks[Node] == Generation) return false;
+        Marks[Node] = Generation;
+        return true;
+    }
+};
+
+thread_local FVisitedNodes VisitedNodes;
+
+TStaticArray<int64, NumSections> GetSectionSizes(int64 NumNodes, int64 NumUpperLinks, int32 Stride, int32 MaxLinks0)
+{
+    TStaticArray<int64, NumSections> Sizes;
+    Sizes[0] = NumNodes * Stride * static_cast<int64>(sizeof(float));
+    Sizes[1] = NumNodes * static_cast<int64>(sizeof(int64));
+    Sizes[2] = NumNodes * static_cast<int64>(sizeof(int32));
+    Sizes[3] = NumNodes * (1 + MaxLinks0) * static_cast<int64>(sizeof(int32));
+    Sizes[4] = NumUpperLinks * static_cast<int64>(sizeof(int32));
+    Sizes[5] = NumNodes * static_cast<int64>(sizeof(int64));
+    return Sizes;
+}
+
+/**
+  Entry point, levels, upper offsets and every link of the file point inside the graph, so the search can't read out of bounds.
+*/
+bool IsValidGraph(const FFileHeader& Header, const uint8* Data, int32 MaxLinks0)
+{
+    const int32 NumNodes = Header.NumNodes;
+    if (NumNodes == 0) return Header.EntryPoint == INDEX_NONE && Header.MaxLevel == INDEX_NONE;
+    if (Header.EntryPoint < 0 || Header.EntryPoint >= NumNodes || Header.MaxLevel < 0 || Header.MaxLevel > MaxNodeLevel) return false;
+
+    const auto* Levels = reinterpret_cast<const int32*>(Data + Header.SectionOffsets[2]);
+    const auto* BaseLinks = reinterpret_cast<const int32*>(Data + Header.SectionOffsets[3]);
+    const auto* UpperLinks = reinterpret_cast<const int32*>(Data + Header.SectionOffsets[4]);
+    const auto* UpperOffsets = reinterpret_cast<const int64*>(Data + Header.SectionOffsets[5]);
+
+    const auto IsValidBlock = [NumNodes](const int32* Block, int32 MaxLinks)
+    {
+        if (Block[0] < 0 || Block[0] > MaxLinks) return false;
+        for (int32 Link = 1; Link <= Block[0]; ++Link)
+        {
+            if (Block[Link] < 0 || Block[Link] >= NumNodes) return false;
+        }
+        return true;
+    };
+
+    const int64 UpperBlockSize = 1 + Header.M;
+    for (int32 Node = 0; Node < NumNodes; ++Node)
+    {
+        const int32 Level = Levels[Node];
+        const int64 UpperOffset = UpperOffsets[Node];
+        if (Level < 0 || Level > Header.MaxLevel || UpperOffset < 0 || UpperOffset + Level * UpperBlockSize > Header.NumUpperLinks ||
+            !IsValidBlock(BaseLinks + static_cast<int64>(Node) * (1 + MaxLinks0), MaxLinks0))
+        {
+            return false;
+        }
+        for (int32 UpperLevel = 0; UpperLevel < Level; ++UpperLevel)
+        {
+            if (!IsValidBlock(UpperLinks + UpperOffset + UpperLevel * UpperBlockSize, Header.M)) return false;
+        }
+    }
+    return Levels[Header.EntryPoint] == Header.MaxLevel;
+}
+
+// heap predicates: the best or the worst score is on the top
+const auto BestOnTop = [](const FScoredVector& A, const FScoredVector& B) { return A.Score > B.Score; };
+const auto WorstOnTop = [](const FScoredVector& A, const FScoredVector& B) { return A.Score < B.Score; };
+}  // namespace
+
+FHNSWIndex::FHNSWIndex(int32 InDimensions, const FHNSWParams& InParams)
+    : Dimensions(FMath::Max(1, InDimensions)), Params(InParams), LinkLocks(MakeUnique<FCriticalSection[]>(NumLinkLocks))
+{
+    ApplyParams();
+}
+
+FHNSWIndex::~FHNSWIndex() = default;
+
+void FHNSWIndex::ApplyParams()
+{
+    Stride = Align(Dimensions, RowAlignment);
+    Params.M = FMath::Max(2, Params.M);
+    Params.EfConstruction = FMath::Max(Params.M, Params.EfConstruction);
+    Params.EfSearch = FMath::Max(1, Params.EfSearch);
+    MaxLinks0 = Params.M * 2;
+    LevelMultiplier = 1.0 / FMath::Loge(static_cast<double>(Params.M));
+}
+
+int32 FHNSWIndex::Num() const
+{
+    FReadScopeLock ReadLock(Lock);
+    return NumNodes;
+}
+
+int64 FHNSWIndex::GetId(int32 Node) const
+{
+    FReadScopeLock ReadLock(Lock);
+    return Node >= 0 && Node < NumNodes ? Ids.GetData()[Node] : INDEX_NONE;
+}
+
+bool FHNSWIndex::CopyVector(int32 Node, TArray<float>& Vector) const
+{
+    FReadScopeLock ReadLock(Lock);
+    if (Node < 0 || Node >= NumNodes) return false;
+
+    Vector.Reset(Dimensions);
+    Vector.Append(GetVector(Node), Dimensions);
+    return true;
+}
+
+void FHNSWIndex::SetEfSearch(int32 EfSearch)
+{
+    FWriteScopeLock WriteLock(Lock);
+    Params.EfSearch = FMath::Max(1, EfSearch);
+}
+
+void FHNSWIndex::Reserve(int32 NumVectors)
+{
+    FWriteScopeLock WriteLock(Lock);
+    Detach();
+    Vectors.Owned.Reserve(static_cast<int64>(NumVectors) * Stride);
+    Ids.Owned.Reserve(NumVectors);
+    Levels.Owned.Reserve(NumVectors);
+    BaseLinks.Owned.Reserve(static_cast<int64>(NumVectors) * (1 + MaxLinks0));
+    UpperOffsets.Owned.Reserve(NumVectors);
+}
+
+bool FHNSWIndex::Add(int64 Id, TArrayView<const float> Vector)
+{
+    if (Vector.Num() < Dimensions) return false;
+
+    FWriteScopeLock WriteLock(Lock);
+    Detach();
+    LinkNode(AllocateNode(Id, Vector.GetData()), false);
+    return true;
+}
+
+bool FHNSWIndex::Build(TArrayView<const int64> InIds, TArrayView<const float> InVectors)
+{
+    if (InVectors.Num() < static_cast<int64>(InIds.Num()) * Dimensions) return false;
+
+    FWriteScopeLock WriteLock(Lock);
+    Detach();
+
+    // nodes are allocated up front, so the arrays aren't reallocated while the graph is linked in parallel
+    const int32 FirstNode = NumNodes;
+    for (int32 Index = 0; Index < InIds.Num(); ++Index)
+    {
+        AllocateNode(InIds[Index], InVectors.GetData() + static_cast<int64>(Index) * Dimensions);
+    }
+
+    int32 FirstParallelNode = FirstNode;
+    if (EntryPoint == INDEX_NONE && FirstNode < NumNodes)
+    {
+        LinkNode(FirstNode, false);
+        ++FirstParallelNode;
+    }
+    ParallelFor(NumNodes - FirstParallelNode, [this, FirstParallelNode](int32 Index) { LinkNode(FirstParallelNode + Index, true); });
+
+    UE_LOGFMT(LogHNSWIndex, Display, "{0} vector(s) were added, max level: {1}", InIds.Num(), MaxLevel);
+    return true;
+}
+
+TArray<FVectorSearchResult> FHNSWIndex::Search(TArrayView<const float> Query, int32 K, int32 Ef) const
+{
+    return SearchNodes(Query, K, Ef, nullptr);
+}
+
+TArray<FVectorSearchResult> FHNSWIndex::Search(TArrayView<const float> Query, int32 K, const FRoaringBitmap& Filter, int32 Ef) const
+{
+    return SearchNodes(Query, K, Ef, &Filter);
+}
+
+TArray<FVectorSearchResult> FHNSWIndex::SearchNodes(TArrayView<const float> Query, int32 K, int32 Ef, const FRoaringBitmap* Filter) const
+{
+    FReadScopeLock ReadLock(Lock);
+    if (NumNodes == 0 || K <= 0 || Query.Num() < Dimensions || (Filter && Filter->IsEmpty())) return {};
+
+    TArray<float, TAlignedHeapAllocator<16>> Prepared;
+    Prepared.SetNumZeroed(Stride);
+    PrepareVector(Query.GetData(), Prepared.GetData());
+
+    Ef = FMath::Max(Ef > 0 ? Ef : Params.EfSearch, K);
+    TArray<FScoredVector> Candidates;
+    // the traversal scores about Ef * MaxLinks0 nodes, a smaller filter is cheaper to scan
+    // and a selective filter would make the traversal wander through the rejected nodes
+    if (Filter && Filter->Num() <= static_cast<int64>(Ef) * MaxLinks0)
+    {
+        ScanNodes(Prepared.GetData(), *Filter, K, Candidates);
+    }
+    else
+    {
+        const int32 Entry = GreedySearch(Prepared.GetData(), EntryPoint, MaxLevel, 0, false);
+        SearchLayer(Prepared.GetData(), Entry, Ef, 0, false, Candidates, Filter);
+    }
+
+    TArray<FVectorSearchResult> Results;
+    Results.Reserve(FMath::Min(K, Candidates.Num()));
+    for (int32 Index = 0; Index < Candidates.Num() && Index < K; ++Index)
+    {
+        Results.Add(FVectorSearchResult{Ids.GetData()[Candidates[Index].Index], Candidates[Index].Score});
+    }
+    return Results;
+}
+
+void FHNSWIndex::ScanNodes(const float* Query, const FRoaringBitmap& Filter, int32 K, TArray<FScoredVector>& Results) const
+{
+    TArray<int32> Nodes;
+    TArray<float> Scores;
+    Filter.ForEach(
+        [&](uint32 Node)
+        {
+            if (Node < static_cast<uint32>(NumNodes))
+            {
+                Nodes.Add(static_cast<int32>(Node));
+                Scores.Add(Score(Query, GetVector(Node)));
+            }
+        });
+
+    Results = FEmbeddingMatrix::SelectTopK(Scores, K);
+    for (FScoredVector& Result : Results)
+    {
+        Result.Index = Nodes[Result.Index];
+    }
+}
+
+int32 FHNSWIndex::AllocateNode(int64 Id, const float* Vector)
+{
+    const int32 Node = NumNodes++;
+
+    Vectors.Owned.AddZeroed(Stride);
+    PrepareVector(Vector, Vectors.GetMutableData() + static_cast<int64>(Node) * Stride);
+    Ids.Owned.Add(Id);
+
+    FRandomStream Random(HashCombine(GetTypeHash(Params.Seed), GetTypeHash(Node)));
+    const double Fraction = FMath::Max(static_cast<double>(Random.GetFraction()), UE_DOUBLE_SMALL_NUMBER);
+    const int32 Level = FMath::Min(FMath::FloorToInt32(-FMath::Loge(Fraction) * LevelMultiplier), MaxNodeLevel);
+    Levels.Owned.Add(Level);
+
+    BaseLinks.Owned.AddZeroed(1 + MaxLinks0);
+    UpperOffsets.Owned.Add(UpperLinks.Owned.Num());
+    UpperLinks.Owned.AddZeroed(Level * (1 + Params.M));
+    return Node;
+}
+
+void FHNSWIndex::LinkNode(int32 Node, bool Concurrent)
+{
+    const int32 NodeLevel = Levels.GetData()[Node];
+    const float* Vector = GetVector(Node);
+
+    int32 CurrentEntryPoint;
+    int32 CurrentMaxLevel;
+    {
+        FScopeLock ScopeLock(&GraphLock);
+        CurrentEntryPoint = EntryPoint;
+        CurrentMaxLevel = MaxLevel;
+        if (CurrentEntryPoint == INDEX_NONE)
+        {
+            EntryPoint = Node;
+            MaxLevel = NodeLevel;
+            return;
+        }
+    }
+
+    // rare nodes above the top level are linked exclusively, they become the new entry point
+    TOptional<FScopeLock> NewTopLevelLock;
+    if (NodeLevel > CurrentMaxLevel)
+    {
+        NewTopLevelLock.Emplace(&GraphLock);
+    }
+
+    int32 Entry = GreedySearch(Vector, CurrentEntryPoint, CurrentMaxLevel, NodeLevel, Concurrent);
+
+    TArray<FScoredVector> Candidates;
+    for (int32 Level = FMath::Min(NodeLevel, CurrentMaxLevel); Level >= 0; --Level)
+    {
+        SearchLayer(Vector, Entry, Params.EfConstruction, Level, Concurrent, Candidates);
+        Candidates.RemoveAll([Node](const FScoredVector& Candidate) { return Candidate.Index == Node; });
+        if (Candidates.IsEmpty()) continue;
+
+        Entry = Candidates[0].Index;
+        SelectNeighbors(Candidates, Params.M);
+        {
+            FScopeLock LinkLock(&LinkLocks[Node % NumLinkLocks]);
+            int32* Links = GetLinks(Node, Level);
+            Links[0] = Candidates.Num();
+            for (int32 Index = 0; Index < Candidates.Num(); ++Index)
+            {
+                Links[1 + Index] = Candidates[Index].Index;
+            }
+        }
+
+        for (const FScoredVector& Neighbor : Candidates)
+        {
+            ConnectBack(Neighbor.Index, Node, Level);
+        }
+    }
+
+    if (NewTopLevelLock.IsSet() && NodeLevel > MaxLevel)
+    {
+        EntryPoint = Node;
+        MaxLevel = NodeLevel;
+    }
+}
+
+void FHNSWIndex::ConnectBack(int32 Neighbor, int32 Node, int32 Level)
+{
+    FScopeLock LinkLock(&LinkLocks[Neighbor % NumLinkLocks]);
+    int32* Links = GetLinks(Neighbor, Level);
+    const int32 MaxLinks = GetMaxLinks(Level);
+    if (Links[0] < MaxLinks)
+    {
+        Links[1 + Links[0]++] = Node;
+        return;
+    }
+
+    // the list is full, the node competes with the existing links
+    const float* NeighborVector = GetVector(Neighbor);
+    TArray<FScoredVector> Candidates;
+    Candidates.Reserve(MaxLinks + 1);
+    Candidates.Add(FScoredVector{Node, Score(NeighborVector, GetVector(Node))});
+    for (int32 Index = 1; Index <= Links[0]; ++Index)
+    {
+        Candidates.Add(FScoredVector{Links[Index], Score(NeighborVector, GetVector(Links[Index]))});
+    }
+    Candidates.Sort(BestOnTop);
+    SelectNeighbors(Candidates, MaxLinks);
+
+    Links[0] = Candidates.Num();
+    for (int32 Index = 0; Index < Candidates.Num(); ++Index)
+    {
+        Links[1 + Index] = Candidates[Index].Index;
+    }
+}
+
+int32 FHNSWIndex::GreedySearch(const float* Query, int32 Node, int32 FromLevel, int32 ToLevel, bool Concurrent) const
+{
+    float BestScore = Score(Query, GetVector(Node));
+    TArray<int32, TInlineAllocator<64>> Links;
+    for (int32 Level = FromLevel; Level > ToLevel; --Level)
+    {
+        bool Improved = true;
+        while (Improved)
+        {
+            Improved = false;
+            CopyLinks(Node, Level, Concurrent, Links);
+            for (const int32 Neighbor : Links)
+            {
+                const float NeighborScore = Score(Query, GetVector(Neighbor));
+                if (NeighborScore > BestScore)
+                {
+                    BestScore = NeighborScore;
+                    Node = Neighbor;
+                    Improved = true;
+                }
+            }
+        }
+    }
+    return Node;
+}
+
+void FHNSWIndex::SearchLayer(const float* Query, int32 EntryNode, int32 Ef, int32 Level, bool Concurrent, TArray<FScoredVector>& Results,
+    const FRoaringBitmap* Filter) const
+{
+    FVisitedNodes& Visited = VisitedNodes;
+    Visited.Reset(NumNodes);
+    Visited.Visit(EntryNode);
+
+    // rejected nodes are still traversed, so the filtered nodes behind them are reachable
+    const auto Accepts = [Filter](int32 Node) { return !Filter || Filter->Contains(Node); };
+
+    const FScoredVector Entry{EntryNode, Score(Query, GetVector(EntryNode))};
+    TArray<FScoredVector> Candidates;
+    Candidates.HeapPush(Entry, BestOnTop);
+    Results.Reset();
+    if (Accepts(EntryNode))
+    {
+        Results.HeapPush(Entry, WorstOnTop);
+    }
+
+    TArray<int32, TInlineAllocator<64>> Links;
+    while (!Candidates.IsEmpty())
+    {
+        FScoredVector Current;
+        Candidates.HeapPop(Current, BestOnTop);
+        if (Results.Num() >= Ef && Current.Score < Results.HeapTop().Score) break;
+
+        CopyLinks(Current.Index, Level, Concurrent, Links);
+        for (const int32 Neighbor : Links)
+        {
+            if (!Visited.Visit(Neighbor)) continue;
+
+            const float NeighborScore = Score(Query, GetVector(Neighbor));
+            if (Results.Num() < Ef || NeighborScore > Results.HeapTop().Score)
+            {
+                Candidates.HeapPush(FScoredVector{Neighbor, NeighborScore}, BestOnTop);
+                if (!Accepts(Neighbor)) continue;
+
+                Results.HeapPush(FScoredVector{Neighbor, NeighborScore}, WorstOnTop);
+                if (Results.Num() > Ef)
+                {
+                    Results.HeapPopDiscard(WorstOnTop);
+                }
+            }
+        }
+    }
+
+    Results.Sort(BestOnTop);
+}
+
+void FHNSWIndex::SelectNeighbors(TArray<FScoredVector>& Candidates, int32 MaxNeighbors) const
+{
+    if (Candidates.Num() <= MaxNeighbors) return;
+
+    // a candidate is kept if it's closer to the node than to every neighbor that is already selected,
+    // so the links point in different directions
+    TArray<FScoredVector> Selected;
+    Selected.Reserve(MaxNeighbors);
+    for (const FScoredVector& Candidate : Candidates)
+    {
+        if (Selected.Num() >= MaxNeighbors) break;
+
+        const float* CandidateVector = GetVector(Candidate.Index);
+        const bool Diverse = !Selected.ContainsByPredicate([&](const FScoredVector& Neighbor)
+            { return Score(CandidateVector, GetVector(Neighbor.Index)) > Candidate.Score; });
+        if (Diverse)
+        {
+            Selected.Add(Candidate);
+        }
+    }
+    Candidates = MoveTemp(Selected);
+}
+
+void FHNSWIndex::CopyLinks(int32 Node, int32 Level, bool Concurrent, TArray<int32, TInlineAllocator<64>>& Links) const
+{
+    Links.Reset();
+    if (Level > Levels.GetData()[Node]) return;
+
+    TOptional<FScopeLock> LinkLock;
+    if (Concurrent)
+    {
+        LinkLock.Emplace(&LinkLocks[Node % NumLinkLocks]);
+    }
+    const int32* Block = GetLinks(Node, Level);
+    Links.Append(Block + 1, Block[0]);
+}
+
+int32* FHNSWIndex::GetLinks(int32 Node, int32 Level)
+{
+    if (Level == 0) return BaseLinks.GetMutableData() + static_cast<int64>(Node) * (1 + MaxLinks0);
+    return UpperLinks.GetMutableData() + UpperOffsets.GetData()[Node] + (Level - 1) * (1 + Params.M);
+}
+
+const int32* FHNSWIndex::GetLinks(int32 Node, int32 Level) const
+{
+    if (Level == 0) return BaseLinks.GetData() + static_cast<int64>(Node) * (1 + MaxLinks0);
+    return UpperLinks.GetData() + UpperOffsets.GetData()[Node] + (Level - 1) * (1 + Params.M);
+}
+
+void FHNSWIndex::PrepareVector(const float* Vector, float* Prepared) const
+{
+    // longer vectors are truncated, padding stays zero
+    FMemory::Memcpy(Prepared, Vector, Dimensions * sizeof(float));
+    if (Params.Metric == EVectorMetric::Cosine)
+    {
+        VectorMath::Normalize(MakeArrayView(Prepared, Dimensions));
+    }
+}
+
+void FHNSWIndex::Detach()
+{
+    if (!MappedFile) return;
+
+    Vectors.Detach();
+    Ids.Detach();
+    Levels.Detach();
+    BaseLinks.Detach();
+    UpperLinks.Detach();
+    UpperOffsets.Detach();
+    MappedFile.Reset();
+}
+
+void FHNSWIndex::Reset()
+{
+    FWriteScopeLock WriteLock(Lock);
+    Vectors.Reset();
+    Ids.Reset();
+    Levels.Reset();
+    BaseLinks.Reset();
+    UpperLinks.Reset();
+    UpperOffsets.Reset();
+    MappedFile.Reset();
+    NumNodes = 0;
+    EntryPoint = INDEX_NONE;
+    MaxLevel = INDEX_NONE;
+}
+
+bool FHNSWIndex::Save(const FString& FilePath) const
+{
+    FReadScopeLock ReadLock(Lock);
+
+    const auto SectionSizes = GetSectionSizes(NumNodes, UpperLinks.Num(), Stride, MaxLinks0);
+    const void* SectionData[NumSections] = {
+        Vectors.GetData(), Ids.GetData(), Levels.GetData(), BaseLinks.GetData(), UpperLinks.GetData(), UpperOffsets.GetData()};
+
+    FFileHeader Header{};
+    Header.Magic = FileMagic;
+    Header.Version = FileVersion;
+    Header.Dimensions = Dimensions;
+    Header.M = Params.M;
+    Header.EfConstruction = Params.EfConstruction;
+    Header.EfSearch = Params.EfSearch;
+    Header.Metric = static_cast<int32>(Params.Metric);
+    Header.Seed = Params.Seed;
+    Header.NumNodes = NumNodes;
+    Header.EntryPoint = EntryPoint;
+    Header.MaxLevel = MaxLevel;
+    Header.NumUpperLinks = UpperLinks.Num();
+
+    int64 Offset = Align(static_cast<int64>(sizeof(FFileHeader)), SectionAlignment);
+    for (int32 Index = 0; Index < NumSections; ++Index)
+    {
+        Header.SectionOffsets[Index] = Offset;
+        Offset = Align(Offset + SectionSizes[Index], SectionAlignment);
+    }
+
+    // the index is written next to the target and replaces it only when it's complete
+    const FString TempFilePath = FilePath + TEXT(".tmp");
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilePath));
+    if (!Writer)
+    {
+        UE_LOGFMT(LogHNSWIndex, Error, "Can't create file: {0}", TempFilePath);
+        return false;
+    }
+
+    uint8 Padding[SectionAlignment]{};
+    Writer->Serialize(&Header, sizeof(FFileHeader));
+    for (int32 Index = 0; Index < NumSections; ++Index)
+    {
+        Writer->Serialize(Padding, Header.SectionOffsets[Index] - Writer->Tell());
+        Writer->Serialize(const_cast<void*>(SectionData[Index]), SectionSizes[Index]);
+    }
+
+    const bool Written = Writer->Close() && !Writer->IsError();
+    Writer.Reset();
+    if (!Written || !AtomicFile::Replace(FilePath, TempFilePath))
+    {
+        UE_LOGFMT(LogHNSWIndex, Error, "Can't save index: {0}", FilePath);
+        IFileManager::Get().Delete(*TempFilePath);
+        return false;
+    }
+    return true;
+}
+
+bool FHNSWIndex::Load(const FString& FilePath)
+{
+    auto File = MakeUnique<FMappedFile>();
+    if (!File->Open(FilePath)) return false;
+
+    FFileHeader Header;
+    if (File->GetSize() < static_cast<int64>(sizeof(FFileHeader)))
+    {
+        UE_LOGFMT(LogHNSWIndex, Error, "Index file is too small: {0}", FilePath);
+        return false;
+    }
+    FMemory::Memcpy(&Header, File->GetData(), sizeof(FFileHeader));
+    if (Header.Magic != FileMagic || Header.Version != FileVersion || Header.Dimensions <= 0 || Header.NumNodes < 0 ||
+        Header.M < 2 || Header.M > MaxFileM || Header.Metric < 0 || Header.Metric > static_cast<int32>(EVectorMetric::L2) ||
+        Header.NumUpperLinks < 0)
+    {
+        UE_LOGFMT(LogHNSWIndex, Error, "Unsupported index file: {0}", FilePath);
+        return false;
+    }
+
+    // everything is validated before the index is changed, a corrupted file leaves the current graph as it is
+    const int32 FileStride = Align(Header.Dimensions, RowAlignment);
+    const int32 FileMaxLinks0 = Header.M * 2;
+    const auto SectionSizes = GetSectionSizes(Header.NumNodes, Header.NumUpperLinks, FileStride, FileMaxLinks0);
+    for (int32 Index = 0; Index < NumSections; ++Index)
+    {
+        const int64 SectionOffset = Header.SectionOffsets[Index];
+        if (SectionOffset < 0 || SectionOffset % SectionAlignment != 0 || SectionOffset + SectionSizes[Index] > File->GetSize())
+        {
+            UE_LOGFMT(LogHNSWIndex, Error, "Index file is corrupted: {0}", FilePath);
+            return false;
+        }
+    }
+    if (!IsValidGraph(Header, File->GetData(), FileMaxLinks0))
+    {
+        UE_LOGFMT(LogHNSWIndex, Error, "Graph of the index file is corrupted: {0}", FilePath);
+        return false;
+    }
+
+    FWriteScopeLock WriteLock(Lock);
+    Dimensions = Header.Dimensions;
+    Params.M = Header.M;
+    Params.EfConstruction = Header.EfConstruction;
+    Params.EfSearch = Header.EfSearch;
+    Params.Metric = static_cast<EVectorMetric>(Header.Metric);
+    Params.Seed = Header.Seed;
+    ApplyParams();
+
+    const uint8* Data = File->GetData();
+    const auto MapSection = [&](auto& Section, int32 Index, int64 Num)
+    {
+        using ElementType = typename TRemoveReference<decltype(Section.Owned)>::Type::ElementType;
+        Section.Owned.Empty();
+        Section.Mapped = reinterpret_cast<const ElementType*>(Data + Header.SectionOffsets[Index]);
+        Section.MappedNum = Num;
+    };
+    MapSection(Vectors, 0, static_cast<int64>(Header.NumNodes) * Stride);
+    MapSection(Ids, 1, Header.NumNodes);
+    MapSection(Levels, 2, Header.NumNodes);
+    MapSection(BaseLinks, 3, static_cast<int64>(Header.NumNodes) * (1 + MaxLinks0));
+    MapSection(UpperLinks, 4, Header.NumUpperLinks);
+    MapSection(UpperOffsets, 5, Header.NumNodes);
+
+    NumNodes = Header.NumNodes;
+    EntryPoint = Header.EntryPoint;
+    MaxLevel = Header.MaxLevel;
+    MappedFile = MoveTemp(File);
+
+    UE_LOGFMT(LogHNSWIndex, Display, "{0} vector(s) were loaded, mapped: {1}", NumNodes, MappedFile->IsMapped());
+    return true;
+}
@@ -0,0 +1,380 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/MetadataTable.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMetadataTable, All, All);
+
+using namespace OpenAI;
+
+FMetadataFilter FMetadataFilter::TagEquals(FName Column, const FString& Value)
+{
+    return TagIn(Column, {Value});
+}
+
+FMetadataFilter FMetadataFilter::TagIn(FName Column, const TArray<FString>& Values)
+{
+    FMetadataFilter Filter;
+    Filter.Ops.Add(FOp{EOpType::TagIn, Column, Values});
+    return Filter;
+}
+
+FMetadataFilter FMetadataFilter::IntRange(FName Column, int64 Min, int64 Max)
+{
+    FMetadataFilter Filter;
+    Filter.Ops.Add(FOp{EOpType::IntRange, Column, {}, Min, Max});
+    return Filter;
+}
+
+FMetadataFilter FMetadataFilter::IsTrue(FName Column)
+{
+    FMetadataFilter Filter;
+    Filter.Ops.Add(FOp{EOpType::IsTrue, Column});
+    return Filter;
+}
+
+FMetadataFilter FMetadataFilter::Exists(FName Column)
+{
+    FMetadataFilter Filter;
+    Filter.Ops.Add(FOp{EOpType::Exists, Column});
+    return Filter;
+}
+
+FMetadataFilter FMetadataFilter::Combine(FMetadataFilter A, const FMetadataFilter& B, EOpType Type)
+{
+    // an empty filter matches all rows
+    if (A.IsEmpty()) return Type == EOpType::And ? B : A;
+    if (B.IsEmpty()) return Type == EOpType::And ? A : B;
+
+    A.Ops.Append(B.Ops);
+    A.Ops.Add(FOp{Type});
+    return A;
+}
+
+namespace OpenAI
+{
+FMetadataFilter operator&&(FMetadataFilter A, const FMetadataFilter& B)
+{
+    return FMetadataFilter::Combine(MoveTemp(A), B, FMetadataFilter::EOpType::And);
+}
+
+FMetadataFilter operator||(FMetadataFilter A, const FMetadataFilter& B)
+{
+    return FMetadataFilter::Combine(MoveTemp(A), B, FMetadataFilter::EOpType::Or);
+}
+
+FMetadataFilter operator!(FMetadataFilter A)
+{
+    // the negation of all rows, a tag filter without values matches no rows
+    if (A.IsEmpty()) return FMetadataFilter::TagIn(NAME_None, {});
+
+    A.Ops.Add(FMetadataFilter::FOp{FMetadataFilter::EOpType::Not});
+    return A;
+}
+}  // namespace OpenAI
+
+FMetadataTable::FColumn* FMetadataTable::FindOrAddColumn(FName Column, EMetadataType Type)
+{
+    if (FColumn* Found = Columns.Find(Column))
+    {
+        if (Found->Type == Type) return Found;
+
+        UE_LOGFMT(LogMetadataTable, Error, "Metadata column {0} has another type", Column);
+        return nullptr;
+    }
+
+    FColumn& Added = Columns.Add(Column);
+    Added.Type = Type;
+    return &Added;
+}
+
+const FMetadataTable::FColumn* FMetadataTable::FindColumn(FName Column, EMetadataType Type) const
+{
+    const FColumn* Found = Columns.Find(Column);
+    return Found && Found->Type == Type ? Found : nullptr;
+}
+
+void FMetadataTable::ClearValue(FColumn& Column, int32 Row)
+{
+    if (!Column.Present.Contains(Row)) return;
+
+    Column.Present.Remove(Row);
+    if (Column.Type == EMetadataType::Tag)
+    {
+        Column.TagRows[Column.TagIndices[Row]].Remove(Row);
+        Column.TagIndices[Row] = INDEX_NONE;
+    }
+    else if (Column.Type == EMetadataType::Bool)
+    {
+        Column.TrueRows.Remove(Row);
+    }
+}
+
+bool FMetadataTable::SetTag(int32 Row, FName Column, const FString& Value)
+{
+    FColumn* Found = Row >= 0 ? FindOrAddColumn(Column, EMetadataType::Tag) : nullptr;
+    if (!Found) return false;
+
+    ClearValue(*Found, Row);
+
+    int32 ValueIndex;
+    if (const int32* ExistingIndex = Found->TagLookup.Find(Value))
+    {
+        ValueIndex = *ExistingIndex;
+    }
+    else
+    {
+        ValueIndex = Found->TagValues.Add(Value);
+        Found->TagLookup.Add(Value, ValueIndex);
+        Found->TagRows.AddDefaulted();
+    }
+
+    if (Found->TagIndices.Num() <= Row)
+    {
+        Found->TagIndices.Reserve(FMath::Max(Row + 1, Found->TagIndices.Num() * 2));
+        while (Found->TagIndices.Num() <= Row)
+        {
+            Found->TagIndices.Add(INDEX_NONE);
+        }
+    }
+    Found->TagIndices[Row] = ValueIndex;
+    Found->TagRows[ValueIndex].Add(Row);
+    Found->Present.Add(Row);
+    RowCount = FMath::Max(RowCount, Row + 1);
+    return true;
+}
+
+bool FMetadataTable::SetInt(int32 Row, FName Column, int64 Value)
+{
+    FColumn* Found = Row >= 0 ? FindOrAddColumn(Column, EMetadataType::Int) : nullptr;
+    if (!Found) return false;
+
+    if (Found->IntValues.Num() <= Row)
+    {
+        Found->IntValues.Reserve(FMath::Max(Row + 1, Found->IntValues.Num() * 2));
+        Found->IntValues.AddZeroed(Row + 1 - Found->IntValues.Num());
+    }
+    Found->IntValues[Row] = Value;
+    Found->Present.Add(Row);
+    RowCount = FMath::Max(RowCount, Row + 1);
+    return true;
+}
+
+bool FMetadataTable::SetBool(int32 Row, FName Column, bool Value)
+{
+    FColumn* Found = Row >= 0 ? FindOrAddColumn(Column, EMetadataType::Bool) : nullptr;
+    if (!Found) return false;
+
+    if (Value)
+    {
+        Found->TrueRows.Add(Row);
+    }
+    else
+    {
+        Found->TrueRows.Remove(Row);
+    }
+    Found->Present.Add(Row);
+    RowCount = FMath::Max(RowCount, Row + 1);
+    return true;
+}
+
+bool FMetadataTable::GetTag(int32 Row, FName Column, FString& Value) const
+{
+    const FColumn* Found = FindColumn(Column, EMetadataType::Tag);
+    if (!Found || Row < 0 || !Found->Present.Contains(Row)) return false;
+
+    Value = Found->TagValues[Found->TagIndices[Row]];
+    return true;
+}
+
+bool FMetadataTable::GetInt(int32 Row, FName Column, int64& Value) const
+{
+    const FColumn* Found = FindColumn(Column, EMetadataType::Int);
+    if (!Found || Row < 0 || !Found->Present.Contains(Row)) return false;
+
+    Value = Found->IntValues[Row];
+    return true;
+}
+
+bool FMetadataTable::GetBool(int32 Row, FName Column, bool& Value) const
+{
+    const FColumn* Found = FindColumn(Column, EMetadataType::Bool);
+    if (!Found || Row < 0 || !Found->Present.Contains(Row)) return false;
+
+    Value = Found->TrueRows.Contains(Row);
+    return true;
+}
+
+bool FMetadataTable::SetRow(int32 Row, const FMetadataRow& Values)
+{
+    RemoveRow(Row);
+
+    bool Success{true};
+    for (const auto& [Column, Value] : Values.Tags)
+    {
+        Success &= SetTag(Row, Column, Value);
+    }
+    for (const auto& [Column, Value] : Values.Ints)
+    {
+        Success &= SetInt(Row, Column, Value);
+    }
+    for (const auto& [Column, Value] : Values.Bools)
+    {
+        Success &= SetBool(Row, Column, Value);
+    }
+    return Success;
+}
+
+FMetadataRow FMetadataTable::GetRow(int32 Row) const
+{
+    FMetadataRow Values;
+    if (Row < 0) return Values;
+
+    for (const auto& [Name, Column] : Columns)
+    {
+        if (!Column.Present.Contains(Row)) continue;
+
+        switch (Column.Type)
+        {
+            case EMetadataType::Tag: Values.Tags.Add(Name, Column.TagValues[Column.TagIndices[Row]]); break;
+            case EMetadataType::Int: Values.Ints.Add(Name, Column.IntValues[Row]); break;
+            case EMetadataType::Bool: Values.Bools.Add(Name, Column.TrueRows.Contains(Row)); break;
+        }
+    }
+    return Values;
+}
+
+void FMetadataTable::RemoveRow(int32 Row)
+{
+    if (Row < 0) return;
+
+    for (auto& [Name, Column] : Columns)
+    {
+        ClearValue(Column, Row);
+    }
+}
+
+TOptional<EMetadataType> FMetadataTable::GetColumnType(FName Column) const
+{
+    const FColumn* Found = Columns.Find(Column);
+    return Found ? TOptional<EMetadataType>(Found->Type) : TOptional<EMetadataType>{};
+}
+
+void FMetadataTable::Reset()
+{
+    Columns.Reset();
+    RowCount = 0;
+}
+
+FRoaringBitmap FMetadataTable::Evaluate(const FMetadataFilter::FOp& Op) const
+{
+    using EOpType = FMetadataFilter::EOpType;
+
+    FRoaringBitmap Rows;
+    switch (Op.Type)
+    {
+        case EOpType::TagIn:
+            if (const FColumn* Column = FindColumn(Op.Column, EMetadataType::Tag))
+            {
+                for (const FString& Value : Op.Values)
+                {
+                    if (const int32* ValueIndex = Column->TagLookup.Find(Value))
+                    {
+                        Rows |= Column->TagRows[*ValueIndex];
+                    }
+                }
+            }
+            break;
+
+        case EOpType::IntRange:
+            if (const FColumn* Column = FindColumn(Op.Column, EMetadataType::Int))
+            {
+                Column->Present.ForEach(
+                    [&](uint32 Row)
+                    {
+                        const int64 Value = Column->IntValues[Row];
+                        if (Value >= Op.Min && Value <= Op.Max)
+                        {
+                            Rows.Add(Row);
+                        }
+                    });
+            }
+            break;
+
+        case EOpType::IsTrue:
+            if (const FColumn* Column = FindColumn(Op.Column, EMetadataType::Bool))
+            {
+                Rows = Column->TrueRows;
+            }
+            break;
+
+        case EOpType::Exists:
+            if (const FColumn* Column = Columns.Find(Op.Column))
+            {
+                Rows = Column->Present;
+            }
+            break;
+
+        default: checkNoEntry();
+    }
+
+    if (!Columns.Contains(Op.Column))
+    {
+        UE_LOGFMT(LogMetadataTable, Verbose, "Filter uses unknown metadata column {0}", Op.Column);
+    }
+    return Rows;
+}
+
+FRoaringBitmap FMetadataTable::Compile(const FMetadataFilter& Filter, int32 NumAllRows) const
+{
+    using EOpType = FMetadataFilter::EOpType;
+
+    const uint32 AllRowsEnd = static_cast<uint32>(FMath::Max(RowCount, NumAllRows));
+    if (Filter.IsEmpty()) return FRoaringBitmap::MakeRange(0, AllRowsEnd);
+
+    TArray<FRoaringBitmap, TInlineAllocator<8>> Stack;
+    for (const FMetadataFilter::FOp& Op : Filter.Ops)
+    {
+        if (Op.Type == EOpType::And || Op.Type == EOpType::Or)
+        {
+            const FRoaringBitmap Right = Stack.Pop();
+            if (Op.Type == EOpType::And)
+            {
+                Stack.Last() &= Right;
+            }
+            else
+            {
+                Stack.Last() |= Right;
+            }
+        }
+        else if (Op.Type == EOpType::Not)
+        {
+            FRoaringBitmap All = FRoaringBitmap::MakeRange(0, AllRowsEnd);
+            All.AndNot(Stack.Last());
+            Stack.Last() = MoveTemp(All);
+        }
+        else
+        {
+            Stack.Add(Evaluate(Op));
+        }
+    }
+
+    check(Stack.Num() == 1);
+    return MoveTemp(Stack[0]);
+}
+
+SIZE_T FMetadataTable::GetAllocatedSize() const
+{
+    SIZE_T Size = Columns.GetAllocatedSize();
+    for (const auto& [Name, Column] : Columns)
+    {
+        Size += Column.Present.GetAllocatedSize() + Column.TagIndices.GetAllocatedSize() + Column.TagValues.GetAllocatedSize() +
+                Column.TagLookup.GetAllocatedSize() + Column.TagRows.GetAllocatedSize() + Column.IntValues.GetAllocatedSize() +
+                Column.TrueRows.GetAllocatedSize();
+        for (const FRoaringBitmap& TagRows : Column.TagRows)
+        {
+            Size += TagRows.GetAllocatedSize();
+        }
+    }
+    return Size;
+}
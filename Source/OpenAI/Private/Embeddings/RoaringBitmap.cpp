@@ -0,0 +1,496 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/RoaringBitmap.h"
+#include "Algo/BinarySearch.h"
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr uint32 ChunkSize = 65536;
+
+uint16 HighBits(uint32 Value)
+{
+    return static_cast<uint16>(Value >> 16);
+}
+
+uint16 LowBits(uint32 Value)
+{
+    return static_cast<uint16>(Value & 0xFFFF);
+}
+
+void SetBit(uint64* Bits, uint16 Low)
+{
+    Bits[Low >> 6] |= 1ull << (Low & 63);
+}
+
+bool TestBit(const uint64* Bits, uint16 Low)
+{
+    return (Bits[Low >> 6] & (1ull << (Low & 63))) != 0;
+}
+
+/**
+  Sets the bits in [First, Last) of one chunk.
+*/
+void SetBitRange(uint64* Bits, uint32 First, uint32 Last)
+{
+    while (First < Last)
+    {
+        const uint32 Offset = First & 63;
+        const uint32 Count = FMath::Min(64 - Offset, Last - First);
+        const uint64 Mask = Count == 64 ? ~0ull : ((1ull << Count) - 1) << Offset;
+        Bits[First >> 6] |= Mask;
+        First += Count;
+    }
+}
+
+int32 CountBits(const uint64* Bits, int32 NumWords)
+{
+    int32 Count{0};
+    for (int32 Word = 0; Word < NumWords; ++Word)
+    {
+        Count += static_cast<int32>(FPlatformMath::CountBits(Bits[Word]));
+    }
+    return Count;
+}
+}  // namespace
+
+bool FRoaringBitmap::FContainer::Contains(uint16 Low) const
+{
+    return IsBitmap() ? TestBit(Bits.GetData(), Low) : Algo::BinarySearch(Values, Low) != INDEX_NONE;
+}
+
+void FRoaringBitmap::FContainer::ToBitmap()
+{
+    if (IsBitmap()) return;
+
+    Bits.SetNumZeroed(BitmapWords);
+    for (const uint16 Low : Values)
+    {
+        SetBit(Bits.GetData(), Low);
+    }
+    Values.Empty();
+}
+
+void FRoaringBitmap::FContainer::Normalize()
+{
+    if (IsBitmap() && Cardinality <= MaxArrayValues)
+    {
+        Values.Reset(Cardinality);
+        for (int32 Word = 0; Word < BitmapWords; ++Word)
+        {
+            for (uint64 Word64 = Bits[Word]; Word64 != 0; Word64 &= Word64 - 1)
+            {
+                Values.Add(static_cast<uint16>(Word * 64 + FMath::CountTrailingZeros64(Word64)));
+            }
+        }
+        Bits.Empty();
+    }
+    else if (!IsBitmap() && Cardinality > MaxArrayValues)
+    {
+        ToBitmap();
+    }
+}
+
+FRoaringBitmap FRoaringBitmap::MakeRange(uint32 First, uint32 Last)
+{
+    FRoaringBitmap Bitmap;
+    Bitmap.AddRange(First, Last);
+    return Bitmap;
+}
+
+int32 FRoaringBitmap::FindContainer(uint16 Key) const
+{
+    const int32 Index = Algo::LowerBoundBy(Containers, Key, &FContainer::Key);
+    return Index < Containers.Num() && Containers[Index].Key == Key ? Index : INDEX_NONE;
+}
+
+FRoaringBitmap::FContainer& FRoaringBitmap::FindOrAddContainer(uint16 Key)
+{
+    // keys usually come in the ascending order
+    if (Containers.IsEmpty() || Containers.Last().Key < Key)
+    {
+        FContainer& Container = Containers.AddDefaulted_GetRef();
+        Container.Key = Key;
+        return Container;
+    }
+
+    const int32 Index = Algo::LowerBoundBy(Containers, Key, &FContainer::Key);
+    if (Containers[Index].Key != Key)
+    {
+        Containers.InsertDefaulted(Index);
+        Containers[Index].Key = Key;
+    }
+    return Containers[Index];
+}
+
+void FRoaringBitmap::Add(uint32 Value)
+{
+    FContainer& Container = FindOrAddContainer(HighBits(Value));
+    const uint16 Low = LowBits(Value);
+    if (Container.IsBitmap())
+    {
+        if (!TestBit(Container.Bits.GetData(), Low))
+        {
+            SetBit(Container.Bits.GetData(), Low);
+            ++Container.Cardinality;
+        }
+        return;
+    }
+
+    if (Container.Values.IsEmpty() || Container.Values.Last() < Low)
+    {
+        Container.Values.Add(Low);
+    }
+    else
+    {
+        const int32 Index = Algo::LowerBound(Container.Values, Low);
+        if (Container.Values[Index] == Low) return;
+        Container.Values.Insert(Low, Index);
+    }
+    ++Container.Cardinality;
+    Container.Normalize();
+}
+
+void FRoaringBitmap::AddRange(uint32 First, uint32 Last)
+{
+    while (First < Last)
+    {
+        const uint32 ChunkEnd = static_cast<uint32>(FMath::Min<uint64>((static_cast<uint64>(First) | (ChunkSize - 1)) + 1, Last));
+        FContainer& Container = FindOrAddContainer(HighBits(First));
+        const uint32 NumValues = ChunkEnd - First;
+        if (!Container.IsBitmap() && Container.Cardinality + NumValues <= MaxArrayValues)
+        {
+            for (uint32 Value = First; Value < ChunkEnd; ++Value)
+            {
+                Add(Value);
+            }
+        }
+        else
+        {
+            Container.ToBitmap();
+            SetBitRange(Container.Bits.GetData(), LowBits(First), LowBits(First) + NumValues);
+            Container.Cardinality = CountBits(Container.Bits.GetData(), BitmapWords);
+            Container.Normalize();
+        }
+        First = ChunkEnd;
+    }
+}
+
+void FRoaringBitmap::Remove(uint32 Value)
+{
+    const int32 Index = FindContainer(HighBits(Value));
+    if (Index == INDEX_NONE) return;
+
+    FContainer& Container = Containers[Index];
+    const uint16 Low = LowBits(Value);
+    if (Container.IsBitmap())
+    {
+        if (!TestBit(Container.Bits.GetData(), Low)) return;
+        Container.Bits[Low >> 6] &= ~(1ull << (Low & 63));
+    }
+    else
+    {
+        const int32 ValueIndex = Algo::BinarySearch(Container.Values, Low);
+        if (ValueIndex == INDEX_NONE) return;
+        Container.Values.RemoveAt(ValueIndex);
+    }
+
+    if (--Container.Cardinality == 0)
+    {
+        Containers.RemoveAt(Index);
+        return;
+    }
+    Container.Normalize();
+}
+
+bool FRoaringBitmap::Contains(uint32 Value) const
+{
+    const int32 Index = FindContainer(HighBits(Value));
+    return Index != INDEX_NONE && Containers[Index].Contains(LowBits(Value));
+}
+
+int64 FRoaringBitmap::Num() const
+{
+    int64 Count{0};
+    for (const FContainer& Container : Containers)
+    {
+        Count += Container.Cardinality;
+    }
+    return Count;
+}
+
+void FRoaringBitmap::CopyBits(const FContainer& Container, uint64* Bits)
+{
+    if (Container.IsBitmap())
+    {
+        FMemory::Memcpy(Bits, Container.Bits.GetData(), BitmapWords * sizeof(uint64));
+        return;
+    }
+
+    FMemory::Memzero(Bits, BitmapWords * sizeof(uint64));
+    for (const uint16 Low : Container.Values)
+    {
+        SetBit(Bits, Low);
+    }
+}
+
+FRoaringBitmap::FContainer FRoaringBitmap::Intersect(const FContainer& A, const FContainer& B)
+{
+    FContainer Result;
+    Result.Key = A.Key;
+
+    if (A.IsBitmap() && B.IsBitmap())
+    {
+        Result.Bits.SetNumUninitialized(BitmapWords);
+        for (int32 Word = 0; Word < BitmapWords; ++Word)
+        {
+            Result.Bits[Word] = A.Bits[Word] & B.Bits[Word];
+        }
+        Result.Cardinality = CountBits(Result.Bits.GetData(), BitmapWords);
+        Result.Normalize();
+        return Result;
+    }
+
+    if (A.IsBitmap() || B.IsBitmap())
+    {
+        const FContainer& Array = A.IsBitmap() ? B : A;
+        const FContainer& Bitmap = A.IsBitmap() ? A : B;
+        for (const uint16 Low : Array.Values)
+        {
+            if (TestBit(Bitmap.Bits.GetData(), Low))
+            {
+                Result.Values.Add(Low);
+            }
+        }
+        Result.Cardinality = Result.Values.Num();
+        return Result;
+    }
+
+    int32 IndexA{0}, IndexB{0};
+    while (IndexA < A.Values.Num() && IndexB < B.Values.Num())
+    {
+        if (A.Values[IndexA] < B.Values[IndexB])
+        {
+            ++IndexA;
+        }
+        else if (B.Values[IndexB] < A.Values[IndexA])
+        {
+            ++IndexB;
+        }
+        else
+        {
+            Result.Values.Add(A.Values[IndexA]);
+            ++IndexA;
+            ++IndexB;
+        }
+    }
+    Result.Cardinality = Result.Values.Num();
+    return Result;
+}
+
+FRoaringBitmap::FContainer FRoaringBitmap::Unite(const FContainer& A, const FContainer& B)
+{
+    FContainer Result;
+    Result.Key = A.Key;
+
+    if (!A.IsBitmap() && !B.IsBitmap() && A.Cardinality + B.Cardinality <= MaxArrayValues)
+    {
+        Result.Values.Reserve(A.Cardinality + B.Cardinality);
+        int32 IndexA{0}, IndexB{0};
+        while (IndexA < A.Values.Num() || IndexB < B.Values.Num())
+        {
+            if (IndexB == B.Values.Num() || (IndexA < A.Values.Num() && A.Values[IndexA] < B.Values[IndexB]))
+            {
+                Result.Values.Add(A.Values[IndexA++]);
+            }
+            else if (IndexA == A.Values.Num() || B.Values[IndexB] < A.Values[IndexA])
+            {
+                Result.Values.Add(B.Values[IndexB++]);
+            }
+            else
+            {
+                Result.Values.Add(A.Values[IndexA]);
+                ++IndexA;
+                ++IndexB;
+            }
+        }
+        Result.Cardinality = Result.Values.Num();
+        return Result;
+    }
+
+    Result.Bits.SetNumUninitialized(BitmapWords);
+    CopyBits(A, Result.Bits.GetData());
+    if (B.IsBitmap())
+    {
+        for (int32 Word = 0; Word < BitmapWords; ++Word)
+        {
+            Result.Bits[Word] |= B.Bits[Word];
+        }
+    }
+    else
+    {
+        for (const uint16 Low : B.Values)
+        {
+            SetBit(Result.Bits.GetData(), Low);
+        }
+    }
+    Result.Cardinality = CountBits(Result.Bits.GetData(), BitmapWords);
+    Result.Normalize();
+    return Result;
+}
+
+FRoaringBitmap::FContainer FRoaringBitmap::Subtract(const FContainer& A, const FContainer& B)
+{
+    FContainer Result;
+    Result.Key = A.Key;
+
+    if (!A.IsBitmap())
+    {
+        for (const uint16 Low : A.Values)
+        {
+            if (!B.Contains(Low))
+            {
+                Result.Values.Add(Low);
+            }
+        }
+        Result.Cardinality = Result.Values.Num();
+        return Result;
+    }
+
+    Result.Bits = A.Bits;
+    if (B.IsBitmap())
+    {
+        for (int32 Word = 0; Word < BitmapWords; ++Word)
+        {
+            Result.Bits[Word] &= ~B.Bits[Word];
+        }
+    }
+    else
+    {
+        for (const uint16 Low : B.Values)
+        {
+            Result.Bits[Low >> 6] &= ~(1ull << (Low & 63));
+        }
+    }
+    Result.Cardinality = CountBits(Result.Bits.GetData(), BitmapWords);
+    Result.Normalize();
+    return Result;
+}
+
+FRoaringBitmap& FRoaringBitmap::operator&=(const FRoaringBitmap& Other)
+{
+    TArray<FContainer> Result;
+    int32 IndexA{0}, IndexB{0};
+    while (IndexA < Containers.Num() && IndexB < Other.Containers.Num())
+    {
+        const FContainer& A = Containers[IndexA];
+        const FContainer& B = Other.Containers[IndexB];
+        if (A.Key < B.Key)
+        {
+            ++IndexA;
+        }
+        else if (B.Key < A.Key)
+        {
+            ++IndexB;
+        }
+        else
+        {
+            FContainer Container = Intersect(A, B);
+            if (Container.Cardinality > 0)
+            {
+                Result.Add(MoveTemp(Container));
+            }
+            ++IndexA;
+            ++IndexB;
+        }
+    }
+    Containers = MoveTemp(Result);
+    return *this;
+}
+
+FRoaringBitmap& FRoaringBitmap::operator|=(const FRoaringBitmap& Other)
+{
+    TArray<FContainer> Result;
+    Result.Reserve(Containers.Num() + Other.Containers.Num());
+    int32 IndexA{0}, IndexB{0};
+    while (IndexA < Containers.Num() || IndexB < Other.Containers.Num())
+    {
+        if (IndexB == Other.Containers.Num() || (IndexA < Containers.Num() && Containers[IndexA].Key < Other.Containers[IndexB].Key))
+        {
+            Result.Add(MoveTemp(Containers[IndexA++]));
+        }
+        else if (IndexA == Containers.Num() || Other.Containers[IndexB].Key < Containers[IndexA].Key)
+        {
+            Result.Add(Other.Containers[IndexB++]);
+        }
+        else
+        {
+            Result.Add(Unite(Containers[IndexA], Other.Containers[IndexB]));
+            ++IndexA;
+            ++IndexB;
+        }
+    }
+    Containers = MoveTemp(Result);
+    return *this;
+}
+
+FRoaringBitmap& FRoaringBitmap::AndNot(const FRoaringBitmap& Other)
+{
+    TArray<FContainer> Result;
+    Result.Reserve(Containers.Num());
+    int32 IndexB{0};
+    for (FContainer& A : Containers)
+    {
+        while (IndexB < Other.Containers.Num() && Other.Containers[IndexB].Key < A.Key)
+        {
+            ++IndexB;
+        }
+
+        if (IndexB == Other.Containers.Num() || Other.Containers[IndexB].Key != A.Key)
+        {
+            Result.Add(MoveTemp(A));
+            continue;
+        }
+
+        FContainer Container = Subtract(A, Other.Containers[IndexB]);
+        if (Container.Cardinality > 0)
+        {
+            Result.Add(MoveTemp(Container));
+        }
+    }
+    Containers = MoveTemp(Result);
+    return *this;
+}
+
+bool FRoaringBitmap::operator==(const FRoaringBitmap& Other) const
+{
+    if (Containers.Num() != Other.Containers.Num()) return false;
+
+    // containers are normalized, so equal sets have equal layouts
+    for (int32 Index = 0; Index < Containers.Num(); ++Index)
+    {
+        const FContainer& A = Containers[Index];
+        const FContainer& B = Other.Containers[Index];
+        if (A.Key != B.Key || A.Cardinality != B.Cardinality || A.Values != B.Values || A.Bits != B.Bits) return false;
+    }
+    return true;
+}
+
+TArray<uint32> FRoaringBitmap::ToArray() const
+{
+    TArray<uint32> Values;
+    Values.Reserve(Num());
+    ForEach([&Values](uint32 Value) { Values.Add(Value); });
+    return Values;
+}
+
+SIZE_T FRoaringBitmap::GetAllocatedSize() const
+{
+    SIZE_T Size = Containers.GetAllocatedSize();
+    for (const FContainer& Container : Containers)
+    {
+        Size += Container.Values.GetAllocatedSize() + Container.Bits.GetAllocatedSize();
+    }
+    return Size;
+}
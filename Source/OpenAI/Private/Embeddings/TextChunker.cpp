@@ -0,0 +1,341 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/TextChunker.h"
+#include "Tokenizer/BPETokenizer.h"
+#include "Async/ParallelFor.h"
+
+using namespace OpenAI;
+
+namespace
+{
+/**
+  Characters of a big document that are chunked by one task.
+*/
+constexpr int32 BlockSize = 1024 * 1024;
+
+/**
+  One of 8 units closes the chunk once it's half full.
+*/
+constexpr uint64 ResyncMask = 7;
+
+struct FUnit
+{
+    int32 Begin{};
+    int32 End{};
+    int32 Tokens{};
+    bool bSectionStart{false};
+};
+
+struct FTask
+{
+    int32 Document{};
+    int32 Begin{};
+    int32 End{};
+};
+
+enum class ESplitLevel : uint8
+{
+    Lines,
+    Sentences,
+    Words,
+    Characters
+};
+
+bool IsSentenceEnd(const FString& Text, int32 Index, int32 End)
+{
+    const TCHAR Char = Text[Index];
+    return (Char == '.' || Char == '!' || Char == '?') && Index + 1 < End && FChar::IsWhitespace(Text[Index + 1]);
+}
+
+/**
+  Breaks a range of the document into units that fit the target.
+*/
+class FUnitSplitter
+{
+public:
+    FUnitSplitter(const FString& InText, const FTextChunkerOptions& InOptions, TArray<FUnit>& InUnits)
+        : Text(InText), Options(InOptions), Units(InUnits)
+    {
+    }
+
+    void SplitParagraphs(int32 Begin, int32 End, bool bMarkdown)
+    {
+        bool bSectionStart = true;
+        bool bInFence = false;
+        int32 ParagraphBegin = Begin;
+
+        for (int32 LineBegin = Begin; LineBegin < End;)
+        {
+            int32 LineEnd = LineBegin;
+            while (LineEnd < End && Text[LineEnd] != '\n')
+            {
+                ++LineEnd;
+            }
+            const FStringView Line = FStringView(Text).Mid(LineBegin, LineEnd - LineBegin).TrimStart();
+
+            if (bMarkdown && (Line.StartsWith(TEXT("```")) || Line.StartsWith(TEXT("~~~"))))
+            {
+                bInFence = !bInFence;
+            }
+            else if (bMarkdown && !bInFence && Line.StartsWith('#'))
+            {
+                // the heading stays with its content
+                AddRange(ParagraphBegin, LineBegin, bSectionStart);
+                ParagraphBegin = LineBegin;
+                bSectionStart = true;
+            }
+            else if (!bInFence && Line.TrimEnd().IsEmpty())
+            {
+                bSectionStart = !AddRange(ParagraphBegin, LineBegin, bSectionStart) && bSectionStart;
+                ParagraphBegin = LineEnd;
+            }
+            LineBegin = LineEnd + 1;
+        }
+        AddRange(ParagraphBegin, End, bSectionStart);
+    }
+
+    void SplitJson(int32 Begin, int32 End)
+    {
+        int32 Depth = 0;
+        bool bInString = false;
+        bool bEscaped = false;
+        bool bSectionStart = true;
+        int32 ElementBegin = Begin;
+
+        for (int32 Index = Begin; Index < End; ++Index)
+        {
+            const TCHAR Char = Text[Index];
+            if (bInString)
+            {
+                bInString = bEscaped || Char != '"';
+                bEscaped = !bEscaped && Char == '\\';
+                continue;
+            }
+
+            if (Char == '"')
+            {
+                bInString = true;
+            }
+            else if (Char == '{' || Char == '[')
+            {
+                ++Depth;
+            }
+            else if (Char == '}' || Char == ']')
+            {
+                --Depth;
+            }
+            else if (Char == ',' && Depth == 1)
+            {
+                bSectionStart = !AddRange(ElementBegin, Index + 1, bSectionStart) && bSectionStart;
+                ElementBegin = Index + 1;
+            }
+        }
+        AddRange(ElementBegin, End, bSectionStart);
+    }
+
+private:
+    const FString& Text;
+    const FTextChunkerOptions& Options;
+    TArray<FUnit>& Units;
+
+    /**
+      Returns false if the range is blank.
+    */
+    bool AddRange(int32 Begin, int32 End, bool bSectionStart, ESplitLevel Level = ESplitLevel::Lines)
+    {
+        while (Begin < End && FChar::IsWhitespace(Text[Begin]))
+        {
+            ++Begin;
+        }
+        while (End > Begin && FChar::IsWhitespace(Text[End - 1]))
+        {
+            --End;
+        }
+        if (Begin == End) return false;
+
+        const int32 Tokens = Options.TokenCounter(FStringView(Text).Mid(Begin, End - Begin));
+        if (Tokens <= Options.TargetTokens || (Level == ESplitLevel::Characters && End - Begin == 1))
+        {
+            Units.Add(FUnit{Begin, End, Tokens, bSectionStart});
+            return true;
+        }
+
+        if (Level == ESplitLevel::Characters)
+        {
+            const int32 PieceLength = FMath::Max(1, static_cast<int32>(static_cast<int64>(End - Begin) * Options.TargetTokens / Tokens));
+            for (int32 PieceBegin = Begin; PieceBegin < End; PieceBegin += PieceLength)
+            {
+                AddRange(PieceBegin, FMath::Min(End, PieceBegin + PieceLength), bSectionStart, Level);
+                bSectionStart = false;
+            }
+            return true;
+        }
+
+        const ESplitLevel NextLevel = static_cast<ESplitLevel>(static_cast<uint8>(Level) + 1);
+        int32 PieceBegin = Begin;
+        for (int32 Index = Begin; Index < End; ++Index)
+        {
+            const bool bPieceEnd = Level == ESplitLevel::Lines       ? Text[Index] == '\n'
+                                   : Level == ESplitLevel::Sentences ? IsSentenceEnd(Text, Index, End)
+                                                                     : FChar::IsWhitespace(Text[Index]);
+            if (!bPieceEnd) continue;
+
+            if (AddRange(PieceBegin, Index + 1, bSectionStart, NextLevel))
+            {
+                bSectionStart = false;
+            }
+            PieceBegin = Index + 1;
+        }
+        AddRange(PieceBegin, End, bSectionStart, NextLevel);
+        return true;
+    }
+};
+
+FXxHash128 MakeChunkId(const FTextDocument& Document, FStringView Text)
+{
+    const uint8 Separator = 0;
+    FXxHash128Builder Builder;
+    Builder.Update(*Document.Name, Document.Name.Len() * sizeof(TCHAR));
+    Builder.Update(&Separator, sizeof(Separator));
+    Builder.Update(Text.GetData(), Text.Len() * sizeof(TCHAR));
+    return Builder.Finalize();
+}
+
+void PackUnits(const FTextDocument& Document, int32 DocumentIndex, TArrayView<const FUnit> Units, const FTextChunkerOptions& Options,
+    TArray<FTextChunk>& Chunks)
+{
+    const auto Emit = [&](int32 First, int32 Last, int32 Tokens)
+    {
+        FTextChunk& Chunk = Chunks.AddDefaulted_GetRef();
+        Chunk.Document = DocumentIndex;
+        Chunk.Offset = Units[First].Begin;
+        Chunk.Length = Units[Last - 1].End - Chunk.Offset;
+        Chunk.Tokens = Tokens;
+        Chunk.Id = MakeChunkId(Document, FStringView(Document.Text).Mid(Chunk.Offset, Chunk.Length));
+    };
+
+    int32 First = 0;
+    int32 Tokens = 0;
+    bool bCut = false;
+    for (int32 Index = 0; Index < Units.Num(); ++Index)
+    {
+        const FUnit& Unit = Units[Index];
+        if (Index > First && (Unit.bSectionStart || bCut || Tokens + Unit.Tokens > Options.TargetTokens))
+        {
+            Emit(First, Index, Tokens);
+
+            // the overlap never takes the whole previous chunk, so every chunk moves forward
+            int32 NextFirst = Index;
+            int32 OverlapTokens = 0;
+            while (!Unit.bSectionStart && NextFirst - 1 > First && OverlapTokens + Units[NextFirst - 1].Tokens <= Options.OverlapTokens &&
+                   OverlapTokens + Units[NextFirst - 1].Tokens + Unit.Tokens <= Options.TargetTokens)
+            {
+                --NextFirst;
+                OverlapTokens += Units[NextFirst].Tokens;
+            }
+            First = NextFirst;
+            Tokens = OverlapTokens;
+        }
+
+        Tokens += Unit.Tokens;
+        bCut = Tokens * 2 >= Options.TargetTokens &&
+               (FXxHash64::HashBuffer(&Document.Text[Unit.Begin], (Unit.End - Unit.Begin) * sizeof(TCHAR)).Hash & ResyncMask) == 0;
+    }
+
+    if (First < Units.Num())
+    {
+        Emit(First, Units.Num(), Tokens);
+    }
+}
+
+void AddTasks(const FTextDocument& Document, int32 DocumentIndex, ETextFormat Format, TArray<FTask>& Tasks)
+{
+    const int32 Length = Document.Text.Len();
+    int32 Begin = 0;
+
+    // JSON is split by its structure, a block would start in the middle of an element
+    while (Format != ETextFormat::Json && Length - Begin > BlockSize)
+    {
+        int32 BlockEnd = Document.Text.Find(TEXT("\n\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Begin + BlockSize);
+        if (BlockEnd == INDEX_NONE)
+        {
+            BlockEnd = Document.Text.Find(TEXT("\n"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Begin + BlockSize);
+        }
+        if (BlockEnd == INDEX_NONE) break;
+
+        Tasks.Add(FTask{DocumentIndex, Begin, BlockEnd});
+        Begin = BlockEnd;
+    }
+    Tasks.Add(FTask{DocumentIndex, Begin, Length});
+}
+}  // namespace
+
+FTextChunker::FTextChunker(const FTextChunkerOptions& InOptions) : Options(InOptions)
+{
+    Options.TargetTokens = FMath::Max(1, Options.TargetTokens);
+    Options.OverlapTokens = FMath::Clamp(Options.OverlapTokens, 0, Options.TargetTokens / 2);
+    if (!Options.TokenCounter)
+    {
+        Options.TokenCounter = FBPETokenizer::MakeTokenCounter(EBPEEncoding::Cl100kBase);
+    }
+}
+
+TArray<FTextChunk> FTextChunker::Chunk(TArrayView<const FTextDocument> Documents) const
+{
+    TArray<FTask> Tasks;
+    for (int32 DocumentIndex = 0; DocumentIndex < Documents.Num(); ++DocumentIndex)
+    {
+        AddTasks(Documents[DocumentIndex], DocumentIndex, Options.Format, Tasks);
+    }
+
+    TArray<TArray<FTextChunk>> TaskChunks;
+    TaskChunks.SetNum(Tasks.Num());
+    ParallelFor(Tasks.Num(),
+        [&](int32 TaskIndex)
+        {
+            const FTask& Task = Tasks[TaskIndex];
+            const FTextDocument& Document = Documents[Task.Document];
+
+            TArray<FUnit> Units;
+            FUnitSplitter Splitter(Document.Text, Options, Units);
+            const FStringView Text = FStringView(Document.Text).Mid(Task.Begin, Task.End - Task.Begin).TrimStart();
+            if (Options.Format == ETextFormat::Json && (Text.StartsWith('{') || Text.StartsWith('[')))
+            {
+                Splitter.SplitJson(Task.Begin, Task.End);
+            }
+            else
+            {
+                Splitter.SplitParagraphs(Task.Begin, Task.End, Options.Format == ETextFormat::Markdown);
+            }
+            PackUnits(Document, Task.Document, Units, Options, TaskChunks[TaskIndex]);
+        });
+
+    TArray<FTextChunk> Chunks;
+    int32 NumChunks = 0;
+    for (const TArray<FTextChunk>& Chunk : TaskChunks)
+    {
+        NumChunks += Chunk.Num();
+    }
+    Chunks.Reserve(NumChunks);
+    for (const TArray<FTextChunk>& Chunk : TaskChunks)
+    {
+        Chunks.Append(Chunk);
+    }
+    return Chunks;
+}
+
+FStringView FTextChunker::GetText(TArrayView<const FTextDocument> Documents, const FTextChunk& Chunk)
+{
+    return FStringView(Documents[Chunk.Document].Text).Mid(Chunk.Offset, Chunk.Length);
+}
+
+TArray<FString> FTextChunker::MakeInput(TArrayView<const FTextDocument> Documents, TArrayView<const FTextChunk> Chunks)
+{
+    TArray<FString> Input;
+    Input.Reserve(Chunks.Num());
+    for (const FTextChunk& Chunk : Chunks)
+    {
+        Input.Emplace(GetText(Documents, Chunk));
+    }
+    return Input;
+}
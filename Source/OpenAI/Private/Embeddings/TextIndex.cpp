@@ -0,0 +1,216 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/TextIndex.h"
+#include "IO/MappedFile.h"
+#include "IO/AtomicFile.h"
+#include "HAL/FileManager.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTextIndex, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr uint32 FileMagic = 0x49545845;  // EXTI
+constexpr uint32 FileVersion = 1;
+constexpr int64 SectionAlignment = 64;
+
+struct FFileHeader
+{
+    uint32 Magic;
+    uint32 Version;
+    int32 NumEntries;
+    int32 ModelSize;
+    int64 EntriesOffset;
+    int64 StringsOffset;
+    int64 StringsSize;
+};
+
+FString GetGraphPath(const FString& BasePath)
+{
+    return BasePath + TEXT(".hnsw");
+}
+
+FString GetChunksPath(const FString& BasePath)
+{
+    return BasePath + TEXT(".chunks");
+}
+}  // namespace
+
+/**
+  Source follows the text in the strings section, both are UTF-8.
+*/
+struct FTextIndex::FEntry
+{
+    uint64 HashLow;
+    uint64 HashHigh;
+    int64 TextOffset;
+    int32 TextSize;
+    int32 SourceSize;
+};
+
+FTextIndex::FTextIndex() : Index(MakeUnique<FHNSWIndex>(1)) {}
+
+FTextIndex::~FTextIndex() = default;
+
+FXxHash128 FTextIndex::HashText(FStringView Text)
+{
+    const FTCHARToUTF8 Utf8Text(Text.GetData(), Text.Len());
+    return FXxHash128::HashBuffer(Utf8Text.Get(), Utf8Text.Length());
+}
+
+bool FTextIndex::Save(const FString& BasePath, const FString& Model, TArrayView<const FTextIndexEntry> InEntries, const FHNSWIndex& InIndex)
+{
+    if (InIndex.Num() != InEntries.Num())
+    {
+        UE_LOGFMT(LogTextIndex, Error, "Number of vectors {0} doesn't match number of texts {1}", InIndex.Num(), InEntries.Num());
+        return false;
+    }
+
+    TArray<FEntry> Entries;
+    Entries.Reserve(InEntries.Num());
+    TArray<uint8> Strings;
+    const auto AddString = [&Strings](const FString& String)
+    {
+        const FTCHARToUTF8 Utf8String(*String, String.Len());
+        Strings.Append(reinterpret_cast<const uint8*>(Utf8String.Get()), Utf8String.Length());
+        return Utf8String.Length();
+    };
+
+    const int32 ModelSize = AddString(Model);
+    for (const FTextIndexEntry& InEntry : InEntries)
+    {
+        const FXxHash128 Hash = HashText(InEntry.Text);
+        FEntry& Entry = Entries.AddDefaulted_GetRef();
+        Entry.HashLow = Hash.HashLow;
+        Entry.HashHigh = Hash.HashHigh;
+        Entry.TextOffset = Strings.Num();
+        Entry.TextSize = AddString(InEntry.Text);
+        Entry.SourceSize = AddString(InEntry.Source);
+    }
+
+    FFileHeader Header{};
+    Header.Magic = FileMagic;
+    Header.Version = FileVersion;
+    Header.NumEntries = Entries.Num();
+    Header.ModelSize = ModelSize;
+    Header.EntriesOffset = Align(static_cast<int64>(sizeof(FFileHeader)), SectionAlignment);
+    Header.StringsOffset = Align(Header.EntriesOffset + Entries.Num() * static_cast<int64>(sizeof(FEntry)), SectionAlignment);
+    Header.StringsSize = Strings.Num();
+
+    // both files are written next to the targets and replace them only when both are complete,
+    // a crash between the two renames is caught by the entry count check of Load
+    const FString FilePath = GetChunksPath(BasePath);
+    const FString TempFilePath = FilePath + TEXT(".tmp");
+    const FString GraphPath = GetGraphPath(BasePath);
+    const FString TempGraphPath = GraphPath + TEXT(".tmp");
+    const auto DeleteTempFiles = [&]()
+    {
+        IFileManager::Get().Delete(*TempFilePath);
+        IFileManager::Get().Delete(*TempGraphPath);
+    };
+
+    if (!InIndex.Save(TempGraphPath))
+    {
+        DeleteTempFiles();
+        return false;
+    }
+
+    TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilePath));
+    if (!Writer)
+    {
+        UE_LOGFMT(LogTextIndex, Error, "Can't create file: {0}", TempFilePath);
+        DeleteTempFiles();
+        return false;
+    }
+
+    uint8 Padding[SectionAlignment]{};
+    Writer->Serialize(&Header, sizeof(FFileHeader));
+    Writer->Serialize(Padding, Header.EntriesOffset - Writer->Tell());
+    Writer->Serialize(Entries.GetData(), Entries.Num() * sizeof(FEntry));
+    Writer->Serialize(Padding, Header.StringsOffset - Writer->Tell());
+    Writer->Serialize(Strings.GetData(), Strings.Num());
+
+    const bool Written = Writer->Close() && !Writer->IsError();
+    Writer.Reset();
+    if (!Written || !AtomicFile::Replace(FilePath, TempFilePath) || !AtomicFile::Replace(GraphPath, TempGraphPath))
+    {
+        UE_LOGFMT(LogTextIndex, Error, "Can't save text index: {0}", BasePath);
+        DeleteTempFiles();
+        return false;
+    }
+    return true;
+}
+
+bool FTextIndex::Load(const FString& BasePath)
+{
+    auto NewFile = MakeUnique<FMappedFile>();
+    const FString FilePath = GetChunksPath(BasePath);
+    if (!NewFile->Open(FilePath)) return false;
+
+    FFileHeader Header;
+    if (NewFile->GetSize() < static_cast<int64>(sizeof(FFileHeader)))
+    {
+        UE_LOGFMT(LogTextIndex, Error, "Text index file is too small: {0}", FilePath);
+        return false;
+    }
+    FMemory::Memcpy(&Header, NewFile->GetData(), sizeof(FFileHeader));
+
+    const bool Valid = Header.Magic == FileMagic && Header.Version == FileVersion && Header.NumEntries >= 0 &&
+                       Header.EntriesOffset % SectionAlignment == 0 && Header.StringsOffset % SectionAlignment == 0 &&
+                       Header.EntriesOffset + Header.NumEntries * static_cast<int64>(sizeof(FEntry)) <= NewFile->GetSize() &&
+                       Header.StringsSize >= 0 && Header.StringsOffset + Header.StringsSize <= NewFile->GetSize() &&
+                       Header.ModelSize >= 0 && Header.ModelSize <= Header.StringsSize;
+    if (!Valid)
+    {
+        UE_LOGFMT(LogTextIndex, Error, "Unsupported text index file: {0}", FilePath);
+        return false;
+    }
+
+    // the getters read the strings without checks
+    const FEntry* NewEntries = reinterpret_cast<const FEntry*>(NewFile->GetData() + Header.EntriesOffset);
+    for (int32 Entry = 0; Entry < Header.NumEntries; ++Entry)
+    {
+        const FEntry& Check = NewEntries[Entry];
+        if (Check.TextOffset < 0 || Check.TextSize < 0 || Check.SourceSize < 0 ||
+            Check.TextOffset + Check.TextSize + Check.SourceSize > Header.StringsSize)
+        {
+            UE_LOGFMT(LogTextIndex, Error, "Entry {0} is out of the strings section: {1}", Entry, FilePath);
+            return false;
+        }
+    }
+
+    auto NewIndex = MakeUnique<FHNSWIndex>(1);
+    if (!NewIndex->Load(GetGraphPath(BasePath)) || NewIndex->Num() != Header.NumEntries)
+    {
+        UE_LOGFMT(LogTextIndex, Error, "Graph doesn't match the texts: {0}", BasePath);
+        return false;
+    }
+
+    File = MoveTemp(NewFile);
+    Index = MoveTemp(NewIndex);
+    Entries = NewEntries;
+    Strings = reinterpret_cast<const UTF8CHAR*>(File->GetData() + Header.StringsOffset);
+    NumEntries = Header.NumEntries;
+    Model = FString(FUtf8StringView(Strings, Header.ModelSize));
+    return true;
+}
+
+FString FTextIndex::GetText(int32 Entry) const
+{
+    if (Entry < 0 || Entry >= NumEntries) return {};
+    return FString(FUtf8StringView(Strings + Entries[Entry].TextOffset, Entries[Entry].TextSize));
+}
+
+FString FTextIndex::GetSource(int32 Entry) const
+{
+    if (Entry < 0 || Entry >= NumEntries) return {};
+    return FString(FUtf8StringView(Strings + Entries[Entry].TextOffset + Entries[Entry].TextSize, Entries[Entry].SourceSize));
+}
+
+FXxHash128 FTextIndex::GetHash(int32 Entry) const
+{
+    if (Entry < 0 || Entry >= NumEntries) return {};
+    return FXxHash128{Entries[Entry].HashLow, Entries[Entry].HashHigh};
+}
@@ -0,0 +1,158 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Embeddings/VectorMath.h"
+#include "Math/VectorRegister.h"
+
+namespace OpenAI::VectorMath
+{
+namespace
+{
+constexpr int32 FloatsPerRegister = 4;
+// several accumulators hide the latency of the multiply-add
+constexpr int32 FloatsPerIteration = FloatsPerRegister * 4;
+
+float HorizontalSum(const VectorRegister4Float& Register)
+{
+    alignas(16) float Components[FloatsPerRegister];
+    VectorStoreAligned(Register, Components);
+    return (Components[0] + Components[1]) + (Components[2] + Components[3]);
+}
+
+template <typename KernelType>
+float Reduce(const float* A, const float* B, int32 Num, KernelType&& Kernel)
+{
+    VectorRegister4Float Sum0 = VectorZeroFloat();
+    VectorRegister4Float Sum1 = VectorZeroFloat();
+    VectorRegister4Float Sum2 = VectorZeroFloat();
+    VectorRegister4Float Sum3 = VectorZeroFloat();
+
+    int32 Index = 0;
+    for (; Index + FloatsPerIteration <= Num; Index += FloatsPerIteration)
+    {
+        Sum0 = Kernel(VectorLoad(A + Index), VectorLoad(B + Index), Sum0);
+        Sum1 = Kernel(VectorLoad(A + Index + 4), VectorLoad(B + Index + 4), Sum1);
+        Sum2 = Kernel(VectorLoad(A + Index + 8), VectorLoad(B + Index + 8), Sum2);
+        Sum3 = Kernel(VectorLoad(A + Index + 12), VectorLoad(B + Index + 12), Sum3);
+    }
+    for (; Index + FloatsPerRegister <= Num; Index += FloatsPerRegister)
+    {
+        Sum0 = Kernel(VectorLoad(A + Index), VectorLoad(B + Index), Sum0);
+    }
+
+    if (Index < Num)
+    {
+        // zero padding doesn't change the sum of both kernels
+        alignas(16) float TailA[FloatsPerRegister]{};
+        alignas(16) float TailB[FloatsPerRegister]{};
+        FMemory::Memcpy(TailA, A + Index, (Num - Index) * sizeof(float));
+        FMemory::Memcpy(TailB, B + Index, (Num - Index) * sizeof(float));
+        Sum1 = Kernel(VectorLoadAligned(TailA), VectorLoadAligned(TailB), Sum1);
+    }
+
+    return HorizontalSum(VectorAdd(VectorAdd(Sum0, Sum1), VectorAdd(Sum2, Sum3)));
+}
+}  // namespace
+
+float Dot(const float* A, const float* B, int32 Num)
+{
+    return Reduce(A, B, Num,
+        [](const VectorRegister4Float& VectorA, const VectorRegister4Float& VectorB, const VectorRegister4Float& Sum)
+        { return VectorMultiplyAdd(VectorA, VectorB, Sum); });
+}
+
+float L2Squared(const float* A, const float* B, int32 Num)
+{
+    return Reduce(A, B, Num,
+        [](const VectorRegister4Float& VectorA, const VectorRegister4Float& VectorB, const VectorRegister4Float& Sum)
+        {
+            const VectorRegister4Float Difference = VectorSubtract(VectorA, VectorB);
+            return VectorMultiplyAdd(Difference, Difference, Sum);
+        });
+}
+
+float Cosine(const float* A, const float* B, int32 Num)
+{
+    const float Norms = FMath::Sqrt(Dot(A, A, Num) * Dot(B, B, Num));
+    return Norms > UE_SMALL_NUMBER ? Dot(A, B, Num) / Norms : 0.0f;
+}
+
+float Score(const float* A, const float* B, int32 Num, EVectorMetric Metric)
+{
+    switch (Metric)
+    {
+        case EVectorMetric::L2: return -L2Squared(A, B, Num);
+        // cosine vectors are normalized beforehand
+        default: return Dot(A, B, Num);
+    }
+}
+
+void Normalize(TArrayView<float> Vector)
+{
+    const float Length = FMath::Sqrt(Dot(Vector.GetData(), Vector.GetData(), Vector.Num()));
+    if (Length <= UE_SMALL_NUMBER) return;
+
+    const float InvLength = 1.0f / Length;
+    for (float& Value : Vector)
+    {
+        Value *= InvLength;
+    }
+}
+
+TArray<float> Truncate(TArrayView<const float> Vector, int32 Dimensions)
+{
+    TArray<float> Truncated(Vector.GetData(), FMath::Clamp(Dimensions, 0, Vector.Num()));
+    Normalize(Truncated);
+    return Truncated;
+}
+
+float QuantizeInt8(const float* Vector, int32 Num, int8* Quantized)
+{
+    float MaxAbs{0.0f};
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        MaxAbs = FMath::Max(MaxAbs, FMath::Abs(Vector[Index]));
+    }
+
+    const float Scale = MaxAbs > 0.0f ? MaxAbs / 127.0f : 1.0f;
+    const float InvScale = 1.0f / Scale;
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        Quantized[Index] = static_cast<int8>(FMath::Clamp(FMath::RoundToInt32(Vector[Index] * InvScale), -127, 127));
+    }
+    return Scale;
+}
+
+int32 DotInt8(const int8* A, const int8* B, int32 Num)
+{
+    // plain loop is vectorized by the compiler
+    int32 Sum{0};
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        Sum += static_cast<int32>(A[Index]) * static_cast<int32>(B[Index]);
+    }
+    return Sum;
+}
+
+void QuantizeBinary(const float* Vector, int32 Num, uint64* Bits)
+{
+    FMemory::Memzero(Bits, NumBinaryWords(Num) * sizeof(uint64));
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        if (Vector[Index] > 0.0f)
+        {
+            Bits[Index / 64] |= 1ull << (Index % 64);
+        }
+    }
+}
+
+int32 HammingDistance(const uint64* A, const uint64* B, int32 NumWords)
+{
+    int32 Distance{0};
+    for (int32 Index = 0; Index < NumWords; ++Index)
+    {
+        Distance += static_cast<int32>(FPlatformMath::CountBits(A[Index] ^ B[Index]));
+    }
+    return Distance;
+}
+
+}  // namespace OpenAI::VectorMath
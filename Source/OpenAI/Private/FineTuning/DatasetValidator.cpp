@@ -0,0 +1,402 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "FineTuning/DatasetValidator.h"
+#include "IO/MappedFile.h"
+#include "Tokenizer/BPETokenizer.h"
+#include "Async/ParallelFor.h"
+#include "Hash/xxhash.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogDatasetValidator, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 WriteBufferSize = 4 * 1024 * 1024;
+
+// https://cookbook.openai.com/examples/chat_finetuning_data_prep
+constexpr int32 TokensPerMessage = 3;
+constexpr int32 TokensPerName = 1;
+constexpr int32 TokensPerReply = 3;
+constexpr int32 TokensPerImage = 85;
+
+struct FExampleResult
+{
+    FString Error;
+    int32 Tokens{};
+    uint64 Hash{};
+};
+
+class FExampleValidator
+{
+public:
+    explicit FExampleValidator(const FTokenCounter& InCountTokens) : CountTokens(InCountTokens) {}
+
+    bool Validate(const FJsonObject& Example, FString& Error)
+    {
+        const TArray<TSharedPtr<FJsonValue>>* Messages = nullptr;
+        if (!Example.TryGetArrayField(TEXT("messages"), Messages) || Messages->IsEmpty())
+        {
+            Error = TEXT("messages list is missing or empty");
+            return false;
+        }
+
+        bool HasAssistantMessage{false};
+        for (int32 Index = 0; Index < Messages->Num(); ++Index)
+        {
+            const TSharedPtr<FJsonObject>* Message = nullptr;
+            if (!(*Messages)[Index].IsValid() || !(*Messages)[Index]->TryGetObject(Message))
+            {
+                Error = FString::Printf(TEXT("message %d is not an object"), Index);
+                return false;
+            }
+
+            FString Role;
+            if (!ValidateMessage(**Message, Role, Error))
+            {
+                Error = FString::Printf(TEXT("message %d: %s"), Index, *Error);
+                return false;
+            }
+            HasAssistantMessage |= Role.Equals(TEXT("assistant"));
+        }
+
+        if (!HasAssistantMessage)
+        {
+            Error = TEXT("example has no assistant message");
+            return false;
+        }
+
+        const TArray<TSharedPtr<FJsonValue>>* Tools = nullptr;
+        if (Example.TryGetArrayField(TEXT("tools"), Tools))
+        {
+            // tool definitions are a part of the prompt
+            FString ToolsString;
+            const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&ToolsString);
+            FJsonSerializer::Serialize(*Tools, Writer);
+            Tokens += CountTokens(ToolsString);
+        }
+
+        Tokens += TokensPerReply;
+        return true;
+    }
+
+    int32 GetTokens() const { return Tokens; }
+
+private:
+    const FTokenCounter& CountTokens;
+    TSet<FString> PendingToolCallIds;
+    int32 Tokens{};
+
+    bool ValidateMessage(const FJsonObject& Message, FString& Role, FString& Error)
+    {
+        static const TSet<FString> Roles{TEXT("system"), TEXT("user"), TEXT("assistant"), TEXT("tool"), TEXT("function")};
+        static const TSet<FString> Keys{TEXT("role"), TEXT("content"), TEXT("name"), TEXT("function_call"), TEXT("weight"),
+            TEXT("tool_calls"), TEXT("tool_call_id"), TEXT("refusal")};
+
+        for (const auto& [Key, Value] : Message.Values)
+        {
+            if (!Keys.Contains(Key))
+            {
+                Error = FString::Printf(TEXT("unrecognized key: %s"), *Key);
+                return false;
+            }
+        }
+
+        if (!Message.TryGetStringField(TEXT("role"), Role) || !Roles.Contains(Role))
+        {
+            Error = FString::Printf(TEXT("unrecognized role: %s"), *Role);
+            return false;
+        }
+        Tokens += TokensPerMessage + CountTokens(Role);
+
+        FString Name;
+        if (Message.TryGetStringField(TEXT("name"), Name))
+        {
+            Tokens += TokensPerName + CountTokens(Name);
+        }
+
+        const bool IsAssistant = Role.Equals(TEXT("assistant"));
+        if (Message.HasField(TEXT("weight")))
+        {
+            double Weight{};
+            if (!IsAssistant || !Message.TryGetNumberField(TEXT("weight"), Weight) || (Weight != 0.0 && Weight != 1.0))
+            {
+                Error = TEXT("weight must be 0 or 1 and is allowed for assistant messages only");
+                return false;
+            }
+        }
+
+        const bool HasToolCalls = Message.HasField(TEXT("tool_calls"));
+        if (HasToolCalls && !IsAssistant)
+        {
+            Error = TEXT("tool_calls are allowed for assistant messages only");
+            return false;
+        }
+        if (HasToolCalls && !ValidateToolCalls(Message, Error)) return false;
+
+        if (Role.Equals(TEXT("tool")))
+        {
+            FString ToolCallId;
+            if (!Message.TryGetStringField(TEXT("tool_call_id"), ToolCallId) || !PendingToolCallIds.Remove(ToolCallId))
+            {
+                Error = FString::Printf(TEXT("tool message doesn't answer a preceding tool call: %s"), *ToolCallId);
+                return false;
+            }
+        }
+
+        const TSharedPtr<FJsonValue> Content = Message.TryGetField(TEXT("content"));
+        const bool HasContent = Content.IsValid() && !Content->IsNull();
+        if (!HasContent)
+        {
+            // assistant can answer with a call only
+            if (IsAssistant && (HasToolCalls || Message.HasField(TEXT("function_call")))) return true;
+            Error = TEXT("content is missing");
+            return false;
+        }
+
+        return ValidateContent(*Content, Error);
+    }
+
+    bool ValidateContent(const FJsonValue& Content, FString& Error)
+    {
+        if (Content.Type == EJson::String)
+        {
+            Tokens += CountTokens(Content.AsString());
+            return true;
+        }
+
+        const TArray<TSharedPtr<FJsonValue>>* Parts = nullptr;
+        if (!Content.TryGetArray(Parts))
+        {
+            Error = TEXT("content must be a string or an array of parts");
+            return false;
+        }
+
+        for (const auto& Part : *Parts)
+        {
+            const TSharedPtr<FJsonObject>* PartObject = nullptr;
+            FString Type, Text;
+            if (!Part.IsValid() || !Part->TryGetObject(PartObject) || !(*PartObject)->TryGetStringField(TEXT("type"), Type))
+            {
+                Error = TEXT("content part must be an object with a type");
+                return false;
+            }
+
+            if (Type.Equals(TEXT("text")) && (*PartObject)->TryGetStringField(TEXT("text"), Text))
+            {
+                Tokens += CountTokens(Text);
+            }
+            else if (Type.Equals(TEXT("image_url")) && (*PartObject)->HasTypedField<EJson::Object>(TEXT("image_url")))
+            {
+                Tokens += TokensPerImage;
+            }
+            else
+            {
+                Error = FString::Printf(TEXT("unsupported content part: %s"), *Type);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ValidateToolCalls(const FJsonObject& Message, FString& Error)
+    {
+        const TArray<TSharedPtr<FJsonValue>>* ToolCalls = nullptr;
+        if (!Message.TryGetArrayField(TEXT("tool_calls"), ToolCalls) || ToolCalls->IsEmpty())
+        {
+            Error = TEXT("tool_calls must be a non-empty array");
+            return false;
+        }
+
+        for (const auto& ToolCall : *ToolCalls)
+        {
+            const TSharedPtr<FJsonObject>* ToolCallObject = nullptr;
+            const TSharedPtr<FJsonObject>* Function = nullptr;
+            FString Id, Type, Name, Arguments;
+            const bool Valid = ToolCall.IsValid() && ToolCall->TryGetObject(ToolCallObject) &&
+                               (*ToolCallObject)->TryGetStringField(TEXT("id"), Id) && !Id.IsEmpty() &&
+                               (*ToolCallObject)->TryGetStringField(TEXT("type"), Type) && Type.Equals(TEXT("function")) &&
+                               (*ToolCallObject)->TryGetObjectField(TEXT("function"), Function) &&
+                               (*Function)->TryGetStringField(TEXT("name"), Name) && !Name.IsEmpty() &&
+                               (*Function)->TryGetStringField(TEXT("arguments"), Arguments);
+            if (!Valid)
+            {
+                Error = TEXT("tool call must have an id, the function type, a function name and arguments");
+                return false;
+            }
+
+            PendingToolCallIds.Add(Id);
+            Tokens += CountTokens(Name) + CountTokens(Arguments);
+        }
+        return true;
+    }
+};
+
+FExampleResult ValidateLine(FUtf8StringView Line, const FTokenCounter& CountTokens)
+{
+    FExampleResult Result;
+    Result.Hash = FXxHash64::HashBuffer(Line.GetData(), Line.Len()).Hash;
+
+    const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Line.GetData()), Line.Len());
+    const FStringView LineString(Converter.Get(), Converter.Length());
+
+    TSharedPtr<FJsonObject> Json;
+    const auto Reader = TJsonReaderFactory<TCHAR>::CreateFromView(LineString);
+    if (!FJsonSerializer::Deserialize(Reader, Json) || !Json.IsValid())
+    {
+        Result.Error = TEXT("line is not a JSON object");
+        return Result;
+    }
+
+    FExampleValidator Validator(CountTokens);
+    if (Validator.Validate(*Json, Result.Error))
+    {
+        Result.Tokens = Validator.GetTokens();
+    }
+    return Result;
+}
+}  // namespace
+
+FFineTuningDatasetValidator::FFineTuningDatasetValidator(const FDatasetValidationOptions& InOptions)
+    : Options(InOptions), TokenCounter(FBPETokenizer::MakeTokenCounter(EBPEEncoding::O200kBase))
+{
+}
+
+bool FFineTuningDatasetValidator::Validate(const FString& FilePath, FDatasetReport& Report) const
+{
+    FMappedFile File;
+    if (!File.Open(FilePath))
+    {
+        Report = {};
+        Report.Issues.Add({0, FString::Printf(TEXT("Can't open file: %s"), *FilePath)});
+        return false;
+    }
+    return ValidateMappedFile(File, Report);
+}
+
+bool FFineTuningDatasetValidator::ValidateString(const FString& Content, FDatasetReport& Report) const
+{
+    FMappedFile File;
+    File.OpenFromString(Content);
+    return ValidateMappedFile(File, Report);
+}
+
+bool FFineTuningDatasetValidator::ValidateMappedFile(const FMappedFile& File, FDatasetReport& Report) const
+{
+    Report = {};
+
+    TArray<FMappedFile::FLine> Lines;
+    File.SplitLines(Lines);
+
+    TArray<FExampleResult> Results;
+    Results.SetNum(Lines.Num());
+    ParallelFor(Lines.Num(), [&](int32 Index) { Results[Index] = ValidateLine(File.View(Lines[Index]), TokenCounter); });
+
+    // duplicates are resolved in file order, the first occurrence is kept
+    TArray<bool> Keep;
+    Keep.SetNumZeroed(Lines.Num());
+    // every distinct example of a hash is kept, a collision mustn't hide the second one
+    TMultiMap<uint64, int32> FirstByHash;
+    FirstByHash.Reserve(Lines.Num());
+
+    Report.NumExamples = Lines.Num();
+    for (int32 Index = 0; Index < Lines.Num(); ++Index)
+    {
+        const FExampleResult& Result = Results[Index];
+        FString Issue;
+        if (!Result.Error.IsEmpty())
+        {
+            ++Report.NumInvalid;
+            Issue = Result.Error;
+        }
+        else if (Result.Tokens > Options.MaxTokensPerExample)
+        {
+            ++Report.NumTooLong;
+            Issue = FString::Printf(TEXT("example has %d tokens, the limit is %d"), Result.Tokens, Options.MaxTokensPerExample);
+        }
+        else
+        {
+            int32 FirstIndex = INDEX_NONE;
+            for (auto It = FirstByHash.CreateConstKeyIterator(Result.Hash); It; ++It)
+            {
+                if (File.View(Lines[It.Value()]).Equals(File.View(Lines[Index]), ESearchCase::CaseSensitive))
+                {
+                    FirstIndex = It.Value();
+                    break;
+                }
+            }
+
+            if (FirstIndex != INDEX_NONE)
+            {
+                ++Report.NumDuplicates;
+                if (!Options.RemoveDuplicates)
+                {
+                    Keep[Index] = true;
+                    Report.TrainingTokens += Result.Tokens;
+                }
+                Issue = FString::Printf(TEXT("duplicate of example %d"), FirstIndex + 1);
+            }
+            else
+            {
+                FirstByHash.Add(Result.Hash, Index);
+                Keep[Index] = true;
+                ++Report.NumValid;
+                Report.TrainingTokens += Result.Tokens;
+                Report.MaxExampleTokens = FMath::Max(Report.MaxExampleTokens, Result.Tokens);
+            }
+        }
+
+        if (!Issue.IsEmpty() && Report.Issues.Num() < Options.MaxReportedIssues)
+        {
+            Report.Issues.Add({Index + 1, MoveTemp(Issue)});
+        }
+    }
+
+    Report.EstimatedCost = static_cast<double>(Report.TrainingTokens) * Options.Epochs * Options.PricePerMillionTrainingTokens / 1e6;
+
+    UE_LOGFMT(LogDatasetValidator, Display, "Examples: {0}, valid: {1}, invalid: {2}, duplicates: {3}, too long: {4}, tokens: {5}",
+        Report.NumExamples, Report.NumValid, Report.NumInvalid, Report.NumDuplicates, Report.NumTooLong, Report.TrainingTokens);
+
+    if (Options.CleanedFilePath.IsEmpty()) return Report.IsValid();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Options.CleanedFilePath));
+    TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*Options.CleanedFilePath));
+    if (!FileHandle)
+    {
+        UE_LOGFMT(LogDatasetValidator, Error, "Can't open file for writing: {0}", Options.CleanedFilePath);
+        return false;
+    }
+
+    TArray<uint8> WriteBuffer;
+    WriteBuffer.Reserve(WriteBufferSize);
+    bool Written{true};
+    for (int32 Index = 0; Index < Lines.Num() && Written; ++Index)
+    {
+        if (!Keep[Index]) continue;
+
+        const FUtf8StringView Line = File.View(Lines[Index]);
+        if (WriteBuffer.Num() + Line.Len() + 1 > WriteBufferSize)
+        {
+            Written = FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+            WriteBuffer.Reset();
+        }
+        WriteBuffer.Append(reinterpret_cast<const uint8*>(Line.GetData()), Line.Len());
+        WriteBuffer.Add('\n');
+    }
+    Written = Written && FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+
+    if (!Written)
+    {
+        UE_LOGFMT(LogDatasetValidator, Error, "Can't write file: {0}", Options.CleanedFilePath);
+    }
+    return Written && Report.NumValid > 0;
+}
@@ -1,6 +1,8 @@
 // OpenAI Sample, Copyright LifeEXE. All Rights Reserved.
 
 #include "FuncLib/OpenAIFuncLib.h"
+#include "FuncLib/EnumNameTable.h"
+#include "Provider/ModelRegistry.h"
 #include "Internationalization/Regex.h"
 #include "Misc/FileHelper.h"
 #include "Misc/Base64.h"
@@ -10,357 +12,333 @@
 
 DEFINE_LOG_CATEGORY_STATIC(LogOpenAIFuncLib, All, All);
 
-FString UOpenAIFuncLib::OpenAIAllModelToString(EAllModelEnum Model)
+using namespace OpenAI;
+
+namespace
+{
+// API names of the enums, the conversions both ways are generated from them
+constexpr TEnumName<EAllModelEnum> AllModelNames[]{
+    {EAllModelEnum::Whisper_1, TEXT("whisper-1")},
+    {EAllModelEnum::GPT_3_5_Turbo, TEXT("gpt-3.5-turbo")},
+    {EAllModelEnum::GPT_3_5_Turbo_16k, TEXT("gpt-3.5-turbo-16k")},
+    {EAllModelEnum::GPT_3_5_Turbo_Instruct_0914, TEXT("gpt-3.5-turbo-instruct-0914")},
+    {EAllModelEnum::GPT_3_5_Turbo_Instruct, TEXT("gpt-3.5-turbo-instruct")},
+    {EAllModelEnum::Text_Embedding_Ada_002, TEXT("text-embedding-ada-002")},
+    {EAllModelEnum::GPT_4, TEXT("gpt-4")},
+    {EAllModelEnum::GPT_4_0314, TEXT("gpt-4-0314")},
+    {EAllModelEnum::GPT_4_0613, TEXT("gpt-4-0613")},
+    {EAllModelEnum::DALL_E_2, TEXT("dall-e-2")},
+    {EAllModelEnum::DALL_E_3, TEXT("dall-e-3")},
+    {EAllModelEnum::GPT_4_1106_Preview, TEXT("gpt-4-1106-preview")},
+    {EAllModelEnum::GPT_4_Vision_Preview, TEXT("gpt-4-vision-preview")},
+    {EAllModelEnum::GPT_3_5_Turbo_1106, TEXT("gpt-3.5-turbo-1106")},
+    {EAllModelEnum::TTS_1, TEXT("tts-1")},
+    {EAllModelEnum::TTS_1_HD, TEXT("tts-1-hd")},
+    {EAllModelEnum::TTS_1_1106, TEXT("tts-1-1106")},
+    {EAllModelEnum::TTS_1_HD_1106, TEXT("tts-1-hd-1106")},
+    {EAllModelEnum::Text_Embedding_3_Large, TEXT("text-embedding-3-large")},
+    {EAllModelEnum::GPT_4_32K_0314, TEXT("gpt-4-32k-0314")},
+    {EAllModelEnum::GPT_3_5_Turbo_0125, TEXT("gpt-3.5-turbo-0125")},
+    {EAllModelEnum::Text_Embedding_3_Small, TEXT("text-embedding-3-small")},
+    {EAllModelEnum::GPT_4_0125_Preview, TEXT("gpt-4-0125-preview")},
+    {EAllModelEnum::GPT_4_Turbo_Preview, TEXT("gpt-4-turbo-preview")},
+    {EAllModelEnum::GPT_4O_2024_05_13, TEXT("gpt-4o-2024-05-13")},
+    {EAllModelEnum::GPT_4O, TEXT("gpt-4o")},
+    {EAllModelEnum::GPT_4_Turbo_2024_04_09, TEXT("gpt-4-turbo-2024-04-09")},
+    {EAllModelEnum::GPT_4_Turbo, TEXT("gpt-4-turbo")},
+    {EAllModelEnum::GPT_4_1106_Vision_Preview, TEXT("gpt-4-1106-vision-preview")},
+    {EAllModelEnum::GPT_4O_Mini, TEXT("gpt-4o-mini")},
+    {EAllModelEnum::GPT_4O_Mini_2024_07_18, TEXT("gpt-4o-mini-2024-07-18")},
+    {EAllModelEnum::ChatGPT_4O_Latest, TEXT("chatgpt-4o-latest")},
+    {EAllModelEnum::GPT_4O_2024_08_06, TEXT("gpt-4o-2024-08-06")}};
+
+constexpr TEnumName<EMainModelEnum> MainModelNames[]{
+    {EMainModelEnum::GPT_4O, TEXT("gpt-4o")},
+    {EMainModelEnum::GPT_4, TEXT("gpt-4")},
+    {EMainModelEnum::GPT_4_0314, TEXT("gpt-4-0314")},
+    {EMainModelEnum::GPT_4_0613, TEXT("gpt-4-0613")},
+    {EMainModelEnum::GPT_4_1106_Preview, TEXT("gpt-4-1106-preview")},
+    {EMainModelEnum::GPT_4_Vision_Preview, TEXT("gpt-4-vision-preview")},
+    {EMainModelEnum::GPT_3_5_Turbo, TEXT("gpt-3.5-turbo")},
+    {EMainModelEnum::GPT_3_5_Turbo_Instruct, TEXT("gpt-3.5-turbo-instruct")},
+    {EMainModelEnum::GPT_4O_Mini, TEXT("gpt-4o-mini")}};
+
+constexpr TEnumName<EModerationsModelEnum> ModerationsModelNames[]{
+    {EModerationsModelEnum::Text_Moderation_Latest, TEXT("text-moderation-latest")},
+    {EModerationsModelEnum::Text_Moderation_Stable, TEXT("text-moderation-stable")}};
+
+constexpr TEnumName<EAudioModel> AudioModelNames[]{
+    {EAudioModel::Whisper_1, TEXT("whisper-1")}};
+
+constexpr TEnumName<ETTSModel> TTSModelNames[]{
+    {ETTSModel::TTS_1, TEXT("tts-1")},
+    {ETTSModel::TTS_1_HD, TEXT("tts-1-hd")}};
+
+constexpr TEnumName<EVoice> VoiceNames[]{
+    {EVoice::Alloy, TEXT("alloy")},
+    {EVoice::Echo, TEXT("echo")},
+    {EVoice::Fable, TEXT("fable")},
+    {EVoice::Nova, TEXT("nova")},
+    {EVoice::Onyx, TEXT("onyx")},
+    {EVoice::Shimmer, TEXT("shimmer")}};
+
+constexpr TEnumName<ETTSAudioFormat> TTSAudioFormatNames[]{
+    {ETTSAudioFormat::AAC, TEXT("aac")},
+    {ETTSAudioFormat::FLAC, TEXT("flac")},
+    {ETTSAudioFormat::MP3, TEXT("mp3")},
+    {ETTSAudioFormat::OPUS, TEXT("opus")}};
+
+constexpr TEnumName<EImageModelEnum> ImageModelNames[]{
+    {EImageModelEnum::DALL_E_2, TEXT("dall-e-2")},
+    {EImageModelEnum::DALL_E_3, TEXT("dall-e-3")}};
+
+constexpr TEnumName<EImageSizeDalle2> ImageSizeDalle2Names[]{
+    {EImageSizeDalle2::Size_256x256, TEXT("256x256")},
+    {EImageSizeDalle2::Size_512x512, TEXT("512x512")},
+    {EImageSizeDalle2::Size_1024x1024, TEXT("1024x1024")}};
+
+constexpr TEnumName<EImageSizeDalle3> ImageSizeDalle3Names[]{
+    {EImageSizeDalle3::Size_1024x1024, TEXT("1024x1024")},
+    {EImageSizeDalle3::Size_1024x1792, TEXT("1024x1792")},
+    {EImageSizeDalle3::Size_1792x1024, TEXT("1792x1024")}};
+
+constexpr TEnumName<EOpenAIImageFormat> ImageFormatNames[]{
+    {EOpenAIImageFormat::URL, TEXT("url")},
+    {EOpenAIImageFormat::B64_JSON, TEXT("b64_json")}};
+
+constexpr TEnumName<EOpenAIImageQuality> ImageQualityNames[]{
+    {EOpenAIImageQuality::HD, TEXT("hd")},
+    {EOpenAIImageQuality::Standard, TEXT("standard")}};
+
+constexpr TEnumName<EOpenAIImageStyle> ImageStyleNames[]{
+    {EOpenAIImageStyle::Natural, TEXT("natural")},
+    {EOpenAIImageStyle::Vivid, TEXT("vivid")}};
+
+constexpr TEnumName<ERole> RoleNames[]{
+    {ERole::System, TEXT("system")},
+    {ERole::User, TEXT("user")},
+    {ERole::Assistant, TEXT("assistant")},
+    {ERole::Function, TEXT("function")},
+    {ERole::Tool, TEXT("tool")}};
+
+constexpr TEnumName<EOpenAIFinishReason> FinishReasonNames[]{
+    {EOpenAIFinishReason::Stop, TEXT("stop")},
+    {EOpenAIFinishReason::Length, TEXT("length")},
+    {EOpenAIFinishReason::Content_Filter, TEXT("content_filter")},
+    {EOpenAIFinishReason::Tool_Calls, TEXT("tool_calls")},
+    {EOpenAIFinishReason::Null, TEXT("")}};
+
+constexpr TEnumName<ETranscriptFormat> TranscriptFormatNames[]{
+    {ETranscriptFormat::JSON, TEXT("json")},
+    {ETranscriptFormat::Text, TEXT("text")},
+    {ETranscriptFormat::Str, TEXT("str")},
+    {ETranscriptFormat::Verbose_JSON, TEXT("verbose_json")},
+    {ETranscriptFormat::Vtt, TEXT("vtt")}};
+
+constexpr TEnumName<EEmbeddingsEncodingFormat> EmbeddingsEncodingFormatNames[]{
+    {EEmbeddingsEncodingFormat::Float, TEXT("float")},
+    {EEmbeddingsEncodingFormat::Base64, TEXT("base64")}};
+
+constexpr TEnumName<EChatResponseFormat> ChatResponseFormatNames[]{
+    {EChatResponseFormat::Text, TEXT("text")},
+    {EChatResponseFormat::JSON_Object, TEXT("json_object")}};
+
+constexpr TEnumName<EMessageContentType> MessageContentTypeNames[]{
+    {EMessageContentType::Text, TEXT("text")},
+    {EMessageContentType::Image_URL, TEXT("image_url")}};
+
+constexpr TEnumName<EUploadFilePurpose> UploadFilePurposeNames[]{
+    {EUploadFilePurpose::Assistants, TEXT("assistants")},
+    {EUploadFilePurpose::Vision, TEXT("vision")},
+    {EUploadFilePurpose::Batch, TEXT("batch")},
+    {EUploadFilePurpose::FineTune, TEXT("fine-tune")}};
+
+constexpr TEnumName<EBatchEndpoint> BatchEndpointNames[]{
+    {EBatchEndpoint::ChatCompletions, TEXT("/v1/chat/completions")},
+    {EBatchEndpoint::Completions, TEXT("/v1/completions")},
+    {EBatchEndpoint::Embeddings, TEXT("/v1/embeddings")}};
+
+constexpr TEnumName<EBatchCompletionWindow> BatchCompletionWindowNames[]{
+    {EBatchCompletionWindow::Window_24h, TEXT("24h")}};
+
+constexpr TEnumName<EUploadStatus> UploadStatusNames[]{
+    {EUploadStatus::Pending, TEXT("pending")},
+    {EUploadStatus::Completed, TEXT("completed")},
+    {EUploadStatus::Cancelled, TEXT("cancelled")}};
+
+constexpr TEnumName<EServiceTier> ServiceTierNames[]{
+    {EServiceTier::Auto, TEXT("auto")},
+    {EServiceTier::Default, TEXT("default")}};
+
+template <const auto& Names>
+FString EnumToString(typename TEnumNameTable<Names>::EnumType Value)
+{
+    const TOptional<FStringView> Name = TEnumNameTable<Names>::FindName(Value);
+    if (!Name.IsSet())
+    {
+        checkNoEntry();
+        return {};
+    }
+    return FString(Name.GetValue());
+}
+
+template <const auto& Names, ESearchCase::Type SearchCase = ESearchCase::CaseSensitive>
+typename TEnumNameTable<Names>::EnumType StringToEnum(const FString& Name, const TCHAR* EnumName)
 {
-    switch (Model)
+    const auto Value = TEnumNameTable<Names, SearchCase>::FindValue(Name);
+    if (!Value.IsSet())
     {
-        case EAllModelEnum::Whisper_1: return "whisper-1";
-        case EAllModelEnum::GPT_3_5_Turbo: return "gpt-3.5-turbo";
-        case EAllModelEnum::GPT_3_5_Turbo_16k: return "gpt-3.5-turbo-16k";
-        case EAllModelEnum::GPT_3_5_Turbo_Instruct_0914: return "gpt-3.5-turbo-instruct-0914";
-        case EAllModelEnum::GPT_3_5_Turbo_Instruct: return "gpt-3.5-turbo-instruct";
-        case EAllModelEnum::Text_Embedding_Ada_002: return "text-embedding-ada-002";
-        case EAllModelEnum::GPT_4: return "gpt-4";
-        case EAllModelEnum::GPT_4_0314: return "gpt-4-0314";
-        case EAllModelEnum::GPT_4_0613: return "gpt-4-0613";
-        case EAllModelEnum::DALL_E_2: return "dall-e-2";
-        case EAllModelEnum::DALL_E_3: return "dall-e-3";
-        case EAllModelEnum::GPT_4_1106_Preview: return "gpt-4-1106-preview";
-        case EAllModelEnum::GPT_4_Vision_Preview: return "gpt-4-vision-preview";
-        case EAllModelEnum::GPT_3_5_Turbo_1106: return "gpt-3.5-turbo-1106";
-        case EAllModelEnum::TTS_1: return "tts-1";
-        case EAllModelEnum::TTS_1_HD: return "tts-1-hd";
-        case EAllModelEnum::TTS_1_1106: return "tts-1-1106";
-        case EAllModelEnum::TTS_1_HD_1106: return "tts-1-hd-1106";
-        case EAllModelEnum::Text_Embedding_3_Large: return "text-embedding-3-large";
-        case EAllModelEnum::GPT_4_32K_0314: return "gpt-4-32k-0314";
-        case EAllModelEnum::GPT_3_5_Turbo_0125: return "gpt-3.5-turbo-0125";
-        case EAllModelEnum::Text_Embedding_3_Small: return "text-embedding-3-small";
-        case EAllModelEnum::GPT_4_0125_Preview: return "gpt-4-0125-preview";
-        case EAllModelEnum::GPT_4_Turbo_Preview: return "gpt-4-turbo-preview";
-        case EAllModelEnum::GPT_4O_2024_05_13: return "gpt-4o-2024-05-13";
-        case EAllModelEnum::GPT_4O: return "gpt-4o";
-        case EAllModelEnum::GPT_4_Turbo_2024_04_09: return "gpt-4-turbo-2024-04-09";
-        case EAllModelEnum::GPT_4_Turbo: return "gpt-4-turbo";
-        case EAllModelEnum::GPT_4_1106_Vision_Preview: return "gpt-4-1106-vision-preview";
-        case EAllModelEnum::GPT_4O_Mini: return "gpt-4o-mini";
-        case EAllModelEnum::GPT_4O_Mini_2024_07_18: return "gpt-4o-mini-2024-07-18";
-        case EAllModelEnum::ChatGPT_4O_Latest: return "chatgpt-4o-latest";
-        case EAllModelEnum::GPT_4O_2024_08_06: return "gpt-4o-2024-08-06";
+        UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown {0}: {1}", EnumName, Name);
+        checkNoEntry();
+        return {};
     }
-    checkNoEntry();
-    return {};
+    return Value.GetValue();
+}
+}  // namespace
+
+FString UOpenAIFuncLib::OpenAIAllModelToString(EAllModelEnum Model)
+{
+    return EnumToString<AllModelNames>(Model);
 }
 
 FString UOpenAIFuncLib::OpenAIMainModelToString(EMainModelEnum Model)
 {
-    switch (Model)
-    {
-        case EMainModelEnum::GPT_4O: return "gpt-4o";
-        case EMainModelEnum::GPT_4: return "gpt-4";
-        case EMainModelEnum::GPT_4_0314: return "gpt-4-0314";
-        case EMainModelEnum::GPT_4_0613: return "gpt-4-0613";
-        case EMainModelEnum::GPT_4_1106_Preview: return "gpt-4-1106-preview";
-        case EMainModelEnum::GPT_4_Vision_Preview: return "gpt-4-vision-preview";
-        case EMainModelEnum::GPT_3_5_Turbo: return "gpt-3.5-turbo";
-        case EMainModelEnum::GPT_3_5_Turbo_Instruct: return "gpt-3.5-turbo-instruct";
-        case EMainModelEnum::GPT_4O_Mini: return "gpt-4o-mini";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<MainModelNames>(Model);
 }
 
 FString UOpenAIFuncLib::OpenAIModerationModelToString(EModerationsModelEnum Model)
 {
-    switch (Model)
-    {
-        case EModerationsModelEnum::Text_Moderation_Latest: return "text-moderation-latest";
-        case EModerationsModelEnum::Text_Moderation_Stable: return "text-moderation-stable";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ModerationsModelNames>(Model);
 }
 
 bool UOpenAIFuncLib::ModelSupportsVision(const FString& Model)
 {
-    return OpenAIAllModelToString(EAllModelEnum::GPT_4_Vision_Preview).Equals(Model) ||
-           OpenAIAllModelToString(EAllModelEnum::GPT_4_1106_Vision_Preview).Equals(Model) ||
-           OpenAIAllModelToString(EAllModelEnum::GPT_4O).Equals(Model);
+    return FModelRegistry::Get()->Find(Model).Vision;
 }
 
 FString UOpenAIFuncLib::OpenAIAudioModelToString(EAudioModel Model)
 {
-    switch (Model)
-    {
-        case EAudioModel::Whisper_1: return "whisper-1";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<AudioModelNames>(Model);
 }
 
 FString UOpenAIFuncLib::OpenAITTSModelToString(ETTSModel Model)
 {
-    switch (Model)
-    {
-        case ETTSModel::TTS_1: return "tts-1";
-        case ETTSModel::TTS_1_HD: return "tts-1-hd";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<TTSModelNames>(Model);
 }
 
 FString UOpenAIFuncLib::OpenAIVoiceToString(EVoice Voice)
 {
-    switch (Voice)
-    {
-        case EVoice::Alloy: return "alloy";
-        case EVoice::Echo: return "echo";
-        case EVoice::Fable: return "fable";
-        case EVoice::Nova: return "nova";
-        case EVoice::Onyx: return "onyx";
-        case EVoice::Shimmer: return "shimmer";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<VoiceNames>(Voice);
 }
 
 FString UOpenAIFuncLib::OpenAITTSAudioFormatToString(ETTSAudioFormat Format)
 {
-    switch (Format)
-    {
-        case ETTSAudioFormat::AAC: return "aac";
-        case ETTSAudioFormat::FLAC: return "flac";
-        case ETTSAudioFormat::MP3: return "mp3";
-        case ETTSAudioFormat::OPUS: return "opus";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<TTSAudioFormatNames>(Format);
 }
 
 FString UOpenAIFuncLib::OpenAIImageModelToString(EImageModelEnum Model)
 {
-    switch (Model)
-    {
-        case EImageModelEnum::DALL_E_2: return "dall-e-2";
-        case EImageModelEnum::DALL_E_3: return "dall-e-3";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ImageModelNames>(Model);
 }
 
 EImageModelEnum UOpenAIFuncLib::StringToOpenAIImageModel(const FString& Model)
 {
-    if (Model.Equals("dall-e-2")) return EImageModelEnum::DALL_E_2;
-    if (Model.Equals("dall-e-3")) return EImageModelEnum::DALL_E_3;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown EImageModelEnum: {0}", Model);
-    checkNoEntry();
-
-    return {};
+    return StringToEnum<ImageModelNames>(Model, TEXT("EImageModelEnum"));
 }
 
 FString UOpenAIFuncLib::OpenAIImageSizeDalle2ToString(EImageSizeDalle2 ImageSize)
 {
-    switch (ImageSize)
-    {
-        case EImageSizeDalle2::Size_256x256: return "256x256";
-        case EImageSizeDalle2::Size_512x512: return "512x512";
-        case EImageSizeDalle2::Size_1024x1024: return "1024x1024";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ImageSizeDalle2Names>(ImageSize);
 }
 
 EImageSizeDalle2 UOpenAIFuncLib::StringToOpenAIImageSizeDalle2(const FString& ImageSize)
 {
-    if (ImageSize.Equals("256x256")) return EImageSizeDalle2::Size_256x256;
-    if (ImageSize.Equals("512x512")) return EImageSizeDalle2::Size_512x512;
-    if (ImageSize.Equals("1024x1024")) return EImageSizeDalle2::Size_1024x1024;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown EImageSizeDalle2: {0}", ImageSize);
-    checkNoEntry();
-
-    return {};
+    return StringToEnum<ImageSizeDalle2Names>(ImageSize, TEXT("EImageSizeDalle2"));
 }
 
 FString UOpenAIFuncLib::OpenAIImageSizeDalle3ToString(EImageSizeDalle3 ImageSize)
 {
-    switch (ImageSize)
-    {
-        case EImageSizeDalle3::Size_1024x1024: return "1024x1024";
-        case EImageSizeDalle3::Size_1024x1792: return "1024x1792";
-        case EImageSizeDalle3::Size_1792x1024: return "1792x1024";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ImageSizeDalle3Names>(ImageSize);
 }
 
 EImageSizeDalle3 UOpenAIFuncLib::StringToOpenAIImageSizeDalle3(const FString& ImageSize)
 {
-    if (ImageSize.Equals("1024x1024")) return EImageSizeDalle3::Size_1024x1024;
-    if (ImageSize.Equals("1024x1792")) return EImageSizeDalle3::Size_1024x1792;
-    if (ImageSize.Equals("1792x1024")) return EImageSizeDalle3::Size_1792x1024;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown EImageSizeDalle3: {0}", ImageSize);
-    checkNoEntry();
-
-    return {};
+    return StringToEnum<ImageSizeDalle3Names>(ImageSize, TEXT("EImageSizeDalle3"));
 }
 
 FString UOpenAIFuncLib::OpenAIImageFormatToString(EOpenAIImageFormat ImageFormat)
 {
-    switch (ImageFormat)
-    {
-        case EOpenAIImageFormat::URL: return "url";
-        case EOpenAIImageFormat::B64_JSON: return "b64_json";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ImageFormatNames>(ImageFormat);
 }
 
 EOpenAIImageFormat UOpenAIFuncLib::StringToOpenAIImageFormat(const FString& ImageFormat)
 {
-    if (ImageFormat.Equals("url")) return EOpenAIImageFormat::URL;
-    if (ImageFormat.Equals("b64_json")) return EOpenAIImageFormat::B64_JSON;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown EOpenAIImageFormat: {0}", ImageFormat);
-    checkNoEntry();
-
-    return {};
+    return StringToEnum<ImageFormatNames>(ImageFormat, TEXT("EOpenAIImageFormat"));
 }
 
 FString UOpenAIFuncLib::OpenAIImageQualityToString(EOpenAIImageQuality ImageQuality)
 {
-    switch (ImageQuality)
-    {
-        case EOpenAIImageQuality::HD: return "hd";
-        case EOpenAIImageQuality::Standard: return "standard";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ImageQualityNames>(ImageQuality);
 }
 
 EOpenAIImageQuality UOpenAIFuncLib::StringToOpenAIImageQuality(const FString& ImageQuality)
 {
-    if (ImageQuality.Equals("hd")) return EOpenAIImageQuality::HD;
-    if (ImageQuality.Equals("standard")) return EOpenAIImageQuality::Standard;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown EOpenAIImageQuality: {0}", ImageQuality);
-    checkNoEntry();
-
-    return {};
+    return StringToEnum<ImageQualityNames>(ImageQuality, TEXT("EOpenAIImageQuality"));
 }
 
 FString UOpenAIFuncLib::OpenAIImageStyleToString(EOpenAIImageStyle ImageStyle)
 {
-    switch (ImageStyle)
-    {
-        case EOpenAIImageStyle::Natural: return "natural";
-        case EOpenAIImageStyle::Vivid: return "vivid";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ImageStyleNames>(ImageStyle);
 }
 
 EOpenAIImageStyle UOpenAIFuncLib::StringToOpenAIImageStyle(const FString& ImageStyle)
 {
-    if (ImageStyle.Equals("natural")) return EOpenAIImageStyle::Natural;
-    if (ImageStyle.Equals("vivid")) return EOpenAIImageStyle::Vivid;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown EOpenAIImageStyle: {0}", ImageStyle);
-    checkNoEntry();
-
-    return {};
+    return StringToEnum<ImageStyleNames>(ImageStyle, TEXT("EOpenAIImageStyle"));
 }
 
 FString UOpenAIFuncLib::OpenAIRoleToString(ERole Role)
 {
-    switch (Role)
-    {
-        case ERole::System: return "system";
-        case ERole::User: return "user";
-        case ERole::Assistant: return "assistant";
-        case ERole::Function: return "function";
-        case ERole::Tool: return "tool";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<RoleNames>(Role);
 }
 
 FString UOpenAIFuncLib::OpenAIFinishReasonToString(EOpenAIFinishReason FinishReason)
 {
-    switch (FinishReason)
-    {
-        case EOpenAIFinishReason::Stop: return "stop";
-        case EOpenAIFinishReason::Length: return "length";
-        case EOpenAIFinishReason::Content_Filter: return "content_filter";
-        case EOpenAIFinishReason::Tool_Calls: return "tool_calls";
-        case EOpenAIFinishReason::Null: return "";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<FinishReasonNames>(FinishReason);
 }
 
 EOpenAIFinishReason UOpenAIFuncLib::StringToOpenAIFinishReason(const FString& FinishReason)
 {
-    if (FinishReason.Equals("stop")) return EOpenAIFinishReason::Stop;
-    if (FinishReason.Equals("length")) return EOpenAIFinishReason::Length;
-    if (FinishReason.Equals("content_filter")) return EOpenAIFinishReason::Content_Filter;
-    if (FinishReason.Equals("tool_calls")) return EOpenAIFinishReason::Tool_Calls;
-    if (FinishReason.IsEmpty()) return EOpenAIFinishReason::Null;
-
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown OpenAIFinishReason: {0}", FinishReason);
-    checkNoEntry();
-    return {};
+    return StringToEnum<FinishReasonNames>(FinishReason, TEXT("OpenAIFinishReason"));
 }
 
 ERole UOpenAIFuncLib::StringToOpenAIRole(const FString& Role)
 {
-    if (Role.ToLower().Equals("system")) return ERole::System;
-    if (Role.ToLower().Equals("user")) return ERole::User;
-    if (Role.ToLower().Equals("assistant")) return ERole::Assistant;
-    if (Role.ToLower().Equals("function")) return ERole::Function;
-    if (Role.ToLower().Equals("tool")) return ERole::Tool;
+    return StringToEnum<RoleNames, ESearchCase::IgnoreCase>(Role, TEXT("OpenAIRole"));
+}
 
-    UE_LOGFMT(LogOpenAIFuncLib, Error, "Unknown OpenAIRole: {0}", Role);
-    checkNoEntry();
-    return {};
+TOptional<ERole> UOpenAIFuncLib::FindOpenAIRole(FStringView Role)
+{
+    return TEnumNameTable<RoleNames, ESearchCase::IgnoreCase>::FindValue(Role);
+}
+
+TOptional<EOpenAIFinishReason> UOpenAIFuncLib::FindOpenAIFinishReason(FStringView FinishReason)
+{
+    return TEnumNameTable<FinishReasonNames>::FindValue(FinishReason);
 }
 
 FString UOpenAIFuncLib::OpenAIAudioTranscriptToString(ETranscriptFormat TranscriptFormat)
 {
-    switch (TranscriptFormat)
-    {
-        case ETranscriptFormat::JSON: return "json";
-        case ETranscriptFormat::Text: return "text";
-        case ETranscriptFormat::Str: return "str";
-        case ETranscriptFormat::Verbose_JSON: return "verbose_json";
-        case ETranscriptFormat::Vtt: return "vtt";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<TranscriptFormatNames>(TranscriptFormat);
 }
 
 FString UOpenAIFuncLib::OpenAIEmbeddingsEncodingFormatToString(EEmbeddingsEncodingFormat EmbeddingsEncodingFormat)
 {
-    switch (EmbeddingsEncodingFormat)
-    {
-        case EEmbeddingsEncodingFormat::Float: return "float";
-        case EEmbeddingsEncodingFormat::Base64: return "base64";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<EmbeddingsEncodingFormatNames>(EmbeddingsEncodingFormat);
 }
 
 FString UOpenAIFuncLib::OpenAIChatResponseFormatToString(EChatResponseFormat ChatResponseFormat)
 {
-    switch (ChatResponseFormat)
-    {
-        case EChatResponseFormat::Text: return "text";
-        case EChatResponseFormat::JSON_Object: return "json_object";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<ChatResponseFormatNames>(ChatResponseFormat);
 }
 
 FString UOpenAIFuncLib::OpenAIModelToString(const FOpenAIModel& OpenAIModel)
@@ -374,13 +352,7 @@ FString UOpenAIFuncLib::OpenAIModelToString(const FOpenAIModel& OpenAIModel)
 
 FString UOpenAIFuncLib::OpenAIMessageContentTypeToString(EMessageContentType MessageContentType)
 {
-    switch (MessageContentType)
-    {
-        case EMessageContentType::Text: return "text";
-        case EMessageContentType::Image_URL: return "image_url";
-    }
-    checkNoEntry();
-    return {};
+    return EnumToString<MessageContentTypeNames>(MessageContentType);
 }
 
 FString UOpenAIFuncLib::BoolToString(bool Value)
@@ -391,13 +363,13 @@ FString UOpenAIFuncLib::BoolToString(bool Value)
 FString UOpenAIFuncLib::RemoveWhiteSpaces(const FString& Input)
 {
     FString Result;
-    const TSet<TCHAR> Whitespaces{'\t', '\n', '\r'};
+    Result.Reserve(Input.Len());
 
-    for (const TCHAR& Char : Input)
+    for (const TCHAR Char : Input)
     {
-        if (!Whitespaces.Contains(Char))
+        if (Char != '\t' && Char != '\n' && Char != '\r')
         {
-            Result += Char;
+            Result.AppendChar(Char);
         }
     }
     return Result;
@@ -437,65 +409,27 @@ FString UOpenAIFuncLib::OpenAIModerationsToString(const FModerationResults& Mode
 
 FString UOpenAIFuncLib::OpenAIUploadFilePurposeToString(EUploadFilePurpose UploadFilePurpose)
 {
-    switch (UploadFilePurpose)
-    {
-        case EUploadFilePurpose::Assistants: return "assistants";
-        case EUploadFilePurpose::Vision: return "vision";
-        case EUploadFilePurpose::Batch: return "batch";
-        case EUploadFilePurpose::FineTune: return "fine-tune";
-    }
-
-    checkNoEntry();
-    return {};
+    return EnumToString<UploadFilePurposeNames>(UploadFilePurpose);
 }
 
 FString UOpenAIFuncLib::OpenAIBatchEndpointToString(EBatchEndpoint BatchEndpoint)
 {
-    switch (BatchEndpoint)
-    {
-        case EBatchEndpoint::ChatCompletions: return "/v1/chat/completions";
-        case EBatchEndpoint::Completions: return "/v1/completions";
-        case EBatchEndpoint::Embeddings: return "/v1/embeddings";
-    }
-
-    checkNoEntry();
-    return {};
+    return EnumToString<BatchEndpointNames>(BatchEndpoint);
 }
 
 FString UOpenAIFuncLib::OpenAIBatchCompletionWindowToString(EBatchCompletionWindow BatchCompletionWindow)
 {
-    switch (BatchCompletionWindow)
-    {
-        case EBatchCompletionWindow::Window_24h: return "24h";
-    }
-
-    checkNoEntry();
-    return {};
+    return EnumToString<BatchCompletionWindowNames>(BatchCompletionWindow);
 }
 
 FString UOpenAIFuncLib::OpenAIUploadStatusToString(EUploadStatus UploadStatus)
 {
-    switch (UploadStatus)
-    {
-        case EUploadStatus::Pending: return "pending";
-        case EUploadStatus::Completed: return "completed";
-        case EUploadStatus::Cancelled: return "cancelled";
-    }
-
-    checkNoEntry();
-    return {};
+    return EnumToString<UploadStatusNames>(UploadStatus);
 }
 
 FString UOpenAIFuncLib::OpenAIServiceTierToString(EServiceTier ServiceTier)
 {
-    switch (ServiceTier)
-    {
-        case EServiceTier::Auto: return "auto";
-        case EServiceTier::Default: return "default";
-    }
-
-    checkNoEntry();
-    return {};
+    return EnumToString<ServiceTierNames>(ServiceTier);
 }
 
 EOpenAIResponseError UOpenAIFuncLib::GetErrorCode(const FString& RawError)
@@ -0,0 +1,44 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "IO/AtomicFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+#include "Logging/StructuredLog.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogAtomicFile, All, All);
+
+using namespace OpenAI;
+
+bool AtomicFile::Replace(const FString& FilePath, const FString& TempPath)
+{
+#if PLATFORM_WINDOWS
+    // MoveFileW of the platform file fails if the target exists
+    const FString FullFilePath = FPaths::ConvertRelativePathToFull(FilePath);
+    const FString FullTempPath = FPaths::ConvertRelativePathToFull(TempPath);
+    const bool Replaced = ::MoveFileExW(*FullTempPath, *FullFilePath, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    // rename() replaces the target atomically
+    const bool Replaced = FPlatformFileManager::Get().GetPlatformFile().MoveFile(*FilePath, *TempPath);
+#endif
+    if (!Replaced)
+    {
+        UE_LOGFMT(LogAtomicFile, Error, "Can't replace {0} with {1}", FilePath, TempPath);
+    }
+    return Replaced;
+}
+
+bool AtomicFile::Save(const FString& FilePath, TFunctionRef<bool(const FString&)> Save)
+{
+    const FString TempPath = FilePath + TEXT(".tmp");
+    if (Save(TempPath) && Replace(FilePath, TempPath)) return true;
+
+    IFileManager::Get().Delete(*TempPath);
+    return false;
+}
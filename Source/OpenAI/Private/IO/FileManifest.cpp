@@ -0,0 +1,186 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "IO/FileManifest.h"
+#include "Provider/Types/FileTypes.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Hash/Blake3.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogFileManifest, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int64 HashReadBufferSize = 1024 * 1024;
+}
+
+FFileManifest::FFileManifest(const FString& InFilePath) : FilePath(InFilePath)
+{
+    Load();
+}
+
+FString FFileManifest::DefaultFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAI"), TEXT("FileManifest.json"));
+}
+
+FString FFileManifest::HashFile(const FString& InFilePath)
+{
+    TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*InFilePath));
+    if (!FileHandle)
+    {
+        UE_LOGFMT(LogFileManifest, Error, "Can't open file for hashing: {0}", InFilePath);
+        return {};
+    }
+
+    FBlake3 Hasher;
+    TArray<uint8> Buffer;
+    Buffer.SetNumUninitialized(HashReadBufferSize);
+
+    int64 Remaining = FileHandle->Size();
+    while (Remaining > 0)
+    {
+        const int64 ChunkSize = FMath::Min(Remaining, HashReadBufferSize);
+        if (!FileHandle->Read(Buffer.GetData(), ChunkSize))
+        {
+            UE_LOGFMT(LogFileManifest, Error, "Can't read file for hashing: {0}", InFilePath);
+            return {};
+        }
+        Hasher.Update(Buffer.GetData(), ChunkSize);
+        Remaining -= ChunkSize;
+    }
+
+    return LexToString(Hasher.Finalize());
+}
+
+bool FFileManifest::Find(const FString& Hash, const FString& Purpose, FString& FileId) const
+{
+    FScopeLock Lock(&CriticalSection);
+    const FString* Found = Entries.Find(MakeKey(Hash, Purpose));
+    if (!Found) return false;
+
+    FileId = *Found;
+    return true;
+}
+
+void FFileManifest::Add(const FString& Hash, const FString& Purpose, const FString& FileId)
+{
+    if (Hash.IsEmpty() || FileId.IsEmpty()) return;
+
+    FScopeLock Lock(&CriticalSection);
+    Entries.Add(MakeKey(Hash, Purpose), FileId);
+    Save();
+}
+
+void FFileManifest::RemoveFile(const FString& FileId)
+{
+    FScopeLock Lock(&CriticalSection);
+    const int32 NumBefore = Entries.Num();
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (It.Value().Equals(FileId))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    if (Entries.Num() != NumBefore)
+    {
+        Save();
+    }
+}
+
+void FFileManifest::Reconcile(const TArray<FOpenAIFile>& RemoteFiles)
+{
+    TSet<FString> RemoteFileIds;
+    RemoteFileIds.Reserve(RemoteFiles.Num());
+    for (const FOpenAIFile& File : RemoteFiles)
+    {
+        if (!File.Status.Equals("error") && !File.Status.Equals("deleted"))
+        {
+            RemoteFileIds.Add(File.ID);
+        }
+    }
+
+    FScopeLock Lock(&CriticalSection);
+    const int32 NumBefore = Entries.Num();
+    for (auto It = Entries.CreateIterator(); It; ++It)
+    {
+        if (!RemoteFileIds.Contains(It.Value()))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    if (Entries.Num() != NumBefore)
+    {
+        UE_LOGFMT(LogFileManifest, Display, "{0} file(s) are not on the server anymore", NumBefore - Entries.Num());
+        Save();
+    }
+}
+
+int32 FFileManifest::Num() const
+{
+    FScopeLock Lock(&CriticalSection);
+    return Entries.Num();
+}
+
+void FFileManifest::Reset()
+{
+    FScopeLock Lock(&CriticalSection);
+    Entries.Reset();
+    Save();
+}
+
+bool FFileManifest::Load()
+{
+    FScopeLock Lock(&CriticalSection);
+    Entries.Reset();
+
+    FString Content;
+    if (!FPaths::FileExists(FilePath) || !FFileHelper::LoadFileToString(Content, *FilePath)) return false;
+
+    TSharedPtr<FJsonObject> Json;
+    if (!UJsonFuncLib::StringToJson(Content, Json) || !Json.IsValid())
+    {
+        UE_LOGFMT(LogFileManifest, Error, "Can't parse file manifest: {0}", FilePath);
+        return false;
+    }
+
+    for (const auto& [Key, Value] : Json->Values)
+    {
+        FString FileId;
+        if (Value.IsValid() && Value->TryGetString(FileId))
+        {
+            Entries.Add(Key, FileId);
+        }
+    }
+    return true;
+}
+
+bool FFileManifest::Save() const
+{
+    FScopeLock Lock(&CriticalSection);
+
+    TSharedPtr<FJsonObject> Json = MakeShared<FJsonObject>();
+    for (const auto& [Key, FileId] : Entries)
+    {
+        Json->SetStringField(Key, FileId);
+    }
+
+    FString Content;
+    const auto Writer = TJsonWriterFactory<>::Create(&Content);
+    if (!FJsonSerializer::Serialize(Json.ToSharedRef(), Writer) || !FFileHelper::SaveStringToFile(Content, *FilePath))
+    {
+        UE_LOGFMT(LogFileManifest, Error, "Can't save file manifest: {0}", FilePath);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,160 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "IO/MappedFile.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Async/ParallelFor.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMappedFile, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int64 MinSplitBlockSize = 1024 * 1024;
+constexpr int32 MaxSplitBlocks = 256;
+
+bool IsWhiteSpace(uint8 Char)
+{
+    return Char == ' ' || Char == '\t' || Char == '\r' || Char == '\n';
+}
+}  // namespace
+
+FMappedFile::~FMappedFile()
+{
+    Close();
+}
+
+bool FMappedFile::Open(const FString& FilePath)
+{
+    Close();
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    const int64 FileSize = PlatformFile.FileSize(*FilePath);
+    if (FileSize < 0)
+    {
+        UE_LOGFMT(LogMappedFile, Error, "File doesn't exist: {0}", FilePath);
+        return false;
+    }
+
+    if (FileSize == 0)
+    {
+        bOpened = true;
+        return true;
+    }
+
+    IPlatformFile::FOpenMappedResult MappedResult = PlatformFile.OpenMappedEx(*FilePath);
+    if (MappedResult.HasValue())
+    {
+        Handle = MappedResult.StealValue();
+        Region.Reset(Handle->MapRegion(0, FileSize));
+    }
+
+    if (Region.IsValid())
+    {
+        Data = Region->GetMappedPtr();
+        Size = Region->GetMappedSize();
+    }
+    else
+    {
+        // some platforms (and pak files) don't support mapping, read the file instead
+        Handle.Reset();
+        if (!FFileHelper::LoadFileToArray(Buffer, *FilePath))
+        {
+            UE_LOGFMT(LogMappedFile, Error, "Can't read file: {0}", FilePath);
+            return false;
+        }
+        Data = Buffer.GetData();
+        Size = Buffer.Num();
+    }
+
+    bOpened = true;
+    return true;
+}
+
+void FMappedFile::OpenFromBuffer(TArray64<uint8>&& InBuffer)
+{
+    Close();
+
+    Buffer = MoveTemp(InBuffer);
+    Data = Buffer.GetData();
+    Size = Buffer.Num();
+    bOpened = true;
+}
+
+void FMappedFile::OpenFromString(const FString& Content)
+{
+    const FTCHARToUTF8 Converter(*Content, Content.Len());
+
+    TArray64<uint8> UTF8Buffer;
+    UTF8Buffer.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+    OpenFromBuffer(MoveTemp(UTF8Buffer));
+}
+
+void FMappedFile::Close()
+{
+    // region must be released before the handle that owns the mapping
+    Region.Reset();
+    Handle.Reset();
+    Buffer.Empty();
+
+    Data = nullptr;
+    Size = 0;
+    bOpened = false;
+}
+
+void FMappedFile::SplitLines(TArray<FLine>& Lines) const
+{
+    Lines.Reset();
+    if (Size == 0) return;
+
+    // every block collects the line ends that fall into it, blocks are merged in file order afterwards
+    const int32 NumBlocks = static_cast<int32>(FMath::Clamp<int64>(Size / MinSplitBlockSize, 1, MaxSplitBlocks));
+    const int64 BlockSize = FMath::DivideAndRoundUp<int64>(Size, NumBlocks);
+
+    TArray<TArray<int64>> LineEnds;
+    LineEnds.SetNum(NumBlocks);
+    ParallelFor(NumBlocks,
+        [&](int32 BlockIndex)
+        {
+            const int64 Begin = BlockIndex * BlockSize;
+            const int64 End = FMath::Min(Begin + BlockSize, Size);
+            for (int64 Index = Begin; Index < End; ++Index)
+            {
+                if (Data[Index] == '\n')
+                {
+                    LineEnds[BlockIndex].Add(Index);
+                }
+            }
+        });
+
+    int32 NumLineEnds{0};
+    for (const auto& BlockLineEnds : LineEnds)
+    {
+        NumLineEnds += BlockLineEnds.Num();
+    }
+    Lines.Reserve(NumLineEnds + 1);
+
+    const auto AddLine = [&](int64 Begin, int64 End)
+    {
+        while (End > Begin && IsWhiteSpace(Data[End - 1])) --End;
+        while (Begin < End && IsWhiteSpace(Data[Begin])) ++Begin;
+        if (End > Begin)
+        {
+            Lines.Add({Begin, static_cast<int32>(End - Begin)});
+        }
+    };
+
+    int64 LineBegin{0};
+    for (const auto& BlockLineEnds : LineEnds)
+    {
+        for (const int64 LineEnd : BlockLineEnds)
+        {
+            AddLine(LineBegin, LineEnd);
+            LineBegin = LineEnd + 1;
+        }
+    }
+    AddLine(LineBegin, Size);
+}
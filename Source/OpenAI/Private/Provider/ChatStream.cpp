@@ -0,0 +1,391 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Provider/ChatStream.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Serialization/JsonReader.h"
+
+using namespace OpenAI;
+
+namespace
+{
+enum class EScope : uint8
+{
+    Chunk,
+    Choices,
+    Choice,
+    Delta,
+    ToolCalls,
+    ToolCall,
+    Function,
+    Skip
+};
+
+EScope EnterScope(TConstArrayView<EScope> Scopes, const FString& Key)
+{
+    if (Scopes.IsEmpty()) return EScope::Chunk;
+
+    switch (Scopes.Last())
+    {
+        case EScope::Chunk: return Key.Equals(TEXT("choices")) ? EScope::Choices : EScope::Skip;
+        case EScope::Choices: return EScope::Choice;
+        case EScope::Choice: return Key.Equals(TEXT("delta")) ? EScope::Delta : EScope::Skip;
+        case EScope::Delta: return Key.Equals(TEXT("tool_calls")) ? EScope::ToolCalls : EScope::Skip;
+        case EScope::ToolCalls: return EScope::ToolCall;
+        case EScope::ToolCall: return Key.Equals(TEXT("function")) ? EScope::Function : EScope::Skip;
+        default: return EScope::Skip;
+    }
+}
+
+FChatStreamText AppendText(FString& Text, const FString& Delta)
+{
+    const FChatStreamText Part{Text.Len(), Delta.Len()};
+    Text.Append(Delta);
+    return Part;
+}
+
+FString GetText(const FString& Text, const FChatStreamText& Part)
+{
+    return Text.Mid(Part.Start, Part.Len);
+}
+
+void SetOnce(FString& Field, const FString& Value)
+{
+    if (Field.IsEmpty())
+    {
+        Field = Value;
+    }
+}
+}  // namespace
+
+int32 FChatStream::Parse(FStringView Content, bool bComplete)
+{
+    int32 NumParsed = 0;
+    while (ParsedLength < Content.Len())
+    {
+        const FStringView Rest = Content.RightChop(ParsedLength);
+        int32 LineEnd = INDEX_NONE;
+        if (!Rest.FindChar(TEXT('\n'), LineEnd))
+        {
+            if (!bComplete) break;
+            LineEnd = Rest.Len();
+        }
+
+        ParsedLength += FMath::Min(LineEnd + 1, Rest.Len());
+        NumParsed += ParseLine(Rest.Left(LineEnd)) ? 1 : 0;
+    }
+    return NumParsed;
+}
+
+int32 FChatStream::ParseUtf8(TConstArrayView<uint8> Content, bool bComplete, FString* NewLines)
+{
+    // a line feed is never a part of a multibyte character, so the complete lines are cut at the last one
+    int32 End = Content.Num();
+    if (!bComplete)
+    {
+        while (End > ParsedBytes && Content[End - 1] != '\n')
+        {
+            --End;
+        }
+    }
+    if (End <= ParsedBytes) return 0;
+
+    const FUTF8ToTCHAR Lines(reinterpret_cast<const ANSICHAR*>(Content.GetData() + ParsedBytes), End - ParsedBytes);
+    ParsedBytes = End;
+    if (NewLines)
+    {
+        *NewLines = FString(Lines.Length(), Lines.Get());
+    }
+    return ParseLines(FStringView(Lines.Get(), Lines.Length()));
+}
+
+int32 FChatStream::ParseLines(FStringView Lines)
+{
+    int32 NumParsed = 0;
+    while (!Lines.IsEmpty())
+    {
+        int32 LineEnd = INDEX_NONE;
+        if (!Lines.FindChar(TEXT('\n'), LineEnd))
+        {
+            LineEnd = Lines.Len();
+        }
+        NumParsed += ParseLine(Lines.Left(LineEnd)) ? 1 : 0;
+        Lines.RightChopInline(LineEnd + 1);
+    }
+    return NumParsed;
+}
+
+bool FChatStream::ParseLine(FStringView Line)
+{
+    Line = Line.TrimStartAndEnd();
+    if (Line.StartsWith(TEXT("data:")))
+    {
+        Line = Line.RightChop(5).TrimStart();
+    }
+    // empty lines separate the events, colons start the comments
+    if (bDone || Line.IsEmpty() || Line.StartsWith(TEXT(':'))) return false;
+
+    if (Line.Equals(TEXT("[DONE]")))
+    {
+        bDone = true;
+        return false;
+    }
+
+    const int32 ChunkStart = Deltas.Num();
+    ChunkStarts.Add(ChunkStart);
+    if (!ParseChunk(Line) && Deltas.Num() == ChunkStart)
+    {
+        ChunkStarts.Pop();
+        return false;
+    }
+    return true;
+}
+
+bool FChatStream::ParseChunk(FStringView Json)
+{
+    const auto Reader = TJsonReaderFactory<>::CreateFromView(Json);
+    TArray<EScope, TInlineAllocator<8>> Scopes;
+    bool bHasOptInFields{false};
+
+    EJsonNotation Notation{EJsonNotation::Null};
+    while (Reader->ReadNext(Notation))
+    {
+        const FString& Key = Reader->GetIdentifier();
+        const EScope Scope = Scopes.IsEmpty() ? EScope::Skip : Scopes.Last();
+        switch (Notation)
+        {
+            case EJsonNotation::ObjectStart:
+            case EJsonNotation::ArrayStart:
+            {
+                bHasOptInFields |= (Scope == EScope::Choice && Key.Equals(TEXT("logprobs"))) ||
+                                   (Scope == EScope::Chunk && Key.Equals(TEXT("usage")));
+                const EScope NewScope = EnterScope(Scopes, Key);
+                if (NewScope == EScope::ToolCall)
+                {
+                    if (!Pending.ToolCalls.IsValidIndex(Pending.NumToolCalls))
+                    {
+                        Pending.ToolCalls.AddDefaulted();
+                    }
+                    ++Pending.NumToolCalls;
+                }
+                Scopes.Add(NewScope);
+                break;
+            }
+
+            case EJsonNotation::ObjectEnd:
+            case EJsonNotation::ArrayEnd:
+                if (Scopes.Pop() == EScope::Choice)
+                {
+                    CommitChoice();
+                }
+                break;
+
+            case EJsonNotation::Number:
+                if (Scope == EScope::Choice && Key.Equals(TEXT("index")))
+                {
+                    Pending.Index = static_cast<int32>(Reader->GetValueAsNumber());
+                }
+                else if (Scope == EScope::ToolCall && Key.Equals(TEXT("index")))
+                {
+                    Pending.ToolCalls[Pending.NumToolCalls - 1].Index = static_cast<int32>(Reader->GetValueAsNumber());
+                }
+                else if (Scope == EScope::Chunk && Key.Equals(TEXT("created")) && Created == 0)
+                {
+                    Created = static_cast<int32>(Reader->GetValueAsNumber());
+                }
+                break;
+
+            case EJsonNotation::String:
+            {
+                const FString& Value = Reader->GetValueAsString();
+                if (Scope == EScope::Delta)
+                {
+                    if (Key.Equals(TEXT("content"))) Pending.Content.Append(Value);
+                    else if (Key.Equals(TEXT("refusal"))) Pending.Refusal.Append(Value);
+                    else if (Key.Equals(TEXT("role"))) Pending.Role = UOpenAIFuncLib::FindOpenAIRole(Value);
+                }
+                else if (Scope == EScope::Choice && Key.Equals(TEXT("finish_reason")))
+                {
+                    Pending.FinishReason = UOpenAIFuncLib::FindOpenAIFinishReason(Value).Get(EOpenAIFinishReason::Null);
+                }
+                else if (Scope == EScope::ToolCall || Scope == EScope::Function)
+                {
+                    FPendingToolCall& ToolCall = Pending.ToolCalls[Pending.NumToolCalls - 1];
+                    if (Key.Equals(TEXT("id"))) ToolCall.ID.Append(Value);
+                    else if (Key.Equals(TEXT("type"))) ToolCall.Type.Append(Value);
+                    else if (Key.Equals(TEXT("name"))) ToolCall.Name.Append(Value);
+                    else if (Key.Equals(TEXT("arguments"))) ToolCall.Arguments.Append(Value);
+                }
+                else if (Scope == EScope::Chunk)
+                {
+                    // the same in every chunk of the stream
+                    if (Key.Equals(TEXT("id"))) SetOnce(ID, Value);
+                    else if (Key.Equals(TEXT("model"))) SetOnce(Model, Value);
+                    else if (Key.Equals(TEXT("object"))) SetOnce(Object, Value);
+                    else if (Key.Equals(TEXT("system_fingerprint"))) SetOnce(SystemFingerprint, Value);
+                    else if (Key.Equals(TEXT("service_tier"))) SetOnce(ServiceTier, Value);
+                }
+                break;
+            }
+
+            default: break;
+        }
+    }
+
+    if (Notation == EJsonNotation::Error || !Reader->GetErrorMessage().IsEmpty())
+    {
+        ResetPendingChoice();
+        return false;
+    }
+
+    if (bHasOptInFields)
+    {
+        FChatCompletionStreamResponse Response;
+        if (UJsonFuncLib::ParseJSONToStruct(FString(Json), &Response))
+        {
+            if (Response.Usage.Total_Tokens > 0)
+            {
+                Usage = Response.Usage;
+                UsageChunk = ChunkStarts.Num() - 1;
+            }
+            for (const FChatStreamChoice& Choice : Response.Choices)
+            {
+                for (int32 DeltaIndex = ChunkStarts.Last(); DeltaIndex < Deltas.Num(); ++DeltaIndex)
+                {
+                    if (Deltas[DeltaIndex].Choice == Choice.Index)
+                    {
+                        LogProbs.Add(DeltaIndex, Choice.Logprobs);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void FChatStream::CommitChoice()
+{
+    // indices of the choices and the tool calls are small, the limit keeps a malformed chunk from allocating
+    constexpr int32 MaxIndex = 128;
+    if (Pending.Index >= 0 && Pending.Index < MaxIndex)
+    {
+        if (!Messages.IsValidIndex(Pending.Index))
+        {
+            Messages.SetNum(Pending.Index + 1);
+        }
+        FChatStreamMessage& Message = Messages[Pending.Index];
+
+        FChatStreamDelta& Delta = Deltas.AddDefaulted_GetRef();
+        Delta.Choice = Pending.Index;
+        Delta.Content = AppendText(Message.Content, Pending.Content);
+        Delta.Refusal = AppendText(Message.Refusal, Pending.Refusal);
+        if (Pending.Role.IsSet())
+        {
+            Message.Role = Pending.Role.GetValue();
+            Delta.Role = Pending.Role;
+        }
+        if (Pending.FinishReason != EOpenAIFinishReason::Null)
+        {
+            Message.FinishReason = Pending.FinishReason;
+            Delta.FinishReason = Pending.FinishReason;
+        }
+
+        for (int32 Index = 0; Index < Pending.NumToolCalls; ++Index)
+        {
+            const FPendingToolCall& PendingToolCall = Pending.ToolCalls[Index];
+            if (PendingToolCall.Index < 0 || PendingToolCall.Index >= MaxIndex) continue;
+
+            if (!Message.ToolCalls.IsValidIndex(PendingToolCall.Index))
+            {
+                Message.ToolCalls.SetNum(PendingToolCall.Index + 1);
+            }
+            FToolCalls& ToolCall = Message.ToolCalls[PendingToolCall.Index];
+            if (!PendingToolCall.Type.IsEmpty())
+            {
+                ToolCall.Type = PendingToolCall.Type;
+            }
+
+            // every next tool call of the chunk gets its own delta
+            FChatStreamDelta& ToolCallDelta = Index == 0 ? Delta : Deltas.AddDefaulted_GetRef();
+            ToolCallDelta.Choice = Pending.Index;
+            ToolCallDelta.ToolCall = PendingToolCall.Index;
+            ToolCallDelta.ToolCallID = AppendText(ToolCall.ID, PendingToolCall.ID);
+            ToolCallDelta.FunctionName = AppendText(ToolCall.Function.Name, PendingToolCall.Name);
+            ToolCallDelta.Arguments = AppendText(ToolCall.Function.Arguments, PendingToolCall.Arguments);
+        }
+    }
+
+    ResetPendingChoice();
+}
+
+void FChatStream::ResetPendingChoice()
+{
+    Pending.Index = 0;
+    Pending.Content.Reset();
+    Pending.Refusal.Reset();
+    for (int32 Index = 0; Index < Pending.NumToolCalls; ++Index)
+    {
+        FPendingToolCall& ToolCall = Pending.ToolCalls[Index];
+        ToolCall.Index = 0;
+        ToolCall.ID.Reset();
+        ToolCall.Type.Reset();
+        ToolCall.Name.Reset();
+        ToolCall.Arguments.Reset();
+    }
+    Pending.NumToolCalls = 0;
+    Pending.Role.Reset();
+    Pending.FinishReason = EOpenAIFinishReason::Null;
+}
+
+TArray<FChatCompletionStreamResponse> FChatStream::ToResponses() const
+{
+    TArray<FChatCompletionStreamResponse> Responses;
+    Responses.Reserve(ChunkStarts.Num());
+    for (int32 Chunk = 0; Chunk < ChunkStarts.Num(); ++Chunk)
+    {
+        FChatCompletionStreamResponse& Response = Responses.AddDefaulted_GetRef();
+        Response.ID = ID;
+        Response.Created = Created;
+        Response.Model = Model;
+        Response.Object = Object;
+        Response.System_Fingerprint = SystemFingerprint;
+        Response.Service_Tier = ServiceTier;
+        if (Chunk == UsageChunk)
+        {
+            Response.Usage = Usage;
+        }
+
+        const int32 ChunkEnd = ChunkStarts.IsValidIndex(Chunk + 1) ? ChunkStarts[Chunk + 1] : Deltas.Num();
+        for (int32 DeltaIndex = ChunkStarts[Chunk]; DeltaIndex < ChunkEnd; ++DeltaIndex)
+        {
+            const FChatStreamDelta& Delta = Deltas[DeltaIndex];
+            const FChatStreamMessage& Message = Messages[Delta.Choice];
+
+            FChatStreamChoice& Choice = Response.Choices.AddDefaulted_GetRef();
+            Choice.Index = Delta.Choice;
+            Choice.Delta.Content = GetText(Message.Content, Delta.Content);
+            Choice.Delta.Refusal = GetText(Message.Refusal, Delta.Refusal);
+            if (Delta.Role.IsSet())
+            {
+                Choice.Delta.Role = UOpenAIFuncLib::OpenAIRoleToString(Delta.Role.GetValue());
+            }
+            Choice.Finish_Reason = UOpenAIFuncLib::OpenAIFinishReasonToString(Delta.FinishReason);
+            if (const FLogProbs* ChoiceLogProbs = LogProbs.Find(DeltaIndex))
+            {
+                Choice.Logprobs = *ChoiceLogProbs;
+            }
+
+            if (Delta.ToolCall != INDEX_NONE)
+            {
+                const FToolCalls& ToolCall = Message.ToolCalls[Delta.ToolCall];
+                Choice.Delta.Tool_Calls.Index = Delta.ToolCall;
+                Choice.Delta.Tool_Calls.ID = GetText(ToolCall.ID, Delta.ToolCallID);
+                Choice.Delta.Tool_Calls.Type = ToolCall.Type;
+                Choice.Delta.Tool_Calls.Function.Name = GetText(ToolCall.Function.Name, Delta.FunctionName);
+                Choice.Delta.Tool_Calls.Function.Arguments = GetText(ToolCall.Function.Arguments, Delta.Arguments);
+            }
+        }
+    }
+    return Responses;
+}
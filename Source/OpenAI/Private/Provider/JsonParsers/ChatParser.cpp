@@ -5,13 +5,37 @@
 #include "Provider/JsonParsers/ChatParser.h"
 #include "JsonObjectConverter.h"
 #include "FuncLib/JsonFuncLib.h"
-#include "FuncLib/OpenAIFuncLib.h"
+#include "Provider/ModelRegistry.h"
+#include "Hash/xxhash.h"
 
 using namespace OpenAI;
 
 namespace
 {
-void CleanFieldsThatCantBeEmpty(const FChatCompletion& ChatCompletion, TSharedPtr<FJsonObject>& Json)
+void CleanMessageFieldsThatCantBeEmpty(const FMessage& Message, const TSharedPtr<FJsonObject>& MessageObj)
+{
+    if (!Message.ContentArray.IsEmpty())
+    {
+        auto Content = MessageObj->GetArrayField(TEXT("ContentArray"));
+
+        for (int32 j = 0; j < Content.Num(); ++j)
+        {
+            TSharedPtr<FJsonObject> MessageContent = Content[j]->AsObject();
+            if (MessageContent->GetStringField(TEXT("Type")).Equals("text"))
+            {
+                MessageContent->RemoveField(TEXT("Image_URL"));
+            }
+            else
+            {
+                MessageContent->RemoveField(TEXT("Text"));
+            }
+        }
+        MessageObj->SetArrayField(TEXT("Content"), Content);
+        MessageObj->RemoveField(TEXT("ContentArray"));
+    }
+}
+
+void CleanCompletionFieldsThatCantBeEmpty(const FChatCompletion& ChatCompletion, TSharedPtr<FJsonObject>& Json)
 {
     if (ChatCompletion.Tool_Choice.Function.Name.IsEmpty())
     {
@@ -23,7 +47,7 @@ void CleanFieldsThatCantBeEmpty(const FChatCompletion& ChatCompletion, TSharedPt
         Json->RemoveField(TEXT("Logit_Bias"));
     }
 
-    if (ChatCompletion.Model == UOpenAIFuncLib::OpenAIAllModelToString(EAllModelEnum::GPT_4_Vision_Preview))
+    if (!FModelRegistry::Get()->Find(ChatCompletion.Model).Response_Format)
     {
         Json->RemoveField(TEXT("Response_Format"));
     }
@@ -32,34 +56,118 @@ void CleanFieldsThatCantBeEmpty(const FChatCompletion& ChatCompletion, TSharedPt
     {
         Json->RemoveField(TEXT("Stream_Options"));
     }
+}
+
+void CleanFieldsThatCantBeEmpty(const FChatCompletion& ChatCompletion, TSharedPtr<FJsonObject>& Json)
+{
+    CleanCompletionFieldsThatCantBeEmpty(ChatCompletion, Json);
 
     for (int32 i = 0; i < ChatCompletion.Messages.Num(); ++i)
     {
         const auto& Message = ChatCompletion.Messages[i];
         auto& MessageObj = Json->GetArrayField(TEXT("Messages"))[i]->AsObject();
+        CleanMessageFieldsThatCantBeEmpty(Message, MessageObj);
+    }
+}
 
-        if (!Message.ContentArray.IsEmpty())
+FString JsonToRequestString(const TSharedPtr<FJsonObject>& Json)
+{
+    FString TransformedString;
+    UJsonFuncLib::JsonToString(Json, TransformedString);
+
+    TransformedString = UJsonFuncLib::CleanUpFunctionsObject(TransformedString);
+    TransformedString = UJsonFuncLib::RemoveOptionalValuesThatNotSet(TransformedString);
+
+    return TransformedString;
+}
+
+/**
+  All fields of the completion except the messages.
+*/
+TSharedPtr<FJsonObject> CompletionWithoutMessagesToJsonObject(const FChatCompletion& ChatCompletion)
+{
+    TSharedPtr<FJsonObject> Json = MakeShared<FJsonObject>();
+    for (TFieldIterator<FProperty> It(FChatCompletion::StaticStruct()); It; ++It)
+    {
+        if (It->GetFName() == GET_MEMBER_NAME_CHECKED(FChatCompletion, Messages)) continue;
+
+        const TSharedPtr<FJsonValue> Value =
+            FJsonObjectConverter::UPropertyToJsonValue(*It, It->ContainerPtrToValuePtr<void>(&ChatCompletion));
+        if (Value.IsValid())
         {
-            auto Content = MessageObj->GetArrayField(TEXT("ContentArray"));
+            Json->SetField(FJsonObjectConverter::StandardizeCase(It->GetName()), Value);
+        }
+    }
+    return Json;
+}
+
+void UpdateHash(FXxHash128Builder& Builder, const FString& String)
+{
+    const int32 Length = String.Len();
+    Builder.Update(&Length, sizeof(Length));
+    Builder.Update(*String, Length * sizeof(TCHAR));
+}
+}  // namespace
 
-            for (int32 j = 0; j < Content.Num(); ++j)
+const FString& FChatMessageJsonCache::FindOrAdd(const FMessage& Message)
+{
+    FFragment& Fragment = Fragments.FindOrAdd(HashMessage(Message));
+    if (Fragment.Json.IsEmpty())
+    {
+        Fragment.Json = ChatParser::MessageToJsonRepresentation(Message);
+    }
+    Fragment.LastUsed = Generation;
+    return Fragment.Json;
+}
+
+void FChatMessageJsonCache::Trim()
+{
+    if (Fragments.Num() > Capacity)
+    {
+        for (auto It = Fragments.CreateIterator(); It; ++It)
+        {
+            if (It.Value().LastUsed != Generation)
             {
-                TSharedPtr<FJsonObject> MessageContent = Content[j]->AsObject();
-                if (MessageContent->GetStringField(TEXT("Type")).Equals("text"))
-                {
-                    MessageContent->RemoveField(TEXT("Image_URL"));
-                }
-                else
-                {
-                    MessageContent->RemoveField(TEXT("Text"));
-                }
+                It.RemoveCurrent();
             }
-            MessageObj->SetArrayField(TEXT("Content"), Content);
-            MessageObj->RemoveField(TEXT("ContentArray"));
         }
     }
+    ++Generation;
+}
+
+TTuple<uint64, uint64> FChatMessageJsonCache::HashMessage(const FMessage& Message)
+{
+    FXxHash128Builder Builder;
+    UpdateHash(Builder, Message.Role);
+    UpdateHash(Builder, Message.Content);
+    UpdateHash(Builder, Message.Name.IsSet ? Message.Name.Value : FString{});
+    UpdateHash(Builder, Message.Tool_Call_ID.IsSet ? Message.Tool_Call_ID.Value : FString{});
+    const uint8 Flags = (Message.Name.IsSet ? 1 : 0) | (Message.Tool_Call_ID.IsSet ? 2 : 0);
+    Builder.Update(&Flags, sizeof(Flags));
+
+    const int32 NumContents = Message.ContentArray.Num();
+    Builder.Update(&NumContents, sizeof(NumContents));
+    for (const FMessageContent& Content : Message.ContentArray)
+    {
+        UpdateHash(Builder, Content.Type);
+        UpdateHash(Builder, Content.Text);
+        UpdateHash(Builder, Content.Image_URL.URL);
+        UpdateHash(Builder, Content.Image_URL.Detail);
+    }
+
+    const int32 NumToolCalls = Message.Tool_Calls.Num();
+    Builder.Update(&NumToolCalls, sizeof(NumToolCalls));
+    for (const FToolCalls& ToolCall : Message.Tool_Calls)
+    {
+        UpdateHash(Builder, ToolCall.ID);
+        UpdateHash(Builder, ToolCall.Type);
+        UpdateHash(Builder, ToolCall.Function.Name);
+        UpdateHash(Builder, ToolCall.Function.Arguments);
+    }
+
+    const FXxHash128 Hash = Builder.Finalize();
+    return MakeTuple(Hash.HashLow, Hash.HashHigh);
 }
-}  // namespace
 
 FString ChatParser::ChatCompletionToJsonRepresentation(const FChatCompletion& ChatCompletion)
 {
@@ -67,13 +175,47 @@ FString ChatParser::ChatCompletionToJsonRepresentation(const FChatCompletion& Ch
     UJsonFuncLib::RemoveEmptyArrays(Json);
     CleanFieldsThatCantBeEmpty(ChatCompletion, Json);
 
-    FString TransformedString;
-    UJsonFuncLib::JsonToString(Json, TransformedString);
+    return JsonToRequestString(Json);
+}
 
-    TransformedString = UJsonFuncLib::CleanUpFunctionsObject(TransformedString);
-    TransformedString = UJsonFuncLib::RemoveOptionalValuesThatNotSet(TransformedString);
+FString ChatParser::ChatCompletionToJsonRepresentation(const FChatCompletion& ChatCompletion, FChatMessageJsonCache& Cache)
+{
+    TSharedPtr<FJsonObject> Json = CompletionWithoutMessagesToJsonObject(ChatCompletion);
+    UJsonFuncLib::RemoveEmptyArrays(Json);
+    CleanCompletionFieldsThatCantBeEmpty(ChatCompletion, Json);
 
-    return TransformedString;
+    const FString CompletionString = JsonToRequestString(Json);
+    // the messages are appended as the last field of the object
+    const int32 ObjectEnd = CompletionString.Find(TEXT("}"), ESearchCase::CaseSensitive, ESearchDir::FromEnd);
+    if (ChatCompletion.Messages.IsEmpty() || ObjectEnd == INDEX_NONE) return CompletionString;
+
+    FString Output = CompletionString.Left(ObjectEnd).TrimEnd();
+    if (!Output.EndsWith(TEXT("{")))
+    {
+        Output.AppendChar(',');
+    }
+    Output.Append(TEXT("\"messages\":["));
+    for (int32 Index = 0; Index < ChatCompletion.Messages.Num(); ++Index)
+    {
+        if (Index > 0)
+        {
+            Output.AppendChar(',');
+        }
+        Output.Append(Cache.FindOrAdd(ChatCompletion.Messages[Index]));
+    }
+    Output.Append(TEXT("]}"));
+
+    Cache.Trim();
+    return Output;
+}
+
+FString ChatParser::MessageToJsonRepresentation(const FMessage& Message)
+{
+    TSharedPtr<FJsonObject> Json = FJsonObjectConverter::UStructToJsonObject(Message);
+    UJsonFuncLib::RemoveEmptyArrays(Json);
+    CleanMessageFieldsThatCantBeEmpty(Message, Json);
+
+    return JsonToRequestString(Json);
 }
 
 bool ChatParser::CleanChunkResponseString(FString& IncomeString, bool& LastString)
@@ -0,0 +1,352 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Provider/JsonParsers/EmbeddingParser.h"
+#include "Misc/Base64.h"
+
+using namespace OpenAI;
+
+namespace
+{
+// powers of ten that are exact in double
+constexpr double ExactPowersOf10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+    1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr int32 MaxExactPowerOf10 = UE_ARRAY_COUNT(ExactPowersOf10) - 1;
+constexpr uint64 MaxExactMantissa = 1ull << 53;
+constexpr int32 MaxMantissaDigits = 19;
+
+/**
+  Minimal JSON reader over the response buffer.
+*/
+class FJsonScanner
+{
+public:
+    explicit FJsonScanner(FStringView Content) : Cur(Content.GetData()), End(Content.GetData() + Content.Len()) {}
+
+    bool Consume(TCHAR Char)
+    {
+        SkipWhitespace();
+        if (Cur >= End || *Cur != Char) return false;
+        ++Cur;
+        return true;
+    }
+
+    bool Peek(TCHAR Char)
+    {
+        SkipWhitespace();
+        return Cur < End && *Cur == Char;
+    }
+
+    bool IsAtEnd()
+    {
+        SkipWhitespace();
+        return Cur >= End;
+    }
+
+    /**
+      View of the raw string between the quotes, escape sequences are kept as is.
+    */
+    bool ReadStringView(FStringView& View, bool& HasEscapes)
+    {
+        if (!Consume('"')) return false;
+
+        HasEscapes = false;
+        const TCHAR* Start = Cur;
+        while (Cur < End && *Cur != '"')
+        {
+            if (*Cur == '\\')
+            {
+                HasEscapes = true;
+                ++Cur;
+            }
+            ++Cur;
+        }
+        if (Cur >= End) return false;
+
+        View = FStringView(Start, static_cast<int32>(Cur - Start));
+        ++Cur;
+        return true;
+    }
+
+    bool ReadString(FString& String)
+    {
+        FStringView View;
+        bool HasEscapes;
+        if (!ReadStringView(View, HasEscapes)) return false;
+
+        String = HasEscapes ? Unescape(View) : FString(View);
+        return true;
+    }
+
+    bool ReadNumber(double& Number)
+    {
+        SkipWhitespace();
+        const TCHAR* Start = Cur;
+
+        const bool Negative = Cur < End && *Cur == '-';
+        if (Negative) ++Cur;
+
+        uint64 Mantissa{0};
+        int32 Digits{0};
+        int32 Exponent{0};
+        const TCHAR* DigitsStart = Cur;
+        while (Cur < End && FChar::IsDigit(*Cur))
+        {
+            if (Digits < MaxMantissaDigits)
+            {
+                Mantissa = Mantissa * 10 + (*Cur - '0');
+                if (Mantissa > 0) ++Digits;
+            }
+            else
+            {
+                ++Exponent;
+            }
+            ++Cur;
+        }
+        if (Cur < End && *Cur == '.')
+        {
+            ++Cur;
+            while (Cur < End && FChar::IsDigit(*Cur))
+            {
+                if (Digits < MaxMantissaDigits)
+                {
+                    Mantissa = Mantissa * 10 + (*Cur - '0');
+                    if (Mantissa > 0) ++Digits;
+                    --Exponent;
+                }
+                ++Cur;
+            }
+        }
+        if (Cur == DigitsStart) return false;
+
+        if (Cur < End && (*Cur == 'e' || *Cur == 'E'))
+        {
+            ++Cur;
+            const bool NegativeExponent = Cur < End && *Cur == '-';
+            if (Cur < End && (*Cur == '-' || *Cur == '+')) ++Cur;
+
+            int32 ExponentValue{0};
+            while (Cur < End && FChar::IsDigit(*Cur))
+            {
+                ExponentValue = FMath::Min(ExponentValue * 10 + (*Cur - '0'), 100000);
+                ++Cur;
+            }
+            Exponent += NegativeExponent ? -ExponentValue : ExponentValue;
+        }
+
+        if (Mantissa <= MaxExactMantissa && FMath::Abs(Exponent) <= MaxExactPowerOf10)
+        {
+            // one correctly rounded operation, same result as the generic reader
+            const double Value = static_cast<double>(Mantissa);
+            Number = Exponent < 0 ? Value / ExactPowersOf10[-Exponent] : Value * ExactPowersOf10[Exponent];
+            if (Negative) Number = -Number;
+        }
+        else
+        {
+            Number = FCString::Atod(*FString(static_cast<int32>(Cur - Start), Start));
+        }
+        return true;
+    }
+
+    bool SkipValue()
+    {
+        if (Peek('"'))
+        {
+            FStringView View;
+            bool HasEscapes;
+            return ReadStringView(View, HasEscapes);
+        }
+        if (Consume('{'))
+        {
+            if (Consume('}')) return true;
+            do
+            {
+                FStringView Key;
+                bool HasEscapes;
+                if (!ReadStringView(Key, HasEscapes) || !Consume(':') || !SkipValue()) return false;
+            } while (Consume(','));
+            return Consume('}');
+        }
+        if (Consume('['))
+        {
+            if (Consume(']')) return true;
+            do
+            {
+                if (!SkipValue()) return false;
+            } while (Consume(','));
+            return Consume(']');
+        }
+
+        // number, bool or null
+        const TCHAR* Start = Cur;
+        while (Cur < End && *Cur != ',' && *Cur != '}' && *Cur != ']' && !FChar::IsWhitespace(*Cur))
+        {
+            ++Cur;
+        }
+        return Cur != Start;
+    }
+
+    /**
+      Calls OnKey for every key of the object, OnKey must read the value.
+    */
+    template <typename FunctionType>
+    bool ReadObject(FunctionType&& OnKey)
+    {
+        if (!Consume('{')) return false;
+        if (Consume('}')) return true;
+        do
+        {
+            FStringView Key;
+            bool HasEscapes;
+            if (!ReadStringView(Key, HasEscapes) || !Consume(':') || !OnKey(Key)) return false;
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+    template <typename FunctionType>
+    bool ReadArray(FunctionType&& OnItem)
+    {
+        if (!Consume('[')) return false;
+        if (Consume(']')) return true;
+        do
+        {
+            if (!OnItem()) return false;
+        } while (Consume(','));
+        return Consume(']');
+    }
+
+private:
+    const TCHAR* Cur;
+    const TCHAR* End;
+
+    void SkipWhitespace()
+    {
+        while (Cur < End && FChar::IsWhitespace(*Cur))
+        {
+            ++Cur;
+        }
+    }
+
+    static FString Unescape(FStringView View)
+    {
+        FString Result;
+        Result.Reserve(View.Len());
+        for (int32 Index = 0; Index < View.Len(); ++Index)
+        {
+            const TCHAR Char = View[Index];
+            if (Char != '\\' || Index + 1 >= View.Len())
+            {
+                Result.AppendChar(Char);
+                continue;
+            }
+
+            const TCHAR Escaped = View[++Index];
+            switch (Escaped)
+            {
+                case 'b': Result.AppendChar('\b'); break;
+                case 'f': Result.AppendChar('\f'); break;
+                case 'n': Result.AppendChar('\n'); break;
+                case 'r': Result.AppendChar('\r'); break;
+                case 't': Result.AppendChar('\t'); break;
+                case 'u':
+                    if (Index + 4 < View.Len())
+                    {
+                        Result.AppendChar(static_cast<TCHAR>(FParse::HexNumber(*FString(View.Mid(Index + 1, 4)))));
+                        Index += 4;
+                    }
+                    break;
+                default: Result.AppendChar(Escaped);
+            }
+        }
+        return Result;
+    }
+};
+
+bool ReadInt(FJsonScanner& Scanner, int32& Value)
+{
+    double Number;
+    if (!Scanner.ReadNumber(Number)) return false;
+    Value = static_cast<int32>(Number);
+    return true;
+}
+
+bool ReadEmbedding(FJsonScanner& Scanner, int32 SizeHint, TArray<float>& Embedding)
+{
+    if (Scanner.Peek('"'))
+    {
+        FStringView Base64;
+        bool HasEscapes;
+        if (!Scanner.ReadStringView(Base64, HasEscapes)) return false;
+
+        // base64 alphabet has '/' that may be sent as "\/"
+        return HasEscapes ? EmbeddingParser::DecodeBase64(FString(Base64).Replace(TEXT("\\/"), TEXT("/")), Embedding)
+                          : EmbeddingParser::DecodeBase64(Base64, Embedding);
+    }
+
+    Embedding.Reserve(SizeHint);
+    return Scanner.ReadArray(
+        [&]()
+        {
+            double Number;
+            if (!Scanner.ReadNumber(Number)) return false;
+            Embedding.Add(static_cast<float>(Number));
+            return true;
+        });
+}
+
+bool ReadData(FJsonScanner& Scanner, int32 SizeHint, FEmbeddingsData& Data)
+{
+    return Scanner.ReadObject(
+        [&](FStringView Key)
+        {
+            if (Key == TEXTVIEW("embedding")) return ReadEmbedding(Scanner, SizeHint, Data.Embedding);
+            if (Key == TEXTVIEW("index")) return ReadInt(Scanner, Data.Index);
+            if (Key == TEXTVIEW("object")) return Scanner.ReadString(Data.Object);
+            return Scanner.SkipValue();
+        });
+}
+
+bool ReadUsage(FJsonScanner& Scanner, FEmbeddingsUsage& Usage)
+{
+    return Scanner.ReadObject(
+        [&](FStringView Key)
+        {
+            if (Key == TEXTVIEW("prompt_tokens")) return ReadInt(Scanner, Usage.Prompt_Tokens);
+            if (Key == TEXTVIEW("total_tokens")) return ReadInt(Scanner, Usage.Total_Tokens);
+            return Scanner.SkipValue();
+        });
+}
+}  // namespace
+
+bool EmbeddingParser::DeserializeResponse(const FString& ResponseString, FEmbeddingsResponse& EmbeddingsResponse)
+{
+    FJsonScanner Scanner(ResponseString);
+    const bool Parsed = Scanner.ReadObject(
+        [&](FStringView Key)
+        {
+            if (Key == TEXTVIEW("data"))
+            {
+                return Scanner.ReadArray(
+                    [&]()
+                    {
+                        // all vectors of the response have the same size
+                        const int32 SizeHint = EmbeddingsResponse.Data.IsEmpty() ? 0 : EmbeddingsResponse.Data.Last().Embedding.Num();
+                        return ReadData(Scanner, SizeHint, EmbeddingsResponse.Data.AddDefaulted_GetRef());
+                    });
+            }
+            if (Key == TEXTVIEW("object")) return Scanner.ReadString(EmbeddingsResponse.Object);
+            if (Key == TEXTVIEW("model")) return Scanner.ReadString(EmbeddingsResponse.Model);
+            if (Key == TEXTVIEW("usage")) return ReadUsage(Scanner, EmbeddingsResponse.Usage);
+            return Scanner.SkipValue();
+        });
+    return Parsed && Scanner.IsAtEnd();
+}
+
+bool EmbeddingParser::DecodeBase64(FStringView Base64, TArray<float>& Floats)
+{
+    const uint32 NumBytes = FBase64::GetDecodedDataSize(Base64.GetData(), Base64.Len());
+    if (NumBytes % sizeof(float) != 0) return false;
+
+    // floats are sent in little-endian order that matches the supported platforms, bytes are decoded in place
+    Floats.SetNumUninitialized(NumBytes / sizeof(float));
+    return NumBytes == 0 || FBase64::Decode(Base64.GetData(), Base64.Len(), reinterpret_cast<uint8*>(Floats.GetData()));
+}
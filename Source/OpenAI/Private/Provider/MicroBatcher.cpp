@@ -0,0 +1,178 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Provider/MicroBatcher.h"
+#include "Provider/OpenAIProvider.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMicroBatcher, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+template <typename ResultType>
+struct TMicroBatchTraits;
+
+template <>
+struct TMicroBatchTraits<FEmbeddingsData>
+{
+    using ResponseType = FEmbeddingsResponse;
+
+    static FOnCreateEmbeddingsCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnCreateEmbeddingsCompleted(); }
+
+    static void Send(UOpenAIProvider* Provider, const FEmbeddings& Params, TArray<FString>&& Inputs, const FOpenAIAuth& Auth)
+    {
+        FEmbeddings Embeddings = Params;
+        Embeddings.Input = MoveTemp(Inputs);
+        Provider->CreateEmbeddings(Embeddings, Auth);
+    }
+
+    static const FEmbeddingsData* FindResult(const FEmbeddingsResponse& Response, int32 Index)
+    {
+        // data is ordered by index, the search is a fallback only
+        if (Response.Data.IsValidIndex(Index) && Response.Data[Index].Index == Index) return &Response.Data[Index];
+        return Response.Data.FindByPredicate([Index](const FEmbeddingsData& Data) { return Data.Index == Index; });
+    }
+};
+
+template <>
+struct TMicroBatchTraits<FModerationResults>
+{
+    using ResponseType = FModerationsResponse;
+
+    static FOnCreateModerationsCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnCreateModerationsCompleted(); }
+
+    static void Send(UOpenAIProvider* Provider, const FModerations& Params, TArray<FString>&& Inputs, const FOpenAIAuth& Auth)
+    {
+        FModerations Moderations = Params;
+        Moderations.Input = MoveTemp(Inputs);
+        Provider->CreateModerations(Moderations, Auth);
+    }
+
+    static const FModerationResults* FindResult(const FModerationsResponse& Response, int32 Index)
+    {
+        return Response.Results.IsValidIndex(Index) ? &Response.Results[Index] : nullptr;
+    }
+};
+}  // namespace
+
+void UOpenAIMicroBatcher::BeginDestroy()
+{
+    StopTicker(PendingEmbeddings);
+    StopTicker(PendingModerations);
+    Super::BeginDestroy();
+}
+
+void UOpenAIMicroBatcher::SetOptions(const FMicroBatchingOptions& InOptions)
+{
+    Options = InOptions;
+    Options.MaxItems = FMath::Clamp(Options.MaxItems, 1, 2048);
+}
+
+void UOpenAIMicroBatcher::Embed(const FString& Input, const FOnItemEmbedded& OnCompleted)
+{
+    Add(PendingEmbeddings, EmbeddingsParams, Input, OnCompleted);
+}
+
+void UOpenAIMicroBatcher::Moderate(const FString& Input, const FOnItemModerated& OnCompleted)
+{
+    Add(PendingModerations, ModerationsParams, Input, OnCompleted);
+}
+
+void UOpenAIMicroBatcher::Flush()
+{
+    Send(PendingEmbeddings, EmbeddingsParams);
+    Send(PendingModerations, ModerationsParams);
+}
+
+template <typename ResultType, typename RequestType>
+void UOpenAIMicroBatcher::Add(TMicroBatch<ResultType>& Batch, const RequestType& Params, const FString& Input,
+    const typename TMicroBatch<ResultType>::FOnResult& OnCompleted)
+{
+    check(IsInGameThread());
+
+    int32 InputIndex;
+    if (const int32* Found = Batch.InputIndices.Find(Input))
+    {
+        InputIndex = *Found;
+    }
+    else
+    {
+        InputIndex = Batch.Inputs.Add(Input);
+        Batch.InputIndices.Add(Input, InputIndex);
+    }
+    Batch.Callers.Emplace(InputIndex, OnCompleted);
+
+    if (Batch.Inputs.Num() >= Options.MaxItems)
+    {
+        Send(Batch, Params);
+        return;
+    }
+
+    if (!Batch.TickerHandle.IsValid())
+    {
+        // batch and params are members, the ticker is removed before the object is destroyed
+        const auto OnWindowElapsed = FTickerDelegate::CreateWeakLambda(this,
+            [this, &Batch, &Params](float)
+            {
+                Batch.TickerHandle.Reset();
+                Send(Batch, Params);
+                return false;
+            });
+        Batch.TickerHandle = FTSTicker::GetCoreTicker().AddTicker(OnWindowElapsed, static_cast<float>(Options.Window.GetTotalSeconds()));
+    }
+}
+
+template <typename ResultType, typename RequestType>
+void UOpenAIMicroBatcher::Send(TMicroBatch<ResultType>& Batch, const RequestType& Params)
+{
+    using FTraits = TMicroBatchTraits<ResultType>;
+    using ResponseType = typename FTraits::ResponseType;
+    using FCallers = TArray<TPair<int32, typename TMicroBatch<ResultType>::FOnResult>>;
+
+    StopTicker(Batch);
+    if (Batch.Callers.IsEmpty()) return;
+
+    const auto Callers = MakeShared<FCallers>(MoveTemp(Batch.Callers));
+    TArray<FString> Inputs = MoveTemp(Batch.Inputs);
+    Batch.Callers.Reset();
+    Batch.Inputs.Reset();
+    Batch.InputIndices.Reset();
+
+    UE_LOGFMT(LogMicroBatcher, Verbose, "{0} call(s) are sent as one request with {1} input(s)", Callers->Num(), Inputs.Num());
+
+    auto* Provider = NewObject<UOpenAIProvider>(this, ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass());
+    Providers.Add(Provider);
+
+    FTraits::OnCompleted(Provider).AddWeakLambda(this,
+        [this, Provider, Callers](const ResponseType& Response)
+        {
+            Providers.RemoveSingleSwap(Provider);
+            for (const auto& [InputIndex, OnResult] : *Callers)
+            {
+                const ResultType* Result = FTraits::FindResult(Response, InputIndex);
+                OnResult(Result ? *Result : ResultType{}, Result != nullptr);
+            }
+        });
+    Provider->OnRequestError().AddWeakLambda(this,
+        [this, Provider, Callers](const FString& URL, const FString& Content)
+        {
+            UE_LOGFMT(LogMicroBatcher, Error, "Batched request of {0} call(s) failed: {1}", Callers->Num(), Content);
+            Providers.RemoveSingleSwap(Provider);
+            for (const auto& [InputIndex, OnResult] : *Callers)
+            {
+                OnResult(ResultType{}, false);
+            }
+        });
+
+    ++NumSent;
+    FTraits::Send(Provider, Params, MoveTemp(Inputs), Auth);
+}
+
+template <typename ResultType>
+void UOpenAIMicroBatcher::StopTicker(TMicroBatch<ResultType>& Batch)
+{
+    if (!Batch.TickerHandle.IsValid()) return;
+    FTSTicker::GetCoreTicker().RemoveTicker(Batch.TickerHandle);
+    Batch.TickerHandle.Reset();
+}
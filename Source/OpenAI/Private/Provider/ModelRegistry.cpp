@@ -0,0 +1,248 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Provider/ModelRegistry.h"
+#include "FuncLib/EnumNameTable.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeRWLock.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogModelRegistry, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr uint8 HasVision = 1 << 0;
+constexpr uint8 HasTools = 1 << 1;
+constexpr uint8 HasStreaming = 1 << 2;
+constexpr uint8 HasResponseFormat = 1 << 3;
+constexpr uint8 Chat = HasTools | HasStreaming | HasResponseFormat;
+
+struct FBuiltInModel
+{
+    const TCHAR* Name;
+    int32 ContextWindow;
+    int32 MaxOutputTokens;
+    EBPEEncoding Encoding;
+    uint8 Features;
+    float InputPrice;
+    float OutputPrice;
+};
+
+constexpr EBPEEncoding Cl100k = EBPEEncoding::Cl100kBase;
+constexpr EBPEEncoding O200k = EBPEEncoding::O200kBase;
+
+// https://platform.openai.com/docs/models, prices are USD per 1M tokens
+constexpr FBuiltInModel BuiltInModels[] = {
+    {TEXT("gpt-5"), 400000, 128000, O200k, Chat | HasVision, 1.25f, 10.0f},
+    {TEXT("gpt-5-mini"), 400000, 128000, O200k, Chat | HasVision, 0.25f, 2.0f},
+    {TEXT("gpt-5-nano"), 400000, 128000, O200k, Chat | HasVision, 0.05f, 0.4f},
+    {TEXT("gpt-4.1"), 1047576, 32768, O200k, Chat | HasVision, 2.0f, 8.0f},
+    {TEXT("gpt-4.1-mini"), 1047576, 32768, O200k, Chat | HasVision, 0.4f, 1.6f},
+    {TEXT("gpt-4.1-nano"), 1047576, 32768, O200k, Chat | HasVision, 0.1f, 0.4f},
+    {TEXT("gpt-4.5"), 128000, 16384, O200k, Chat | HasVision, 75.0f, 150.0f},
+    {TEXT("gpt-4o"), 128000, 16384, O200k, Chat | HasVision, 2.5f, 10.0f},
+    {TEXT("gpt-4o-mini"), 128000, 16384, O200k, Chat | HasVision, 0.15f, 0.6f},
+    {TEXT("chatgpt-4o"), 128000, 16384, O200k, HasStreaming | HasResponseFormat | HasVision, 5.0f, 15.0f},
+    {TEXT("o1"), 200000, 100000, O200k, Chat | HasVision, 15.0f, 60.0f},
+    {TEXT("o1-mini"), 128000, 65536, O200k, HasStreaming, 1.1f, 4.4f},
+    {TEXT("o1-preview"), 128000, 32768, O200k, HasStreaming, 15.0f, 60.0f},
+    {TEXT("o1-pro"), 200000, 100000, O200k, HasTools | HasResponseFormat | HasVision, 150.0f, 600.0f},
+    {TEXT("o3"), 200000, 100000, O200k, Chat | HasVision, 2.0f, 8.0f},
+    {TEXT("o3-mini"), 200000, 100000, O200k, Chat, 1.1f, 4.4f},
+    {TEXT("o4-mini"), 200000, 100000, O200k, Chat | HasVision, 1.1f, 4.4f},
+    {TEXT("gpt-oss"), 131072, 131072, O200k, Chat, 0.0f, 0.0f},
+    {TEXT("gpt-4-turbo"), 128000, 4096, Cl100k, Chat | HasVision, 10.0f, 30.0f},
+    {TEXT("gpt-4-turbo-preview"), 128000, 4096, Cl100k, Chat, 10.0f, 30.0f},
+    {TEXT("gpt-4-1106"), 128000, 4096, Cl100k, Chat, 10.0f, 30.0f},
+    {TEXT("gpt-4-0125"), 128000, 4096, Cl100k, Chat, 10.0f, 30.0f},
+    {TEXT("gpt-4-vision"), 128000, 4096, Cl100k, HasStreaming | HasVision, 10.0f, 30.0f},
+    {TEXT("gpt-4-1106-vision"), 128000, 4096, Cl100k, HasStreaming | HasVision, 10.0f, 30.0f},
+    {TEXT("gpt-4-32k"), 32768, 8192, Cl100k, Chat, 60.0f, 120.0f},
+    {TEXT("gpt-4"), 8192, 8192, Cl100k, Chat, 30.0f, 60.0f},
+    {TEXT("gpt-3.5-turbo"), 16385, 4096, Cl100k, Chat, 0.5f, 1.5f},
+    {TEXT("gpt-3.5-turbo-instruct"), 4096, 4096, Cl100k, HasStreaming, 1.5f, 2.0f},
+    {TEXT("text-embedding-3-small"), 8191, 0, Cl100k, 0, 0.02f, 0.0f},
+    {TEXT("text-embedding-3-large"), 8191, 0, Cl100k, 0, 0.13f, 0.0f},
+    {TEXT("text-embedding-ada-002"), 8191, 0, Cl100k, 0, 0.1f, 0.0f},
+};
+
+constexpr const TCHAR* O200kName = TEXT("o200k_base");
+constexpr const TCHAR* Cl100kName = TEXT("cl100k_base");
+
+uint64 HashName(FStringView Name)
+{
+    return EnumNames::Hash(Name.GetData(), Name.Len(), ESearchCase::IgnoreCase);
+}
+
+FRWLock SharedRegistryLock;
+TSharedPtr<const FModelRegistry> SharedRegistry;
+}  // namespace
+
+FModelRegistry::FModelRegistry()
+{
+    Models.Reserve(UE_ARRAY_COUNT(BuiltInModels));
+    for (const FBuiltInModel& BuiltIn : BuiltInModels)
+    {
+        FModelCapabilities Model;
+        Model.Name = BuiltIn.Name;
+        Model.Context_Window = BuiltIn.ContextWindow;
+        Model.Max_Output_Tokens = BuiltIn.MaxOutputTokens;
+        Model.Tokenizer = BuiltIn.Encoding == EBPEEncoding::O200kBase ? O200kName : Cl100kName;
+        Model.Vision = (BuiltIn.Features & HasVision) != 0;
+        Model.Tools = (BuiltIn.Features & HasTools) != 0;
+        Model.Streaming = (BuiltIn.Features & HasStreaming) != 0;
+        Model.Response_Format = (BuiltIn.Features & HasResponseFormat) != 0;
+        Model.Input_Price = BuiltIn.InputPrice;
+        Model.Output_Price = BuiltIn.OutputPrice;
+        Add(Model);
+    }
+}
+
+void FModelRegistry::Add(const FModelCapabilities& Model)
+{
+    EBPEEncoding Encoding = EBPEEncoding::Cl100kBase;
+    if (Model.Tokenizer.Equals(O200kName))
+    {
+        Encoding = EBPEEncoding::O200kBase;
+    }
+    else if (!Model.Tokenizer.Equals(Cl100kName))
+    {
+        UE_LOGFMT(LogModelRegistry, Warning, "Unknown tokenizer {0} of {1}, {2} is used", Model.Tokenizer, Model.Name, Cl100kName);
+    }
+
+    const int32 Index = FindExactIndex(Model.Name);
+    if (Index != INDEX_NONE)
+    {
+        Models[Index] = Model;
+        Encodings[Index] = Encoding;
+        return;
+    }
+
+    ModelIndices.Add(HashName(Model.Name), Models.Add(Model));
+    Encodings.Add(Encoding);
+}
+
+bool FModelRegistry::LoadFromFile(const FString& FilePath)
+{
+    FString JsonString;
+    if (!FFileHelper::LoadFileToString(JsonString, *FilePath))
+    {
+        UE_LOGFMT(LogModelRegistry, Error, "Failed loading file: {0}", FilePath);
+        return false;
+    }
+    return LoadFromString(JsonString);
+}
+
+bool FModelRegistry::LoadFromString(const FString& JsonString)
+{
+    TSharedPtr<FJsonObject> Json;
+    const TArray<TSharedPtr<FJsonValue>>* Entries = nullptr;
+    if (!UJsonFuncLib::StringToJson(JsonString, Json) || !Json->TryGetArrayField(TEXT("models"), Entries))
+    {
+        UE_LOGFMT(LogModelRegistry, Error, "Models should be an array in the models field");
+        return false;
+    }
+
+    for (const TSharedPtr<FJsonValue>& Entry : *Entries)
+    {
+        const TSharedPtr<FJsonObject>* EntryObject = nullptr;
+        FString Name;
+        if (!Entry->TryGetObject(EntryObject) || !(*EntryObject)->TryGetStringField(TEXT("name"), Name) || Name.IsEmpty())
+        {
+            UE_LOGFMT(LogModelRegistry, Warning, "Model without a name is skipped");
+            continue;
+        }
+
+        // the file overrides only the fields it has
+        FModelCapabilities Model = Find(Name);
+        FJsonObjectConverter::JsonObjectToUStruct(EntryObject->ToSharedRef(), &Model, 0, 0);
+        Model.Name = Name;
+        Add(Model);
+    }
+    return true;
+}
+
+const FModelCapabilities& FModelRegistry::Find(FStringView Model) const
+{
+    const int32 Index = FindIndex(Model);
+    return Index != INDEX_NONE ? Models[Index] : Defaults;
+}
+
+bool FModelRegistry::IsKnown(FStringView Model) const
+{
+    return FindIndex(Model) != INDEX_NONE;
+}
+
+EBPEEncoding FModelRegistry::GetEncoding(FStringView Model) const
+{
+    const int32 Index = FindIndex(Model);
+    return Index != INDEX_NONE ? Encodings[Index] : EBPEEncoding::Cl100kBase;
+}
+
+int32 FModelRegistry::FindIndex(FStringView Model) const
+{
+    // ft:gpt-4o-mini-2024-07-18:org:suffix:id
+    FStringView Name = Model;
+    if (Name.StartsWith(TEXT("ft:")))
+    {
+        Name.RightChopInline(3);
+    }
+    int32 Colon = INDEX_NONE;
+    if (Name.FindChar(TEXT(':'), Colon))
+    {
+        Name.LeftInline(Colon);
+    }
+
+    // gpt-4o-mini-2024-07-18 -> gpt-4o-mini-2024-07 -> gpt-4o-mini-2024 -> gpt-4o-mini
+    while (!Name.IsEmpty())
+    {
+        const int32 Index = FindExactIndex(Name);
+        if (Index != INDEX_NONE) return Index;
+
+        int32 Dash = INDEX_NONE;
+        if (!Name.FindLastChar(TEXT('-'), Dash)) break;
+        Name.LeftInline(Dash);
+    }
+    return INDEX_NONE;
+}
+
+int32 FModelRegistry::FindExactIndex(FStringView Name) const
+{
+    const int32* Index = ModelIndices.Find(HashName(Name));
+    return Index && Name.Equals(Models[*Index].Name, ESearchCase::IgnoreCase) ? *Index : INDEX_NONE;
+}
+
+TSharedRef<const FModelRegistry> FModelRegistry::Get()
+{
+    {
+        FReadScopeLock ReadLock(SharedRegistryLock);
+        if (SharedRegistry.IsValid()) return SharedRegistry.ToSharedRef();
+    }
+
+    FWriteScopeLock WriteLock(SharedRegistryLock);
+    if (!SharedRegistry.IsValid())
+    {
+        const TSharedRef<FModelRegistry> Registry = MakeShared<FModelRegistry>();
+        const FString FilePath = GetDefaultFilePath();
+        if (FPaths::FileExists(FilePath) && Registry->LoadFromFile(FilePath))
+        {
+            UE_LOGFMT(LogModelRegistry, Display, "Models were loaded from {0}", FilePath);
+        }
+        SharedRegistry = Registry;
+    }
+    return SharedRegistry.ToSharedRef();
+}
+
+void FModelRegistry::Set(const TSharedRef<const FModelRegistry>& Registry)
+{
+    FWriteScopeLock WriteLock(SharedRegistryLock);
+    SharedRegistry = Registry;
+}
+
+FString FModelRegistry::GetDefaultFilePath()
+{
+    return FPaths::Combine(FPaths::ProjectContentDir(), TEXT("OpenAI"), TEXT("Models.json"));
+}
@@ -4,12 +4,19 @@
 #include "Provider/JsonParsers/ModerationParser.h"
 #include "Provider/JsonParsers/ImageParser.h"
 #include "Provider/JsonParsers/AudioParser.h"
+#include "Provider/JsonParsers/EmbeddingParser.h"
 #include "API/API.h"
 #include "JsonObjectConverter.h"
 #include "Serialization/JsonReader.h"
 #include "Http/HttpHelper.h"
 #include "FuncLib/OpenAIFuncLib.h"
 #include "FuncLib/JsonFuncLib.h"
+#include "IO/FileManifest.h"
+#include "Embeddings/EmbeddingCache.h"
+#include "Provider/ChatStream.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
 #include "Logging/StructuredLog.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogOpenAIProvider, All, All);
@@ -18,7 +25,8 @@ using namespace OpenAI;
 
 PRAGMA_DISABLE_DEPRECATION_WARNINGS
 
-UOpenAIProvider::UOpenAIProvider() : API(MakeShared<OpenAI::V1::OpenAIAPI>())  //
+UOpenAIProvider::UOpenAIProvider()
+    : API(MakeShared<OpenAI::V1::OpenAIAPI>()), ChatMessageCache(MakeShared<OpenAI::FChatMessageJsonCache>())
 {
 }
 
@@ -79,6 +87,7 @@ void UOpenAIProvider::CreateChatCompletion(const FChatCompletion& ChatCompletion
     auto HttpRequest = MakeRequest(ChatCompletion, API->ChatCompletion(), "POST", Auth);
     if (ChatCompletion.Stream)
     {
+        ChatStreams.Add(&HttpRequest.Get(), MakeShared<FChatStream>());
         HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnCreateChatCompletionStreamCompleted);
         HttpRequest->OnRequestProgress().BindUObject(this, &ThisClass::OnCreateChatCompletionStreamProgress);
     }
@@ -157,8 +166,59 @@ void UOpenAIProvider::CreateImageVariation(const FOpenAIImageVariation& ImageVar
 
 void UOpenAIProvider::CreateEmbeddings(const FEmbeddings& Embeddings, const FOpenAIAuth& Auth)
 {
-    auto HttpRequest = MakeRequest(Embeddings, API->Embeddings(), "POST", Auth);
-    HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnCreateEmbeddingsCompleted);
+    if (!EmbeddingCache.IsValid())
+    {
+        auto HttpRequest = MakeRequest(Embeddings, API->Embeddings(), "POST", Auth);
+        HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnCreateEmbeddingsCompleted);
+        ProcessRequest(HttpRequest);
+        return;
+    }
+
+    // inputs of bulk requests are hashed on the worker thread
+    Async(EAsyncExecution::ThreadPool,
+        [WeakThis = TWeakObjectPtr<UOpenAIProvider>(this), Cache = EmbeddingCache.ToSharedRef(), Embeddings, Auth]()
+        {
+            const auto Lookup = MakeShared<FEmbeddingCacheLookup>(Cache->Lookup(Embeddings));
+            AsyncTask(ENamedThreads::GameThread,
+                [WeakThis, Embeddings, Auth, Lookup]()
+                {
+                    if (!WeakThis.IsValid()) return;
+
+                    if (!Lookup->HasMisses())
+                    {
+                        WeakThis->Log(FString::Printf(TEXT("All %d embedding input(s) were cached"), Embeddings.Input.Num()));
+                        WeakThis->CreateEmbeddingsCompleted.Broadcast(FEmbeddingCache::MakeResponse(*Lookup, {}));
+                        return;
+                    }
+                    WeakThis->SendCachedEmbeddingsRequest(Embeddings, Auth, Lookup);
+                });
+        });
+}
+
+void UOpenAIProvider::SendCachedEmbeddingsRequest(
+    const FEmbeddings& Embeddings, const FOpenAIAuth& Auth, const TSharedRef<FEmbeddingCacheLookup>& Lookup)
+{
+    FEmbeddings MissEmbeddings = Embeddings;
+    MissEmbeddings.Input = Lookup->MissInput;
+
+    auto HttpRequest = MakeRequest(MissEmbeddings, API->Embeddings(), "POST", Auth);
+    HttpRequest->OnProcessRequestComplete().BindWeakLambda(this,
+        [this, Cache = EmbeddingCache.ToSharedRef(), Lookup](FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
+        {
+            FEmbeddingsResponse MissResponse;
+            if (!ParseEmbeddingsResponse(Response, WasSuccessful, MissResponse)) return;
+
+            if (MissResponse.Data.Num() != Lookup->MissInput.Num() || !Cache->Resolve(*Lookup, MissResponse))
+            {
+                LogError("Embeddings response doesn't match the request");
+                RequestError.Broadcast(Response->GetURL(), Response->GetContentAsString());
+                return;
+            }
+
+            // appending to the slab is file IO
+            Async(EAsyncExecution::ThreadPool, [Cache]() { Cache->Save(); });
+            CreateEmbeddingsCompleted.Broadcast(FEmbeddingCache::MakeResponse(*Lookup, MissResponse));
+        });
     ProcessRequest(HttpRequest);
 }
 
@@ -216,14 +276,47 @@ void UOpenAIProvider::CreateAudioTranslation(const FAudioTranslation& AudioTrans
     ProcessRequest(HttpRequest);
 }
 
-void UOpenAIProvider::ListFiles(const FOpenAIAuth& Auth)
+void UOpenAIProvider::ListFiles(const FOpenAIAuth& Auth, const FListFiles& ListFiles)
 {
-    auto HttpRequest = MakeRequest(API->Files(), "GET", Auth);
-    HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnListFilesCompleted);
+    const bool FullListing = !ListFiles.Purpose.IsSet && !ListFiles.Limit.IsSet && !ListFiles.After.IsSet;
+    const auto URL = FString(API->Files()).Append(ListFiles.ToQuery());
+    auto HttpRequest = MakeRequest(URL, "GET", Auth);
+    HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnListFilesCompleted, FullListing);
     ProcessRequest(HttpRequest);
 }
 
 void UOpenAIProvider::UploadFile(const FUploadFile& UploadFile, const FOpenAIAuth& Auth)
+{
+    if (!FileManifest.IsValid())
+    {
+        SendUploadFileRequest(UploadFile, Auth, {});
+        return;
+    }
+
+    // files can be big, hashing is done on the worker thread
+    Async(EAsyncExecution::ThreadPool,
+        [WeakThis = TWeakObjectPtr<UOpenAIProvider>(this), Manifest = FileManifest.ToSharedRef(), UploadFile, Auth]()
+        {
+            const FString Hash = FFileManifest::HashFile(UploadFile.File);
+            FString FileId;
+            const bool Uploaded = !Hash.IsEmpty() && Manifest->Find(Hash, UploadFile.Purpose, FileId);
+
+            AsyncTask(ENamedThreads::GameThread,
+                [WeakThis, UploadFile, Auth, Hash, FileId, Uploaded]()
+                {
+                    if (!WeakThis.IsValid()) return;
+
+                    if (Uploaded)
+                    {
+                        WeakThis->BroadcastUploadedFile(UploadFile, FileId);
+                        return;
+                    }
+                    WeakThis->SendUploadFileRequest(UploadFile, Auth, Hash);
+                });
+        });
+}
+
+void UOpenAIProvider::SendUploadFileRequest(const FUploadFile& UploadFile, const FOpenAIAuth& Auth, const FString& ContentHash)
 {
     const auto& [Boundary, BeginBoundary, EndBoundary] = HttpHelper::MakeBoundary();
     auto HttpRequest = CreateRequest();
@@ -238,10 +331,60 @@ void UOpenAIProvider::UploadFile(const FUploadFile& UploadFile, const FOpenAIAut
     RequestContent.Append((uint8*)TCHAR_TO_ANSI(*EndBoundary), EndBoundary.Len());
 
     HttpRequest->SetContent(RequestContent);
-    HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnUploadFileCompleted);
+    if (ContentHash.IsEmpty() || !FileManifest.IsValid())
+    {
+        HttpRequest->OnProcessRequestComplete().BindUObject(this, &ThisClass::OnUploadFileCompleted);
+    }
+    else
+    {
+        HttpRequest->OnProcessRequestComplete().BindWeakLambda(this,
+            [this, Manifest = FileManifest.ToSharedRef(), ContentHash, Purpose = UploadFile.Purpose](
+                FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
+            {
+                FUploadFileResponse ParsedResponse;
+                if (WasSuccessful && Response.IsValid() && EHttpResponseCodes::IsOk(Response->GetResponseCode()) &&
+                    UJsonFuncLib::ParseJSONToStruct(Response->GetContentAsString(), &ParsedResponse))
+                {
+                    Manifest->Add(ContentHash, Purpose, ParsedResponse.ID);
+                }
+                OnUploadFileCompleted(Request, Response, WasSuccessful);
+            });
+    }
     ProcessRequest(HttpRequest);
 }
 
+void UOpenAIProvider::BroadcastUploadedFile(const FUploadFile& UploadFile, const FString& FileId)
+{
+    Log(FString::Printf(TEXT("File %s was already uploaded: %s"), *UploadFile.File, *FileId));
+
+    FUploadFileResponse Response;
+    Response.ID = FileId;
+    Response.Object = "file";
+    Response.Bytes = static_cast<int32>(IFileManager::Get().FileSize(*UploadFile.File));
+    Response.FileName = FPaths::GetCleanFilename(UploadFile.File);
+    Response.Purpose = UploadFile.Purpose;
+    Response.Status = "processed";
+    UploadFileCompleted.Broadcast(Response);
+}
+
+void UOpenAIProvider::SetFileManifest(const TSharedPtr<FFileManifest>& Manifest)
+{
+    DeleteFileCompleted.Remove(DeleteFileManifestHandle);
+    DeleteFileManifestHandle.Reset();
+
+    FileManifest = Manifest;
+    if (!FileManifest.IsValid()) return;
+
+    DeleteFileManifestHandle = DeleteFileCompleted.AddWeakLambda(this,
+        [Manifest = FileManifest.ToSharedRef()](const FDeleteFileResponse& Response)
+        {
+            if (Response.Deleted)
+            {
+                Manifest->RemoveFile(Response.ID);
+            }
+        });
+}
+
 void UOpenAIProvider::DeleteFile(const FString& FileID, const FOpenAIAuth& Auth)
 {
     const auto URL = FString(API->Files()).Append("/").Append(FileID);
@@ -439,12 +582,59 @@ void UOpenAIProvider::OnCreateChatCompletionCompleted(FHttpRequestPtr Request, F
 
 void UOpenAIProvider::OnCreateChatCompletionStreamCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
 {
-    OnStreamCompleted<FChatCompletionStreamResponse>(Request, Response, WasSuccessful, CreateChatCompletionStreamCompleted);
+    TSharedPtr<FChatStream> Stream;
+    ChatStreams.RemoveAndCopyValue(Request.Get(), Stream);
+    if (!Stream)
+    {
+        OnStreamCompleted<FChatCompletionStreamResponse>(Request, Response, WasSuccessful, CreateChatCompletionStreamCompleted);
+        return;
+    }
+
+    if (!WasSuccessful)
+    {
+        const auto& [URL, Content] = GetErrorData(Request, Response);
+        LogError(Content);
+        RequestError.Broadcast(URL, Content);
+        return;
+    }
+
+    if (!Response.IsValid())
+    {
+        LogError("JSON deserialization error");
+        RequestError.Broadcast(FString{}, FString{});
+        return;
+    }
+
+    FString NewLines;
+    Stream->ParseUtf8(Response->GetContent(), true, &NewLines);
+    LogResponse(Response, NewLines);
+    CreateChatCompletionStreamUpdated.Broadcast(*Stream, true);
+    if (CreateChatCompletionStreamCompleted.IsBound())
+    {
+        CreateChatCompletionStreamCompleted.Broadcast(Stream->ToResponses());
+    }
 }
 
 void UOpenAIProvider::OnCreateChatCompletionStreamProgress(FHttpRequestPtr Request, int32 BytesSent, int32 BytesReceived)
 {
-    OnStreamProgress<FChatCompletionStreamResponse>(Request, BytesSent, BytesReceived, CreateChatCompletionStreamProgresses);
+    const TSharedPtr<FChatStream> Stream = Request ? ChatStreams.FindRef(Request.Get()) : nullptr;
+    if (!Stream)
+    {
+        OnStreamProgress<FChatCompletionStreamResponse>(Request, BytesSent, BytesReceived, CreateChatCompletionStreamProgresses);
+        return;
+    }
+
+    // only the lines that were received since the previous progress are converted, parsed and logged
+    const FHttpResponsePtr Response = Request->GetResponse();
+    FString NewLines;
+    if (!Response.IsValid() || Stream->ParseUtf8(Response->GetContent(), false, &NewLines) == 0) return;
+
+    LogResponse(Response, NewLines);
+    CreateChatCompletionStreamUpdated.Broadcast(*Stream, false);
+    if (CreateChatCompletionStreamProgresses.IsBound())
+    {
+        CreateChatCompletionStreamProgresses.Broadcast(Stream->ToResponses());
+    }
 }
 
 void UOpenAIProvider::OnCreateImageCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
@@ -508,7 +698,32 @@ void UOpenAIProvider::OnCreateImageVariationCompleted(FHttpRequestPtr Request, F
 
 void UOpenAIProvider::OnCreateEmbeddingsCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
 {
-    HandleResponse<FEmbeddingsResponse>(Response, WasSuccessful, CreateEmbeddingsCompleted);
+    FEmbeddingsResponse EmbeddingsResponse;
+    if (ParseEmbeddingsResponse(Response, WasSuccessful, EmbeddingsResponse))
+    {
+        CreateEmbeddingsCompleted.Broadcast(EmbeddingsResponse);
+    }
+}
+
+bool UOpenAIProvider::ParseEmbeddingsResponse(FHttpResponsePtr Response, bool WasSuccessful, FEmbeddingsResponse& EmbeddingsResponse)
+{
+    // bulk responses are large, errors come with non 2xx codes so the generic DOM check is needed only for them
+    if (!WasSuccessful || !Response.IsValid() || !EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+    {
+        HandleResponse<FEmbeddingsResponse>(Response, WasSuccessful, CreateEmbeddingsCompleted);
+        return false;
+    }
+
+    const FString Content = Response->GetContentAsString();
+    if (!EmbeddingParser::DeserializeResponse(Content, EmbeddingsResponse))
+    {
+        LogError("Failed to parse embeddings response");
+        RequestError.Broadcast(Response->GetURL(), Content);
+        return false;
+    }
+
+    LogResponse(Response);
+    return true;
 }
 
 void UOpenAIProvider::OnCreateSpeechCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
@@ -543,9 +758,20 @@ void UOpenAIProvider::OnCreateAudioTranslationCompleted(FHttpRequestPtr Request,
     HandleResponse<FAudioTranslationResponse>(Response, WasSuccessful, CreateAudioTranslationCompleted);
 }
 
-void UOpenAIProvider::OnListFilesCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
+void UOpenAIProvider::OnListFilesCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful, bool FullListing)
 {
-    HandleResponse<FListFilesResponse>(Response, WasSuccessful, ListFilesCompleted);
+    FListFilesResponse ListFilesResponse;
+    if (!ParseResponse(Response, WasSuccessful, ListFilesResponse)) return;
+
+    // only the complete list of all files tells which files were removed,
+    // a filtered or limited one doesn't have the files of the other purposes or pages
+    if (FullListing && !ListFilesResponse.Has_More && FileManifest.IsValid())
+    {
+        // reconciliation saves the manifest, it's done in the background
+        Async(EAsyncExecution::ThreadPool,
+            [Manifest = FileManifest.ToSharedRef(), Files = ListFilesResponse.Data]() { Manifest->Reconcile(Files); });
+    }
+    ListFilesCompleted.Broadcast(ListFilesResponse);
 }
 
 void UOpenAIProvider::OnUploadFileCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful)
@@ -724,11 +950,19 @@ void UOpenAIProvider::Log(const FString& Info) const
 }
 
 void UOpenAIProvider::LogResponse(FHttpResponsePtr Response) const
+{
+    if (bLogEnabled)
+    {
+        LogResponse(Response, Response.IsValid() ? Response->GetContentAsString() : FString{});
+    }
+}
+
+void UOpenAIProvider::LogResponse(FHttpResponsePtr Response, const FString& Content) const
 {
     if (bLogEnabled)
     {
         UE_LOGFMT(LogOpenAIProvider, Display, "Response. Request URL: {0}", Response.IsValid() ? Response->GetURL() : FString{});
-        UE_LOGFMT(LogOpenAIProvider, Display, "Response. Content: {0}", Response.IsValid() ? Response->GetContentAsString() : FString{});
+        UE_LOGFMT(LogOpenAIProvider, Display, "Response. Content: {0}", Content);
     }
 }
 
@@ -790,7 +1024,7 @@ FHttpRequestRef UOpenAIProvider::MakeRequest(
     HttpRequest->SetURL(URL);
     HttpRequest->SetVerb(Method);
 
-    const FString RequestBodyStr = ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion);
+    const FString RequestBodyStr = ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion, *ChatMessageCache);
     Log(FString("Postprocessed content was set as: ").Append(RequestBodyStr));
     HttpRequest->SetContentAsString(RequestBodyStr);
 
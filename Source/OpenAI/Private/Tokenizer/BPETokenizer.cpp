@@ -0,0 +1,638 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Tokenizer/BPETokenizer.h"
+#include "Provider/ModelRegistry.h"
+#include "IO/MappedFile.h"
+#include "Misc/Base64.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Logging/StructuredLog.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogBPETokenizer, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 NumEncodings = 2;
+constexpr int32 NoRank = MAX_int32;
+
+/**
+  Character classes of the pre-tokenization regex.
+  Marks (\p{M}) aren't letters, but o200k words can contain them, so they are both upper and lower case.
+*/
+enum ECharClass : uint8
+{
+    Other = 0,
+    Letter = 1 << 0,
+    Upper = 1 << 1,
+    Lower = 1 << 2,
+    Number = 1 << 3,
+    Space = 1 << 4,
+    Newline = 1 << 5
+};
+
+struct FAsciiClasses
+{
+    uint8 Classes[128];
+
+    FAsciiClasses()
+    {
+        for (int32 Char = 0; Char < 128; ++Char)
+        {
+            uint8 Class = Other;
+            if (Char >= 'A' && Char <= 'Z') Class = Letter | Upper;
+            if (Char >= 'a' && Char <= 'z') Class = Letter | Lower;
+            if (Char >= '0' && Char <= '9') Class = Number;
+            if (Char == ' ' || (Char >= '\t' && Char <= '\r')) Class = Space;
+            if (Char == '\r' || Char == '\n') Class = Space | Newline;
+            Classes[Char] = Class;
+        }
+    }
+};
+
+const FAsciiClasses AsciiClasses;
+
+bool IsMark(uint32 CodePoint)
+{
+    return (CodePoint >= 0x0300 && CodePoint <= 0x036F) || (CodePoint >= 0x0483 && CodePoint <= 0x0489) ||
+           (CodePoint >= 0x0591 && CodePoint <= 0x05C7) || (CodePoint >= 0x0610 && CodePoint <= 0x061A) ||
+           (CodePoint >= 0x064B && CodePoint <= 0x065F) || (CodePoint >= 0x0900 && CodePoint <= 0x0903) ||
+           (CodePoint >= 0x093A && CodePoint <= 0x094F) || (CodePoint >= 0x0E31 && CodePoint <= 0x0E3A && CodePoint != 0x0E32) ||
+           (CodePoint >= 0x0E47 && CodePoint <= 0x0E4E) || (CodePoint >= 0x1AB0 && CodePoint <= 0x1AFF) ||
+           (CodePoint >= 0x1DC0 && CodePoint <= 0x1DFF) || (CodePoint >= 0x20D0 && CodePoint <= 0x20FF) ||
+           (CodePoint >= 0x3099 && CodePoint <= 0x309A) || (CodePoint >= 0xFE00 && CodePoint <= 0xFE0F) ||
+           (CodePoint >= 0xFE20 && CodePoint <= 0xFE2F);
+}
+
+/**
+  \s of the regex, the platform whitespace functions differ on the no-break spaces.
+*/
+bool IsSpace(uint32 CodePoint)
+{
+    return CodePoint == 0x85 || CodePoint == 0xA0 || CodePoint == 0x1680 || (CodePoint >= 0x2000 && CodePoint <= 0x200A) ||
+           CodePoint == 0x2028 || CodePoint == 0x2029 || CodePoint == 0x202F || CodePoint == 0x205F || CodePoint == 0x3000;
+}
+
+uint8 ToLowerAscii(uint8 Byte)
+{
+    return Byte >= 'A' && Byte <= 'Z' ? Byte + ('a' - 'A') : Byte;
+}
+
+uint8 ClassifyCodePoint(uint32 CodePoint)
+{
+    if (IsSpace(CodePoint)) return Space;
+    if (IsMark(CodePoint)) return Upper | Lower;
+
+    if (CodePoint > 0xFFFF)
+    {
+        // CJK extensions, other supplementary planes are symbols and emoji
+        return CodePoint >= 0x20000 && CodePoint <= 0x3FFFF ? Letter | Upper | Lower : Other;
+    }
+
+    const TCHAR Char = static_cast<TCHAR>(CodePoint);
+    if (FChar::IsAlpha(Char))
+    {
+        const bool bUpper = FChar::IsUpper(Char);
+        const bool bLower = FChar::IsLower(Char);
+        // letters without case (CJK, Arabic, ...) match both o200k word classes
+        return Letter | (bUpper ? Upper : 0) | (bLower ? Lower : 0) | (!bUpper && !bLower ? Upper | Lower : 0);
+    }
+    return Other;
+}
+
+/**
+  UTF-8 scanner that matches one piece of the pre-tokenization regex at a time.
+  Invalid bytes are single characters of no class.
+*/
+class FPieceScanner
+{
+public:
+    FPieceScanner(const uint8* InText, int32 InLength) : Text(InText), Length(InLength) {}
+
+    /**
+      '(?i:[sdmt]|ll|ve|re)|[^\r\n\p{L}\p{N}]?+\p{L}++|\p{N}{1,3}+| ?[^\s\p{L}\p{N}]++[\r\n]*+|\s++$|\s*[\r\n]|\s+(?!\S)|\s
+    */
+    int32 MatchCl100k(int32 Index) const
+    {
+        int32 Size;
+        const uint8 Class = ClassAt(Index, Size);
+
+        if (const int32 Contraction = MatchContraction(Index))
+        {
+            return Index + Contraction;
+        }
+
+        int32 WordBegin = Index;
+        if (!(Class & (Letter | Number | Newline)) && Index + Size < Length && (ClassAt(Index + Size) & Letter))
+        {
+            WordBegin = Index + Size;
+        }
+        if (WordBegin < Length && (ClassAt(WordBegin) & Letter))
+        {
+            return SkipWhile(WordBegin, Letter);
+        }
+
+        if (Class & Number)
+        {
+            return SkipDigits(Index);
+        }
+
+        if (const int32 End = MatchPunctuation(Index, false))
+        {
+            return End;
+        }
+
+        return Class & Space ? MatchWhitespace(Index, false) : Index + Size;
+    }
+
+    /**
+      [^\r\n\p{L}\p{N}]?[\p{Lu}\p{Lt}\p{Lm}\p{Lo}\p{M}]*[\p{Ll}\p{Lm}\p{Lo}\p{M}]+(?i:'s|'t|'re|'ve|'m|'ll|'d)?
+      |[^\r\n\p{L}\p{N}]?[\p{Lu}\p{Lt}\p{Lm}\p{Lo}\p{M}]+[\p{Ll}\p{Lm}\p{Lo}\p{M}]*(?i:'s|'t|'re|'ve|'m|'ll|'d)?
+      |\p{N}{1,3}| ?[^\s\p{L}\p{N}]+[\r\n/]*|\s*[\r\n]+|\s+(?!\S)|\s+
+    */
+    int32 MatchO200k(int32 Index) const
+    {
+        int32 Size;
+        const uint8 Class = ClassAt(Index, Size);
+
+        int32 WordBegin = Index;
+        if (!(Class & (Letter | Number | Newline)) && Index + Size < Length && (ClassAt(Index + Size) & (Upper | Lower)))
+        {
+            WordBegin = Index + Size;
+        }
+        if (WordBegin < Length && (ClassAt(WordBegin) & (Upper | Lower)))
+        {
+            // characters without case are in both classes, the regex backtracks the upper case run
+            // to the last character that can start the lower case part
+            int32 UpperEnd = WordBegin;
+            int32 LastLowerEnd = INDEX_NONE;
+            while (UpperEnd < Length)
+            {
+                int32 CharSize;
+                const uint8 CharClass = ClassAt(UpperEnd, CharSize);
+                if (!(CharClass & Upper)) break;
+                UpperEnd += CharSize;
+                if (CharClass & Lower)
+                {
+                    LastLowerEnd = UpperEnd;
+                }
+            }
+
+            int32 End = UpperEnd;
+            if (UpperEnd < Length && (ClassAt(UpperEnd) & Lower))
+            {
+                End = SkipWhile(UpperEnd, Lower);
+            }
+            else if (LastLowerEnd != INDEX_NONE)
+            {
+                End = LastLowerEnd;
+            }
+            return End + MatchContraction(End);
+        }
+
+        if (Class & Number)
+        {
+            return SkipDigits(Index);
+        }
+
+        if (const int32 End = MatchPunctuation(Index, true))
+        {
+            return End;
+        }
+
+        return Class & Space ? MatchWhitespace(Index, true) : Index + Size;
+    }
+
+private:
+    const uint8* Text;
+    const int32 Length;
+
+    uint8 ClassAt(int32 Index, int32& Size) const
+    {
+        const uint8 Byte = Text[Index];
+        if (Byte < 0x80)
+        {
+            Size = 1;
+            return AsciiClasses.Classes[Byte];
+        }
+
+        const int32 Expected = (Byte & 0xE0) == 0xC0 ? 2 : (Byte & 0xF0) == 0xE0 ? 3 : (Byte & 0xF8) == 0xF0 ? 4 : 0;
+        if (Expected == 0 || Index + Expected > Length)
+        {
+            Size = 1;
+            return Other;
+        }
+
+        uint32 CodePoint = Byte & (0x7F >> Expected);
+        for (int32 Offset = 1; Offset < Expected; ++Offset)
+        {
+            const uint8 Continuation = Text[Index + Offset];
+            if ((Continuation & 0xC0) != 0x80)
+            {
+                Size = 1;
+                return Other;
+            }
+            CodePoint = (CodePoint << 6) | (Continuation & 0x3F);
+        }
+        Size = Expected;
+        return ClassifyCodePoint(CodePoint);
+    }
+
+    uint8 ClassAt(int32 Index) const
+    {
+        int32 Size;
+        return ClassAt(Index, Size);
+    }
+
+    int32 SkipWhile(int32 Index, uint8 Mask) const
+    {
+        while (Index < Length)
+        {
+            int32 Size;
+            if (!(ClassAt(Index, Size) & Mask)) break;
+            Index += Size;
+        }
+        return Index;
+    }
+
+    int32 SkipDigits(int32 Index) const
+    {
+        for (int32 Digit = 0; Digit < 3 && Index < Length; ++Digit)
+        {
+            int32 Size;
+            if (!(ClassAt(Index, Size) & Number)) break;
+            Index += Size;
+        }
+        return Index;
+    }
+
+    /**
+      Length of 's 't 're 've 'm 'll 'd (any case) at the index, zero if there is none.
+    */
+    int32 MatchContraction(int32 Index) const
+    {
+        if (Index + 1 >= Length || Text[Index] != '\'') return 0;
+
+        const uint8 First = ToLowerAscii(Text[Index + 1]);
+        if (First == 's' || First == 't' || First == 'm' || First == 'd') return 2;
+        if (Index + 2 >= Length) return 0;
+
+        const uint8 Second = ToLowerAscii(Text[Index + 2]);
+        const bool bMatch = (First == 'r' && Second == 'e') || (First == 'v' && Second == 'e') || (First == 'l' && Second == 'l');
+        return bMatch ? 3 : 0;
+    }
+
+    /**
+      ' ?[^\s\p{L}\p{N}]+' followed by new lines (and slashes for o200k), zero if there is no match.
+    */
+    int32 MatchPunctuation(int32 Index, bool bSlashes) const
+    {
+        const int32 Begin = Text[Index] == ' ' ? Index + 1 : Index;
+        const int32 End = SkipPunctuation(Begin);
+        if (End == Begin) return 0;
+
+        int32 Tail = End;
+        while (Tail < Length && (Text[Tail] == '\r' || Text[Tail] == '\n' || (bSlashes && Text[Tail] == '/')))
+        {
+            ++Tail;
+        }
+        return Tail;
+    }
+
+    int32 SkipPunctuation(int32 Index) const
+    {
+        while (Index < Length)
+        {
+            int32 Size;
+            if (ClassAt(Index, Size) & (Letter | Number | Space)) break;
+            Index += Size;
+        }
+        return Index;
+    }
+
+    /**
+      \s++$|\s*[\r\n]|\s+(?!\S)|\s : the run up to the end of the text, the run up to its last new line,
+      the run without its last character (that becomes the prefix of the next word) or the single character.
+      o200k tries the new lines before the end of the text.
+    */
+    int32 MatchWhitespace(int32 Index, bool bNewlinesFirst) const
+    {
+        int32 End = Index;
+        int32 LastChar = Index;
+        int32 LastNewline = INDEX_NONE;
+        while (End < Length)
+        {
+            int32 Size;
+            const uint8 Class = ClassAt(End, Size);
+            if (!(Class & Space)) break;
+            if (Class & Newline)
+            {
+                LastNewline = End + Size;
+            }
+            LastChar = End;
+            End += Size;
+        }
+
+        if (bNewlinesFirst && LastNewline != INDEX_NONE) return LastNewline;
+        if (End == Length) return End;
+        if (LastNewline != INDEX_NONE) return LastNewline;
+        return LastChar > Index ? LastChar : End;
+    }
+};
+
+uint64 HashBytes(const uint8* Data, int32 Length)
+{
+    // FNV-1a, tokens are short
+    uint64 Hash = 0xcbf29ce484222325ull;
+    for (int32 Index = 0; Index < Length; ++Index)
+    {
+        Hash = (Hash ^ Data[Index]) * 0x100000001b3ull;
+    }
+    return Hash ^ (Hash >> 29);
+}
+
+const TCHAR* GetEncodingName(EBPEEncoding Encoding)
+{
+    return Encoding == EBPEEncoding::O200kBase ? TEXT("o200k_base") : TEXT("cl100k_base");
+}
+
+struct FSharedTokenizer
+{
+    FCriticalSection Lock;
+    TUniquePtr<FBPETokenizer> Tokenizer;
+    /**
+      Zero until the first load, then 1 if loaded and -1 if the rank file isn't available.
+    */
+    std::atomic<int32> State{0};
+};
+
+FSharedTokenizer& GetSharedTokenizer(EBPEEncoding Encoding)
+{
+    static FSharedTokenizer SharedTokenizers[NumEncodings];
+    return SharedTokenizers[static_cast<int32>(Encoding)];
+}
+}  // namespace
+
+template <typename OnPieceType>
+void FBPETokenizer::SplitPieces(const uint8* Text, int32 Length, OnPieceType&& OnPiece) const
+{
+    const FPieceScanner Scanner(Text, Length);
+    const bool bO200k = Encoding == EBPEEncoding::O200kBase;
+    for (int32 Index = 0; Index < Length;)
+    {
+        const int32 End = bO200k ? Scanner.MatchO200k(Index) : Scanner.MatchCl100k(Index);
+        OnPiece(Text + Index, End - Index);
+        Index = End;
+    }
+}
+
+FBPETokenizer::FBPETokenizer() = default;
+FBPETokenizer::~FBPETokenizer() = default;
+
+bool FBPETokenizer::Load(const FString& FilePath, EBPEEncoding InEncoding)
+{
+    Bytes.Reset();
+    Tokens.Reset();
+    Slots.Reset();
+    NumTokens = 0;
+    Encoding = InEncoding;
+
+    FMappedFile File;
+    if (!File.Open(FilePath))
+    {
+        UE_LOGFMT(LogBPETokenizer, Warning, "Can't open rank file: {0}", FilePath);
+        return false;
+    }
+
+    TArray<FMappedFile::FLine> Lines;
+    File.SplitLines(Lines);
+    Tokens.SetNumZeroed(Lines.Num());
+    Bytes.Reserve(Lines.Num() * 8);
+
+    TArray<uint8> Token;
+    for (const FMappedFile::FLine& Line : Lines)
+    {
+        const FUtf8StringView LineView = File.View(Line);
+        int32 Separator;
+        if (!LineView.FindChar(' ', Separator))
+        {
+            UE_LOGFMT(LogBPETokenizer, Warning, "Invalid line at offset {0} of the rank file: {1}", Line.Offset, FilePath);
+            return false;
+        }
+
+        const FString Base64(LineView.Left(Separator));
+        const FString RankString(LineView.Mid(Separator + 1));
+        const int32 Rank = FCString::Atoi(*RankString);
+        if (!FBase64::Decode(Base64, Token) || Token.IsEmpty() || Rank < 0 || Rank >= Tokens.Num() || Tokens[Rank].Length != 0)
+        {
+            UE_LOGFMT(LogBPETokenizer, Warning, "Invalid token at offset {0} of the rank file: {1}", Line.Offset, FilePath);
+            return false;
+        }
+
+        Tokens[Rank] = FToken{static_cast<uint32>(Bytes.Num()), static_cast<uint32>(Token.Num())};
+        Bytes.Append(Token);
+    }
+
+    Slots.SetNumZeroed(FMath::RoundUpToPowerOfTwo(FMath::Max(Tokens.Num() * 2, 16)));
+    const uint32 Mask = Slots.Num() - 1;
+    for (int32 Rank = 0; Rank < Tokens.Num(); ++Rank)
+    {
+        const FToken& Entry = Tokens[Rank];
+        if (Entry.Length == 0)
+        {
+            UE_LOGFMT(LogBPETokenizer, Warning, "Rank {0} is missing in the rank file: {1}", Rank, FilePath);
+            return false;
+        }
+
+        uint32 Slot = static_cast<uint32>(HashBytes(&Bytes[Entry.Offset], Entry.Length)) & Mask;
+        while (Slots[Slot] != 0)
+        {
+            Slot = (Slot + 1) & Mask;
+        }
+        Slots[Slot] = Rank + 1;
+    }
+
+    // every byte must be a token, so any text can be encoded
+    for (int32 Byte = 0; Byte < 256; ++Byte)
+    {
+        const uint8 Data = static_cast<uint8>(Byte);
+        if (FindRank(&Data, 1) == INDEX_NONE)
+        {
+            UE_LOGFMT(LogBPETokenizer, Warning, "Byte {0} isn't a token of the rank file: {1}", Byte, FilePath);
+            Slots.Reset();
+            return false;
+        }
+    }
+
+    NumTokens = Tokens.Num();
+    UE_LOGFMT(LogBPETokenizer, Display, "Loaded {0} tokens of {1}", NumTokens, GetEncodingName(Encoding));
+    return true;
+}
+
+const FBPETokenizer* FBPETokenizer::Get(EBPEEncoding Encoding)
+{
+    FSharedTokenizer& Shared = GetSharedTokenizer(Encoding);
+    const int32 State = Shared.State.load(std::memory_order_acquire);
+    if (State != 0)
+    {
+        return State > 0 ? Shared.Tokenizer.Get() : nullptr;
+    }
+
+    FScopeLock Lock(&Shared.Lock);
+    if (Shared.State.load(std::memory_order_relaxed) == 0)
+    {
+        auto Tokenizer = MakeUnique<FBPETokenizer>();
+        if (Tokenizer->Load(GetDefaultFilePath(Encoding), Encoding))
+        {
+            Shared.Tokenizer = MoveTemp(Tokenizer);
+            Shared.State.store(1, std::memory_order_release);
+        }
+        else
+        {
+            UE_LOGFMT(LogBPETokenizer, Warning, "{0} isn't available, tokens are estimated", GetEncodingName(Encoding));
+            Shared.State.store(-1, std::memory_order_release);
+        }
+    }
+    return Shared.Tokenizer.Get();
+}
+
+FString FBPETokenizer::GetDefaultFilePath(EBPEEncoding Encoding)
+{
+    const FString FileName = FString(GetEncodingName(Encoding)) + TEXT(".tiktoken");
+    return FPaths::Combine(FPaths::ProjectContentDir(), TEXT("OpenAI"), TEXT("Tokenizer"), FileName);
+}
+
+EBPEEncoding FBPETokenizer::GetEncodingForModel(const FString& Model)
+{
+    return FModelRegistry::Get()->GetEncoding(Model);
+}
+
+FTokenCounter FBPETokenizer::MakeTokenCounter(EBPEEncoding Encoding)
+{
+    return [Encoding](FStringView Text)
+    {
+        const FBPETokenizer* Tokenizer = Get(Encoding);
+        return Tokenizer ? Tokenizer->Count(Text) : EstimateTokens(Text);
+    };
+}
+
+int32 FBPETokenizer::Count(FStringView Text) const
+{
+    if (!IsLoaded()) return EstimateTokens(Text);
+
+    const FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+    int32 TokenCount = 0;
+    FParts Parts;
+    SplitPieces(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length(),
+        [&](const uint8* Piece, int32 Length)
+        {
+            if (FindRank(Piece, Length) != INDEX_NONE)
+            {
+                ++TokenCount;
+                return;
+            }
+            MergePiece(Piece, Length, Parts);
+            TokenCount += Parts.Num() - 1;
+        });
+    return TokenCount;
+}
+
+void FBPETokenizer::Encode(FStringView Text, TArray<int32>& OutTokens) const
+{
+    OutTokens.Reset();
+    if (!IsLoaded()) return;
+
+    const FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+    FParts Parts;
+    SplitPieces(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length(),
+        [&](const uint8* Piece, int32 Length)
+        {
+            const int32 Rank = FindRank(Piece, Length);
+            if (Rank != INDEX_NONE)
+            {
+                OutTokens.Add(Rank);
+                return;
+            }
+
+            MergePiece(Piece, Length, Parts);
+            for (int32 Index = 0; Index + 1 < Parts.Num(); ++Index)
+            {
+                OutTokens.Add(FindRank(Piece + Parts[Index].Start, Parts[Index + 1].Start - Parts[Index].Start));
+            }
+        });
+}
+
+FString FBPETokenizer::Decode(TArrayView<const int32> InTokens) const
+{
+    TArray<uint8> Utf8;
+    for (const int32 Rank : InTokens)
+    {
+        if (!Tokens.IsValidIndex(Rank)) continue;
+        Utf8.Append(&Bytes[Tokens[Rank].Offset], Tokens[Rank].Length);
+    }
+    return FString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Utf8.GetData()), Utf8.Num()));
+}
+
+int32 FBPETokenizer::FindRank(const uint8* Data, int32 Length) const
+{
+    if (Slots.IsEmpty()) return INDEX_NONE;
+
+    const uint32 Mask = Slots.Num() - 1;
+    for (uint32 Slot = static_cast<uint32>(HashBytes(Data, Length)) & Mask;; Slot = (Slot + 1) & Mask)
+    {
+        const uint32 Entry = Slots[Slot];
+        if (Entry == 0) return INDEX_NONE;
+
+        const FToken& Token = Tokens[Entry - 1];
+        if (Token.Length == static_cast<uint32>(Length) && FMemory::Memcmp(&Bytes[Token.Offset], Data, Length) == 0)
+        {
+            return Entry - 1;
+        }
+    }
+}
+
+void FBPETokenizer::MergePiece(const uint8* Piece, int32 Length, FParts& Parts) const
+{
+    // https://github.com/openai/tiktoken/blob/main/src/lib.rs byte_pair_merge
+    const auto GetRank = [&](int32 Index)
+    {
+        if (Index + 2 >= Parts.Num()) return NoRank;
+        const int32 Rank = FindRank(Piece + Parts[Index].Start, Parts[Index + 2].Start - Parts[Index].Start);
+        return Rank != INDEX_NONE ? Rank : NoRank;
+    };
+
+    Parts.SetNumUninitialized(Length + 1);
+    for (int32 Index = 0; Index <= Length; ++Index)
+    {
+        Parts[Index].Start = Index;
+    }
+    for (int32 Index = 0; Index <= Length; ++Index)
+    {
+        Parts[Index].Rank = GetRank(Index);
+    }
+
+    while (Parts.Num() > 2)
+    {
+        int32 MinIndex = INDEX_NONE;
+        int32 MinRank = NoRank;
+        for (int32 Index = 0; Index + 1 < Parts.Num(); ++Index)
+        {
+            if (Parts[Index].Rank < MinRank)
+            {
+                MinRank = Parts[Index].Rank;
+                MinIndex = Index;
+            }
+        }
+        if (MinIndex == INDEX_NONE) break;
+
+        // the ranks of the merged part and of the one before it are taken as if the next part were already removed
+        Parts.RemoveAt(MinIndex + 1);
+        Parts[MinIndex].Rank = GetRank(MinIndex);
+        if (MinIndex > 0)
+        {
+            Parts[MinIndex - 1].Rank = GetRank(MinIndex - 1);
+        }
+    }
+}
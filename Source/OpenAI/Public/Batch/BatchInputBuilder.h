@@ -0,0 +1,101 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/BatchTypes.h"
+#include "Provider/Types/CommonTypes.h"
+#include "Templates/SubclassOf.h"
+
+class UOpenAIProvider;
+struct FChatCompletion;
+struct FEmbeddings;
+
+namespace OpenAI
+{
+class FFileManifest;
+
+/**
+  One JSONL input file of a batch.
+  https://platform.openai.com/docs/api-reference/batch/request-input
+*/
+struct FBatchInputShard
+{
+    FString FilePath;
+    FString Endpoint;
+    TArray<FString> CustomIds;
+    int64 NumBytes{};
+};
+
+/**
+  Uploaded shard that is ready to be passed to UOpenAIProvider::CreateBatch.
+*/
+struct FBatchSpec
+{
+    FCreateBatch CreateBatch;
+    FBatchInputShard Shard;
+};
+
+using FOnBatchSpecsReady = TFunction<void(const TArray<FBatchSpec>& /* Specs */, bool /* AllUploaded */)>;
+
+/**
+  Builds Batch API input files from typed requests.
+
+  Requests are serialized on the worker threads, each request becomes one line of the JSONL file.
+  Lines are split into shards that fit the Batch API limits (50,000 requests and 200 MB per file),
+  shards are streamed to disk and can be uploaded with the batch purpose in one call.
+*/
+class OPENAI_API FBatchInputBuilder
+{
+public:
+    static constexpr int32 MaxRequestsPerFile = 50000;
+    static constexpr int64 MaxBytesPerFile = 200 * 1024 * 1024;
+
+    explicit FBatchInputBuilder(EBatchEndpoint Endpoint = EBatchEndpoint::ChatCompletions);
+    explicit FBatchInputBuilder(const FString& InEndpoint) : Endpoint(InEndpoint) {}
+
+    /**
+      CustomIds must be unique within the batch and have the same size as Requests.
+    */
+    void Add(const TArray<FChatCompletion>& Requests, const TArray<FString>& CustomIds);
+    void Add(const TArray<FEmbeddings>& Requests, const TArray<FString>& CustomIds);
+
+    /**
+      Adds request line that was serialized before, e.g. a line from the previous input file.
+    */
+    void AddLine(const FString& CustomId, FUtf8StringView Line);
+
+    void SetLimits(int32 MaxRequests, int64 MaxBytes);
+    void Reset();
+
+    int32 Num() const { return Lines.Num(); }
+    const FString& GetEndpoint() const { return Endpoint; }
+
+    /**
+      Writes shards to OutputDir (Saved/OpenAI/Batch if empty), files are named <FileNamePrefix>_<ShardIndex>.jsonl
+    */
+    bool Build(TArray<FBatchInputShard>& Shards, const FString& FileNamePrefix = "batch_input", const FString& OutputDir = {}) const;
+
+    /**
+      Uploads all shards in parallel, OnCompleted is called on the game thread once every upload has finished.
+      Shards that are already in the file manifest aren't uploaded again.
+      Files are uploaded with providers of ProviderClass, UOpenAIProvider if it's not set.
+    */
+    static void Upload(const TArray<FBatchInputShard>& Shards, const FOpenAIAuth& Auth, const FOnBatchSpecsReady& OnCompleted,
+        const TSharedPtr<FFileManifest>& FileManifest = nullptr, const TSubclassOf<UOpenAIProvider>& ProviderClass = nullptr);
+
+    static FString DefaultOutputDir();
+
+private:
+    FString Endpoint;
+    int32 MaxRequests{MaxRequestsPerFile};
+    int64 MaxBytes{MaxBytesPerFile};
+
+    TArray<FString> CustomIds;
+    TArray<TArray<uint8>> Lines;
+
+    template <typename RequestType>
+    void AddRequests(const TArray<RequestType>& Requests, const TArray<FString>& InCustomIds);
+};
+
+}  // namespace OpenAI
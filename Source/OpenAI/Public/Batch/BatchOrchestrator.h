@@ -0,0 +1,189 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Containers/Ticker.h"
+#include "Batch/BatchInputBuilder.h"
+#include "Batch/BatchResultReader.h"
+#include "Provider/Types/BatchTypes.h"
+#include "Provider/Types/CommonTypes.h"
+#include "BatchOrchestrator.generated.h"
+
+class UOpenAIProvider;
+
+namespace OpenAI
+{
+/**
+  Results of all batches of the orchestrator joined by custom_id.
+  Lines stay inside of the downloaded files and are parsed on request.
+*/
+class OPENAI_API FBatchResults
+{
+public:
+    /**
+      Successful lines replace failed ones with the same custom_id, e.g. after a retry.
+    */
+    void Add(const TSharedRef<const FBatchResultReader>& Reader, bool Succeeded);
+
+    int32 Num() const { return Index.Num(); }
+    int32 NumSucceeded() const { return SucceededNum; }
+    bool Contains(const FString& CustomId) const { return Index.Contains(CustomId); }
+    bool Succeeded(const FString& CustomId) const;
+    void GetCustomIds(TArray<FString>& CustomIds) const { Index.GetKeys(CustomIds); }
+
+    template <typename BodyType>
+    bool Find(const FString& CustomId, TBatchResult<BodyType>& Result) const
+    {
+        const FEntry* Entry = Index.Find(CustomId);
+        return Entry && Readers[Entry->ReaderIndex]->Parse(Entry->LineIndex, Result);
+    }
+
+    void Reset();
+
+private:
+    struct FEntry
+    {
+        int32 ReaderIndex{};
+        int32 LineIndex{};
+        bool Succeeded{};
+    };
+
+    TArray<TSharedRef<const FBatchResultReader>> Readers;
+    TMap<FString, FEntry> Index;
+    int32 SucceededNum{};
+};
+}  // namespace OpenAI
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBatchStatusChanged, const FOpenAIBatch&);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBatchOrchestratorCompleted, const OpenAI::FBatchResults&);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnBatchOrchestratorError, const FString& /* Error */);
+
+/**
+  Drives a set of batches from input files to joined results.
+
+  Shards of the builder are uploaded and submitted as separate batches.
+  One ticker polls all tracked batches with a single paginated ListBatch request,
+  the interval grows while nothing changes and resets when any batch changes its status.
+  Output and error files of finished batches are downloaded and indexed on the worker threads,
+  retryable failures (rate limits, server errors, expired requests) are resubmitted as new batches.
+*/
+UCLASS()
+class OPENAI_API UBatchOrchestrator : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void BeginDestroy() override;
+
+    void SetAuth(const FOpenAIAuth& InAuth) { Auth = InAuth; }
+    void SetLogEnabled(bool LogEnabled) { bLogEnabled = LogEnabled; }
+
+    /**
+      Class of the providers that talk to the API, e.g. a fake one in tests.
+    */
+    void SetProviderClass(const TSubclassOf<UOpenAIProvider>& InProviderClass) { ProviderClass = InProviderClass; }
+
+    /**
+      Interval between polls in seconds.
+    */
+    void SetPollingInterval(float MinInterval, float MaxInterval);
+
+    /**
+      How many times a failed request can be resubmitted.
+    */
+    void SetMaxRetries(int32 InMaxRetries) { MaxRetries = FMath::Max(0, InMaxRetries); }
+
+    /**
+      Builds input files, uploads them and creates one batch per file.
+      OnCompleted is broadcasted once all batches (including retries) are finished.
+    */
+    void Submit(const OpenAI::FBatchInputBuilder& Builder, const FString& Name = "batch");
+
+    /**
+      Cancels all tracked batches, partial results are still downloaded.
+    */
+    void Cancel();
+
+    bool IsRunning() const { return NumPendingOperations > 0 || HasActiveJobs(); }
+
+    /**
+      Results of the batches since the last submission that was made when nothing was running.
+    */
+    const OpenAI::FBatchResults& GetResults() const { return Results; }
+
+    /**
+      Rate limits, server errors and expired requests. Other failures aren't fixed by a resubmission.
+    */
+    static bool IsRetryable(const OpenAI::FBatchResultHeader& Header);
+
+    /**
+      Requests of the shard that are in neither file or failed with a retryable error.
+    */
+    static TArray<FString> FindRetryIds(const OpenAI::FBatchInputShard& Shard, const OpenAI::FBatchResultReader& OutputReader,
+        const OpenAI::FBatchResultReader& ErrorReader);
+
+    FOnBatchStatusChanged& OnBatchStatusChanged() { return BatchStatusChanged; }
+    FOnBatchOrchestratorCompleted& OnCompleted() { return Completed; }
+    FOnBatchOrchestratorError& OnError() { return Error; }
+
+private:
+    struct FBatchJob
+    {
+        OpenAI::FBatchSpec Spec;
+        FOpenAIBatch Batch;
+        FString Name;
+        int32 Attempt{};
+        bool Finished{false};
+    };
+
+    UPROPERTY()
+    TArray<TObjectPtr<UOpenAIProvider>> Providers;
+
+    UPROPERTY()
+    TSubclassOf<UOpenAIProvider> ProviderClass;
+
+    FOpenAIAuth Auth;
+    TArray<FBatchJob> Jobs;
+    OpenAI::FBatchResults Results;
+
+    float MinPollInterval{10.0f};
+    float MaxPollInterval{300.0f};
+    float PollInterval{10.0f};
+    double NextPollTime{0.0};
+    bool bPollInProgress{false};
+    int32 MaxRetries{2};
+    int32 NumPendingOperations{0};
+    bool bSubmitted{false};
+    bool bCancelled{false};
+    bool bLogEnabled{false};
+
+    FTSTicker::FDelegateHandle TickerHandle;
+
+    FOnBatchStatusChanged BatchStatusChanged;
+    FOnBatchOrchestratorCompleted Completed;
+    FOnBatchOrchestratorError Error;
+
+    bool Tick(float DeltaTime);
+    void Poll();
+    void ListBatchPage(const FString& After, int32 Page, TSharedRef<TSet<FString>> SeenBatches, TSharedRef<bool> AnyStatusChanged);
+    void RetrieveUnseenBatches(const TSet<FString>& SeenBatches, TSharedRef<bool> AnyStatusChanged);
+    void FinishPoll(bool AnyStatusChanged);
+    bool UpdateJob(const FOpenAIBatch& Batch);
+
+    void UploadAndCreate(const TArray<OpenAI::FBatchInputShard>& Shards, const FString& Name, int32 Attempt);
+    void CreateBatch(const OpenAI::FBatchSpec& Spec, const FString& Name, int32 Attempt);
+    void DownloadResults(int32 JobIndex);
+    void RetrieveFileContent(const FString& FileId, TFunction<void(FString&&)> OnRetrieved);
+    void OnResultsDownloaded(int32 JobIndex, FString&& OutputContent, FString&& ErrorContent);
+
+    bool HasActiveJobs() const;
+    void TryComplete();
+    void ReportError(const FString& ErrorText);
+
+    UOpenAIProvider* MakeProvider();
+    void ReleaseProvider(UOpenAIProvider* Provider);
+    void StartTicker();
+    void StopTicker();
+};
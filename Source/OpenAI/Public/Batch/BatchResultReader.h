@@ -0,0 +1,180 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IO/MappedFile.h"
+#include "Provider/Types/BatchTypes.h"
+#include "Provider/Types/EmbeddingTypes.h"
+#include "Async/ParallelFor.h"
+#include "JsonObjectConverter.h"
+
+class FJsonObject;
+
+namespace OpenAI
+{
+/**
+  Fields of the batch output line that don't depend on the endpoint.
+  https://platform.openai.com/docs/api-reference/batch/request-output
+*/
+struct FBatchResultHeader
+{
+    FString Id;
+    FString Custom_Id;
+    int32 Status_Code{};
+    FString Request_Id;
+    FBatchRequestOutputError Error;
+    bool HasError{false};
+
+    bool Succeeded() const { return !HasError && Status_Code >= 200 && Status_Code < 300; }
+};
+
+/**
+  Batch output line with the response body parsed into the endpoint response type,
+  e.g. TBatchResult<FChatCompletionResponse> or TBatchResult<FEmbeddingsResponse>.
+*/
+template <typename BodyType>
+struct TBatchResult : public FBatchResultHeader
+{
+    BodyType Body;
+};
+
+/**
+  Reader for the output and error files of the Batch API.
+
+  The file is memory-mapped and split into lines once, custom_id index is built in parallel.
+  Lines are parsed only when requested: one by one through Find() and the lazy iterator
+  or all at once on the worker threads through ParseAll().
+  All const methods are safe to call from several threads.
+*/
+class OPENAI_API FBatchResultReader
+{
+public:
+    bool Open(const FString& FilePath);
+
+    /**
+      Content that was received with UOpenAIProvider::RetrieveFileContent.
+    */
+    bool OpenFromString(const FString& Content);
+
+    int32 Num() const { return Lines.Num(); }
+    bool Contains(const FString& CustomId) const { return CustomIdToLine.Contains(CustomId); }
+    int32 FindLine(const FString& CustomId) const;
+
+    const FString& GetCustomId(int32 LineIndex) const { return CustomIds[LineIndex]; }
+    const TArray<FString>& GetCustomIds() const { return CustomIds; }
+
+    /**
+      Raw UTF-8 JSON of the line, valid while the reader is alive.
+    */
+    FUtf8StringView GetLine(int32 LineIndex) const;
+
+    /**
+      Parses everything except of the response body.
+    */
+    bool ParseHeader(int32 LineIndex, FBatchResultHeader& Header) const
+    {
+        TSharedPtr<FJsonObject> Body;
+        return ParseLine(LineIndex, Header, Body);
+    }
+
+    template <typename BodyType>
+    bool Parse(int32 LineIndex, TBatchResult<BodyType>& Result) const
+    {
+        TSharedPtr<FJsonObject> Body;
+        if (!ParseLine(LineIndex, Result, Body)) return false;
+        return !Body.IsValid() || BodyToStruct(Body.ToSharedRef(), Result.Body);
+    }
+
+    template <typename BodyType>
+    bool Find(const FString& CustomId, TBatchResult<BodyType>& Result) const
+    {
+        const int32 LineIndex = FindLine(CustomId);
+        return LineIndex != INDEX_NONE && Parse(LineIndex, Result);
+    }
+
+    /**
+      Parses all lines in parallel, results keep the order of the file.
+      Returns false if at least one line is malformed.
+    */
+    template <typename BodyType>
+    bool ParseAll(TArray<TBatchResult<BodyType>>& Results) const
+    {
+        Results.SetNum(Lines.Num());
+        std::atomic<bool> AllParsed{true};
+        ParallelFor(Lines.Num(),
+            [&](int32 LineIndex)
+            {
+                if (!Parse(LineIndex, Results[LineIndex]))
+                {
+                    AllParsed = false;
+                }
+            });
+        return AllParsed;
+    }
+
+    template <typename BodyType>
+    class TIterator
+    {
+    public:
+        TIterator(const FBatchResultReader& InReader, int32 InLineIndex) : Reader(InReader), LineIndex(InLineIndex) {}
+
+        TIterator& operator++()
+        {
+            ++LineIndex;
+            return *this;
+        }
+
+        bool operator!=(const TIterator& Other) const { return LineIndex != Other.LineIndex; }
+
+        TBatchResult<BodyType> operator*() const
+        {
+            TBatchResult<BodyType> Result;
+            Reader.Parse(LineIndex, Result);
+            return Result;
+        }
+
+        int32 GetLineIndex() const { return LineIndex; }
+
+    private:
+        const FBatchResultReader& Reader;
+        int32 LineIndex;
+    };
+
+    template <typename BodyType>
+    struct TRange
+    {
+        const FBatchResultReader& Reader;
+        TIterator<BodyType> begin() const { return TIterator<BodyType>(Reader, 0); }
+        TIterator<BodyType> end() const { return TIterator<BodyType>(Reader, Reader.Num()); }
+    };
+
+    /**
+      Lazy iteration, each line is parsed on dereference:
+      for (const auto& Result : Reader.Iterate<FChatCompletionResponse>()) {...}
+    */
+    template <typename BodyType>
+    TRange<BodyType> Iterate() const
+    {
+        return TRange<BodyType>{*this};
+    }
+
+private:
+    FMappedFile File;
+    TArray<FMappedFile::FLine> Lines;
+    TArray<FString> CustomIds;
+    TMap<FString, int32> CustomIdToLine;
+
+    bool BuildIndex();
+    bool ParseLine(int32 LineIndex, FBatchResultHeader& Header, TSharedPtr<FJsonObject>& Body) const;
+
+    template <typename BodyType>
+    static bool BodyToStruct(const TSharedRef<FJsonObject>& Body, BodyType& Struct)
+    {
+        return FJsonObjectConverter::JsonObjectToUStruct(Body, &Struct, 0, 0);
+    }
+    // base64 vectors are decoded separately
+    static bool BodyToStruct(const TSharedRef<FJsonObject>& Body, FEmbeddingsResponse& Struct);
+};
+
+}  // namespace OpenAI
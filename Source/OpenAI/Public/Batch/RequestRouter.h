@@ -0,0 +1,134 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Async/Future.h"
+#include "Containers/Queue.h"
+#include "Provider/Types/Chat/ChatCompletionTypes.h"
+#include "Provider/Types/EmbeddingTypes.h"
+#include "Provider/Types/CommonTypes.h"
+#include "Templates/SubclassOf.h"
+#include "RequestRouter.generated.h"
+
+class UOpenAIProvider;
+class UBatchOrchestrator;
+
+namespace OpenAI
+{
+enum class ERequestRoute : uint8
+{
+    Sync,
+    Batch
+};
+
+struct FRoutingPolicy
+{
+    /**
+      Workloads that can wait at least this long are allowed to go through the Batch API.
+      Batches are completed within the 24h completion window.
+    */
+    FTimespan BatchLatencyThreshold{FTimespan::FromHours(24.0)};
+
+    /**
+      Smaller workloads are sent directly, a batch doesn't pay off for a few requests.
+    */
+    int32 MinBatchSize{100};
+
+    /**
+      Max number of synchronous requests in flight.
+    */
+    int32 MaxConcurrentRequests{8};
+};
+
+template <typename ResponseType>
+struct TRoutedResult
+{
+    FString CustomId;
+    bool Succeeded{false};
+    FString Error;
+    ResponseType Response;
+};
+
+using FChatCompletionResults = TArray<TRoutedResult<FChatCompletionResponse>>;
+using FEmbeddingsResults = TArray<TRoutedResult<FEmbeddingsResponse>>;
+
+using FOnChatCompletionsRouted = TFunction<void(const FChatCompletionResults& /* Results */)>;
+using FOnEmbeddingsRouted = TFunction<void(const FEmbeddingsResults& /* Results */)>;
+}  // namespace OpenAI
+
+/**
+  Executes a workload either with the regular endpoints or with the Batch API.
+
+  The route is chosen from the size of the workload and the latency the caller can tolerate,
+  results are delivered in the order of the requests through the same callback (or future) for both routes.
+  Synchronous requests are sent with bounded concurrency, batches are driven by UBatchOrchestrator.
+*/
+UCLASS()
+class OPENAI_API URequestRouter : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    void SetAuth(const FOpenAIAuth& InAuth) { Auth = InAuth; }
+    void SetPolicy(const OpenAI::FRoutingPolicy& InPolicy);
+    const OpenAI::FRoutingPolicy& GetPolicy() const { return Policy; }
+
+    /**
+      Class of the providers of both routes, e.g. a fake one in tests.
+    */
+    void SetProviderClass(const TSubclassOf<UOpenAIProvider>& InProviderClass) { ProviderClass = InProviderClass; }
+
+    OpenAI::ERequestRoute ChooseRoute(int32 NumRequests, const FTimespan& LatencyTolerance) const;
+
+    /**
+      CustomIds must be unique and have the same size as Requests.
+      OnCompleted is called on the game thread once every request has finished.
+      Requests that a batch didn't process, e.g. because its upload failed, are sent directly.
+    */
+    OpenAI::ERequestRoute Submit(const TArray<FChatCompletion>& Requests, const TArray<FString>& CustomIds,
+        const FTimespan& LatencyTolerance, const OpenAI::FOnChatCompletionsRouted& OnCompleted);
+    OpenAI::ERequestRoute Submit(const TArray<FEmbeddings>& Requests, const TArray<FString>& CustomIds,
+        const FTimespan& LatencyTolerance, const OpenAI::FOnEmbeddingsRouted& OnCompleted);
+
+    TFuture<OpenAI::FChatCompletionResults> SubmitAsync(
+        const TArray<FChatCompletion>& Requests, const TArray<FString>& CustomIds, const FTimespan& LatencyTolerance);
+    TFuture<OpenAI::FEmbeddingsResults> SubmitAsync(
+        const TArray<FEmbeddings>& Requests, const TArray<FString>& CustomIds, const FTimespan& LatencyTolerance);
+
+    int32 NumQueuedRequests() const { return NumQueued; }
+    int32 NumRequestsInFlight() const { return NumInFlight; }
+
+private:
+    UPROPERTY()
+    TArray<TObjectPtr<UOpenAIProvider>> Providers;
+
+    UPROPERTY()
+    TArray<TObjectPtr<UBatchOrchestrator>> Orchestrators;
+
+    UPROPERTY()
+    TSubclassOf<UOpenAIProvider> ProviderClass;
+
+    FOpenAIAuth Auth;
+    OpenAI::FRoutingPolicy Policy;
+
+    TQueue<TFunction<void()>> SyncQueue;
+    int32 NumQueued{0};
+    int32 NumInFlight{0};
+
+    template <typename RequestType, typename ResponseType>
+    OpenAI::ERequestRoute Route(const TArray<RequestType>& Requests, const TArray<FString>& CustomIds, const FTimespan& LatencyTolerance,
+        const TFunction<void(const TArray<OpenAI::TRoutedResult<ResponseType>>&)>& OnCompleted);
+
+    template <typename RequestType, typename ResponseType>
+    void SubmitSync(const TArray<RequestType>& Requests, const TArray<FString>& CustomIds,
+        const TFunction<void(const TArray<OpenAI::TRoutedResult<ResponseType>>&)>& OnCompleted);
+
+    template <typename RequestType, typename ResponseType>
+    bool SubmitBatch(const TArray<RequestType>& Requests, const TArray<FString>& CustomIds,
+        const TFunction<void(const TArray<OpenAI::TRoutedResult<ResponseType>>&)>& OnCompleted);
+
+    void PumpSyncQueue();
+    void OnSyncRequestFinished(UOpenAIProvider* Provider);
+};
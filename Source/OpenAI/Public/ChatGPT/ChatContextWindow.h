@@ -0,0 +1,73 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/Chat/ChatCommonTypes.h"
+#include "ChatGPT/ChatHistory.h"
+#include "Tokenizer/TokenCounter.h"
+
+namespace OpenAI
+{
+struct FChatContextPolicy
+{
+    /**
+      Context window of the model in tokens, zero takes it from the model registry.
+    */
+    int32 ContextWindowTokens{0};
+
+    /**
+      Tokens that are left for the tool definitions and the message formatting.
+      The history budget is the context window minus the max completion tokens and this margin.
+    */
+    int32 ReservedTokens{512};
+
+    /**
+      Cap of the history tokens below the budget, e.g. to keep NPC requests small and cheap. Zero means no cap.
+    */
+    int32 MaxHistoryTokens{0};
+
+    /**
+      Cheap model that folds the evicted turns into a running summary, empty drops them.
+    */
+    FString SummaryModel;
+    int32 MaxSummaryTokens{256};
+};
+
+/**
+  Sliding window over the chat history that fits a token budget.
+
+  System messages are pinned. Other messages are kept from the most recent one back until the budget is spent,
+  the window never starts with tool results whose call was evicted. The summary of the evicted messages
+  is sent as a system message after the pinned ones.
+*/
+class OPENAI_API FChatContextWindow
+{
+public:
+    static int32 GetModelContextWindow(const FString& Model);
+
+    /**
+      Tokens of the message with the chat format overhead, images are counted at the low detail cost.
+    */
+    static int32 CountMessageTokens(const FMessage& Message, const FTokenCounter& TokenCounter);
+
+    static bool IsPinned(const FMessage& Message);
+
+    /**
+      Index from which all messages are kept, earlier ones are kept only if pinned.
+      The last message is always kept, even if it's over the budget.
+    */
+    static int32 FindFirstKept(const FChatHistory& History, TArrayView<const int32> MessageTokens, int32 Budget);
+
+    /**
+      Pinned messages that were evicted, the summary and the kept messages.
+    */
+    static TArray<FMessage> MakeMessages(const FChatHistory& History, int32 FirstKept, const FString& Summary);
+
+    /**
+      Request that folds the evicted messages into the previous summary.
+    */
+    static TArray<FMessage> MakeSummaryMessages(TArrayView<const FMessage> Evicted, const FString& PreviousSummary);
+};
+
+}  // namespace OpenAI
@@ -6,6 +6,9 @@
 #include "UObject/NoExportTypes.h"
 #include "Provider/Types/CommonTypes.h"
 #include "Provider/Types/Chat/ChatCommonTypes.h"
+#include "Provider/Types/ModelTypes.h"
+#include "ChatGPT/ChatContextWindow.h"
+#include "ChatGPT/ChatHistory.h"
 #include "Logging/LogVerbosity.h"
 #include "Runtime/CoreUObject/Public/Templates/SubclassOf.h"
 #include "ChatGPT.generated.h"
@@ -27,8 +30,20 @@ public:
     void SetAuth(const FOpenAIAuth& OpenAIAuth);
     void SetModel(const FString& Model);
     FString GetModel() const;
+    /**
+      Max completion tokens of the requests, capped by the max output tokens of the model in the model registry.
+    */
     void SetMaxTokens(int32 Tokens);
 
+    /**
+      Requests send the pinned system messages and the most recent messages that fit the context budget,
+      the evicted ones are optionally folded into a running summary by a cheap model.
+      The full history is kept and returned by GetHistory().
+    */
+    void SetContextPolicy(const OpenAI::FChatContextPolicy& Policy);
+    const OpenAI::FChatContextPolicy& GetContextPolicy() const { return ContextPolicy; }
+    FString GetContextSummary() const;
+
     void SetLogEnabled(bool Enabled);
 
     bool RegisterService(const TSubclassOf<UBaseService>& ServiceClass, const OpenAI::ServiceSecrets& Secrets);
@@ -41,7 +56,17 @@ public:
     void MakeRequest();
 
     void ClearHistory();
-    TArray<FMessage> GetHistory() const;
+
+    /**
+      Snapshot of the history, the messages aren't copied and the snapshot doesn't change with the chat.
+    */
+    OpenAI::FChatHistory GetHistory() const { return ChatHistory; }
+
+    /**
+      Continues the conversation from the history, e.g. a fork of a shared NPC prompt.
+      The messages are shared with the source history.
+    */
+    void SetHistory(const OpenAI::FChatHistory& History);
 
     FOnChatGPTRequestCompleted& OnRequestCompleted() { return RequestCompleted; }
     FOnChatGPTRequestUpdated& OnRequestUpdated() { return RequestUpdated; }
@@ -57,16 +82,45 @@ private:
     FString OpenAIModel;
     int32 MaxCompletionTokens{100};
 
-    TArray<FMessage> ChatHistory;
+    OpenAI::FChatHistory ChatHistory;
     FMessage AssistantMessage;
 
+    UPROPERTY()
+    TObjectPtr<UOpenAIProvider> SummaryProvider;
+
+    OpenAI::FChatContextPolicy ContextPolicy;
+
+    /**
+      Tokens of the history messages, counted once when the messages are sent the first time.
+    */
+    TArray<int32> MessageTokens;
+
+    FString ContextSummary;
+    /**
+      Messages before this index are in the summary.
+    */
+    int32 NumSummarized{0};
+    /**
+      End of the messages in the summary that is being requested, INDEX_NONE if the history was cleared meanwhile.
+    */
+    int32 PendingSummaryEnd{INDEX_NONE};
+    bool bSummaryInProgress{false};
+
 private:
     FOnChatGPTRequestCompleted RequestCompleted;
     FOnChatGPTRequestUpdated RequestUpdated;
 
     void HandleRequestCompletion();
+    void HandleResponseCompletion(EOpenAIFinishReason FinishReason, TConstArrayView<FToolCalls> ToolCalls);
     void UpdateAssistantMessage(const FString& Message, bool WasError = false);
 
+    /**
+      Max completion tokens capped by the max output of the model.
+    */
+    int32 GetCompletionTokens(const FModelCapabilities& Model) const;
+    TArray<FMessage> MakeContextMessages(const FModelCapabilities& Model, int32 CompletionTokens);
+    void RequestSummary(int32 FirstKept);
+
     void HandleError(const FString& Content);
     bool HandleFunctionCall(const FFunctionCommon& FunctionCall, const FString& ID);
 };
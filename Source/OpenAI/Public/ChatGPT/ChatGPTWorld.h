@@ -12,7 +12,7 @@
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGPTRequestUpdated, const FMessage&, Message);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnGPTRequestCompleted, const FMessage&, Message);
 
-class UChatGPT;
+class UChatSessionSubsystem;
 
 UCLASS(Blueprintable, BlueprintType)
 class OPENAI_API AChatGPTWorld : public AInfo
@@ -21,6 +21,7 @@ class OPENAI_API AChatGPTWorld : public AInfo
 
 protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "OpenAI")
     EMainModelEnum Model{EMainModelEnum::GPT_4_Vision_Preview};
@@ -28,6 +29,10 @@ protected:
     UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "OpenAI")
     int32 MaxTokens{2000};
 
+    /**
+      The actor is a session of the world chat session subsystem and the auth belongs to the subsystem,
+      so it replaces the auth of every session of the world, including the ones of the other actors.
+    */
     UFUNCTION(BlueprintCallable, Category = "OpenAI")
     void SetAuth(const FOpenAIAuth& OpenAIAuth);
 
@@ -54,12 +59,12 @@ private:
     FOpenAIAuth OpenAIAuth;
 
     UPROPERTY()
-    TObjectPtr<UChatGPT> ChatGPT;
+    TObjectPtr<UChatSessionSubsystem> ChatSessions;
 
     bool bIsInProgress{false};
     FMessage LastMessage;
 
 private:
-    void OnRequestCompleted();
+    void OnRequestCompleted(const FMessage& Message);
     void OnRequestUpdated(const FMessage& Message, bool WasError);
 };
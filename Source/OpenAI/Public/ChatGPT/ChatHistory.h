@@ -0,0 +1,95 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/Chat/ChatCommonTypes.h"
+
+namespace OpenAI
+{
+/**
+  Immutable chat messages in a persistent vector, a 32-way trie with the last messages in a separate tail.
+  https://hypirion.com/musings/understanding-persistent-vector-pt-1
+
+  Copies share the messages and the trie nodes, so a copy is a snapshot that costs a few reference counts.
+  Add copies only the path to the new message, the other copies don't see it.
+  Many conversations can fork from a long common prefix, e.g. NPCs with the same system prompt and lore.
+  Const methods are safe to call from several threads, a copy can be read while the original grows.
+*/
+class OPENAI_API FChatHistory
+{
+public:
+    using FMessageRef = TSharedRef<const FMessage>;
+
+    FChatHistory();
+    explicit FChatHistory(TArrayView<const FMessage> Messages);
+
+    int32 Num() const { return Count; }
+    bool IsEmpty() const { return Count == 0; }
+    bool IsValidIndex(int32 Index) const { return Index >= 0 && Index < Count; }
+
+    const FMessage& operator[](int32 Index) const { return *GetRef(Index); }
+    const FMessage& Last() const { return *GetRef(Count - 1); }
+    const FMessageRef& GetRef(int32 Index) const;
+
+    void Add(const FMessage& Message);
+    void Add(FMessage&& Message);
+    void Add(const FMessageRef& Message);
+    void Reset();
+
+    /**
+      History of the first messages to branch the conversation from an earlier turn.
+      The messages are shared, only the references are copied.
+    */
+    FChatHistory Left(int32 NumMessages) const;
+
+    TArray<FMessage> ToArray() const;
+
+    /**
+      Calls the function for every message from the first one.
+    */
+    template <typename FunctionType>
+    void ForEach(FunctionType&& Function) const
+    {
+        for (int32 Index = 0; Index < TailOffset(); Index += Width)
+        {
+            for (const FMessageRef& Message : FindLeaf(Index).Messages)
+            {
+                Function(*Message);
+            }
+        }
+        for (const FMessageRef& Message : Tail->Messages)
+        {
+            Function(*Message);
+        }
+    }
+
+private:
+    static constexpr int32 Bits = 5;
+    static constexpr int32 Width = 1 << Bits;
+    static constexpr int32 Mask = Width - 1;
+
+    struct FNode
+    {
+        TArray<TSharedRef<const FNode>> Children;
+        TArray<FMessageRef> Messages;
+    };
+    using FNodeRef = TSharedRef<const FNode>;
+
+    FNodeRef Root;
+    /**
+      Not shared with other histories when unique, so it grows in place.
+    */
+    TSharedRef<FNode> Tail;
+    int32 Count{0};
+    /**
+      Index bits below the root level.
+    */
+    int32 Shift{Bits};
+
+    int32 TailOffset() const { return Count < Width ? 0 : ((Count - 1) >> Bits) << Bits; }
+    const FNode& FindLeaf(int32 Index) const;
+    FNodeRef PushTail(int32 Level, const FNodeRef& Parent, const FNodeRef& Leaf) const;
+    static FNodeRef MakePath(int32 Level, const FNodeRef& Leaf);
+};
+}  // namespace OpenAI
@@ -0,0 +1,84 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace OpenAI
+{
+/**
+  Turns of the chat sessions that share the request slots and the memory budget of the histories.
+
+  Sessions wait for a free slot in the order they asked. A session has at most one request at a time
+  and its follow-ups, e.g. after a tool call, go to the end of the queue, so a chatty session can't starve the others.
+  When the awake histories are over the budget, the least recently used idle sessions are hibernated.
+*/
+class OPENAI_API FChatSessionScheduler
+{
+public:
+    void SetMaxConcurrentRequests(int32 MaxRequests);
+    int32 GetMaxConcurrentRequests() const { return MaxConcurrentRequests; }
+
+    /**
+      Bytes of the awake histories, zero disables hibernation.
+    */
+    void SetHistoryMemoryBudget(int64 Bytes);
+    int64 GetHistoryMemoryBudget() const { return HistoryMemoryBudget; }
+
+    void Add(FName Session);
+    void Remove(FName Session);
+    bool Contains(FName Session) const { return Sessions.Contains(Session); }
+    int32 Num() const { return Sessions.Num(); }
+
+    /**
+      Queues the request of the session, false if it's queued or running already.
+    */
+    bool Enqueue(FName Session);
+
+    /**
+      Session whose request can be sent now, NAME_None if all slots are busy or nobody waits.
+    */
+    FName StartNext();
+    void Complete(FName Session);
+
+    /**
+      The session is queued or running.
+    */
+    bool IsBusy(FName Session) const;
+    int32 NumRunning() const { return Running; }
+    int32 NumQueued() const { return Queue.Num(); }
+
+    /**
+      Marks the session as just used, with the current size of its history.
+    */
+    void Touch(FName Session, int64 HistoryBytes);
+    void SetHibernated(FName Session, bool bHibernated);
+    bool IsHibernated(FName Session) const;
+
+    /**
+      Least recently used idle sessions whose hibernation brings the awake histories within the budget.
+    */
+    TArray<FName> FindSessionsToHibernate() const;
+    int64 GetAwakeHistoryBytes() const { return AwakeHistoryBytes; }
+
+private:
+    struct FSessionState
+    {
+        int64 HistoryBytes{0};
+        uint64 LastUsed{0};
+        bool bQueued{false};
+        bool bRunning{false};
+        bool bHibernated{false};
+    };
+
+    TMap<FName, FSessionState> Sessions;
+    TArray<FName> Queue;
+
+    int32 MaxConcurrentRequests{4};
+    int64 HistoryMemoryBudget{8 * 1024 * 1024};
+
+    int32 Running{0};
+    int64 AwakeHistoryBytes{0};
+    uint64 Clock{0};
+};
+}  // namespace OpenAI
@@ -0,0 +1,206 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Provider/Types/CommonTypes.h"
+#include "Provider/Types/Chat/ChatCommonTypes.h"
+#include "Provider/Types/ModelTypes.h"
+#include "ChatGPT/ChatHistory.h"
+#include "ChatGPT/ChatSessionScheduler.h"
+#include "Runtime/CoreUObject/Public/Templates/SubclassOf.h"
+#include "ChatSessionSubsystem.generated.h"
+
+class UOpenAIProvider;
+class UBaseService;
+
+namespace OpenAI
+{
+struct FChatSession;
+class FChatStream;
+}
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnChatSessionUpdated, FName, Session, const FMessage&, Message, bool, WasError);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChatSessionCompleted, FName, Session, const FMessage&, Message);
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnChatSessionMessageUpdated, const FMessage& /* Message */, bool /* WasError */);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnChatSessionMessageCompleted, const FMessage& /* Message */);
+
+/**
+  Many lightweight chat sessions of the world, e.g. NPC conversations, over one set of providers and services.
+
+  A session is a history, a model and an assistant message. Its requests are sent in turn through
+  the shared request slots, the histories of idle sessions are hibernated to Saved/OpenAI/Sessions
+  when the awake ones are over the memory budget, and are loaded back when the session is used.
+*/
+UCLASS()
+class OPENAI_API UChatSessionSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+
+    /**
+      Auth of the requests of every session of the world.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void SetAuth(const FOpenAIAuth& OpenAIAuth);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void SetLogEnabled(bool Enabled);
+
+    /**
+      Requests that are sent at once, the other sessions wait for their turn.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void SetMaxConcurrentRequests(int32 MaxRequests);
+
+    /**
+      Bytes of the histories that are kept in memory, zero disables hibernation.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void SetHistoryMemoryBudget(int64 Bytes);
+
+    /**
+      Max completion tokens are capped by the max output tokens of the model in the model registry.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool CreateSession(FName Session, const FString& Model, int32 MaxTokens = 2000);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void RemoveSession(FName Session);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool HasSession(FName Session) const;
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void SetSessionModel(FName Session, const FString& Model);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool AddMessage(FName Session, const FMessage& Message);
+
+    /**
+      Adds the message and queues the request, false if the session has a request in progress.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool MakeRequest(FName Session, const FMessage& Message);
+
+    /**
+      The request is queued, sent or waits for a service.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool IsInProgress(FName Session) const;
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool IsHibernated(FName Session) const;
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    FMessage GetAssistantMessage(FName Session) const;
+
+    /**
+      Snapshot of the history, a hibernated session is loaded.
+    */
+    OpenAI::FChatHistory GetHistory(FName Session);
+
+    /**
+      Continues the conversation from the history, e.g. a fork of a shared NPC prompt.
+    */
+    void SetHistory(FName Session, const OpenAI::FChatHistory& History);
+
+    /**
+      Services are shared by all sessions, their results go back to the session that called them.
+    */
+    bool RegisterService(const TSubclassOf<UBaseService>& ServiceClass, const OpenAI::ServiceSecrets& Secrets);
+    void UnRegisterService(const TSubclassOf<UBaseService>& ServiceClass);
+
+    const OpenAI::FChatSessionScheduler& GetScheduler() const { return Scheduler; }
+
+    /**
+      Class of the providers of the request slots, e.g. a fake one in tests.
+    */
+    void SetProviderClass(const TSubclassOf<UOpenAIProvider>& InProviderClass) { ProviderClass = InProviderClass; }
+
+    /**
+      Events of one session, e.g. for the actor that owns it, nullptr if there is no such session.
+      They are removed with the session.
+    */
+    FOnChatSessionMessageUpdated* OnSessionMessageUpdated(FName Session);
+    FOnChatSessionMessageCompleted* OnSessionMessageCompleted(FName Session);
+
+    /**
+      Events of all sessions.
+    */
+    UPROPERTY(BlueprintAssignable)
+    FOnChatSessionUpdated OnSessionUpdated;
+
+    UPROPERTY(BlueprintAssignable)
+    FOnChatSessionCompleted OnSessionCompleted;
+
+private:
+    /**
+      Providers report the responses without their requests, so every request slot has its own provider.
+      There are at most MaxConcurrentRequests of them, however many sessions the world has.
+    */
+    UPROPERTY()
+    TArray<TObjectPtr<UOpenAIProvider>> Providers;
+
+    UPROPERTY()
+    TSubclassOf<UOpenAIProvider> ProviderClass;
+
+    struct FRequestSlot
+    {
+        /**
+          NAME_None if the session was removed while its request is sent.
+        */
+        FName Session;
+        bool bBusy{false};
+    };
+    TArray<FRequestSlot> Slots;
+
+    UPROPERTY()
+    TArray<TObjectPtr<UBaseService>> Services;
+
+    struct FServiceCall
+    {
+        const UBaseService* Service;
+        FString ToolID;
+        FName Session;
+    };
+    TArray<FServiceCall> ServiceCalls;
+
+    TMap<FName, TSharedPtr<OpenAI::FChatSession>> Sessions;
+    OpenAI::FChatSessionScheduler Scheduler;
+
+    FOpenAIAuth Auth;
+    bool bLogEnabled{true};
+
+private:
+    void ScheduleRequests();
+    int32 FindFreeSlot();
+    void SendRequest(int32 Slot, FName SessionName);
+    FName FinishSlot(int32 Slot);
+
+    void OnStreamUpdated(const OpenAI::FChatStream& Stream, bool Completed, int32 Slot);
+    void OnCompletionCompleted(const FChatCompletionResponse& Response, int32 Slot);
+    void OnRequestError(const FString& URL, const FString& Content, int32 Slot);
+    void OnServiceDataRecieved(const FMessage& Message, const UBaseService* Service);
+    void OnServiceDataError(const FString& ErrorMessage, const UBaseService* Service);
+
+    void HandleRequestCompletion(FName SessionName);
+    void HandleResponseCompletion(FName SessionName, EOpenAIFinishReason FinishReason, TConstArrayView<FToolCalls> ToolCalls);
+    void HandleError(FName SessionName, const FString& Content);
+    bool HandleFunctionCall(FName SessionName, const FFunctionCommon& FunctionCall, const FString& ID);
+    void UpdateAssistantMessage(FName SessionName, const FString& Message, bool WasError = false);
+
+    /**
+      Session with its history in memory.
+    */
+    OpenAI::FChatSession* Wake(FName SessionName);
+    void AddToHistory(FName SessionName, OpenAI::FChatSession& Session, const FMessage& Message);
+    void HibernateOverBudget();
+    bool Hibernate(FName SessionName, OpenAI::FChatSession& Session);
+    FString GetSessionFilePath(FName SessionName) const;
+    FString GetSessionDir() const;
+};
@@ -0,0 +1,142 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/EmbeddingTypes.h"
+#include "Hash/xxhash.h"
+
+namespace OpenAI
+{
+class FMappedFile;
+
+/**
+  Inputs of one embeddings request split into the cached vectors and the misses that must be sent.
+*/
+struct FEmbeddingCacheLookup
+{
+    FString Model;
+
+    /**
+      Index of the unique input for every input of the request, identical inputs are embedded once.
+    */
+    TArray<int32> InputToUnique;
+    TArray<FXxHash128> UniqueKeys;
+    /**
+      Empty for the misses until they are resolved.
+    */
+    TArray<TArray<float>> UniqueVectors;
+
+    /**
+      Input of the request for the misses and the unique input of every miss.
+    */
+    TArray<FString> MissInput;
+    TArray<int32> MissToUnique;
+
+    bool HasMisses() const { return !MissInput.IsEmpty(); }
+};
+
+/**
+  Local store of the received embeddings, so unchanged texts aren't embedded and paid for again.
+
+  Vectors are keyed by xxHash128 of the model, the requested dimensions and the normalized input.
+  They are appended to a slab file (Saved/OpenAI/EmbeddingCache.slab by default) that is memory-mapped on load,
+  the keys are kept in an open-addressing table of offsets into the slab.
+  New vectors stay in memory until Save(), a torn record at the end of the slab is dropped on load
+  and cut off by the next save.
+  The cache is safe to use from several threads.
+*/
+class OPENAI_API FEmbeddingCache
+{
+public:
+    explicit FEmbeddingCache(const FString& FilePath = DefaultFilePath());
+    ~FEmbeddingCache();
+
+    FEmbeddingCache(const FEmbeddingCache&) = delete;
+    FEmbeddingCache& operator=(const FEmbeddingCache&) = delete;
+
+    static FString DefaultFilePath();
+
+    /**
+      Trims the input and unifies line endings, the API embeds such inputs the same way.
+    */
+    static FString NormalizeInput(FStringView Input);
+    static FXxHash128 MakeKey(const FString& Model, int32 Dimensions, FStringView Input);
+
+    bool Find(const FXxHash128& Key, TArray<float>& Vector) const;
+    void Add(const FXxHash128& Key, TArrayView<const float> Vector);
+
+    int32 Num() const;
+    void Reset();
+
+    bool Load();
+    /**
+      Appends the vectors that were added since the last save to the slab.
+    */
+    bool Save();
+
+    /**
+      Looks up every input of the request, the vectors of the hits are copied into the lookup.
+    */
+    FEmbeddingCacheLookup Lookup(const FEmbeddings& Request) const;
+
+    /**
+      Stores the vectors of the misses from the response to the request with Lookup.MissInput.
+      Failed requests may come without data, such misses are left unresolved.
+      Returns false if the response doesn't match the misses.
+    */
+    bool Resolve(FEmbeddingCacheLookup& Lookup, const FEmbeddingsResponse& MissResponse);
+
+    /**
+      Response to the original request in the order of its inputs, usage is the usage of the misses.
+    */
+    static FEmbeddingsResponse MakeResponse(const FEmbeddingCacheLookup& Lookup, const FEmbeddingsResponse& MissResponse);
+
+private:
+    struct FSlot
+    {
+        uint64 KeyLow{};
+        uint64 KeyHigh{};
+        /**
+          Offset of the record in the slab or ~Index of the pending vector.
+        */
+        int64 Location{EmptyLocation};
+    };
+
+    struct FPendingVector
+    {
+        FXxHash128 Key;
+        int32 First{};
+        int32 Num{};
+    };
+
+    static constexpr int64 EmptyLocation = MIN_int64;
+
+    const FString FilePath;
+    mutable FRWLock Lock;
+
+    TUniquePtr<FMappedFile> Slab;
+    TArray<FSlot> Slots;
+    int32 NumKeys{0};
+    /**
+      End of the last valid record in the slab, anything after it is torn.
+    */
+    int64 ValidSize{0};
+
+    TArray<FPendingVector> Pending;
+    TArray<float> PendingData;
+
+    int32 FindSlot(const FXxHash128& Key) const;
+    void SetLocation(const FXxHash128& Key, int64 Location);
+    void Grow();
+
+    bool MapSlab();
+
+    /**
+      Maps the slab again after a save, the persisted locations are dropped if it can't be mapped,
+      so only the pending vectors are found until the next load.
+    */
+    bool RemapSlab();
+};
+
+}  // namespace OpenAI
@@ -0,0 +1,57 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Embeddings/HNSWIndex.h"
+#include "Embeddings/VectorSearchTypes.h"
+#include "Provider/Types/EmbeddingTypes.h"
+#include "EmbeddingIndex.generated.h"
+
+/**
+  Blueprint wrapper of the HNSW index over embedding vectors.
+*/
+UCLASS(BlueprintType)
+class OPENAI_API UEmbeddingIndex : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    /**
+      Cosine index, vectors of OpenAI embedding models are normalized, so the dot product gives the same order.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    static UEmbeddingIndex* CreateEmbeddingIndex(int32 Dimensions = 1536, int32 M = 16, int32 EfConstruction = 200, int32 EfSearch = 64);
+
+    static UEmbeddingIndex* CreateEmbeddingIndex(int32 Dimensions, const OpenAI::FHNSWParams& Params);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool Add(int64 Id, const TArray<float>& Vector);
+
+    /**
+      Ids of the vectors are FirstId + FEmbeddingsData::Index.
+    */
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool AddEmbeddings(const FEmbeddingsResponse& Response, int64 FirstId);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    TArray<FVectorSearchResult> Search(const TArray<float>& Query, int32 K = 10) const;
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    void SetEfSearch(int32 EfSearch);
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    int32 Num() const;
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool Save(const FString& FilePath) const;
+
+    UFUNCTION(BlueprintCallable, Category = "OpenAI")
+    bool Load(const FString& FilePath);
+
+    OpenAI::FHNSWIndex& GetIndex() const { return *Index; }
+
+private:
+    TUniquePtr<OpenAI::FHNSWIndex> Index;
+};
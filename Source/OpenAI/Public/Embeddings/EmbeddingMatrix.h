@@ -0,0 +1,116 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Embeddings/VectorMath.h"
+#include "Embeddings/RoaringBitmap.h"
+
+namespace OpenAI
+{
+enum class EVectorQuantization : uint8
+{
+    None,
+    /**
+      4x less memory, scores are close to the full precision ones.
+    */
+    Int8,
+    /**
+      32x less memory, coarse scores that are good for the candidate selection only.
+    */
+    Binary
+};
+
+struct FScoredVector
+{
+    int32 Index{INDEX_NONE};
+    float Score{};
+};
+
+/**
+  Contiguous storage of equally sized vectors for one-to-many scoring.
+
+  Rows are aligned and padded to whole registers, so the kernels never read a partial register.
+  Vectors longer than the matrix are truncated Matryoshka-style, e.g. 3072-dim vectors can be stored as 256-dim ones,
+  cosine vectors are normalized when they are added.
+  With quantization TopK() selects candidates from the quantized rows and re-ranks them with the full precision ones.
+  Const methods are safe to call from several threads.
+*/
+class OPENAI_API FEmbeddingMatrix
+{
+public:
+    explicit FEmbeddingMatrix(int32 InDimensions, EVectorMetric InMetric = EVectorMetric::Cosine);
+
+    void Reserve(int32 NumVectors);
+
+    /**
+      Returns the row index or INDEX_NONE if the vector is shorter than the matrix.
+    */
+    int32 Add(TArrayView<const float> Vector);
+    void Reset();
+
+    int32 Num() const { return NumRows; }
+    int32 GetDimensions() const { return Dimensions; }
+    EVectorMetric GetMetric() const { return Metric; }
+    TArrayView<const float> GetRow(int32 Index) const { return MakeArrayView(GetRowData(Index), Dimensions); }
+
+    /**
+      Builds the quantized copy of the rows, rows that are added later are quantized on add.
+    */
+    void SetQuantization(EVectorQuantization InQuantization);
+    EVectorQuantization GetQuantization() const { return Quantization; }
+
+    /**
+      Full precision scores of all rows, computed in parallel.
+    */
+    void Score(TArrayView<const float> Query, TArray<float>& Scores) const;
+
+    /**
+      K best rows, the best first.
+      Quantized rows are scored first, K * Oversampling best of them are re-ranked with the full precision.
+    */
+    TArray<FScoredVector> TopK(TArrayView<const float> Query, int32 K, int32 Oversampling = 4) const;
+
+    /**
+      K best rows of the filter, only these rows are scored.
+    */
+    TArray<FScoredVector> TopK(TArrayView<const float> Query, int32 K, const FRoaringBitmap& Filter, int32 Oversampling = 4) const;
+
+    static TArray<FScoredVector> SelectTopK(TArrayView<const float> Scores, int32 K);
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    int32 Dimensions;
+    int32 Stride;
+    EVectorMetric Metric;
+    EVectorQuantization Quantization{EVectorQuantization::None};
+    int32 NumRows{0};
+
+    /**
+      Element offsets are 64-bit, e.g. 1.4M 1536-dim rows are over the int32 range.
+    */
+    TArray<float, TAlignedHeapAllocator64<16>> Data;
+
+    TArray64<int8> Int8Data;
+    TArray<float> Int8Scales;
+    TArray<float> SquaredNorms;
+
+    int32 NumBinaryWords;
+    TArray64<uint64> BinaryData;
+
+    const float* GetRowData(int32 Row) const { return Data.GetData() + static_cast<int64>(Row) * Stride; }
+    const int8* GetInt8Row(int32 Row) const { return Int8Data.GetData() + static_cast<int64>(Row) * Dimensions; }
+    const uint64* GetBinaryRow(int32 Row) const { return BinaryData.GetData() + static_cast<int64>(Row) * NumBinaryWords; }
+
+    bool PrepareQuery(TArrayView<const float> Query, TArray<float, TAlignedHeapAllocator<16>>& Prepared) const;
+    /**
+      Scores of the given rows or of all rows if there are none.
+    */
+    void ScoreRows(const float* Query, const TArray<int32>* Rows, TArray<float>& Scores) const;
+    void ScoreQuantizedRows(const float* Query, const TArray<int32>* Rows, TArray<float>& Scores) const;
+    TArray<FScoredVector> SelectRows(const float* Query, const TArray<int32>* Rows, int32 K, int32 Oversampling) const;
+    void QuantizeRow(int32 Index);
+};
+
+}  // namespace OpenAI
@@ -0,0 +1,159 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Embeddings/HNSWIndex.h"
+#include "Embeddings/MetadataTable.h"
+#include "Async/Future.h"
+
+class IFileHandle;
+
+namespace OpenAI
+{
+struct FEmbeddingStoreOptions
+{
+    FHNSWParams IndexParams;
+
+    /**
+      Compaction starts when this many writes are logged since the last one...
+    */
+    int32 CompactionThreshold{10000};
+
+    /**
+      ...or when this much time has passed since the last one and there are logged writes.
+    */
+    FTimespan CompactionInterval{FTimespan::FromMinutes(10.0)};
+
+    /**
+      Every write is flushed to the OS, so it survives a crash of the process.
+      Full flush also survives a power loss, but it's much slower.
+    */
+    bool bFullFlush{false};
+};
+
+/**
+  Persistent vector store with inserts and deletes at runtime, e.g. long-term memory of NPCs.
+
+  Layout of the directory:
+    Snapshot_N.hnsw, Snapshot_N.meta - compacted vectors with the graph and their metadata,
+    Log_N.wal, Log_N+1.wal... - write-ahead logs of inserts and tombstones after the snapshot,
+    Current - the number of the valid snapshot, it's replaced atomically.
+
+  Every write is appended to the log before it's applied in memory. Recent writes are scanned by brute force,
+  compaction folds them into a new snapshot with a rebuilt graph on a worker thread, while writes go to the next log.
+  Recovery loads the current snapshot and replays the logs, torn records at the end of a log are skipped.
+
+  Writers are serialized by their own lock, readers are blocked only while a write is applied in memory
+  and while a compacted snapshot is swapped in, never by the file IO or the graph build.
+*/
+class OPENAI_API FEmbeddingStore
+{
+public:
+    FEmbeddingStore(const FString& InDirectory, int32 InDimensions, const FEmbeddingStoreOptions& InOptions = {});
+    ~FEmbeddingStore();
+
+    FEmbeddingStore(const FEmbeddingStore&) = delete;
+    FEmbeddingStore& operator=(const FEmbeddingStore&) = delete;
+
+    /**
+      Loads the snapshot and replays the logs, must be called before any other method.
+      A torn record at the end of a log is skipped, other damage of a log fails the call.
+    */
+    bool Open();
+    bool IsOpen() const { return LogFile.IsValid(); }
+
+    /**
+      Replaces the vector if the id is already stored.
+    */
+    bool Insert(int64 Id, TArrayView<const float> Vector, const FMetadataRow& Metadata = {});
+    bool Remove(int64 Id);
+
+    bool Contains(int64 Id) const;
+    int32 Num() const;
+    int32 GetDimensions() const { return Dimensions; }
+
+    /**
+      K best live vectors that match the filter, the best first.
+    */
+    TArray<FVectorSearchResult> Search(TArrayView<const float> Query, int32 K, const FMetadataFilter& Filter = {}) const;
+
+    /**
+      Starts a compaction if there are logged writes and none is running.
+    */
+    void Compact();
+    bool IsCompacting() const;
+
+    /**
+      Waits for the running compaction.
+    */
+    void WaitForCompaction();
+
+private:
+    struct FSegment;
+
+    FString Directory;
+    int32 Dimensions;
+    FEmbeddingStoreOptions Options;
+
+    /**
+      Immutable except the tombstones: the compacted snapshot and the recent writes that are being compacted.
+    */
+    TSharedPtr<FSegment> Snapshot;
+    TSharedPtr<FSegment> Frozen;
+    /**
+      Writes since the last compaction start.
+    */
+    TSharedPtr<FSegment> Recent;
+
+    /**
+      Ids that were removed or replaced while the compaction was running, they are removed from its result.
+    */
+    TArray<int64> RemovedWhileCompacting;
+
+    TUniquePtr<IFileHandle> LogFile;
+    int64 LogGeneration{0};
+    int32 NumLoggedWrites{0};
+    FDateTime LastCompactionTime;
+
+    TFuture<void> Compaction;
+    std::atomic<bool> bCompacting{false};
+
+    /**
+      Serializes the writers and the log rotation.
+    */
+    FCriticalSection WriteLock;
+    /**
+      Guards the segments.
+    */
+    mutable FRWLock Lock;
+
+    FString GetSnapshotPath(int64 Generation, const TCHAR* Extension) const;
+    FString GetLogPath(int64 Generation) const;
+    FString GetCurrentPath() const;
+
+    bool LoadSnapshot(int64 Generation);
+
+    /**
+      Newest snapshot that loads when Current is missing, zero if there is none.
+    */
+    int64 RecoverSnapshot();
+    /**
+      False if the log can't be read or has a bad record before its end.
+    */
+    bool ReplayLog(const FString& FilePath);
+    bool OpenLog(int64 Generation);
+    bool AppendToLog(const TArray<uint8>& Record);
+
+    TSharedPtr<FSegment> MakeRecentSegment() const;
+    void ApplyInsert(int64 Id, TArrayView<const float> Vector, const FMetadataRow& Metadata);
+    bool ApplyRemove(int64 Id);
+
+    void StartCompactionIfNeeded();
+    void StartCompaction();
+    void RunCompaction(int64 Generation, TArray<TPair<TSharedPtr<const FSegment>, FRoaringBitmap>> Sources);
+    bool SaveSnapshot(int64 Generation, const FSegment& Segment) const;
+    void DeleteObsoleteFiles(int64 Generation) const;
+};
+
+}  // namespace OpenAI
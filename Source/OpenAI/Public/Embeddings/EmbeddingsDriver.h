@@ -0,0 +1,139 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Containers/Queue.h"
+#include "Provider/Types/EmbeddingTypes.h"
+#include "Provider/Types/CommonTypes.h"
+#include "Tokenizer/TokenCounter.h"
+#include "Templates/SubclassOf.h"
+#include "EmbeddingsDriver.generated.h"
+
+class UOpenAIProvider;
+
+namespace OpenAI
+{
+struct FEmbeddingsJob;
+class FEmbeddingCache;
+
+struct FEmbeddingsDriverOptions
+{
+    /**
+      Limits of one embeddings request.
+      https://platform.openai.com/docs/api-reference/embeddings/create
+    */
+    int32 MaxInputsPerRequest{2048};
+    int32 MaxTokensPerRequest{300000};
+    int32 MaxTokensPerInput{8191};
+
+    int32 MaxConcurrentRequests{8};
+
+    /**
+      Requests that failed with a rate limit, a server or a network error are sent again this many times
+      before the whole call fails, the delay doubles with every attempt. Other errors aren't retried.
+    */
+    int32 MaxRetries{2};
+    FTimespan RetryDelay{FTimespan::FromSeconds(1.0)};
+};
+
+/**
+  Range of the inputs that are sent with one request.
+*/
+struct FEmbeddingsSlice
+{
+    int32 First{};
+    int32 Num{};
+};
+
+using FOnEmbeddingsDriven = TFunction<void(const FEmbeddingsResponse& /* Response */, bool /* Succeeded */)>;
+}  // namespace OpenAI
+
+/**
+  Embeds an input array of any size.
+
+  Inputs are split into requests that respect the input count and token limits of the API,
+  requests are sent with bounded concurrency and the data is merged back in the original index order
+  into one response with the summed usage.
+  Inputs that are over the token limit of one input aren't sent, their data is left empty and the call fails,
+  long documents must be split beforehand.
+*/
+UCLASS()
+class OPENAI_API UEmbeddingsDriver : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    UEmbeddingsDriver();
+
+    void SetAuth(const FOpenAIAuth& InAuth) { Auth = InAuth; }
+    void SetOptions(const OpenAI::FEmbeddingsDriverOptions& InOptions);
+    const OpenAI::FEmbeddingsDriverOptions& GetOptions() const { return Options; }
+
+    /**
+      Tokens are counted by the cl100k tokenizer if the counter isn't set.
+    */
+    void SetTokenCounter(const OpenAI::FTokenCounter& InTokenCounter) { TokenCounter = InTokenCounter; }
+
+    /**
+      Inputs are looked up in the cache before they are split, only the misses are sent
+      and identical inputs are sent once.
+    */
+    void SetEmbeddingCache(const TSharedPtr<OpenAI::FEmbeddingCache>& Cache) { EmbeddingCache = Cache; }
+
+    /**
+      Class of the providers of the requests, e.g. a fake one in tests.
+    */
+    void SetProviderClass(const TSubclassOf<UOpenAIProvider>& InProviderClass) { ProviderClass = InProviderClass; }
+
+    /**
+      OnCompleted is called on the game thread once every input is processed.
+      Data of the failed requests is left empty and Succeeded is false.
+    */
+    void CreateEmbeddings(const FEmbeddings& Embeddings, const OpenAI::FOnEmbeddingsDriven& OnCompleted);
+
+    int32 NumQueuedRequests() const { return NumQueued; }
+    int32 NumRequestsInFlight() const { return NumInFlight; }
+
+    /**
+      Inputs that are over the token limit of one input or of one request are in no slice, they are added to Rejected.
+    */
+    static TArray<OpenAI::FEmbeddingsSlice> SplitInput(const TArray<FString>& Input, const OpenAI::FEmbeddingsDriverOptions& Options,
+        const OpenAI::FTokenCounter& TokenCounter, TArray<int32>* Rejected = nullptr);
+
+    /**
+      Rate limits, server and network errors. Invalid requests, auth and quota errors aren't fixed by sending them again.
+    */
+    static bool IsRetryable(const FString& ErrorContent);
+
+    /**
+      Copies the slice response into the merged one, indices are shifted by the start of the slice.
+    */
+    static bool MergeSlice(FEmbeddingsResponse& Merged, const OpenAI::FEmbeddingsSlice& Slice, const FEmbeddingsResponse& Response);
+
+private:
+    UPROPERTY()
+    TArray<TObjectPtr<UOpenAIProvider>> Providers;
+
+    UPROPERTY()
+    TSubclassOf<UOpenAIProvider> ProviderClass;
+
+    FOpenAIAuth Auth;
+    OpenAI::FEmbeddingsDriverOptions Options;
+    OpenAI::FTokenCounter TokenCounter;
+    TSharedPtr<OpenAI::FEmbeddingCache> EmbeddingCache;
+
+    TQueue<TFunction<void()>> SendQueue;
+    int32 NumQueued{0};
+    int32 NumInFlight{0};
+
+    void EnqueueJob(const TSharedRef<OpenAI::FEmbeddingsJob>& Job);
+    void EnqueueSlice(const TSharedRef<OpenAI::FEmbeddingsJob>& Job, int32 SliceIndex, int32 Attempt);
+    void RetrySlice(const TSharedRef<OpenAI::FEmbeddingsJob>& Job, int32 SliceIndex, int32 Attempt);
+    void SendSlice(const TSharedRef<OpenAI::FEmbeddingsJob>& Job, int32 SliceIndex, int32 Attempt);
+    void OnSliceFinished(const TSharedRef<OpenAI::FEmbeddingsJob>& Job);
+
+    void PumpSendQueue();
+    void OnRequestFinished(UOpenAIProvider* Provider);
+};
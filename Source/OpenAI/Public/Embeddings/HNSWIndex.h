@@ -0,0 +1,182 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Embeddings/EmbeddingMatrix.h"
+#include "Embeddings/RoaringBitmap.h"
+#include "Embeddings/VectorSearchTypes.h"
+
+namespace OpenAI
+{
+class FMappedFile;
+
+struct FHNSWParams
+{
+    /**
+      Links per node on the upper layers, the base layer has twice as many.
+      Higher values give better recall for high-dimensional vectors and use more memory.
+    */
+    int32 M{16};
+
+    /**
+      Candidate list size while building, higher gives a better graph and slower build.
+    */
+    int32 EfConstruction{200};
+
+    /**
+      Default candidate list size while searching, it's raised to K if needed.
+    */
+    int32 EfSearch{64};
+
+    EVectorMetric Metric{EVectorMetric::Cosine};
+
+    /**
+      Levels of the nodes are random, the seed makes builds reproducible.
+    */
+    int32 Seed{1};
+};
+
+/**
+  Hierarchical navigable small world graph for approximate nearest neighbor search.
+  https://arxiv.org/abs/1603.09320
+
+  Any number of readers can search concurrently, writes are exclusive (single writer).
+  Build() inserts a bulk of vectors on the worker threads.
+  Saved index is a flat binary file with aligned sections, Load() maps it into memory without copying,
+  the data is copied on the first write only.
+*/
+class OPENAI_API FHNSWIndex
+{
+public:
+    explicit FHNSWIndex(int32 InDimensions, const FHNSWParams& InParams = {});
+    ~FHNSWIndex();
+
+    FHNSWIndex(const FHNSWIndex&) = delete;
+    FHNSWIndex& operator=(const FHNSWIndex&) = delete;
+
+    int32 Num() const;
+    int32 GetDimensions() const { return Dimensions; }
+    const FHNSWParams& GetParams() const { return Params; }
+    void SetEfSearch(int32 EfSearch);
+
+    void Reserve(int32 NumVectors);
+
+    /**
+      Returns false if the vector is shorter than the index, longer vectors are truncated.
+    */
+    bool Add(int64 Id, TArrayView<const float> Vector);
+
+    /**
+      Vectors are Ids.Num() * Dimensions floats.
+    */
+    bool Build(TArrayView<const int64> Ids, TArrayView<const float> Vectors);
+
+    /**
+      K best vectors, the best first. Ef <= 0 uses EfSearch.
+    */
+    TArray<FVectorSearchResult> Search(TArrayView<const float> Query, int32 K, int32 Ef = 0) const;
+
+    /**
+      K best vectors among the filtered nodes, a node is the index of the vector in the order of insertion.
+      The graph is traversed through all nodes and only the filtered ones are collected,
+      filters that are too selective for the traversal are scanned instead.
+    */
+    TArray<FVectorSearchResult> Search(TArrayView<const float> Query, int32 K, const FRoaringBitmap& Filter, int32 Ef = 0) const;
+
+    /**
+      Id and vector of the node, cosine vectors are stored normalized.
+    */
+    int64 GetId(int32 Node) const;
+    bool CopyVector(int32 Node, TArray<float>& Vector) const;
+
+    bool Save(const FString& FilePath) const;
+    bool Load(const FString& FilePath);
+
+    void Reset();
+
+private:
+    /**
+      Array that either owns its data or points into the mapped file.
+      Sizes are 64-bit, e.g. the vectors of 1M 3072-dim nodes are over the int32 range.
+    */
+    template <typename ElementType>
+    struct TSection
+    {
+        TArray<ElementType, TAlignedHeapAllocator64<64>> Owned;
+        const ElementType* Mapped{nullptr};
+        int64 MappedNum{0};
+
+        const ElementType* GetData() const { return Mapped ? Mapped : Owned.GetData(); }
+        ElementType* GetMutableData()
+        {
+            check(!Mapped);
+            return Owned.GetData();
+        }
+        int64 Num() const { return Mapped ? MappedNum : Owned.Num(); }
+        void Detach()
+        {
+            if (!Mapped) return;
+            Owned = TArray<ElementType, TAlignedHeapAllocator64<64>>(Mapped, MappedNum);
+            Mapped = nullptr;
+            MappedNum = 0;
+        }
+        void Reset()
+        {
+            Owned.Reset();
+            Mapped = nullptr;
+            MappedNum = 0;
+        }
+    };
+
+    int32 Dimensions;
+    int32 Stride;
+    FHNSWParams Params;
+    int32 MaxLinks0;
+    double LevelMultiplier;
+
+    int32 NumNodes{0};
+    int32 EntryPoint{INDEX_NONE};
+    int32 MaxLevel{INDEX_NONE};
+
+    TSection<float> Vectors;
+    TSection<int64> Ids;
+    TSection<int32> Levels;
+    /**
+      Blocks of [count, links...], 1 + 2M per node on the base layer and 1 + M per level above.
+    */
+    TSection<int32> BaseLinks;
+    TSection<int32> UpperLinks;
+    TSection<int64> UpperOffsets;
+
+    TUniquePtr<FMappedFile> MappedFile;
+
+    mutable FRWLock Lock;
+    FCriticalSection GraphLock;
+    TUniquePtr<FCriticalSection[]> LinkLocks;
+
+    void ApplyParams();
+
+    int32 AllocateNode(int64 Id, const float* Vector);
+    void LinkNode(int32 Node, bool Concurrent);
+    void Detach();
+
+    const float* GetVector(int32 Node) const { return Vectors.GetData() + static_cast<int64>(Node) * Stride; }
+    int32* GetLinks(int32 Node, int32 Level);
+    const int32* GetLinks(int32 Node, int32 Level) const;
+    int32 GetMaxLinks(int32 Level) const { return Level == 0 ? MaxLinks0 : Params.M; }
+
+    float Score(const float* A, const float* B) const { return VectorMath::Score(A, B, Stride, Params.Metric); }
+    void PrepareVector(const float* Vector, float* Prepared) const;
+
+    int32 GreedySearch(const float* Query, int32 Node, int32 FromLevel, int32 ToLevel, bool Concurrent) const;
+    TArray<FVectorSearchResult> SearchNodes(TArrayView<const float> Query, int32 K, int32 Ef, const FRoaringBitmap* Filter) const;
+    void SearchLayer(const float* Query, int32 EntryNode, int32 Ef, int32 Level, bool Concurrent, TArray<FScoredVector>& Results,
+        const FRoaringBitmap* Filter = nullptr) const;
+    void ScanNodes(const float* Query, const FRoaringBitmap& Filter, int32 K, TArray<FScoredVector>& Results) const;
+    void SelectNeighbors(TArray<FScoredVector>& Candidates, int32 MaxNeighbors) const;
+    void CopyLinks(int32 Node, int32 Level, bool Concurrent, TArray<int32, TInlineAllocator<64>>& Links) const;
+    void ConnectBack(int32 Neighbor, int32 Node, int32 Level);
+};
+
+}  // namespace OpenAI
@@ -0,0 +1,181 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Embeddings/RoaringBitmap.h"
+
+namespace OpenAI
+{
+enum class EMetadataType : uint8
+{
+    /**
+      String with few distinct values, e.g. region, NPC name or document type.
+    */
+    Tag,
+    Int,
+    Bool
+};
+
+/**
+  All values of one row.
+*/
+struct FMetadataRow
+{
+    TMap<FName, FString> Tags;
+    TMap<FName, int64> Ints;
+    TMap<FName, bool> Bools;
+
+    bool IsEmpty() const { return Tags.IsEmpty() && Ints.IsEmpty() && Bools.IsEmpty(); }
+
+    friend FArchive& operator<<(FArchive& Ar, FMetadataRow& Row) { return Ar << Row.Tags << Row.Ints << Row.Bools; }
+};
+
+/**
+  Filter expression over the metadata columns, e.g.
+  FMetadataFilter::TagEquals("Region", "North") && !FMetadataFilter::IsTrue("Spoiler").
+
+  The expression is kept in postfix order and is compiled into a bitmap of the matching rows by FMetadataTable::Compile().
+  Default filter matches all rows.
+*/
+class OPENAI_API FMetadataFilter
+{
+public:
+    static FMetadataFilter TagEquals(FName Column, const FString& Value);
+    static FMetadataFilter TagIn(FName Column, const TArray<FString>& Values);
+
+    /**
+      Values in [Min, Max].
+    */
+    static FMetadataFilter IntRange(FName Column, int64 Min, int64 Max);
+    static FMetadataFilter IntEquals(FName Column, int64 Value) { return IntRange(Column, Value, Value); }
+    static FMetadataFilter IsTrue(FName Column);
+
+    /**
+      Matches the rows where the column has any value.
+    */
+    static FMetadataFilter Exists(FName Column);
+
+    friend FMetadataFilter operator&&(FMetadataFilter A, const FMetadataFilter& B);
+    friend FMetadataFilter operator||(FMetadataFilter A, const FMetadataFilter& B);
+    friend FMetadataFilter operator!(FMetadataFilter A);
+
+    bool IsEmpty() const { return Ops.IsEmpty(); }
+
+private:
+    friend class FMetadataTable;
+
+    enum class EOpType : uint8
+    {
+        TagIn,
+        IntRange,
+        IsTrue,
+        Exists,
+        And,
+        Or,
+        Not
+    };
+
+    struct FOp
+    {
+        EOpType Type;
+        FName Column;
+        TArray<FString> Values;
+        int64 Min{};
+        int64 Max{};
+    };
+
+    TArray<FOp> Ops;
+
+    static FMetadataFilter Combine(FMetadataFilter A, const FMetadataFilter& B, EOpType Type);
+};
+
+/**
+  Typed metadata columns of the stored vectors, a row is the index of the vector in the matrix or the index.
+
+  Tag columns keep a bitmap of the rows per value, so tag filters are bitmap lookups,
+  int columns are scanned for the range filters. A column gets its type on the first write.
+  Const methods are safe to call from several threads.
+*/
+class OPENAI_API FMetadataTable
+{
+public:
+    bool SetTag(int32 Row, FName Column, const FString& Value);
+    bool SetInt(int32 Row, FName Column, int64 Value);
+    bool SetBool(int32 Row, FName Column, bool Value);
+
+    bool GetTag(int32 Row, FName Column, FString& Value) const;
+    bool GetInt(int32 Row, FName Column, int64& Value) const;
+    bool GetBool(int32 Row, FName Column, bool& Value) const;
+
+    /**
+      Replaces all values of the row, returns false if some of them have the wrong type.
+    */
+    bool SetRow(int32 Row, const FMetadataRow& Values);
+    FMetadataRow GetRow(int32 Row) const;
+
+    /**
+      Clears all values of the row.
+    */
+    void RemoveRow(int32 Row);
+
+    bool HasColumn(FName Column) const { return Columns.Contains(Column); }
+    TOptional<EMetadataType> GetColumnType(FName Column) const;
+
+    /**
+      Rows that have at least one value are below this number.
+    */
+    int32 NumRows() const { return RowCount; }
+
+    void Reset();
+
+    /**
+      Rows that match the filter. Unknown columns and type mismatches match no rows.
+      Negations and the empty filter are relative to the rows below max(NumRows(), NumAllRows),
+      so rows without metadata are matched when the number of stored vectors is passed.
+    */
+    FRoaringBitmap Compile(const FMetadataFilter& Filter, int32 NumAllRows = 0) const;
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    /**
+      Tags are compared case-sensitively, the default FString keys would merge "North" and "north".
+    */
+    struct FTagKeyFuncs : TDefaultMapKeyFuncs<FString, int32, false>
+    {
+        static bool Matches(const FString& A, const FString& B) { return A.Equals(B, ESearchCase::CaseSensitive); }
+        static uint32 GetKeyHash(const FString& Key) { return FCrc::StrCrc32(*Key); }
+    };
+
+    struct FColumn
+    {
+        EMetadataType Type{EMetadataType::Tag};
+        /**
+          Rows that have a value.
+        */
+        FRoaringBitmap Present;
+
+        /**
+          Tag: index of the value per row, INDEX_NONE if unset.
+        */
+        TArray<int32> TagIndices;
+        TArray<FString> TagValues;
+        TMap<FString, int32, FDefaultSetAllocator, FTagKeyFuncs> TagLookup;
+        TArray<FRoaringBitmap> TagRows;
+
+        TArray<int64> IntValues;
+
+        FRoaringBitmap TrueRows;
+    };
+
+    TMap<FName, FColumn> Columns;
+    int32 RowCount{0};
+
+    FColumn* FindOrAddColumn(FName Column, EMetadataType Type);
+    const FColumn* FindColumn(FName Column, EMetadataType Type) const;
+    void ClearValue(FColumn& Column, int32 Row);
+    FRoaringBitmap Evaluate(const FMetadataFilter::FOp& Op) const;
+};
+
+}  // namespace OpenAI
@@ -0,0 +1,121 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace OpenAI
+{
+/**
+  Compressed set of 32-bit values in the roaring bitmap layout.
+  https://roaringbitmap.org
+
+  Values are split into chunks of 65536 by the upper 16 bits, every chunk is stored as
+  a sorted array of the lower 16 bits while it has at most 4096 values and as a 65536-bit bitmap otherwise.
+  Sparse sets stay small and dense sets are combined word by word.
+  Const methods are safe to call from several threads.
+*/
+class OPENAI_API FRoaringBitmap
+{
+public:
+    FRoaringBitmap() = default;
+
+    /**
+      Values in [First, Last).
+    */
+    static FRoaringBitmap MakeRange(uint32 First, uint32 Last);
+
+    void Add(uint32 Value);
+    void AddRange(uint32 First, uint32 Last);
+    void Remove(uint32 Value);
+    bool Contains(uint32 Value) const;
+
+    int64 Num() const;
+    bool IsEmpty() const { return Containers.IsEmpty(); }
+    void Reset() { Containers.Reset(); }
+
+    FRoaringBitmap& operator&=(const FRoaringBitmap& Other);
+    FRoaringBitmap& operator|=(const FRoaringBitmap& Other);
+
+    /**
+      Removes the values of the other set.
+    */
+    FRoaringBitmap& AndNot(const FRoaringBitmap& Other);
+
+    friend FRoaringBitmap operator&(FRoaringBitmap A, const FRoaringBitmap& B) { return A &= B; }
+    friend FRoaringBitmap operator|(FRoaringBitmap A, const FRoaringBitmap& B) { return A |= B; }
+
+    bool operator==(const FRoaringBitmap& Other) const;
+    bool operator!=(const FRoaringBitmap& Other) const { return !(*this == Other); }
+
+    /**
+      Calls the function for every value in ascending order.
+    */
+    template <typename FunctionType>
+    void ForEach(FunctionType&& Function) const
+    {
+        for (const FContainer& Container : Containers)
+        {
+            const uint32 High = static_cast<uint32>(Container.Key) << 16;
+            if (Container.IsBitmap())
+            {
+                for (int32 Word = 0; Word < BitmapWords; ++Word)
+                {
+                    for (uint64 Bits = Container.Bits[Word]; Bits != 0; Bits &= Bits - 1)
+                    {
+                        Function(High | static_cast<uint32>(Word * 64 + FMath::CountTrailingZeros64(Bits)));
+                    }
+                }
+            }
+            else
+            {
+                for (const uint16 Low : Container.Values)
+                {
+                    Function(High | Low);
+                }
+            }
+        }
+    }
+
+    TArray<uint32> ToArray() const;
+
+    SIZE_T GetAllocatedSize() const;
+
+private:
+    static constexpr int32 MaxArrayValues = 4096;
+    static constexpr int32 BitmapWords = 65536 / 64;
+
+    struct FContainer
+    {
+        uint16 Key{};
+        int32 Cardinality{};
+        /**
+          Sorted values if the container is an array.
+        */
+        TArray<uint16> Values;
+        /**
+          BitmapWords words if the container is a bitmap.
+        */
+        TArray<uint64> Bits;
+
+        bool IsBitmap() const { return !Bits.IsEmpty(); }
+        bool Contains(uint16 Low) const;
+        void ToBitmap();
+        void Normalize();
+    };
+
+    /**
+      Sorted by the key.
+    */
+    TArray<FContainer> Containers;
+
+    int32 FindContainer(uint16 Key) const;
+    FContainer& FindOrAddContainer(uint16 Key);
+
+    static void CopyBits(const FContainer& Container, uint64* Bits);
+    static FContainer Intersect(const FContainer& A, const FContainer& B);
+    static FContainer Unite(const FContainer& A, const FContainer& B);
+    static FContainer Subtract(const FContainer& A, const FContainer& B);
+};
+
+}  // namespace OpenAI
@@ -0,0 +1,103 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tokenizer/TokenCounter.h"
+#include "Hash/xxhash.h"
+
+namespace OpenAI
+{
+enum class ETextFormat : uint8
+{
+    Plain,
+    /**
+      Headings start new sections, fenced code blocks aren't split at blank lines.
+    */
+    Markdown,
+    /**
+      Elements of the top-level object or array are split apart first.
+    */
+    Json
+};
+
+struct FTextChunkerOptions
+{
+    /**
+      Chunks are packed up to this many tokens, sentences and words that are longer are cut.
+    */
+    int32 TargetTokens{512};
+
+    /**
+      Trailing tokens of a chunk that are repeated at the start of the next one, the overlap never crosses a section.
+    */
+    int32 OverlapTokens{64};
+
+    ETextFormat Format{ETextFormat::Plain};
+
+    /**
+      Tokens are counted by the cl100k tokenizer if the counter isn't set.
+    */
+    FTokenCounter TokenCounter;
+};
+
+struct FTextDocument
+{
+    /**
+      Part of the chunk ids, e.g. file name or asset path.
+    */
+    FString Name;
+    FString Text;
+};
+
+struct FTextChunk
+{
+    /**
+      Hash of the document name and the chunk text.
+    */
+    FXxHash128 Id;
+
+    int32 Document{};
+    int32 Offset{};
+    int32 Length{};
+    /**
+      Sum of the tokens of the pieces the chunk was packed from.
+    */
+    int32 Tokens{};
+};
+
+/**
+  Splits documents into chunks that fit the embedding model.
+
+  Text is broken down into units: sections (Markdown headings, JSON elements), paragraphs, then lines, sentences
+  and words of the paragraphs that are longer than the target. Units are packed greedily into chunks
+  with the overlap of the previous units. Besides the target, a chunk is also closed after a unit whose text hash
+  has its low bits set to zero, so chunk boundaries after an edit resynchronize with the previous ones
+  and only the chunks around the edit get new ids (and miss the embedding cache).
+
+  Documents and 1M characters blocks of big documents are chunked in parallel, block starts are section starts.
+*/
+class OPENAI_API FTextChunker
+{
+public:
+    explicit FTextChunker(const FTextChunkerOptions& InOptions = {});
+
+    /**
+      Chunks of all documents in the order of the documents and of the text.
+    */
+    TArray<FTextChunk> Chunk(TArrayView<const FTextDocument> Documents) const;
+
+    static FStringView GetText(TArrayView<const FTextDocument> Documents, const FTextChunk& Chunk);
+
+    /**
+      Texts of the chunks for FEmbeddings::Input.
+    */
+    static TArray<FString> MakeInput(TArrayView<const FTextDocument> Documents, TArrayView<const FTextChunk> Chunks);
+
+    const FTextChunkerOptions& GetOptions() const { return Options; }
+
+private:
+    FTextChunkerOptions Options;
+};
+
+}  // namespace OpenAI
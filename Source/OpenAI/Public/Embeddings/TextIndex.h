@@ -0,0 +1,74 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Embeddings/HNSWIndex.h"
+#include "Hash/xxhash.h"
+
+namespace OpenAI
+{
+class FMappedFile;
+
+struct FTextIndexEntry
+{
+    /**
+      Where the text comes from, e.g. string table and key or data table and row.
+    */
+    FString Source;
+    FString Text;
+};
+
+/**
+  Prebuilt searchable texts, e.g. lore, dialogue and item descriptions embedded by the EmbedText commandlet.
+
+  BasePath.hnsw is the graph with the vectors and BasePath.chunks keeps the texts, both files have 64-byte aligned
+  sections and are memory-mapped on load, so nothing is parsed or copied at startup.
+  Ids of the graph are the chunk indices.
+*/
+class OPENAI_API FTextIndex
+{
+public:
+    FTextIndex();
+    ~FTextIndex();
+
+    FTextIndex(const FTextIndex&) = delete;
+    FTextIndex& operator=(const FTextIndex&) = delete;
+
+    static FXxHash128 HashText(FStringView Text);
+
+    static bool Save(const FString& BasePath, const FString& Model, TArrayView<const FTextIndexEntry> Entries, const FHNSWIndex& Index);
+    bool Load(const FString& BasePath);
+
+    bool IsLoaded() const { return Entries != nullptr; }
+    int32 Num() const { return NumEntries; }
+
+    /**
+      Embedding model of the vectors, queries must be embedded with the same one.
+    */
+    const FString& GetModel() const { return Model; }
+    int32 GetDimensions() const { return Index->GetDimensions(); }
+
+    FString GetText(int32 Entry) const;
+    FString GetSource(int32 Entry) const;
+    FXxHash128 GetHash(int32 Entry) const;
+
+    const FHNSWIndex& GetIndex() const { return *Index; }
+
+    /**
+      Ids of the results are the entry indices.
+    */
+    TArray<FVectorSearchResult> Search(TArrayView<const float> Query, int32 K) const { return Index->Search(Query, K); }
+
+private:
+    struct FEntry;
+
+    TUniquePtr<FHNSWIndex> Index;
+    TUniquePtr<FMappedFile> File;
+    const FEntry* Entries{nullptr};
+    const UTF8CHAR* Strings{nullptr};
+    int32 NumEntries{0};
+    FString Model;
+};
+
+}  // namespace OpenAI
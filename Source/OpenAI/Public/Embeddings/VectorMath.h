@@ -0,0 +1,84 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace OpenAI
+{
+enum class EVectorMetric : uint8
+{
+    Dot,
+    /**
+      Vectors are normalized when they are added, so cosine is computed as the dot product.
+    */
+    Cosine,
+    /**
+      Scores are negated squared distances, so the higher score is always the better one.
+    */
+    L2
+};
+
+/**
+  Base malloc of the 64-bit sized arrays whose data must be aligned, e.g. to cache lines.
+*/
+template <uint32 Alignment>
+struct TAlignedMalloc
+{
+    static void* Malloc(SIZE_T Count, uint32 InAlignment = DEFAULT_ALIGNMENT)
+    {
+        return FMemory::Malloc(Count, FMath::Max<uint32>(Alignment, InAlignment));
+    }
+    static void* Realloc(void* Original, SIZE_T Count, uint32 InAlignment = DEFAULT_ALIGNMENT)
+    {
+        return FMemory::Realloc(Original, Count, FMath::Max<uint32>(Alignment, InAlignment));
+    }
+    static void Free(void* Original) { FMemory::Free(Original); }
+};
+
+/**
+  TAlignedHeapAllocator with 64-bit indices, millions of 3072-dim vectors don't fit int32 element counts.
+*/
+template <uint32 Alignment>
+using TAlignedHeapAllocator64 = TSizedHeapAllocator<64, TAlignedMalloc<Alignment>>;
+
+/**
+  Similarity kernels over float32 vectors.
+  Built on VectorRegister4Float, that is compiled to SSE/AVX or NEON for the target platform.
+*/
+namespace VectorMath
+{
+OPENAI_API float Dot(const float* A, const float* B, int32 Num);
+OPENAI_API float L2Squared(const float* A, const float* B, int32 Num);
+OPENAI_API float Cosine(const float* A, const float* B, int32 Num);
+OPENAI_API float Score(const float* A, const float* B, int32 Num, EVectorMetric Metric);
+
+/**
+  Scales the vector to the unit length, zero vectors stay as is.
+*/
+OPENAI_API void Normalize(TArrayView<float> Vector);
+
+/**
+  Matryoshka truncation: keeps the first Dimensions components and renormalizes them.
+  Same result as the vectors that were requested with FEmbeddings::Dimensions.
+*/
+OPENAI_API TArray<float> Truncate(TArrayView<const float> Vector, int32 Dimensions);
+
+/**
+  Symmetric int8 quantization, returns the scale that restores the floats: Value ~= Quantized * Scale.
+*/
+OPENAI_API float QuantizeInt8(const float* Vector, int32 Num, int8* Quantized);
+OPENAI_API int32 DotInt8(const int8* A, const int8* B, int32 Num);
+
+/**
+  Binary quantization keeps the sign bits only, similarity is the number of equal bits.
+*/
+OPENAI_API void QuantizeBinary(const float* Vector, int32 Num, uint64* Bits);
+OPENAI_API int32 HammingDistance(const uint64* A, const uint64* B, int32 NumWords);
+inline int32 NumBinaryWords(int32 Dimensions)
+{
+    return FMath::DivideAndRoundUp(Dimensions, 64);
+}
+}  // namespace VectorMath
+
+}  // namespace OpenAI
@@ -0,0 +1,24 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VectorSearchTypes.generated.h"
+
+USTRUCT(BlueprintType)
+struct FVectorSearchResult
+{
+    GENERATED_BODY()
+
+    /**
+      Id that was assigned to the vector when it was added.
+    */
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    int64 Id{INDEX_NONE};
+
+    /**
+      Higher is better: dot product, cosine similarity or negated squared distance.
+    */
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    float Score{};
+};
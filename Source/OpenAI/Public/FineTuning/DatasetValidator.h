@@ -0,0 +1,95 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tokenizer/TokenCounter.h"
+
+namespace OpenAI
+{
+class FMappedFile;
+
+struct FDatasetValidationOptions
+{
+    /**
+      Examples that are longer than the context of the model are truncated by the API.
+    */
+    int32 MaxTokensPerExample{65536};
+
+    /**
+      Used for the cost estimation only.
+    */
+    int32 Epochs{3};
+    double PricePerMillionTrainingTokens{3.0};
+
+    bool RemoveDuplicates{true};
+    int32 MaxReportedIssues{100};
+
+    /**
+      Valid unique examples are written to this file if it's not empty.
+    */
+    FString CleanedFilePath;
+};
+
+struct FDatasetIssue
+{
+    /**
+      1-based index of the example, empty lines are skipped.
+    */
+    int32 Example{};
+    FString Message;
+};
+
+struct FDatasetReport
+{
+    int32 NumExamples{};
+    int32 NumValid{};
+    int32 NumInvalid{};
+    int32 NumDuplicates{};
+    int32 NumTooLong{};
+
+    /**
+      Tokens of the valid unique examples for one epoch.
+    */
+    int64 TrainingTokens{};
+    int32 MaxExampleTokens{};
+    double EstimatedCost{};
+
+    TArray<FDatasetIssue> Issues;
+
+    bool IsValid() const { return NumValid > 0 && NumInvalid == 0 && NumTooLong == 0; }
+};
+
+/**
+  Validator of the chat format fine-tuning datasets.
+  https://platform.openai.com/docs/guides/fine-tuning/preparing-your-dataset
+
+  The file is memory-mapped and every example is validated on the worker threads:
+  schema, roles, tool calls that are answered by tool messages, at least one assistant message
+  and the token count against the limit. Identical examples are found by the content hash.
+*/
+class OPENAI_API FFineTuningDatasetValidator
+{
+public:
+    explicit FFineTuningDatasetValidator(const FDatasetValidationOptions& Options = {});
+
+    /**
+      Tokens are counted by the o200k tokenizer if the counter isn't set.
+    */
+    void SetTokenCounter(const FTokenCounter& InTokenCounter) { TokenCounter = InTokenCounter; }
+
+    /**
+      Returns false if the dataset has issues.
+      If the cleaned file is requested, returns false only if it can't be written or has no valid examples.
+    */
+    bool Validate(const FString& FilePath, FDatasetReport& Report) const;
+    bool ValidateString(const FString& Content, FDatasetReport& Report) const;
+
+private:
+    FDatasetValidationOptions Options;
+    FTokenCounter TokenCounter;
+
+    bool ValidateMappedFile(const FMappedFile& File, FDatasetReport& Report) const;
+};
+
+}  // namespace OpenAI
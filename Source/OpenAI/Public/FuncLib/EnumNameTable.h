@@ -0,0 +1,194 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <type_traits>
+
+namespace OpenAI
+{
+/**
+  Name of an enum value in the API.
+*/
+template <typename InEnumType>
+struct TEnumName
+{
+    using EnumType = InEnumType;
+
+    EnumType Value;
+    const TCHAR* Name;
+};
+
+namespace EnumNames
+{
+constexpr uint64 NoSeed = MAX_uint64;
+constexpr uint64 MaxSeeds = 4096;
+
+constexpr TCHAR ToLower(TCHAR Char, ESearchCase::Type SearchCase)
+{
+    return SearchCase == ESearchCase::IgnoreCase && Char >= TEXT('A') && Char <= TEXT('Z')  //
+               ? static_cast<TCHAR>(Char + (TEXT('a') - TEXT('A')))
+               : Char;
+}
+
+constexpr int32 Len(const TCHAR* Name)
+{
+    int32 Length = 0;
+    while (Name[Length] != TEXT('\0'))
+    {
+        ++Length;
+    }
+    return Length;
+}
+
+/**
+  FNV-1a of the name, ASCII letters are lowered for the case-insensitive tables.
+*/
+constexpr uint64 Hash(const TCHAR* Name, int32 Length, ESearchCase::Type SearchCase)
+{
+    uint64 Value = 0xcbf29ce484222325ull;
+    for (int32 Index = 0; Index < Length; ++Index)
+    {
+        Value = (Value ^ static_cast<uint64>(ToLower(Name[Index], SearchCase))) * 0x100000001b3ull;
+    }
+    return Value;
+}
+
+constexpr int32 Slot(uint64 NameHash, uint64 Seed, int32 NumSlots)
+{
+    return static_cast<int32>((((NameHash ^ Seed) * 0x9e3779b97f4a7c15ull) >> 32) & static_cast<uint64>(NumSlots - 1));
+}
+
+constexpr int32 RoundUpToPowerOfTwo(int32 Value)
+{
+    int32 Result = 1;
+    while (Result < Value)
+    {
+        Result <<= 1;
+    }
+    return Result;
+}
+
+template <const auto& Names>
+constexpr int32 NumValues()
+{
+    int64 MaxValue = 0;
+    for (const auto& Name : Names)
+    {
+        MaxValue = FMath::Max(MaxValue, static_cast<int64>(Name.Value));
+    }
+    return static_cast<int32>(MaxValue) + 1;
+}
+
+template <int32 NumNames, int32 NumValues, int32 NumSlots>
+struct TTables
+{
+    int32 Lens[NumNames];
+    /**
+      Index of the name of every value, INDEX_NONE for the values without a name.
+    */
+    int32 ValueNames[NumValues];
+    /**
+      Index of the name in every slot of the perfect hash, INDEX_NONE for the empty slots.
+    */
+    int32 Slots[NumSlots];
+    uint64 Seed;
+};
+
+/**
+  Looks for the seed that puts every name into its own slot, there are four slots per name so a few seeds are enough.
+*/
+template <const auto& Names, ESearchCase::Type SearchCase, int32 NumNames, int32 NumValues, int32 NumSlots>
+constexpr TTables<NumNames, NumValues, NumSlots> MakeTables()
+{
+    TTables<NumNames, NumValues, NumSlots> Tables{};
+    uint64 Hashes[NumNames]{};
+    for (int32 Index = 0; Index < NumNames; ++Index)
+    {
+        Tables.Lens[Index] = Len(Names[Index].Name);
+        Hashes[Index] = Hash(Names[Index].Name, Tables.Lens[Index], SearchCase);
+    }
+
+    for (int32 Value = 0; Value < NumValues; ++Value)
+    {
+        Tables.ValueNames[Value] = INDEX_NONE;
+    }
+    for (int32 Index = NumNames - 1; Index >= 0; --Index)
+    {
+        // the first name of a value wins
+        Tables.ValueNames[static_cast<int64>(Names[Index].Value)] = Index;
+    }
+
+    Tables.Seed = NoSeed;
+    for (uint64 Seed = 0; Seed < MaxSeeds && Tables.Seed == NoSeed; ++Seed)
+    {
+        for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+        {
+            Tables.Slots[Slot] = INDEX_NONE;
+        }
+
+        bool bPerfect = true;
+        for (int32 Index = 0; Index < NumNames && bPerfect; ++Index)
+        {
+            int32& Slot = Tables.Slots[EnumNames::Slot(Hashes[Index], Seed, NumSlots)];
+            bPerfect = Slot == INDEX_NONE;
+            Slot = Index;
+        }
+
+        if (bPerfect)
+        {
+            Tables.Seed = Seed;
+        }
+    }
+    return Tables;
+}
+}  // namespace EnumNames
+
+/**
+  Two-way mapping between the values of an enum and their API names, generated at compile time from one array of TEnumName:
+
+    constexpr TEnumName<ERole> RoleNames[]{{ERole::System, TEXT("system")}, {ERole::User, TEXT("user")}};
+    const TOptional<ERole> Role = TEnumNameTable<RoleNames>::FindValue(TEXT("user"));
+
+  Values index an array of names, names are found by a perfect hash and one compare. Neither lookup allocates.
+*/
+template <const auto& Names, ESearchCase::Type SearchCase = ESearchCase::CaseSensitive>
+class TEnumNameTable
+{
+    using FEnumName = std::remove_cv_t<std::remove_reference_t<decltype(Names[0])>>;
+
+public:
+    using EnumType = typename FEnumName::EnumType;
+
+    static TOptional<FStringView> FindName(EnumType Value)
+    {
+        const int64 ValueIndex = static_cast<int64>(Value);
+        if (ValueIndex < 0 || ValueIndex >= NumValues) return {};
+
+        const int32 Index = Tables.ValueNames[ValueIndex];
+        if (Index == INDEX_NONE) return {};
+
+        return FStringView(Names[Index].Name, Tables.Lens[Index]);
+    }
+
+    static TOptional<EnumType> FindValue(FStringView Name)
+    {
+        const uint64 NameHash = EnumNames::Hash(Name.GetData(), Name.Len(), SearchCase);
+        const int32 Index = Tables.Slots[EnumNames::Slot(NameHash, Tables.Seed, NumSlots)];
+        if (Index == INDEX_NONE || !Name.Equals(FStringView(Names[Index].Name, Tables.Lens[Index]), SearchCase)) return {};
+
+        return Names[Index].Value;
+    }
+
+    static constexpr int32 Num() { return NumNames; }
+
+private:
+    static constexpr int32 NumNames = UE_ARRAY_COUNT(Names);
+    static constexpr int32 NumValues = EnumNames::NumValues<Names>();
+    static constexpr int32 NumSlots = EnumNames::RoundUpToPowerOfTwo(NumNames * 4);
+    static constexpr EnumNames::TTables<NumNames, NumValues, NumSlots> Tables =
+        EnumNames::MakeTables<Names, SearchCase, NumNames, NumValues, NumSlots>();
+
+    static_assert(Tables.Seed != EnumNames::NoSeed, "Enum names should be unique");
+};
+}  // namespace OpenAI
@@ -119,6 +119,12 @@ public:
     UFUNCTION(BlueprintPure, Category = "OpenAI | Common")
     static ERole StringToOpenAIRole(const FString& Role);
 
+    /**
+      Don't assert on the unknown names, for the values that come from the server.
+    */
+    static TOptional<ERole> FindOpenAIRole(FStringView Role);
+    static TOptional<EOpenAIFinishReason> FindOpenAIFinishReason(FStringView FinishReason);
+
     // errors
     UFUNCTION(BlueprintPure, Category = "OpenAI | Error")
     static EOpenAIResponseError GetErrorCode(const FString& RawError);
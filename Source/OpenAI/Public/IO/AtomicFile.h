@@ -0,0 +1,25 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace OpenAI
+{
+/**
+  Files that are written next to the target and renamed over it,
+  so after a crash the target is either the old or the new file, never a missing or partial one.
+*/
+namespace AtomicFile
+{
+/**
+  Renames TempPath over FilePath in one step, IFileManager::Move deletes the target first.
+*/
+OPENAI_API bool Replace(const FString& FilePath, const FString& TempPath);
+
+/**
+  Calls Save with the temp path (FilePath.tmp) and replaces the target if it succeeds, the temp file is deleted if not.
+*/
+OPENAI_API bool Save(const FString& FilePath, TFunctionRef<bool(const FString& /* TempPath */)> Save);
+}  // namespace AtomicFile
+}  // namespace OpenAI
@@ -0,0 +1,55 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FOpenAIFile;
+
+namespace OpenAI
+{
+/**
+  Local record of the files that were already uploaded.
+
+  Maps a BLAKE3 hash of the file content plus the upload purpose to the remote file id,
+  so the same training, batch or image file is uploaded only once.
+  The manifest is stored as JSON (Saved/OpenAI/FileManifest.json by default) and is safe to use from several threads.
+*/
+class OPENAI_API FFileManifest
+{
+public:
+    explicit FFileManifest(const FString& FilePath = DefaultFilePath());
+
+    /**
+      Streams the file from disk, returns an empty string if the file can't be read.
+    */
+    static FString HashFile(const FString& FilePath);
+    static FString DefaultFilePath();
+
+    bool Find(const FString& Hash, const FString& Purpose, FString& FileId) const;
+    void Add(const FString& Hash, const FString& Purpose, const FString& FileId);
+    void RemoveFile(const FString& FileId);
+
+    /**
+      Drops the entries whose files are no longer on the server.
+      RemoteFiles must be the complete list that was received with UOpenAIProvider::ListFiles.
+    */
+    void Reconcile(const TArray<FOpenAIFile>& RemoteFiles);
+
+    int32 Num() const;
+    void Reset();
+
+    bool Load();
+    bool Save() const;
+
+private:
+    const FString FilePath;
+    mutable FCriticalSection CriticalSection;
+
+    // hash and purpose -> file id
+    TMap<FString, FString> Entries;
+
+    static FString MakeKey(const FString& Hash, const FString& Purpose) { return Hash + TEXT(":") + Purpose; }
+};
+
+}  // namespace OpenAI
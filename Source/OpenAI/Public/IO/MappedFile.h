@@ -0,0 +1,67 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace OpenAI
+{
+/**
+  Read-only view of a file.
+  The file is memory-mapped when the platform supports it, otherwise it is loaded into memory.
+  The view can also own a buffer that was received over the network (e.g. file content of a batch).
+*/
+class OPENAI_API FMappedFile
+{
+public:
+    struct FLine
+    {
+        int64 Offset{};
+        int32 Length{};
+    };
+
+    FMappedFile() = default;
+    ~FMappedFile();
+
+    FMappedFile(const FMappedFile&) = delete;
+    FMappedFile& operator=(const FMappedFile&) = delete;
+
+    bool Open(const FString& FilePath);
+    void OpenFromBuffer(TArray64<uint8>&& Buffer);
+    void OpenFromString(const FString& Content);
+    void Close();
+
+    bool IsOpen() const { return bOpened; }
+    bool IsMapped() const { return Region.IsValid(); }
+
+    const uint8* GetData() const { return Data; }
+    int64 GetSize() const { return Size; }
+
+    FUtf8StringView View(int64 Offset, int64 Length) const
+    {
+        check(Offset >= 0 && Offset + Length <= Size);
+        return FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Data + Offset), static_cast<int32>(Length));
+    }
+
+    FUtf8StringView View(const FLine& Line) const { return View(Line.Offset, Line.Length); }
+
+    /**
+      Splits the content into non-empty lines without surrounding white spaces (JSONL),
+      the content is scanned in parallel blocks.
+    */
+    void SplitLines(TArray<FLine>& Lines) const;
+
+private:
+    TUniquePtr<IMappedFileHandle> Handle;
+    TUniquePtr<IMappedFileRegion> Region;
+    TArray64<uint8> Buffer;
+
+    const uint8* Data{nullptr};
+    int64 Size{0};
+    bool bOpened{false};
+};
+
+}  // namespace OpenAI
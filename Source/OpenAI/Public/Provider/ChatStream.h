@@ -0,0 +1,144 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/CommonTypes.h"
+#include "Provider/Types/Chat/ChatCompletionChunkTypes.h"
+
+namespace OpenAI
+{
+/**
+  Part of the text that a choice has accumulated.
+*/
+struct FChatStreamText
+{
+    int32 Start{0};
+    int32 Len{0};
+};
+
+/**
+  Choice of one stream chunk. Its texts point into the message of the choice, so parsing a chunk doesn't allocate.
+*/
+struct FChatStreamDelta
+{
+    int32 Choice{0};
+    int32 ToolCall{INDEX_NONE};
+    FChatStreamText Content;
+    FChatStreamText Refusal;
+    FChatStreamText ToolCallID;
+    FChatStreamText FunctionName;
+    FChatStreamText Arguments;
+    TOptional<ERole> Role;
+    EOpenAIFinishReason FinishReason{EOpenAIFinishReason::Null};
+};
+
+/**
+  Message that a choice has accumulated so far.
+*/
+struct FChatStreamMessage
+{
+    FString Content;
+    FString Refusal;
+    TArray<FToolCalls> ToolCalls;
+    ERole Role{ERole::Assistant};
+    EOpenAIFinishReason FinishReason{EOpenAIFinishReason::Null};
+};
+
+/**
+  Incremental parser of the server-sent events of a chat completion stream.
+
+  Every call parses only the lines that were completed since the previous one. The id, model and fingerprint
+  that repeat in every chunk are kept once per stream, roles and finish reasons are enums.
+  The Blueprint structs are made only on demand by ToResponses().
+*/
+class OPENAI_API FChatStream
+{
+public:
+    /**
+      Parses the lines of the response content after the previous call, the last line is parsed only when the response is complete.
+      Returns the number of the new chunks.
+    */
+    int32 Parse(FStringView Content, bool bComplete = false);
+
+    /**
+      Same as Parse() for the raw UTF-8 body of the response, only the bytes after the previous call are converted,
+      so a long stream isn't converted as a whole on every progress. The two methods can't be mixed on one stream.
+      NewLines receives the converted lines, e.g. for logging.
+    */
+    int32 ParseUtf8(TConstArrayView<uint8> Content, bool bComplete = false, FString* NewLines = nullptr);
+
+    bool IsDone() const { return bDone; }
+    int32 NumChunks() const { return ChunkStarts.Num(); }
+
+    const FString& GetID() const { return ID; }
+    const FString& GetModel() const { return Model; }
+    const FUsage& GetUsage() const { return Usage; }
+
+    TConstArrayView<FChatStreamMessage> GetMessages() const { return Messages; }
+    const FChatStreamMessage* FindMessage(int32 Choice = 0) const { return Messages.IsValidIndex(Choice) ? &Messages[Choice] : nullptr; }
+    TConstArrayView<FChatStreamDelta> GetDeltas() const { return Deltas; }
+
+    /**
+      Chunks in the Blueprint representation.
+    */
+    TArray<FChatCompletionStreamResponse> ToResponses() const;
+
+private:
+    struct FPendingToolCall
+    {
+        int32 Index{0};
+        FString ID;
+        FString Type;
+        FString Name;
+        FString Arguments;
+    };
+
+    /**
+      Fields of the choice that is being parsed, the index of the choice may follow its delta.
+      The strings are reused from chunk to chunk.
+    */
+    struct FPendingChoice
+    {
+        int32 Index{0};
+        FString Content;
+        FString Refusal;
+        TArray<FPendingToolCall> ToolCalls;
+        int32 NumToolCalls{0};
+        TOptional<ERole> Role;
+        EOpenAIFinishReason FinishReason{EOpenAIFinishReason::Null};
+    };
+
+    FString ID;
+    FString Model;
+    FString Object;
+    FString SystemFingerprint;
+    FString ServiceTier;
+    int32 Created{0};
+
+    TArray<FChatStreamMessage> Messages;
+    TArray<FChatStreamDelta> Deltas;
+    /**
+      First delta of every chunk.
+    */
+    TArray<int32> ChunkStarts;
+
+    /**
+      Log probabilities and usage are opt-in, the chunks that have them are parsed once more into the Blueprint structs.
+    */
+    TMap<int32, FLogProbs> LogProbs;
+    FUsage Usage;
+    int32 UsageChunk{INDEX_NONE};
+
+    FPendingChoice Pending;
+    int32 ParsedLength{0};
+    int32 ParsedBytes{0};
+    bool bDone{false};
+
+    int32 ParseLines(FStringView Lines);
+    bool ParseLine(FStringView Line);
+    bool ParseChunk(FStringView Json);
+    void CommitChoice();
+    void ResetPendingChoice();
+};
+}  // namespace OpenAI
@@ -5,6 +5,11 @@
 #include "CoreMinimal.h"
 #include "Provider/Types/AllTypesHeader.h"
 
+namespace OpenAI
+{
+class FChatStream;
+}
+
 // ============================ C++ delegates ============================
 // common
 DECLARE_MULTICAST_DELEGATE_TwoParams(FOnRequestCompleted, const FString& /* URL */, const FString& /* Response content */);
@@ -21,6 +26,7 @@ using FOnCreateCompletionStreamProgresses = FOnCreateCompletionStreamCompleted;
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnCreateChatCompletionCompleted, const FChatCompletionResponse&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnCreateChatCompletionStreamCompleted, const TArray<FChatCompletionStreamResponse>&);
 using FOnCreateChatCompletionStreamProgresses = FOnCreateChatCompletionStreamCompleted;
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnCreateChatCompletionStreamUpdated, const OpenAI::FChatStream&, bool /* Completed */);
 // images
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnCreateImageCompleted, const FImageResponse&);
 DECLARE_MULTICAST_DELEGATE_OneParam(FOnCreateImageEditCompleted, const FImageEditResponse&);
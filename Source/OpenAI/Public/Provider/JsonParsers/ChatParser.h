@@ -7,10 +7,54 @@
 
 namespace OpenAI
 {
+/**
+  JSON of the chat messages by the hash of their content.
+  Requests of a growing chat history serialize only the messages that weren't sent before,
+  the others are concatenated from the cache.
+*/
+class OPENAI_API FChatMessageJsonCache
+{
+public:
+    explicit FChatMessageJsonCache(int32 InCapacity = 4096) : Capacity(InCapacity) {}
+
+    /**
+      The reference is valid until the next call.
+    */
+    const FString& FindOrAdd(const FMessage& Message);
+
+    /**
+      Drops the messages that weren't used since the previous trim if the cache is over its capacity.
+    */
+    void Trim();
+
+    void Reset() { Fragments.Reset(); }
+    int32 Num() const { return Fragments.Num(); }
+
+    static TTuple<uint64, uint64> HashMessage(const FMessage& Message);
+
+private:
+    struct FFragment
+    {
+        FString Json;
+        uint64 LastUsed{};
+    };
+
+    TMap<TTuple<uint64, uint64>, FFragment> Fragments;
+    uint64 Generation{0};
+    int32 Capacity;
+};
+
 class OPENAI_API ChatParser
 {
 public:
     static FString ChatCompletionToJsonRepresentation(const FChatCompletion& ChatCompletion);
+
+    /**
+      Same JSON with the messages taken from the cache.
+    */
+    static FString ChatCompletionToJsonRepresentation(const FChatCompletion& ChatCompletion, FChatMessageJsonCache& Cache);
+    static FString MessageToJsonRepresentation(const FMessage& Message);
+
     static bool CleanChunkResponseString(FString& IncomeString, bool& LastString);
 };
-}  // namespace OpenAI
\ No newline at end of file
+}  // namespace OpenAI
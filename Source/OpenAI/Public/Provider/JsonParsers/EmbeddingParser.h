@@ -0,0 +1,24 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/EmbeddingTypes.h"
+
+namespace OpenAI
+{
+/**
+  Single pass parser of the embeddings response, no JSON DOM is built.
+  Vectors are decoded from base64 straight into the float arrays, float arrays are parsed without the generic number reader.
+*/
+class OPENAI_API EmbeddingParser
+{
+public:
+    static bool DeserializeResponse(const FString& ResponseString, FEmbeddingsResponse& EmbeddingsResponse);
+
+    /**
+      Decodes little-endian float32 values, returns false if the size isn't a multiple of the float size.
+    */
+    static bool DecodeBase64(FStringView Base64, TArray<float>& Floats);
+};
+}  // namespace OpenAI
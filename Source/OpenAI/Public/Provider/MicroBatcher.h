@@ -0,0 +1,119 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Containers/Ticker.h"
+#include "Provider/Types/EmbeddingTypes.h"
+#include "Provider/Types/ModerationTypes.h"
+#include "Provider/Types/CommonTypes.h"
+#include "Templates/SubclassOf.h"
+#include "MicroBatcher.generated.h"
+
+class UOpenAIProvider;
+
+namespace OpenAI
+{
+struct FMicroBatchingOptions
+{
+    /**
+      Calls are collected for this long after the first one, then a single request is sent.
+    */
+    FTimespan Window{FTimespan::FromMilliseconds(5.0)};
+
+    /**
+      Request is sent right away when this many calls are collected.
+      The embeddings endpoint accepts 2048 inputs at most.
+    */
+    int32 MaxItems{256};
+};
+
+/**
+  Calls that are waiting for the next request.
+  Identical inputs of one window are sent once and share the result.
+*/
+template <typename ResultType>
+struct TMicroBatch
+{
+    using FOnResult = TFunction<void(const ResultType& /* Result */, bool /* Succeeded */)>;
+
+    TArray<FString> Inputs;
+    TMap<FString, int32> InputIndices;
+    TArray<TPair<int32, FOnResult>> Callers;
+    FTSTicker::FDelegateHandle TickerHandle;
+
+    int32 Num() const { return Callers.Num(); }
+};
+
+using FOnItemEmbedded = TMicroBatch<FEmbeddingsData>::FOnResult;
+using FOnItemModerated = TMicroBatch<FModerationResults>::FOnResult;
+}  // namespace OpenAI
+
+/**
+  Opt-in coalescing of single-string embeddings and moderations calls.
+
+  Calls are collected for a few milliseconds or up to N items and sent as one request,
+  each caller receives its own item of the response. Callbacks are called on the game thread.
+  Every call of a batcher shares the same request parameters (model, dimensions, etc.).
+*/
+UCLASS()
+class OPENAI_API UOpenAIMicroBatcher : public UObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void BeginDestroy() override;
+
+    void SetAuth(const FOpenAIAuth& InAuth) { Auth = InAuth; }
+    void SetOptions(const OpenAI::FMicroBatchingOptions& InOptions);
+    const OpenAI::FMicroBatchingOptions& GetOptions() const { return Options; }
+
+    /**
+      Class of the providers that send the batched requests, e.g. a fake one in tests.
+    */
+    void SetProviderClass(const TSubclassOf<UOpenAIProvider>& InProviderClass) { ProviderClass = InProviderClass; }
+
+    /**
+      Parameters of the batched requests, the input is ignored.
+    */
+    void SetEmbeddingsParams(const FEmbeddings& InParams) { EmbeddingsParams = InParams; }
+    void SetModerationsParams(const FModerations& InParams) { ModerationsParams = InParams; }
+
+    void Embed(const FString& Input, const OpenAI::FOnItemEmbedded& OnCompleted);
+    void Moderate(const FString& Input, const OpenAI::FOnItemModerated& OnCompleted);
+
+    /**
+      Sends the collected calls without waiting for the window to elapse.
+    */
+    void Flush();
+
+    int32 NumPendingItems() const { return PendingEmbeddings.Num() + PendingModerations.Num(); }
+    int32 NumRequestsSent() const { return NumSent; }
+
+private:
+    UPROPERTY()
+    TArray<TObjectPtr<UOpenAIProvider>> Providers;
+
+    UPROPERTY()
+    TSubclassOf<UOpenAIProvider> ProviderClass;
+
+    FOpenAIAuth Auth;
+    OpenAI::FMicroBatchingOptions Options;
+    FEmbeddings EmbeddingsParams;
+    FModerations ModerationsParams;
+
+    OpenAI::TMicroBatch<FEmbeddingsData> PendingEmbeddings;
+    OpenAI::TMicroBatch<FModerationResults> PendingModerations;
+    int32 NumSent{0};
+
+    template <typename ResultType, typename RequestType>
+    void Add(OpenAI::TMicroBatch<ResultType>& Batch, const RequestType& Params, const FString& Input,
+        const typename OpenAI::TMicroBatch<ResultType>::FOnResult& OnCompleted);
+
+    template <typename ResultType, typename RequestType>
+    void Send(OpenAI::TMicroBatch<ResultType>& Batch, const RequestType& Params);
+
+    template <typename ResultType>
+    void StopTicker(OpenAI::TMicroBatch<ResultType>& Batch);
+};
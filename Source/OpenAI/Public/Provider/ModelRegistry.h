@@ -0,0 +1,66 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/Types/ModelTypes.h"
+#include "Tokenizer/BPETokenizer.h"
+
+namespace OpenAI
+{
+/**
+  Capabilities of the models: context window, max output tokens, tokenizer, vision, tools, streaming and pricing.
+
+  Models are found by a hash of the name. Dated snapshots and fine-tunes resolve to their base model
+  by dropping the name suffixes one by one (ft:gpt-4o-mini-2024-07-18:org::id -> gpt-4o-mini), unknown models get the defaults.
+
+  The registry that the plugin uses is built in and is updated from Content/OpenAI/Models.json if the file exists:
+  {"models": [{"name": "gpt-4o", "max_output_tokens": 16384, "input_price": 2.5}, {"name": "my-model", "context_window": 32768}]}
+  Fields that aren't in the file are taken from the entry that the name resolved to before.
+*/
+class OPENAI_API FModelRegistry
+{
+public:
+    /**
+      Registry of the built-in models.
+    */
+    FModelRegistry();
+
+    /**
+      Adds the model or replaces the entry with the same name.
+    */
+    void Add(const FModelCapabilities& Model);
+
+    bool LoadFromFile(const FString& FilePath);
+    bool LoadFromString(const FString& JsonString);
+
+    /**
+      Entry of the model or of its base model, the defaults for unknown models.
+    */
+    const FModelCapabilities& Find(FStringView Model) const;
+    bool IsKnown(FStringView Model) const;
+    EBPEEncoding GetEncoding(FStringView Model) const;
+
+    int32 Num() const { return Models.Num(); }
+    const FModelCapabilities& GetDefaults() const { return Defaults; }
+
+    /**
+      Registry that the plugin uses, it's immutable and can be read from any thread.
+    */
+    static TSharedRef<const FModelRegistry> Get();
+    static void Set(const TSharedRef<const FModelRegistry>& Registry);
+    static FString GetDefaultFilePath();
+
+private:
+    TArray<FModelCapabilities> Models;
+    TArray<EBPEEncoding> Encodings;
+    /**
+      Name hash to the model index.
+    */
+    TMap<uint64, int32> ModelIndices;
+    FModelCapabilities Defaults;
+
+    int32 FindIndex(FStringView Model) const;
+    int32 FindExactIndex(FStringView Name) const;
+};
+}  // namespace OpenAI
@@ -38,6 +38,10 @@ class FJsonObject;
 namespace OpenAI
 {
 class IAPI;
+class FFileManifest;
+class FEmbeddingCache;
+struct FEmbeddingCacheLookup;
+class FChatStream;
 }
 
 UCLASS()
@@ -101,6 +105,7 @@ public:
 
     /**
       Creates an embedding vector representing the input text.
+      With the embedding cache only the missed and deduplicated inputs are sent.
       https://platform.openai.com/docs/api-reference/embeddings/create
     */
     void CreateEmbeddings(const FEmbeddings& Embeddings, const FOpenAIAuth& Auth);
@@ -127,12 +132,14 @@ public:
       Returns a list of files that belong to the user's organization.
       https://platform.openai.com/docs/api-reference/files/list
     */
-    void ListFiles(const FOpenAIAuth& Auth);
+    void ListFiles(const FOpenAIAuth& Auth, const FListFiles& ListFiles = {});
 
     /**
       Upload a file that contains document(s) to be used across various endpoints/features.
       Currently, the size of all the files uploaded by one organization can be up to 1 GB.
       Please contact us if you need to increase the storage limit.
+      If the file manifest is set and the same content was already uploaded with the same purpose,
+      the upload is skipped and the existing file is reported.
       https://platform.openai.com/docs/api-reference/files/upload
     */
     void UploadFile(const FUploadFile& UploadFile, const FOpenAIAuth& Auth);
@@ -261,6 +268,18 @@ public:
     */
     void SetLogEnabled(bool LogEnabled) { bLogEnabled = LogEnabled; }
 
+    /**
+      Manifest of the uploaded files, it's updated by UploadFile and DeleteFile responses
+      and reconciled with the complete list of files, i.e. ListFiles without filters, limit and cursor.
+      The manifest can be shared between providers.
+    */
+    void SetFileManifest(const TSharedPtr<OpenAI::FFileManifest>& Manifest);
+
+    /**
+      Cache of the received embeddings, it's consulted by CreateEmbeddings and can be shared between providers.
+    */
+    void SetEmbeddingCache(const TSharedPtr<OpenAI::FEmbeddingCache>& Cache) { EmbeddingCache = Cache; }
+
 #define DEFINE_EVENT_GETTER(Name)          \
 public:                                    \
     FOn##Name& On##Name() { return Name; } \
@@ -278,6 +297,10 @@ public:
     DEFINE_EVENT_GETTER(CreateChatCompletionCompleted)
     DEFINE_EVENT_GETTER(CreateChatCompletionStreamCompleted)
     DEFINE_EVENT_GETTER(CreateChatCompletionStreamProgresses)
+    /**
+      Compact chat stream that is parsed incrementally, the stream delegates above get the chunks as Blueprint structs.
+    */
+    DEFINE_EVENT_GETTER(CreateChatCompletionStreamUpdated)
     DEFINE_EVENT_GETTER(CreateImageCompleted)
     DEFINE_EVENT_GETTER(CreateImageEditCompleted)
     DEFINE_EVENT_GETTER(CreateImageVariationCompleted)
@@ -313,6 +336,27 @@ private:
     bool bLogEnabled{true};
     FOnRequestError RequestError;
 
+    TSharedPtr<OpenAI::FFileManifest> FileManifest;
+    FDelegateHandle DeleteFileManifestHandle;
+
+    TSharedPtr<OpenAI::FEmbeddingCache> EmbeddingCache;
+
+    /**
+      Chat requests of the same conversation serialize only the new messages.
+    */
+    TSharedPtr<OpenAI::FChatMessageJsonCache> ChatMessageCache;
+
+    /**
+      Chat completion streams that are in progress by their requests.
+    */
+    TMap<const IHttpRequest*, TSharedPtr<OpenAI::FChatStream>> ChatStreams;
+
+    void SendUploadFileRequest(const FUploadFile& UploadFile, const FOpenAIAuth& Auth, const FString& ContentHash);
+    void SendCachedEmbeddingsRequest(
+        const FEmbeddings& Embeddings, const FOpenAIAuth& Auth, const TSharedRef<OpenAI::FEmbeddingCacheLookup>& Lookup);
+    bool ParseEmbeddingsResponse(FHttpResponsePtr Response, bool WasSuccessful, FEmbeddingsResponse& EmbeddingsResponse);
+    void BroadcastUploadedFile(const FUploadFile& UploadFile, const FString& FileId);
+
 #define DECLARE_HTTP_CALLBACK(Callback) virtual void Callback(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful);
 #define DECLARE_HTTP_CALLBACK_PROGRESS(Callback) virtual void Callback(FHttpRequestPtr Request, int32 BytesSent, int32 BytesReceived);
 
@@ -331,7 +375,10 @@ private:
     DECLARE_HTTP_CALLBACK(OnCreateSpeechCompleted)
     DECLARE_HTTP_CALLBACK(OnCreateAudioTranscriptionCompleted)
     DECLARE_HTTP_CALLBACK(OnCreateAudioTranslationCompleted)
-    DECLARE_HTTP_CALLBACK(OnListFilesCompleted)
+    /**
+      FullListing: the request asked for all files, unfiltered and without a limit.
+    */
+    virtual void OnListFilesCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool WasSuccessful, bool FullListing);
     DECLARE_HTTP_CALLBACK(OnUploadFileCompleted)
     DECLARE_HTTP_CALLBACK(OnDeleteFileCompleted)
     DECLARE_HTTP_CALLBACK(OnRetrieveFileCompleted)
@@ -358,6 +405,7 @@ private:
     bool Success(FHttpResponsePtr Response, bool WasSuccessful);
     void Log(const FString& Info) const;
     void LogResponse(FHttpResponsePtr Response) const;
+    void LogResponse(FHttpResponsePtr Response, const FString& Content) const;
     void LogError(const FString& ErrorText) const;
 
     template <typename OutStructType>
@@ -396,21 +444,28 @@ private:
     template <typename ParsedResponseType, typename DelegateType>
     void HandleResponse(FHttpResponsePtr Response, bool WasSuccessful, DelegateType& Delegate)
     {
-        if (!Success(Response, WasSuccessful)) return;
-
-        const FString Content = Response.IsValid() ? Response->GetContentAsString() : FString{};
-        const FString ResponseURL = Response.IsValid() ? Response->GetURL() : FString{};
-
         ParsedResponseType ParsedResponse;
-        if (UJsonFuncLib::ParseJSONToStruct(Content, &ParsedResponse))
+        if (ParseResponse(Response, WasSuccessful, ParsedResponse))
         {
             Delegate.Broadcast(ParsedResponse);
         }
-        else
+    }
+
+    template <typename ParsedResponseType>
+    bool ParseResponse(FHttpResponsePtr Response, bool WasSuccessful, ParsedResponseType& ParsedResponse)
+    {
+        if (!Success(Response, WasSuccessful)) return false;
+
+        const FString Content = Response.IsValid() ? Response->GetContentAsString() : FString{};
+        const FString ResponseURL = Response.IsValid() ? Response->GetURL() : FString{};
+
+        if (!UJsonFuncLib::ParseJSONToStruct(Content, &ParsedResponse))
         {
             LogError("JSON deserialization error");
             RequestError.Broadcast(ResponseURL, Content);
+            return false;
         }
+        return true;
     }
 
     virtual TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest() const { return FHttpModule::Get().CreateRequest(); }
@@ -0,0 +1,387 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Provider/OpenAIProvider.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Templates/SubclassOf.h"
+
+namespace OpenAI
+{
+/**
+  Describes how to request one page of a list endpoint.
+  Cursor of the next page is the id of the last item of the current page.
+*/
+template <typename ListResponseType>
+struct TPageTraits;
+
+template <>
+struct TPageTraits<FListBatchResponse>
+{
+    using ItemType = FOpenAIBatch;
+
+    static FOnListBatchCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnListBatchCompleted(); }
+    static const FString& GetId(const ItemType& Item) { return Item.Id; }
+
+    static void Request(UOpenAIProvider* Provider, const FString& ParentId, const FString& After, int32 Limit, const FOpenAIAuth& Auth)
+    {
+        FListBatch ListBatch;
+        ListBatch.Limit.Set(Limit);
+        if (!After.IsEmpty()) ListBatch.After.Set(After);
+        Provider->ListBatch(ListBatch, Auth);
+    }
+};
+
+template <>
+struct TPageTraits<FListFilesResponse>
+{
+    using ItemType = FOpenAIFile;
+
+    static FOnListFilesCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnListFilesCompleted(); }
+    static const FString& GetId(const ItemType& Item) { return Item.ID; }
+
+    static void Request(UOpenAIProvider* Provider, const FString& ParentId, const FString& After, int32 Limit, const FOpenAIAuth& Auth)
+    {
+        FListFiles ListFiles;
+        ListFiles.Limit.Set(Limit);
+        // parent id is used as a purpose filter
+        if (!ParentId.IsEmpty()) ListFiles.Purpose.Set(ParentId);
+        if (!After.IsEmpty()) ListFiles.After.Set(After);
+        Provider->ListFiles(Auth, ListFiles);
+    }
+};
+
+template <>
+struct TPageTraits<FListFineTuningJobsResponse>
+{
+    using ItemType = FFineTuningJobObjectResponse;
+
+    static FOnListFineTuningJobsCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnListFineTuningJobsCompleted(); }
+    static const FString& GetId(const ItemType& Item) { return Item.ID; }
+
+    static void Request(UOpenAIProvider* Provider, const FString& ParentId, const FString& After, int32 Limit, const FOpenAIAuth& Auth)
+    {
+        Provider->ListFineTuningJobs(Auth, MakeQuery(After, Limit));
+    }
+
+    static FFineTuningQueryParameters MakeQuery(const FString& After, int32 Limit)
+    {
+        FFineTuningQueryParameters Query;
+        Query.Limit.Set(Limit);
+        if (!After.IsEmpty()) Query.After.Set(After);
+        return Query;
+    }
+};
+
+template <>
+struct TPageTraits<FListFineTuningEventsResponse>
+{
+    using ItemType = FFineTuningJobEventResponse;
+
+    static FOnListFineTuningEventsCompleted& OnCompleted(UOpenAIProvider* Provider) { return Provider->OnListFineTuningEventsCompleted(); }
+    static const FString& GetId(const ItemType& Item) { return Item.ID; }
+
+    static void Request(UOpenAIProvider* Provider, const FString& ParentId, const FString& After, int32 Limit, const FOpenAIAuth& Auth)
+    {
+        Provider->ListFineTuningEvents(ParentId, Auth, TPageTraits<FListFineTuningJobsResponse>::MakeQuery(After, Limit));
+    }
+};
+
+template <>
+struct TPageTraits<FListFineTuningCheckpointsResponse>
+{
+    using ItemType = FFineTuningJobCheckpointResponse;
+
+    static FOnListFineTuningCheckpointsCompleted& OnCompleted(UOpenAIProvider* Provider)
+    {
+        return Provider->OnListFineTuningCheckpointsCompleted();
+    }
+    static const FString& GetId(const ItemType& Item) { return Item.ID; }
+
+    static void Request(UOpenAIProvider* Provider, const FString& ParentId, const FString& After, int32 Limit, const FOpenAIAuth& Auth)
+    {
+        Provider->ListFineTuningCheckpoints(ParentId, Auth, TPageTraits<FListFineTuningJobsResponse>::MakeQuery(After, Limit));
+    }
+};
+
+/**
+  Cursor pagination over a list endpoint.
+
+  Next() delivers pages in order, the following page is requested as soon as the current one is delivered,
+  so it's usually ready by the time the caller asks for it.
+  FetchNew() is the tail mode for newest-first lists (e.g. fine-tuning events):
+  it walks from the top of the list and stops at the newest item of the previous call,
+  so only the items created since then are requested. A prefetch of Next() that is in flight is finished first.
+
+  ParentId is the fine-tuning job id for events and checkpoints and the purpose filter for files.
+  Callbacks are called on the game thread.
+*/
+template <typename ListResponseType>
+class TPaginator : public TSharedFromThis<TPaginator<ListResponseType>>
+{
+public:
+    using FTraits = TPageTraits<ListResponseType>;
+    using ItemType = typename FTraits::ItemType;
+    using FOnPage = TFunction<void(const TArray<ItemType>& /* Items */, bool /* HasMore */)>;
+    using FOnItems = TFunction<void(const TArray<ItemType>& /* Items */)>;
+    using FOnError = TFunction<void(const FString& /* Error */)>;
+
+    static TSharedRef<TPaginator> Create(const FOpenAIAuth& Auth, const FString& ParentId = {}, int32 PageSize = 100,
+        const TSubclassOf<UOpenAIProvider>& ProviderClass = nullptr)
+    {
+        const TSharedRef<TPaginator> Paginator = MakeShareable(new TPaginator(Auth, ParentId, PageSize, ProviderClass));
+        Paginator->BindProvider();
+        return Paginator;
+    }
+
+    ~TPaginator()
+    {
+        if (Provider.IsValid())
+        {
+            FTraits::OnCompleted(Provider.Get()).RemoveAll(this);
+            Provider->OnRequestError().RemoveAll(this);
+        }
+    }
+
+    void SetOnError(const FOnError& InOnError) { OnError = InOnError; }
+    void SetProviderLogEnabled(bool LogEnabled) { Provider->SetLogEnabled(LogEnabled); }
+
+    /**
+      Delivers the next page, calls OnPage with an empty array when the list is exhausted.
+    */
+    void Next(const FOnPage& OnPage)
+    {
+        check(!PendingPage && !PendingTail);
+
+        if (Prefetched.IsSet())
+        {
+            DeliverPrefetched(OnPage);
+            return;
+        }
+
+        if (!IsRequestInFlight() && !HasMore())
+        {
+            OnPage({}, false);
+            return;
+        }
+
+        PendingPage = OnPage;
+        if (!IsRequestInFlight())
+        {
+            RequestPage(Cursor);
+        }
+    }
+
+    /**
+      Fetches all remaining pages.
+    */
+    void FetchAll(const FOnItems& OnCompleted)
+    {
+        FetchAllPages(MakeShared<TArray<ItemType>>(), OnCompleted);
+    }
+
+    /**
+      Tail mode: delivers the items that appeared at the top of the list since the previous call, newest first.
+      The first call delivers the first page only and remembers its newest item.
+    */
+    void FetchNew(const FOnItems& OnCompleted)
+    {
+        check(!PendingPage && !PendingTail);
+
+        PendingTail = OnCompleted;
+        TailItems.Reset();
+        // the prefetch of Next() keeps its page, the tail is requested once it's received
+        if (!IsRequestInFlight())
+        {
+            RequestTailPage({});
+        }
+    }
+
+    bool HasMore() const { return !bStarted || bHasMore; }
+    bool IsRequestInFlight() const { return RequestInFlight != ERequest::None; }
+
+    const FString& GetCursor() const { return Cursor; }
+    const FString& GetNewestId() const { return NewestId; }
+
+    /**
+      Restores the position, e.g. the newest event id that was saved by the dashboard.
+    */
+    void SetNewestId(const FString& Id) { NewestId = Id; }
+
+    void Reset()
+    {
+        check(!IsRequestInFlight());
+        Cursor.Empty();
+        bStarted = false;
+        bHasMore = false;
+        Prefetched.Reset();
+    }
+
+private:
+    struct FPage
+    {
+        TArray<ItemType> Items;
+        bool HasMore{false};
+    };
+
+    enum class ERequest : uint8
+    {
+        None,
+        Page,
+        Tail
+    };
+
+    TStrongObjectPtr<UOpenAIProvider> Provider;
+    FOpenAIAuth Auth;
+    FString ParentId;
+    int32 PageSize;
+
+    FString Cursor;
+    FString NewestId;
+    bool bStarted{false};
+    bool bHasMore{false};
+    ERequest RequestInFlight{ERequest::None};
+
+    TOptional<FPage> Prefetched;
+    FOnPage PendingPage;
+    FOnItems PendingTail;
+    TArray<ItemType> TailItems;
+    FOnError OnError;
+
+    TPaginator(const FOpenAIAuth& InAuth, const FString& InParentId, int32 InPageSize, const TSubclassOf<UOpenAIProvider>& ProviderClass)
+        : Provider(NewObject<UOpenAIProvider>(GetTransientPackage(), ProviderClass ? ProviderClass.Get() : UOpenAIProvider::StaticClass())),
+          Auth(InAuth), ParentId(InParentId), PageSize(FMath::Max(1, InPageSize))
+    {
+    }
+
+    void BindProvider()
+    {
+        FTraits::OnCompleted(Provider.Get()).AddSP(this, &TPaginator::OnPageReceived);
+        Provider->OnRequestError().AddSP(this, &TPaginator::OnRequestError);
+    }
+
+    void RequestPage(const FString& After)
+    {
+        RequestInFlight = ERequest::Page;
+        FTraits::Request(Provider.Get(), ParentId, After, PageSize, Auth);
+    }
+
+    void RequestTailPage(const FString& After)
+    {
+        RequestInFlight = ERequest::Tail;
+        FTraits::Request(Provider.Get(), ParentId, After, PageSize, Auth);
+    }
+
+    void OnPageReceived(const ListResponseType& Response)
+    {
+        const ERequest Request = RequestInFlight;
+        RequestInFlight = ERequest::None;
+
+        if (Request == ERequest::Tail)
+        {
+            OnTailPageReceived(Response);
+            return;
+        }
+
+        bStarted = true;
+        bHasMore = Response.Has_More && !Response.Data.IsEmpty();
+        if (!Response.Data.IsEmpty())
+        {
+            Cursor = FTraits::GetId(Response.Data.Last());
+        }
+
+        Prefetched.Emplace(FPage{Response.Data, bHasMore});
+        if (PendingPage)
+        {
+            const FOnPage OnPage = MoveTemp(PendingPage);
+            PendingPage = nullptr;
+            DeliverPrefetched(OnPage);
+        }
+        else if (PendingTail)
+        {
+            RequestTailPage({});
+        }
+    }
+
+    void DeliverPrefetched(const FOnPage& OnPage)
+    {
+        const FPage Page = MoveTemp(Prefetched.GetValue());
+        Prefetched.Reset();
+
+        // the next page is loaded while the caller processes this one
+        if (bHasMore)
+        {
+            RequestPage(Cursor);
+        }
+        OnPage(Page.Items, Page.HasMore);
+    }
+
+    void OnTailPageReceived(const ListResponseType& Response)
+    {
+        const bool FirstCall = NewestId.IsEmpty();
+        bool ReachedKnownItem{false};
+        for (const ItemType& Item : Response.Data)
+        {
+            if (!FirstCall && FTraits::GetId(Item).Equals(NewestId))
+            {
+                ReachedKnownItem = true;
+                break;
+            }
+            TailItems.Add(Item);
+        }
+
+        if (!FirstCall && !ReachedKnownItem && Response.Has_More && !Response.Data.IsEmpty())
+        {
+            RequestTailPage(FTraits::GetId(Response.Data.Last()));
+            return;
+        }
+
+        if (!TailItems.IsEmpty())
+        {
+            NewestId = FTraits::GetId(TailItems[0]);
+        }
+
+        const FOnItems OnCompleted = MoveTemp(PendingTail);
+        PendingTail = nullptr;
+        const TArray<ItemType> Items = MoveTemp(TailItems);
+        TailItems.Reset();
+        OnCompleted(Items);
+    }
+
+    void FetchAllPages(TSharedRef<TArray<ItemType>> Items, const FOnItems& OnCompleted)
+    {
+        Next(
+            [WeakThis = this->AsWeak(), Items, OnCompleted](const TArray<ItemType>& PageItems, bool HasMorePages)
+            {
+                Items->Append(PageItems);
+                const auto Pinned = WeakThis.Pin();
+                if (!HasMorePages || !Pinned.IsValid())
+                {
+                    OnCompleted(*Items);
+                    return;
+                }
+                Pinned->FetchAllPages(Items, OnCompleted);
+            });
+    }
+
+    void OnRequestError(const FString& URL, const FString& Content)
+    {
+        RequestInFlight = ERequest::None;
+        PendingPage = nullptr;
+        PendingTail = nullptr;
+        TailItems.Reset();
+        if (OnError)
+        {
+            OnError(Content);
+        }
+    }
+};
+
+using FBatchPaginator = TPaginator<FListBatchResponse>;
+using FFilesPaginator = TPaginator<FListFilesResponse>;
+using FFineTuningJobsPaginator = TPaginator<FListFineTuningJobsResponse>;
+using FFineTuningEventsPaginator = TPaginator<FListFineTuningEventsResponse>;
+using FFineTuningCheckpointsPaginator = TPaginator<FListFineTuningCheckpointsResponse>;
+
+}  // namespace OpenAI
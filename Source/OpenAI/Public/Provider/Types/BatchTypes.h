@@ -35,7 +35,7 @@ struct FCreateBatch
 
       Your input file must be formatted as a JSONL file,
       and must be uploaded with the purpose batch.
-      The file can contain up to 50,000 requests, and can be up to 100 MB in size.
+      The file can contain up to 50,000 requests, and can be up to 200 MB in size.
     */
     UPROPERTY(BlueprintReadWrite, Category = "OpenAI | Required")
     FString Input_File_Id{};
@@ -339,5 +339,20 @@ struct FListBatchResponse
     bool Has_More{};
 };
 
-// @todo: https://platform.openai.com/docs/api-reference/batch/request-input
-// @todo: https://platform.openai.com/docs/api-reference/batch/request-output
+USTRUCT(BlueprintType)
+struct FBatchRequestOutputError
+{
+    GENERATED_BODY()
+
+    /**
+      A machine-readable error code.
+    */
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    FString Code;
+
+    /**
+      A human-readable error message.
+    */
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    FString Message;
+};
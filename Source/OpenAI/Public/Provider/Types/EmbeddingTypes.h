@@ -41,9 +41,10 @@ struct FEmbeddings
 
     /**
       The format to return the embeddings in. Can be either float or base64.
+      Base64 vectors are decoded into FEmbeddingsData::Embedding as well, the response body is ~4x smaller.
     */
     UPROPERTY(BlueprintReadWrite, Category = "OpenAI | Optional")
-    FString Encoding_Format{"float"};
+    FString Encoding_Format{"base64"};
 
     /**
       The number of dimensions the resulting output embeddings should have.
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Provider/OpenAIOptional.h"
 #include "FileTypes.generated.h"
 
 ///////////////////////////////////////////////////////
@@ -46,6 +47,63 @@ struct FUploadFile
     FString Purpose;
 };
 
+USTRUCT(BlueprintType)
+struct FListFiles
+{
+    GENERATED_BODY()
+
+    /**
+      Only return files with the given purpose.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI | Optional")
+    FOptionalString Purpose;
+
+    /**
+      A limit on the number of objects to be returned.
+      Limit can range between 1 and 10,000, and the default is 10,000.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI | Optional")
+    FOptionalInt Limit;
+
+    /**
+      Sort order by the created_at timestamp of the objects. asc for ascending order and desc for descending order.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI | Optional")
+    FOptionalString Order;
+
+    /**
+      A cursor for use in pagination. after is an object ID that defines your place in the list.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI | Optional")
+    FOptionalString After;
+
+    FString ToQuery() const
+    {
+        FString Query{"?"};
+        if (Purpose.IsSet)
+        {
+            Query.Append("purpose=").Append(Purpose.Value).Append("&");
+        }
+
+        if (Limit.IsSet)
+        {
+            Query.Append("limit=").Append(FString::FromInt(Limit.Value)).Append("&");
+        }
+
+        if (Order.IsSet)
+        {
+            Query.Append("order=").Append(Order.Value).Append("&");
+        }
+
+        if (After.IsSet)
+        {
+            Query.Append("after=").Append(After.Value).Append("&");
+        }
+
+        return Query.LeftChop(1);
+    }
+};
+
 ///////////////////////////////////////////////////////
 //                 RESPONSE TYPES
 ///////////////////////////////////////////////////////
@@ -124,6 +182,15 @@ struct FListFilesResponse
 
     UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
     TArray<FOpenAIFile> Data;
+
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    FString First_Id;
+
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    FString Last_Id;
+
+    UPROPERTY(BlueprintReadOnly, Category = "OpenAI")
+    bool Has_More{false};
 };
 
 USTRUCT(BlueprintType)
@@ -59,6 +59,63 @@ enum class EMainModelEnum : uint8
     GPT_3_5_Turbo_Instruct
 };
 
+/**
+  What a model supports, entries of the model registry.
+*/
+USTRUCT(BlueprintType)
+struct FModelCapabilities
+{
+    GENERATED_BODY()
+
+    /**
+      Model name, the entry applies to its dated snapshots and fine-tunes too: gpt-4o covers gpt-4o-2024-08-06.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    FString Name;
+
+    /**
+      Tokens of the prompt and the completion together.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    int32 Context_Window{8192};
+
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    int32 Max_Output_Tokens{4096};
+
+    /**
+      tiktoken encoding: cl100k_base or o200k_base.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    FString Tokenizer{"cl100k_base"};
+
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    bool Vision{false};
+
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    bool Tools{true};
+
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    bool Streaming{true};
+
+    /**
+      Accepts the response_format field.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    bool Response_Format{true};
+
+    /**
+      USD per 1M input tokens.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    float Input_Price{0.0f};
+
+    /**
+      USD per 1M output tokens.
+    */
+    UPROPERTY(BlueprintReadWrite, Category = "OpenAI")
+    float Output_Price{0.0f};
+};
+
 ///////////////////////////////////////////////////////
 //                 REQUEST TYPES
 ///////////////////////////////////////////////////////
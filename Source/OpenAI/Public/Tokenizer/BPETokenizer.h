@@ -0,0 +1,111 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tokenizer/TokenCounter.h"
+
+namespace OpenAI
+{
+enum class EBPEEncoding : uint8
+{
+    /**
+      GPT-4, GPT-3.5 and the text-embedding-3 / ada-002 models.
+    */
+    Cl100kBase,
+    /**
+      GPT-4o, GPT-4.1, GPT-5 and the o-series models.
+    */
+    O200kBase
+};
+
+/**
+  Byte pair encoding tokenizer that is compatible with the tiktoken encodings.
+  https://github.com/openai/tiktoken
+
+  Ranks are loaded from the public tiktoken files (a base64 token and its rank per line):
+  https://openaipublic.blob.core.windows.net/encodings/cl100k_base.tiktoken
+  https://openaipublic.blob.core.windows.net/encodings/o200k_base.tiktoken
+  Get() looks for them in Content/OpenAI/Tokenizer, the directory must be staged as non-UFS.
+
+  Text is split into pieces by a hand-written scanner that is equivalent to the regex of the encoding
+  (ASCII is classified by a table, other characters by the platform, so some rare scripts may differ slightly),
+  pieces that are tokens themselves are found with one lookup, others are merged by rank.
+  Special tokens like <|endoftext|> are encoded as ordinary text.
+
+  The tokenizer is immutable after loading and safe to use from any number of threads.
+*/
+class OPENAI_API FBPETokenizer
+{
+public:
+    FBPETokenizer();
+    ~FBPETokenizer();
+
+    FBPETokenizer(const FBPETokenizer&) = delete;
+    FBPETokenizer& operator=(const FBPETokenizer&) = delete;
+
+    bool Load(const FString& FilePath, EBPEEncoding InEncoding);
+    bool IsLoaded() const { return NumTokens > 0; }
+    EBPEEncoding GetEncoding() const { return Encoding; }
+
+    /**
+      Shared tokenizer of the encoding that is loaded on the first call, nullptr if the rank file isn't found.
+    */
+    static const FBPETokenizer* Get(EBPEEncoding Encoding);
+    static FString GetDefaultFilePath(EBPEEncoding Encoding);
+    static EBPEEncoding GetEncodingForModel(const FString& Model);
+
+    /**
+      Counter that uses the shared tokenizer of the encoding and falls back to the estimation if it isn't available.
+      The tokenizer is loaded on the first count, not when the counter is made.
+    */
+    static FTokenCounter MakeTokenCounter(EBPEEncoding Encoding);
+
+    /**
+      Number of tokens without materializing them.
+    */
+    int32 Count(FStringView Text) const;
+    void Encode(FStringView Text, TArray<int32>& OutTokens) const;
+    FString Decode(TArrayView<const int32> InTokens) const;
+
+private:
+    struct FToken
+    {
+        uint32 Offset;
+        uint32 Length;
+    };
+
+    struct FPart
+    {
+        int32 Start;
+        int32 Rank;
+    };
+
+    using FParts = TArray<FPart, TInlineAllocator<64>>;
+
+    EBPEEncoding Encoding{EBPEEncoding::Cl100kBase};
+
+    /**
+      Bytes of all tokens, tokens are indexed by rank.
+    */
+    TArray<uint8> Bytes;
+    TArray<FToken> Tokens;
+    int32 NumTokens{0};
+
+    /**
+      Open-addressing table of the ranks + 1, zero is an empty slot.
+    */
+    TArray<uint32> Slots;
+
+    int32 FindRank(const uint8* Data, int32 Length) const;
+
+    /**
+      Merges the bytes of a piece that isn't a token itself, the parts are the resulting tokens plus the end.
+    */
+    void MergePiece(const uint8* Piece, int32 Length, FParts& Parts) const;
+
+    template <typename OnPieceType>
+    void SplitPieces(const uint8* Text, int32 Length, OnPieceType&& OnPiece) const;
+};
+
+}  // namespace OpenAI
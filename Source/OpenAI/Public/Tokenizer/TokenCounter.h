@@ -0,0 +1,22 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace OpenAI
+{
+/**
+  Returns the number of tokens in the text, must be safe to call from several threads.
+*/
+using FTokenCounter = TFunction<int32(FStringView /* Text */)>;
+
+/**
+  Rough estimation of ~4 characters per token, used when no tokenizer is available.
+*/
+inline int32 EstimateTokens(FStringView Text)
+{
+    return FMath::DivideAndRoundUp(Text.Len(), 4);
+}
+
+}  // namespace OpenAI
@@ -17,6 +17,8 @@ public class OpenAIEditor : ModuleRules
                 "Slate",
                 "SlateCore",
                 "UMG",
+                "AssetRegistry",
+                "HTTP",
                 "OpenAI"
             });
         // clang-format on
@@ -0,0 +1,274 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#include "Commandlets/EmbedTextCommandlet.h"
+#include "Embeddings/EmbeddingCache.h"
+#include "Embeddings/EmbeddingsDriver.h"
+#include "Embeddings/TextChunker.h"
+#include "Embeddings/TextIndex.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Engine/DataTable.h"
+#include "Internationalization/StringTable.h"
+#include "Internationalization/StringTableCore.h"
+#include "HttpModule.h"
+#include "HttpManager.h"
+#include "Containers/Ticker.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Misc/Paths.h"
+#include "Algo/Transform.h"
+#include "Logging/StructuredLog.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEmbedTextCommandlet, All, All);
+
+using namespace OpenAI;
+
+namespace
+{
+using FHashKey = TTuple<uint64, uint64>;
+
+FHashKey MakeHashKey(const FXxHash128& Hash)
+{
+    return FHashKey(Hash.HashLow, Hash.HashHigh);
+}
+
+TArray<FAssetData> FindAssets(const TArray<FName>& Paths, const UClass* Class)
+{
+    FARFilter Filter;
+    Filter.PackagePaths = Paths;
+    Filter.bRecursivePaths = true;
+    Filter.ClassPaths.Add(Class->GetClassPathName());
+    Filter.bRecursiveClasses = true;
+
+    TArray<FAssetData> Assets;
+    FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get().GetAssets(Filter, Assets);
+    return Assets;
+}
+
+void CollectStringTables(const TArray<FName>& Paths, TArray<FTextIndexEntry>& Texts)
+{
+    for (const FAssetData& Asset : FindAssets(Paths, UStringTable::StaticClass()))
+    {
+        const UStringTable* StringTable = Cast<UStringTable>(Asset.GetAsset());
+        if (!StringTable) continue;
+
+        const FString TablePath = Asset.GetObjectPathString();
+        StringTable->GetStringTable()->EnumerateSourceStrings(
+            [&](const FString& Key, const FString& SourceString)
+            {
+                Texts.Add({FString::Printf(TEXT("%s:%s"), *TablePath, *Key), SourceString});
+                return true;
+            });
+    }
+}
+
+void CollectDataTables(const TArray<FName>& Paths, TArray<FTextIndexEntry>& Texts)
+{
+    for (const FAssetData& Asset : FindAssets(Paths, UDataTable::StaticClass()))
+    {
+        const UDataTable* DataTable = Cast<UDataTable>(Asset.GetAsset());
+        if (!DataTable || !DataTable->GetRowStruct()) continue;
+
+        const FString TablePath = Asset.GetObjectPathString();
+        for (const auto& [RowName, RowData] : DataTable->GetRowMap())
+        {
+            for (TFieldIterator<FProperty> It(DataTable->GetRowStruct()); It; ++It)
+            {
+                FString Text;
+                if (const FTextProperty* TextProperty = CastField<FTextProperty>(*It))
+                {
+                    Text = TextProperty->GetPropertyValue_InContainer(RowData).ToString();
+                }
+                else if (const FStrProperty* StrProperty = CastField<FStrProperty>(*It))
+                {
+                    Text = StrProperty->GetPropertyValue_InContainer(RowData);
+                }
+                if (Text.IsEmpty()) continue;
+
+                Texts.Add({FString::Printf(TEXT("%s:%s.%s"), *TablePath, *RowName.ToString(), *It->GetName()), MoveTemp(Text)});
+            }
+        }
+    }
+}
+
+/**
+  Commandlets have no engine loop, HTTP responses and game thread tasks are pumped here.
+*/
+void WaitUntil(const TFunctionRef<bool()>& IsDone)
+{
+    double LastTime = FPlatformTime::Seconds();
+    while (!IsDone())
+    {
+        const double Time = FPlatformTime::Seconds();
+        const float DeltaTime = static_cast<float>(Time - LastTime);
+        LastTime = Time;
+
+        FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+        FTSTicker::GetCoreTicker().Tick(DeltaTime);
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+        FPlatformProcess::Sleep(0.01f);
+    }
+}
+}  // namespace
+
+UEmbedTextCommandlet::UEmbedTextCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 UEmbedTextCommandlet::Main(const FString& Params)
+{
+    FString Output = FPaths::Combine(FPaths::ProjectContentDir(), TEXT("OpenAI"), TEXT("TextIndex"));
+    FString Model = TEXT("text-embedding-3-small");
+    FString PathsParam = TEXT("/Game");
+    FString AuthPath = FPaths::ProjectDir().Append("OpenAIAuth.ini");
+    int32 MaxChunkTokens = 256;
+    int32 Concurrency = 32;
+    FParse::Value(*Params, TEXT("Output="), Output);
+    FParse::Value(*Params, TEXT("Model="), Model);
+    FParse::Value(*Params, TEXT("Paths="), PathsParam);
+    FParse::Value(*Params, TEXT("Auth="), AuthPath);
+    FParse::Value(*Params, TEXT("MaxChunkTokens="), MaxChunkTokens);
+    FParse::Value(*Params, TEXT("Concurrency="), Concurrency);
+
+    TArray<FString> PathStrings;
+    PathsParam.ParseIntoArray(PathStrings, TEXT("+"));
+    TArray<FName> Paths;
+    Algo::Transform(PathStrings, Paths, [](const FString& Path) { return FName(Path); });
+
+    FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get().SearchAllAssets(true);
+
+    TArray<FTextIndexEntry> Texts;
+    CollectStringTables(Paths, Texts);
+    CollectDataTables(Paths, Texts);
+
+    TArray<FTextDocument> Documents;
+    Algo::Transform(Texts, Documents, [](const FTextIndexEntry& Text) { return FTextDocument{Text.Source, Text.Text}; });
+
+    FTextChunkerOptions ChunkerOptions;
+    ChunkerOptions.TargetTokens = MaxChunkTokens;
+    ChunkerOptions.OverlapTokens = MaxChunkTokens / 8;
+    const TArray<FTextChunk> Chunks = FTextChunker(ChunkerOptions).Chunk(Documents);
+
+    TArray<FTextIndexEntry> Entries;
+    Entries.Reserve(Chunks.Num());
+    for (const FTextChunk& Chunk : Chunks)
+    {
+        Entries.Add({Documents[Chunk.Document].Name, FString(FTextChunker::GetText(Documents, Chunk))});
+    }
+    UE_LOGFMT(LogEmbedTextCommandlet, Display, "Collected {0} texts, {1} chunks", Texts.Num(), Entries.Num());
+
+    // identical chunks share one vector
+    TMap<FHashKey, int32> UniqueTexts;
+    TArray<FHashKey> EntryKeys;
+    TArray<FString> Input;
+    for (const FTextIndexEntry& Entry : Entries)
+    {
+        const FHashKey Key = MakeHashKey(FTextIndex::HashText(Entry.Text));
+        EntryKeys.Add(Key);
+        if (!UniqueTexts.Contains(Key))
+        {
+            UniqueTexts.Add(Key, Input.Num());
+            Input.Add(Entry.Text);
+        }
+    }
+
+    // the previous output is the cache, vectors of the unchanged chunks are reused
+    TArray<TArray<float>> Vectors;
+    Vectors.SetNum(Input.Num());
+    {
+        // unmapped before the output is replaced
+        FTextIndex Cache;
+        if (Cache.Load(Output) && Cache.GetModel() == Model)
+        {
+            for (int32 Node = 0; Node < Cache.GetIndex().Num(); ++Node)
+            {
+                const FXxHash128 Hash = Cache.GetHash(static_cast<int32>(Cache.GetIndex().GetId(Node)));
+                const int32* UniqueIndex = UniqueTexts.Find(MakeHashKey(Hash));
+                if (UniqueIndex && Vectors[*UniqueIndex].IsEmpty())
+                {
+                    Cache.GetIndex().CopyVector(Node, Vectors[*UniqueIndex]);
+                }
+            }
+        }
+    }
+
+    FEmbeddings Request;
+    Request.Model = Model;
+    TArray<int32> RequestToUnique;
+    for (int32 UniqueIndex = 0; UniqueIndex < Input.Num(); ++UniqueIndex)
+    {
+        if (!Vectors[UniqueIndex].IsEmpty()) continue;
+        RequestToUnique.Add(UniqueIndex);
+        Request.Input.Add(Input[UniqueIndex]);
+    }
+    UE_LOGFMT(LogEmbedTextCommandlet, Display, "{0} unique chunks, {1} to embed", Input.Num(), Request.Input.Num());
+
+    if (!Request.Input.IsEmpty())
+    {
+        const FOpenAIAuth Auth = UOpenAIFuncLib::LoadAPITokensFromFile(AuthPath);
+        if (Auth.APIKey.IsEmpty())
+        {
+            UE_LOGFMT(LogEmbedTextCommandlet, Error, "API key isn't found: {0}", AuthPath);
+            return 1;
+        }
+
+        TStrongObjectPtr<UEmbeddingsDriver> Driver(NewObject<UEmbeddingsDriver>());
+        FEmbeddingsDriverOptions Options;
+        Options.MaxConcurrentRequests = Concurrency;
+        Driver->SetAuth(Auth);
+        Driver->SetOptions(Options);
+        // vectors of the chunks that were embedded by any previous run, e.g. with another output
+        Driver->SetEmbeddingCache(MakeShared<FEmbeddingCache>());
+
+        bool bDone = false;
+        bool bSucceeded = false;
+        Driver->CreateEmbeddings(Request,
+            [&](const FEmbeddingsResponse& Response, bool Succeeded)
+            {
+                for (const FEmbeddingsData& Data : Response.Data)
+                {
+                    if (!RequestToUnique.IsValidIndex(Data.Index)) continue;
+                    Vectors[RequestToUnique[Data.Index]] = Data.Embedding;
+                }
+                bSucceeded = Succeeded;
+                bDone = true;
+            });
+        WaitUntil([&bDone]() { return bDone; });
+
+        if (!bSucceeded)
+        {
+            UE_LOGFMT(LogEmbedTextCommandlet, Error, "Embeddings request failed");
+            return 1;
+        }
+    }
+
+    const int32 Dimensions = Vectors.IsEmpty() ? 1 : Vectors[0].Num();
+    TArray<int64> Ids;
+    TArray<float> EntryVectors;
+    EntryVectors.Reserve(Entries.Num() * Dimensions);
+    for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); ++EntryIndex)
+    {
+        const TArray<float>& Vector = Vectors[UniqueTexts[EntryKeys[EntryIndex]]];
+        if (Vector.Num() != Dimensions)
+        {
+            UE_LOGFMT(LogEmbedTextCommandlet, Error, "Vector of {0} has {1} dimensions instead of {2}", Entries[EntryIndex].Source,
+                Vector.Num(), Dimensions);
+            return 1;
+        }
+        Ids.Add(EntryIndex);
+        EntryVectors.Append(Vector);
+    }
+
+    FHNSWIndex Index(Dimensions);
+    if (!Index.Build(Ids, EntryVectors) || !FTextIndex::Save(Output, Model, Entries, Index))
+    {
+        UE_LOGFMT(LogEmbedTextCommandlet, Error, "Can't save text index: {0}", Output);
+        return 1;
+    }
+
+    UE_LOGFMT(LogEmbedTextCommandlet, Display, "Saved {0} chunks to {1}", Entries.Num(), Output);
+    return 0;
+}
@@ -240,7 +240,7 @@ void UChatGPTWidget::OnDumpChat()
     const FString FilePath = GenerateFilePath();
     const FString Model = ChatGPT->GetModel();
 
-    if (UFileSystemFuncLib::SaveChatHistoryToFile(ChatGPT->GetHistory(), Model, FilePath))
+    if (UFileSystemFuncLib::SaveChatHistoryToFile(ChatGPT->GetHistory().ToArray(), Model, FilePath))
     {
         auto* SystemChatWidget = CreateWidget<UChatMessageWidget>(GetWorld(), ChatMessageWidgetClass);
         check(SystemChatWidget);
@@ -0,0 +1,28 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "EmbedTextCommandlet.generated.h"
+
+/**
+  Embeds the texts of string tables and data tables into a text index that is searchable at runtime (see OpenAI::FTextIndex).
+
+  UnrealEditor-Cmd.exe Project.uproject -run=EmbedText [-Paths=/Game/Lore+/Game/Dialogue] [-Output=Dir/TextIndex]
+    [-Model=text-embedding-3-small] [-MaxChunkTokens=256] [-Concurrency=32] [-Auth=OpenAIAuth.ini]
+
+  Texts are split into chunks, identical chunks are embedded once and chunks that are already in the previous output
+  reuse its vectors, so only new and changed texts are sent to the API.
+  The output directory must be staged as non-UFS (DirectoriesToAlwaysStageAsNonUFS) to be memory-mapped on the target platform.
+*/
+UCLASS()
+class OPENAIEDITOR_API UEmbedTextCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    UEmbedTextCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,152 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Base64.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Tokenizer/BPETokenizer.h"
+
+DEFINE_SPEC(FBPETokenizerSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+/**
+  Ranks of all bytes followed by the merges, the rank of a merge is 256 + its index.
+*/
+bool SaveRankFile(const FString& FilePath, const TArray<FString>& Merges)
+{
+    TArray<FString> Lines;
+    for (int32 Byte = 0; Byte < 256; ++Byte)
+    {
+        Lines.Add(FString::Printf(TEXT("%s %d"), *FBase64::Encode(TArray<uint8>{static_cast<uint8>(Byte)}), Byte));
+    }
+    for (int32 Index = 0; Index < Merges.Num(); ++Index)
+    {
+        const FTCHARToUTF8 Utf8(*Merges[Index]);
+        const TArray<uint8> Token(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+        Lines.Add(FString::Printf(TEXT("%s %d"), *FBase64::Encode(Token), 256 + Index));
+    }
+    return FFileHelper::SaveStringToFile(FString::Join(Lines, TEXT("\n")), *FilePath);
+}
+
+const TArray<FString> Merges{TEXT("he"), TEXT("ll"), TEXT("hell"), TEXT("hello"), TEXT("dog's"), TEXT("123"), TEXT("45"), TEXT("12345"),
+    TEXT("  ")};
+
+int32 Rank(const FString& Token)
+{
+    return Token.Len() == 1 ? Token[0] : 256 + Merges.IndexOfByKey(Token);
+}
+}  // namespace
+
+void FBPETokenizerSpec::Define()
+{
+    Describe("BPETokenizer",
+        [this]()
+        {
+            const FString TestDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("BPETokenizer"));
+            const FString FilePath = FPaths::Combine(TestDir, TEXT("test.tiktoken"));
+
+            AfterEach([TestDir]() { IFileManager::Get().DeleteDirectory(*TestDir, false, true); });
+
+            It("PiecesShouldBeMergedByRank",
+                [this, FilePath]()
+                {
+                    TestTrueExpr(SaveRankFile(FilePath, Merges));
+                    FBPETokenizer Tokenizer;
+                    TestTrueExpr(Tokenizer.Load(FilePath, EBPEEncoding::Cl100kBase));
+
+                    // " hellos" isn't a token: he, ll, hell, hello are merged and the space and s stay bytes
+                    TArray<int32> Tokens;
+                    Tokenizer.Encode(TEXT("hello hellos"), Tokens);
+                    TestTrueExpr(Tokens == TArray<int32>({Rank("hello"), ' ', Rank("hello"), 's'}));
+                    TestTrueExpr(Tokenizer.Count(TEXT("hello hellos")) == 4);
+                    TestTrueExpr(Tokenizer.Decode(Tokens).Equals(TEXT("hello hellos")));
+                });
+
+            It("TextShouldBeSplitByTheRegexOfTheEncoding",
+                [this, FilePath]()
+                {
+                    TestTrueExpr(SaveRankFile(FilePath, Merges));
+                    FBPETokenizer Cl100k;
+                    FBPETokenizer O200k;
+                    TestTrueExpr(Cl100k.Load(FilePath, EBPEEncoding::Cl100kBase));
+                    TestTrueExpr(O200k.Load(FilePath, EBPEEncoding::O200kBase));
+
+                    // tokens never cross pieces: digits are split by three, the last space of a run starts the next word
+                    TArray<int32> Tokens;
+                    Cl100k.Encode(TEXT("12345"), Tokens);
+                    TestTrueExpr(Tokens == TArray<int32>({Rank("123"), Rank("45")}));
+                    Cl100k.Encode(TEXT("a  b"), Tokens);
+                    TestTrueExpr(Tokens == TArray<int32>({'a', ' ', ' ', 'b'}));
+                    Cl100k.Encode(TEXT("a  \n"), Tokens);
+                    TestTrueExpr(Tokens == TArray<int32>({'a', Rank("  "), '\n'}));
+
+                    // cl100k splits the contraction from the word, o200k keeps it
+                    TestTrueExpr(Cl100k.Count(TEXT("dog's")) == 5);
+                    TestTrueExpr(O200k.Count(TEXT("dog's")) == 1);
+                });
+
+            It("TextShouldRoundTripThroughTokens",
+                [this, FilePath]()
+                {
+                    TestTrueExpr(SaveRankFile(FilePath, Merges));
+                    FBPETokenizer Tokenizer;
+                    TestTrueExpr(Tokenizer.Load(FilePath, EBPEEncoding::O200kBase));
+
+                    const FString Text = TEXT("Привет, мир! 日本語 😀\r\n\tHTTPServer's 3.14159  <|endoftext|>");
+                    TArray<int32> Tokens;
+                    Tokenizer.Encode(Text, Tokens);
+                    TestTrueExpr(Tokens.Num() == Tokenizer.Count(Text));
+                    TestTrueExpr(Tokenizer.Decode(Tokens).Equals(Text));
+                });
+
+            It("InvalidRankFileShouldNotBeLoaded",
+                [this, FilePath]()
+                {
+                    FBPETokenizer Tokenizer;
+                    const FString MissingFilePath = FPaths::Combine(FPaths::GetPath(FilePath), TEXT("missing.tiktoken"));
+                    TestTrueExpr(!Tokenizer.Load(MissingFilePath, EBPEEncoding::Cl100kBase));
+
+                    // byte 0 is missing
+                    TestTrueExpr(FFileHelper::SaveStringToFile(FString::Printf(TEXT("%s 0"), *FBase64::Encode(TEXT("a"))), *FilePath));
+                    TestTrueExpr(!Tokenizer.Load(FilePath, EBPEEncoding::Cl100kBase));
+                    TestTrueExpr(!Tokenizer.IsLoaded());
+                    TestTrueExpr(Tokenizer.Count(TEXT("12345678")) == EstimateTokens(TEXT("12345678")));
+                });
+
+            It("ModelsShouldBeMappedToEncodings",
+                [this]()
+                {
+                    TestTrueExpr(FBPETokenizer::GetEncodingForModel(TEXT("gpt-4o-mini")) == EBPEEncoding::O200kBase);
+                    TestTrueExpr(FBPETokenizer::GetEncodingForModel(TEXT("o3-mini")) == EBPEEncoding::O200kBase);
+                    TestTrueExpr(FBPETokenizer::GetEncodingForModel(TEXT("gpt-4.1")) == EBPEEncoding::O200kBase);
+                    TestTrueExpr(FBPETokenizer::GetEncodingForModel(TEXT("gpt-4")) == EBPEEncoding::Cl100kBase);
+                    TestTrueExpr(FBPETokenizer::GetEncodingForModel(TEXT("text-embedding-3-small")) == EBPEEncoding::Cl100kBase);
+                });
+
+            It("SharedCl100kShouldMatchTiktokenIfAvailable",
+                [this]()
+                {
+                    const FBPETokenizer* Tokenizer = FBPETokenizer::Get(EBPEEncoding::Cl100kBase);
+                    if (!Tokenizer)
+                    {
+                        AddInfo(FString::Printf(TEXT("%s isn't found"), *FBPETokenizer::GetDefaultFilePath(EBPEEncoding::Cl100kBase)));
+                        return;
+                    }
+
+                    TArray<int32> Tokens;
+                    Tokenizer->Encode(TEXT("hello world"), Tokens);
+                    TestTrueExpr(Tokens == TArray<int32>({15339, 1917}));
+                    TestTrueExpr(FBPETokenizer::MakeTokenCounter(EBPEEncoding::Cl100kBase)(TEXT("hello world")) == 2);
+                });
+        });
+}
+
+#endif
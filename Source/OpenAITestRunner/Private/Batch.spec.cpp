@@ -0,0 +1,267 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Batch/BatchResultReader.h"
+#include "Batch/BatchInputBuilder.h"
+#include "Batch/RequestRouter.h"
+#include "Batch/BatchOrchestrator.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "Provider/Types/AllTypesHeader.h"
+#include "TestUtils.h"
+#include "OpenAIProviderFake.h"
+
+DEFINE_SPEC(FBatchApiSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FBatchApiSpec::Define()
+{
+    Describe("BatchInputBuilder",
+        [this]()
+        {
+            It("RequestsShouldBeSplitIntoShardsByLimits",
+                [this]()
+                {
+                    TArray<FEmbeddings> Requests;
+                    TArray<FString> CustomIds;
+                    for (int32 i = 0; i < 5; ++i)
+                    {
+                        FEmbeddings Embeddings;
+                        Embeddings.Input = {FString::Printf(TEXT("text %d"), i)};
+                        Embeddings.Model = "text-embedding-3-small";
+                        Requests.Add(Embeddings);
+                        CustomIds.Add(FString::Printf(TEXT("embedding-%d"), i));
+                    }
+
+                    FBatchInputBuilder Builder(EBatchEndpoint::Embeddings);
+                    Builder.SetLimits(2, FBatchInputBuilder::MaxBytesPerFile);
+                    Builder.Add(Requests, CustomIds);
+                    TestTrueExpr(Builder.Num() == 5);
+
+                    const FString OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("Batch"));
+                    TArray<FBatchInputShard> Shards;
+                    TestTrueExpr(Builder.Build(Shards, "embeddings", OutputDir));
+                    TestTrueExpr(Shards.Num() == 3);
+                    TestTrueExpr(Shards[0].CustomIds.Num() == 2);
+                    TestTrueExpr(Shards[2].CustomIds.Num() == 1);
+                    TestTrueExpr(Shards[2].CustomIds[0].Equals("embedding-4"));
+                    TestTrueExpr(Shards[0].Endpoint.Equals(UOpenAIFuncLib::OpenAIBatchEndpointToString(EBatchEndpoint::Embeddings)));
+
+                    FBatchResultReader Reader;
+                    TestTrueExpr(Reader.Open(Shards[1].FilePath));
+                    TestTrueExpr(Reader.Num() == 2);
+                    TestTrueExpr(Reader.GetCustomId(0).Equals("embedding-2"));
+
+                    TSharedPtr<FJsonObject> Json;
+                    const FUtf8StringView LineView = Reader.GetLine(0);
+                    const FString LineString(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(LineView.GetData()), LineView.Len()));
+                    TestTrueExpr(UJsonFuncLib::StringToJson(LineString, Json));
+                    TestTrueExpr(Json->GetStringField(TEXT("method")).Equals("POST"));
+                    TestTrueExpr(Json->GetObjectField(TEXT("body"))->GetStringField(TEXT("model")).Equals("text-embedding-3-small"));
+                    TestTrueExpr(Json->GetObjectField(TEXT("body"))->GetArrayField(TEXT("input"))[0]->AsString().Equals("text 2"));
+
+                    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+                });
+
+            It("ShardShouldBeClosedWhenByteLimitIsReached",
+                [this]()
+                {
+                    FBatchInputBuilder Builder(EBatchEndpoint::ChatCompletions);
+                    const FString Line = "{\"custom_id\":\"id\",\"method\":\"POST\",\"url\":\"/v1/chat/completions\",\"body\":{}}";
+                    const FTCHARToUTF8 Converter(*Line);
+                    const FUtf8StringView LineView(reinterpret_cast<const UTF8CHAR*>(Converter.Get()), Converter.Length());
+                    for (int32 i = 0; i < 4; ++i)
+                    {
+                        Builder.AddLine(FString::Printf(TEXT("id-%d"), i), LineView);
+                    }
+                    // two lines with line breaks fit into the limit, the third one doesn't
+                    Builder.SetLimits(FBatchInputBuilder::MaxRequestsPerFile, (Converter.Length() + 1) * 2);
+
+                    const FString OutputDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("Batch"));
+                    TArray<FBatchInputShard> Shards;
+                    TestTrueExpr(Builder.Build(Shards, "chat", OutputDir));
+                    TestTrueExpr(Shards.Num() == 2);
+                    TestTrueExpr(Shards[0].NumBytes == (Converter.Length() + 1) * 2);
+
+                    IFileManager::Get().DeleteDirectory(*OutputDir, false, true);
+                });
+        });
+
+    Describe("BatchOrchestrator",
+        [this]()
+        {
+            const auto MakeLine = [](const FString& CustomId, int32 StatusCode, const FString& ErrorCode = {})
+            {
+                if (StatusCode == 0)
+                {
+                    return FString::Printf(
+                        TEXT("{\"id\": \"batch_req\", \"custom_id\": \"%s\", \"response\": null, \"error\": {\"code\": \"%s\"}}"),
+                        *CustomId, *ErrorCode);
+                }
+                return FString::Printf(TEXT("{\"id\": \"batch_req\", \"custom_id\": \"%s\", \"response\": {\"status_code\": %d, ")
+                                           TEXT("\"request_id\": \"req\", \"body\": {}}, \"error\": null}"),
+                    *CustomId, StatusCode);
+            };
+
+            It("OnlyTransientFailuresShouldBeRetryable",
+                [this]()
+                {
+                    FBatchResultHeader Header;
+                    for (const int32 StatusCode : {429, 500, 503})
+                    {
+                        Header.Status_Code = StatusCode;
+                        TestTrueExpr(UBatchOrchestrator::IsRetryable(Header));
+                    }
+                    for (const int32 StatusCode : {0, 400, 401, 404})
+                    {
+                        Header.Status_Code = StatusCode;
+                        TestTrueExpr(!UBatchOrchestrator::IsRetryable(Header));
+                    }
+
+                    Header.Status_Code = 0;
+                    Header.Error.Code = "batch_expired";
+                    TestTrueExpr(UBatchOrchestrator::IsRetryable(Header));
+                    Header.Error.Code = "batch_cancelled";
+                    TestTrueExpr(!UBatchOrchestrator::IsRetryable(Header));
+                });
+
+            It("MissingAndTransientlyFailedRequestsShouldBeRetried",
+                [this, MakeLine]()
+                {
+                    FBatchInputShard Shard;
+                    Shard.CustomIds = {"ok", "rate-limited", "invalid", "expired", "cancelled", "missing"};
+
+                    FBatchResultReader OutputReader;
+                    TestTrueExpr(OutputReader.OpenFromString(MakeLine("ok", 200)));
+
+                    const TArray<FString> ErrorLines{MakeLine("rate-limited", 429), MakeLine("invalid", 400),
+                        MakeLine("expired", 0, "batch_expired"), MakeLine("cancelled", 0, "batch_cancelled")};
+                    FBatchResultReader ErrorReader;
+                    TestTrueExpr(ErrorReader.OpenFromString(FString::Join(ErrorLines, TEXT("\n"))));
+
+                    const TArray<FString> RetryIds = UBatchOrchestrator::FindRetryIds(Shard, OutputReader, ErrorReader);
+                    TestTrueExpr(RetryIds == TArray<FString>({"rate-limited", "expired", "missing"}));
+                });
+
+            It("SucceededResultsShouldReplaceFailedOnes",
+                [this, MakeLine]()
+                {
+                    const auto MakeReader = [](const TArray<FString>& Lines)
+                    {
+                        const auto Reader = MakeShared<FBatchResultReader>();
+                        Reader->OpenFromString(FString::Join(Lines, TEXT("\n")));
+                        return Reader;
+                    };
+
+                    FBatchResults Results;
+                    Results.Add(MakeReader({MakeLine("a", 500), MakeLine("b", 400)}), false);
+                    Results.Add(MakeReader({MakeLine("c", 200)}), true);
+                    TestTrueExpr(Results.Num() == 3);
+                    TestTrueExpr(Results.NumSucceeded() == 1);
+                    TestTrueExpr(!Results.Succeeded("a"));
+
+                    // the retry succeeded for a and failed again for c, which stays succeeded
+                    Results.Add(MakeReader({MakeLine("c", 500)}), false);
+                    Results.Add(MakeReader({MakeLine("a", 200)}), true);
+                    TestTrueExpr(Results.Num() == 3);
+                    TestTrueExpr(Results.NumSucceeded() == 2);
+                    TestTrueExpr(Results.Succeeded("a"));
+                    TestTrueExpr(Results.Succeeded("c"));
+                    TestTrueExpr(!Results.Succeeded("b"));
+
+                    TBatchResult<FChatCompletionResponse> Result;
+                    TestTrueExpr(Results.Find("a", Result));
+                    TestTrueExpr(Result.Status_Code == 200);
+
+                    Results.Reset();
+                    TestTrueExpr(Results.Num() == 0);
+                    TestTrueExpr(Results.NumSucceeded() == 0);
+                });
+        });
+
+    Describe("RequestRouter",
+        [this]()
+        {
+            It("RouteShouldDependOnWorkloadSizeAndLatencyTolerance",
+                [this]()
+                {
+                    auto* Router = NewObject<URequestRouter>();
+                    FRoutingPolicy Policy;
+                    Policy.MinBatchSize = 10;
+                    Policy.BatchLatencyThreshold = FTimespan::FromHours(12.0);
+                    Router->SetPolicy(Policy);
+
+                    TestTrueExpr(Router->ChooseRoute(100, FTimespan::FromHours(24.0)) == ERequestRoute::Batch);
+                    TestTrueExpr(Router->ChooseRoute(10, FTimespan::FromHours(12.0)) == ERequestRoute::Batch);
+                    TestTrueExpr(Router->ChooseRoute(9, FTimespan::FromHours(24.0)) == ERequestRoute::Sync);
+                    TestTrueExpr(Router->ChooseRoute(100, FTimespan::FromMinutes(5.0)) == ERequestRoute::Sync);
+                });
+
+            It("EmptyWorkloadShouldBeCompletedImmediately",
+                [this]()
+                {
+                    auto* Router = NewObject<URequestRouter>();
+                    bool Completed{false};
+                    Router->Submit(TArray<FEmbeddings>{}, {}, FTimespan::FromHours(24.0),
+                        [&Completed](const FEmbeddingsResults& Results) { Completed = Results.IsEmpty(); });
+                    TestTrueExpr(Completed);
+                });
+
+            It("RequestsOfFailedBatchShouldBeSentDirectly",
+                [this]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.Reset();
+                    Server.AddRoute("/files",
+                        "{\"error\":{\"message\":\"Upload failed\",\"type\":\"server_error\",\"code\":\"server_error\"}}");
+                    Server.AddRoute("/embeddings",
+                        "{\"object\":\"list\",\"data\":[{\"object\":\"embedding\",\"index\":0,\"embedding\":[0.5,-1.0]}],"
+                        "\"model\":\"text-embedding-3-small\",\"usage\":{\"prompt_tokens\":1,\"total_tokens\":1}}");
+
+                    auto* Router = NewObject<URequestRouter>();
+                    Router->SetProviderClass(UOpenAIProviderFake::StaticClass());
+                    FRoutingPolicy Policy;
+                    Policy.MinBatchSize = 2;
+                    Router->SetPolicy(Policy);
+
+                    TArray<FEmbeddings> Requests;
+                    Requests.SetNum(2);
+                    for (FEmbeddings& Request : Requests)
+                    {
+                        Request.Input = {"Hello"};
+                        Request.Model = "text-embedding-3-small";
+                    }
+
+                    FEmbeddingsResults Results;
+                    bool Completed{false};
+                    Router->Submit(Requests, {"request-0", "request-1"}, FTimespan::FromHours(24.0),
+                        [&](const FEmbeddingsResults& RoutedResults)
+                        {
+                            Results = RoutedResults;
+                            Completed = true;
+                        });
+
+                    TestTrueExpr(Completed);
+                    TestTrueExpr(Server.NumRequests("/files") == 1);
+                    TestTrueExpr(Server.NumRequests("/batches") == 0);
+                    TestTrueExpr(Server.NumRequests("/embeddings") == 2);
+                    TestTrueExpr(Results.Num() == 2);
+                    for (int32 Index = 0; Index < Results.Num(); ++Index)
+                    {
+                        TestTrueExpr(Results[Index].CustomId.Equals(FString::Printf(TEXT("request-%d"), Index)));
+                        TestTrueExpr(Results[Index].Succeeded);
+                        TestTrueExpr(Results[Index].Response.Data.Num() == 1);
+                    }
+                    Server.Reset();
+                });
+        });
+}
+
+#endif
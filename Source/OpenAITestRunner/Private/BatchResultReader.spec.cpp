@@ -0,0 +1,95 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Batch/BatchResultReader.h"
+#include "Provider/Types/AllTypesHeader.h"
+#include "TestUtils.h"
+
+DEFINE_SPEC(FBatchResultReaderSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FBatchResultReaderSpec::Define()
+{
+    Describe("BatchResultReader",
+        [this]()
+        {
+            It("OutputFileShouldBeIndexedByCustomId",
+                [this]()
+                {
+                    FBatchResultReader Reader;
+                    TestTrueExpr(Reader.Open(OpenAI::Tests::TestUtils::FileFullPath("test_file_batch_output.jsonl")));
+                    TestTrueExpr(Reader.Num() == 3);
+                    TestTrueExpr(Reader.FindLine("request-1") == 0);
+                    TestTrueExpr(Reader.FindLine("request-3") == 2);
+                    TestTrueExpr(Reader.FindLine("request-4") == INDEX_NONE);
+                });
+
+            It("ResultsShouldBeParsedIntoTypedResponses",
+                [this]()
+                {
+                    FBatchResultReader Reader;
+                    TestTrueExpr(Reader.Open(OpenAI::Tests::TestUtils::FileFullPath("test_file_batch_output.jsonl")));
+
+                    TBatchResult<FChatCompletionResponse> Result;
+                    TestTrueExpr(Reader.Find("request-1", Result));
+                    TestTrueExpr(Result.Succeeded());
+                    TestTrueExpr(Result.Id.Equals("batch_req_1"));
+                    TestTrueExpr(Result.Request_Id.Equals("req_1"));
+                    TestTrueExpr(Result.Body.Choices.Num() == 1);
+                    TestTrueExpr(Result.Body.Choices[0].Message.Content.Equals("2 + 2 equals 4."));
+                    TestTrueExpr(Result.Body.Usage.Total_Tokens == 30);
+                });
+
+            It("FailedRequestsShouldContainError",
+                [this]()
+                {
+                    FBatchResultReader Reader;
+                    TestTrueExpr(Reader.Open(OpenAI::Tests::TestUtils::FileFullPath("test_file_batch_output.jsonl")));
+
+                    TArray<TBatchResult<FChatCompletionResponse>> Results;
+                    TestTrueExpr(Reader.ParseAll(Results));
+                    TestTrueExpr(Results.Num() == 3);
+
+                    TestTrueExpr(!Results[1].Succeeded());
+                    TestTrueExpr(Results[1].Status_Code == 400);
+                    TestTrueExpr(Results[1].Error.Code.Equals("model_not_found"));
+
+                    TestTrueExpr(!Results[2].Succeeded());
+                    TestTrueExpr(Results[2].Error.Code.Equals("batch_expired"));
+                });
+
+            It("LazyIteratorShouldVisitLinesInFileOrder",
+                [this]()
+                {
+                    FString Content;
+                    FFileHelper::LoadFileToString(Content, *OpenAI::Tests::TestUtils::FileFullPath("test_file_batch_output.jsonl"));
+
+                    FBatchResultReader Reader;
+                    TestTrueExpr(Reader.OpenFromString(Content));
+
+                    TArray<FString> CustomIds;
+                    for (const auto& Result : Reader.Iterate<FChatCompletionResponse>())
+                    {
+                        CustomIds.Add(Result.Custom_Id);
+                    }
+                    TestTrueExpr(CustomIds == TArray<FString>({"request-1", "request-2", "request-3"}));
+                });
+
+            It("InputFileShouldBeIndexedToo",
+                [this]()
+                {
+                    FBatchResultReader Reader;
+                    TestTrueExpr(Reader.Open(OpenAI::Tests::TestUtils::FileFullPath("test_file_batch.jsonl")));
+                    TestTrueExpr(Reader.Num() > 0);
+                    TestTrueExpr(Reader.Contains("request-1"));
+                });
+        });
+}
+
+#endif
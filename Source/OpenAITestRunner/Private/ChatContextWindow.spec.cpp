@@ -0,0 +1,151 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "ChatGPT/ChatContextWindow.h"
+
+DEFINE_SPEC(FChatContextWindowSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+FMessage MakeMessage(const FString& Role, const FString& Content)
+{
+    FMessage Message;
+    Message.Role = Role;
+    Message.Content = Content;
+    return Message;
+}
+
+/**
+  Every message costs 10 tokens.
+*/
+TArray<int32> MakeTokens(const FChatHistory& History)
+{
+    TArray<int32> Tokens;
+    Tokens.Init(10, History.Num());
+    return Tokens;
+}
+
+FChatHistory MakeConversation(int32 NumTurns)
+{
+    FChatHistory History;
+    History.Add(MakeMessage(TEXT("system"), TEXT("You are a blacksmith.")));
+    for (int32 Turn = 0; Turn < NumTurns; ++Turn)
+    {
+        History.Add(MakeMessage(TEXT("user"), FString::Printf(TEXT("Question %d"), Turn)));
+        History.Add(MakeMessage(TEXT("assistant"), FString::Printf(TEXT("Answer %d"), Turn)));
+    }
+    return History;
+}
+}  // namespace
+
+void FChatContextWindowSpec::Define()
+{
+    Describe("ChatContextWindow",
+        [this]()
+        {
+            It("RecentMessagesShouldFitTheBudgetWithPinnedSystemMessage",
+                [this]()
+                {
+                    const FChatHistory History = MakeConversation(10);
+                    // the system message and four more messages
+                    const int32 FirstKept = FChatContextWindow::FindFirstKept(History, MakeTokens(History), 55);
+                    TestTrueExpr(FirstKept == History.Num() - 4);
+
+                    const TArray<FMessage> Messages = FChatContextWindow::MakeMessages(History, FirstKept, {});
+                    TestTrueExpr(Messages.Num() == 5);
+                    TestTrueExpr(Messages[0].Role.Equals(TEXT("system")));
+                    TestTrueExpr(Messages[1].Content.Equals(TEXT("Question 8")));
+                    TestTrueExpr(Messages.Last().Content.Equals(TEXT("Answer 9")));
+                });
+
+            It("RequestSizeShouldStayFlatAsTheSessionGrows",
+                [this]()
+                {
+                    for (const int32 NumTurns : {5, 50, 500})
+                    {
+                        const FChatHistory History = MakeConversation(NumTurns);
+                        const int32 FirstKept = FChatContextWindow::FindFirstKept(History, MakeTokens(History), 100);
+                        TestTrueExpr(FChatContextWindow::MakeMessages(History, FirstKept, {}).Num() == 10);
+                    }
+                });
+
+            It("SummaryShouldFollowThePinnedMessages",
+                [this]()
+                {
+                    const FChatHistory History = MakeConversation(10);
+                    const int32 FirstKept = FChatContextWindow::FindFirstKept(History, MakeTokens(History), 30);
+
+                    const FString Summary = TEXT("The player ordered a sword.");
+                    const TArray<FMessage> Messages = FChatContextWindow::MakeMessages(History, FirstKept, Summary);
+                    TestTrueExpr(Messages.Num() == 4);
+                    TestTrueExpr(Messages[0].Content.Equals(TEXT("You are a blacksmith.")));
+                    TestTrueExpr(Messages[1].Role.Equals(TEXT("system")));
+                    TestTrueExpr(Messages[1].Content.Contains(Summary));
+                });
+
+            It("WindowShouldNotStartWithToolResults",
+                [this]()
+                {
+                    FChatHistory History = MakeConversation(1);
+                    FMessage Call = MakeMessage(TEXT("assistant"), {});
+                    Call.Tool_Calls.AddDefaulted_GetRef().Function.Name = TEXT("get_weather");
+                    History.Add(Call);
+                    History.Add(MakeMessage(TEXT("tool"), TEXT("Rain")));
+                    History.Add(MakeMessage(TEXT("assistant"), TEXT("It rains.")));
+
+                    // the budget fits the tool result but not the call
+                    const int32 FirstKept = FChatContextWindow::FindFirstKept(History, MakeTokens(History), 30);
+                    TestTrueExpr(FirstKept == History.Num() - 1);
+                });
+
+            It("LastMessageShouldBeKeptOverTheBudget",
+                [this]()
+                {
+                    const FChatHistory History = MakeConversation(3);
+                    TestTrueExpr(FChatContextWindow::FindFirstKept(History, MakeTokens(History), 5) == History.Num() - 1);
+                });
+
+            It("EvictedMessagesShouldBeInTheSummaryRequest",
+                [this]()
+                {
+                    const TArray<FMessage> History = MakeConversation(2).ToArray();
+                    const TArray<FMessage> Messages =
+                        FChatContextWindow::MakeSummaryMessages(MakeArrayView(History).Slice(1, 2), TEXT("Old summary."));
+                    TestTrueExpr(Messages.Num() == 2);
+                    TestTrueExpr(Messages[1].Content.Contains(TEXT("Old summary.")));
+                    TestTrueExpr(Messages[1].Content.Contains(TEXT("user: Question 0")));
+                    TestTrueExpr(Messages[1].Content.Contains(TEXT("assistant: Answer 0")));
+                    TestTrueExpr(!Messages[1].Content.Contains(TEXT("Question 1")));
+                });
+
+            It("TokensShouldIncludeTheMessageOverhead",
+                [this]()
+                {
+                    const FTokenCounter TokenCounter = [](FStringView Text) { return Text.Len(); };
+                    FMessage Message = MakeMessage(TEXT("user"), TEXT("Hello"));
+                    const int32 Tokens = FChatContextWindow::CountMessageTokens(Message, TokenCounter);
+                    TestTrueExpr(Tokens > 4 + 5);
+
+                    Message.Name.Set(TEXT("Bob"));
+                    TestTrueExpr(FChatContextWindow::CountMessageTokens(Message, TokenCounter) == Tokens + 4);
+                });
+
+            It("ContextWindowShouldBeTakenFromTheModelName",
+                [this]()
+                {
+                    TestTrueExpr(FChatContextWindow::GetModelContextWindow(TEXT("gpt-4o-mini")) == 128000);
+                    TestTrueExpr(FChatContextWindow::GetModelContextWindow(TEXT("gpt-4-32k-0613")) == 32768);
+                    TestTrueExpr(FChatContextWindow::GetModelContextWindow(TEXT("gpt-4")) == 8192);
+                    TestTrueExpr(FChatContextWindow::GetModelContextWindow(TEXT("o1-mini")) == 128000);
+                    TestTrueExpr(FChatContextWindow::GetModelContextWindow(TEXT("o1")) == 200000);
+                });
+        });
+}
+
+#endif
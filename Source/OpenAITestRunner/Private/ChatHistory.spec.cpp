@@ -0,0 +1,136 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "ChatGPT/ChatHistory.h"
+
+DEFINE_SPEC(FChatHistorySpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+FMessage MakeMessage(int32 Index)
+{
+    FMessage Message;
+    Message.Role = Index % 2 == 0 ? TEXT("user") : TEXT("assistant");
+    Message.Content = FString::FromInt(Index);
+    return Message;
+}
+
+FChatHistory MakeHistory(int32 NumMessages)
+{
+    FChatHistory History;
+    for (int32 Index = 0; Index < NumMessages; ++Index)
+    {
+        History.Add(MakeMessage(Index));
+    }
+    return History;
+}
+
+bool HasMessages(const FChatHistory& History, int32 First, int32 NumMessages)
+{
+    if (History.Num() != NumMessages) return false;
+
+    int32 Index = 0;
+    bool Equal = true;
+    History.ForEach([&](const FMessage& Message) { Equal &= Message.Content.Equals(FString::FromInt(First + Index++)); });
+    return Equal && Index == NumMessages;
+}
+}  // namespace
+
+void FChatHistorySpec::Define()
+{
+    Describe("ChatHistory",
+        [this]()
+        {
+            It("MessagesShouldBeFoundByIndexAcrossTrieLevels",
+                [this]()
+                {
+                    // the root splits at 32 + 1024 messages
+                    for (const int32 NumMessages : {0, 1, 31, 32, 33, 1056, 1057, 40000})
+                    {
+                        const FChatHistory History = MakeHistory(NumMessages);
+                        TestTrueExpr(HasMessages(History, 0, NumMessages));
+
+                        bool Equal = true;
+                        for (int32 Index = 0; Index < NumMessages; ++Index)
+                        {
+                            Equal &= History[Index].Content.Equals(FString::FromInt(Index));
+                        }
+                        TestTrueExpr(Equal);
+                    }
+                });
+
+            It("SnapshotShouldNotSeeNewMessages",
+                [this]()
+                {
+                    for (const int32 NumMessages : {5, 32, 100, 1056})
+                    {
+                        FChatHistory History = MakeHistory(NumMessages);
+                        const FChatHistory Snapshot = History;
+                        for (int32 Index = NumMessages; Index < NumMessages + 100; ++Index)
+                        {
+                            History.Add(MakeMessage(Index));
+                        }
+                        TestTrueExpr(HasMessages(Snapshot, 0, NumMessages));
+                        TestTrueExpr(HasMessages(History, 0, NumMessages + 100));
+                    }
+                });
+
+            It("ForksShouldShareThePrefix",
+                [this]()
+                {
+                    const FChatHistory Lore = MakeHistory(70);
+                    FChatHistory Blacksmith = Lore;
+                    FChatHistory Guard = Lore;
+
+                    FMessage Question;
+                    Question.Role = TEXT("user");
+                    Question.Content = TEXT("Sword?");
+                    Blacksmith.Add(Question);
+                    Question.Content = TEXT("Gate?");
+                    Guard.Add(Question);
+
+                    TestTrueExpr(Blacksmith.Last().Content.Equals(TEXT("Sword?")));
+                    TestTrueExpr(Guard.Last().Content.Equals(TEXT("Gate?")));
+                    TestTrueExpr(Lore.Num() == 70);
+                    for (const int32 Index : {0, 31, 64, 69})
+                    {
+                        TestTrueExpr(&Blacksmith[Index] == &Guard[Index]);
+                        TestTrueExpr(&Blacksmith[Index] == &Lore[Index]);
+                    }
+                });
+
+            It("BranchShouldStartFromAnEarlierMessage",
+                [this]()
+                {
+                    const FChatHistory History = MakeHistory(100);
+                    FChatHistory Branch = History.Left(40);
+                    TestTrueExpr(HasMessages(Branch, 0, 40));
+                    TestTrueExpr(&Branch[39] == &History[39]);
+
+                    Branch.Add(MakeMessage(1000));
+                    TestTrueExpr(Branch.Last().Content.Equals(TEXT("1000")));
+                    TestTrueExpr(History[40].Content.Equals(TEXT("40")));
+                    TestTrueExpr(History.Left(500).Num() == 100);
+                });
+
+            It("ArrayShouldBeConvertedBothWays",
+                [this]()
+                {
+                    const TArray<FMessage> Messages = MakeHistory(50).ToArray();
+                    TestTrueExpr(Messages.Num() == 50);
+                    TestTrueExpr(HasMessages(FChatHistory(Messages), 0, 50));
+
+                    FChatHistory History(Messages);
+                    History.Reset();
+                    TestTrueExpr(History.IsEmpty());
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,165 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Provider/JsonParsers/ChatParser.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "Serialization/JsonSerializer.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+DEFINE_SPEC(FChatParserSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+FChatCompletion MakeCompletion(int32 NumTurns)
+{
+    FChatCompletion ChatCompletion;
+    ChatCompletion.Model = TEXT("gpt-4o");
+    ChatCompletion.Stream = true;
+    ChatCompletion.Max_Completion_Tokens.Set(100);
+
+    FMessage& System = ChatCompletion.Messages.AddDefaulted_GetRef();
+    System.Role = TEXT("system");
+    System.Content = TEXT("You are a blacksmith.");
+
+    for (int32 Turn = 0; Turn < NumTurns; ++Turn)
+    {
+        FMessage& User = ChatCompletion.Messages.AddDefaulted_GetRef();
+        User.Role = TEXT("user");
+        User.Name.Set(TEXT("Player"));
+        User.Content = FString::Printf(TEXT("Question %d with \"quotes\""), Turn);
+
+        FMessage& Assistant = ChatCompletion.Messages.AddDefaulted_GetRef();
+        Assistant.Role = TEXT("assistant");
+        if (Turn % 3 == 1)
+        {
+            FToolCalls& ToolCall = Assistant.Tool_Calls.AddDefaulted_GetRef();
+            ToolCall.ID = FString::Printf(TEXT("call_%d"), Turn);
+            ToolCall.Function.Name = TEXT("get_price");
+
+            FMessage& Tool = ChatCompletion.Messages.AddDefaulted_GetRef();
+            Tool.Role = TEXT("tool");
+            Tool.Tool_Call_ID.Set(ToolCall.ID);
+            Tool.Content = TEXT("10 gold");
+        }
+        else
+        {
+            Assistant.Content = FString::Printf(TEXT("Answer %d"), Turn);
+        }
+    }
+
+    FMessage& Image = ChatCompletion.Messages.AddDefaulted_GetRef();
+    Image.Role = TEXT("user");
+    Image.ContentArray.AddDefaulted_GetRef().Text = TEXT("What is it?");
+    FMessageContent& ImageContent = Image.ContentArray.AddDefaulted_GetRef();
+    ImageContent.Type = TEXT("image_url");
+    ImageContent.Image_URL.URL = TEXT("https://example.com/sword.png");
+    return ChatCompletion;
+}
+
+FString ToCondensedString(const TArray<TSharedPtr<FJsonValue>>& Array)
+{
+    FString Output;
+    const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Output);
+    FJsonSerializer::Serialize(Array, Writer);
+    return Output;
+}
+
+FString ToCondensedString(const TSharedPtr<FJsonObject>& Object)
+{
+    FString Output;
+    const auto Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Output);
+    FJsonSerializer::Serialize(Object.ToSharedRef(), Writer);
+    return Output;
+}
+}  // namespace
+
+void FChatParserSpec::Define()
+{
+    Describe("ChatParser",
+        [this]()
+        {
+            It("CachedMessagesShouldGiveTheSameJson",
+                [this]()
+                {
+                    const FChatCompletion ChatCompletion = MakeCompletion(5);
+                    FChatMessageJsonCache Cache;
+
+                    TSharedPtr<FJsonObject> Expected;
+                    TSharedPtr<FJsonObject> Actual;
+                    TestTrueExpr(UJsonFuncLib::StringToJson(ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion), Expected));
+                    TestTrueExpr(
+                        UJsonFuncLib::StringToJson(ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion, Cache), Actual));
+
+                    const FString ExpectedMessages = ToCondensedString(Expected->GetArrayField(TEXT("messages")));
+                    TestTrueExpr(ExpectedMessages.Equals(ToCondensedString(Actual->GetArrayField(TEXT("messages")))));
+                    TestTrueExpr(ExpectedMessages.Contains(TEXT("\"tool_call_id\":\"call_1\"")));
+                    TestTrueExpr(!ExpectedMessages.Contains(TEXT("isset")));
+
+                    Expected->RemoveField(TEXT("messages"));
+                    Actual->RemoveField(TEXT("messages"));
+                    TestTrueExpr(ToCondensedString(Expected).Equals(ToCondensedString(Actual)));
+                });
+
+            It("OnlyNewMessagesShouldBeSerialized",
+                [this]()
+                {
+                    FChatMessageJsonCache Cache;
+                    FChatCompletion ChatCompletion = MakeCompletion(10);
+                    ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion, Cache);
+                    const int32 NumCached = Cache.Num();
+
+                    FMessage& Message = ChatCompletion.Messages.AddDefaulted_GetRef();
+                    Message.Role = TEXT("user");
+                    Message.Content = TEXT("One more question");
+                    ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion, Cache);
+                    TestTrueExpr(Cache.Num() == NumCached + 1);
+
+                    // an edited message is serialized again
+                    Message.Content = TEXT("Edited question");
+                    TestTrueExpr(ChatParser::ChatCompletionToJsonRepresentation(ChatCompletion, Cache).Contains(TEXT("Edited question")));
+                });
+
+            It("MessagesThatLeftTheWindowShouldBeTrimmed",
+                [this]()
+                {
+                    FChatMessageJsonCache Cache(4);
+                    const FChatCompletion ChatCompletion = MakeCompletion(10);
+                    for (int32 First = 0; First + 3 <= ChatCompletion.Messages.Num(); ++First)
+                    {
+                        FChatCompletion Window = ChatCompletion;
+                        Window.Messages = TArray<FMessage>(ChatCompletion.Messages.GetData() + First, 3);
+                        ChatParser::ChatCompletionToJsonRepresentation(Window, Cache);
+                        TestTrueExpr(Cache.Num() <= 4);
+                    }
+                });
+
+            It("HashShouldDependOnAllFields",
+                [this]()
+                {
+                    FMessage Message;
+                    Message.Role = TEXT("user");
+                    Message.Content = TEXT("Hi");
+                    const auto Hash = FChatMessageJsonCache::HashMessage(Message);
+
+                    FMessage Named = Message;
+                    Named.Name.Set(TEXT("Bob"));
+                    FMessage Tool = Message;
+                    Tool.Tool_Call_ID.Set(TEXT(""));
+                    FMessage Moved = Message;
+                    Moved.Role = TEXT("userH");
+                    Moved.Content = TEXT("i");
+                    TestTrueExpr(Hash != FChatMessageJsonCache::HashMessage(Named));
+                    TestTrueExpr(Hash != FChatMessageJsonCache::HashMessage(Tool));
+                    TestTrueExpr(Hash != FChatMessageJsonCache::HashMessage(Moved));
+                    TestTrueExpr(Hash == FChatMessageJsonCache::HashMessage(FMessage(Message)));
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,121 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "ChatGPT/ChatSessionScheduler.h"
+
+DEFINE_SPEC(FChatSessionSchedulerSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FChatSessionSchedulerSpec::Define()
+{
+    Describe("ChatSessionScheduler",
+        [this]()
+        {
+            const FName A = TEXT("A");
+            const FName B = TEXT("B");
+            const FName C = TEXT("C");
+            const FName D = TEXT("D");
+
+            It("RequestsShouldBeSentInTurn",
+                [this, A, B, C, D]()
+                {
+                    FChatSessionScheduler Scheduler;
+                    Scheduler.SetMaxConcurrentRequests(2);
+                    for (const FName Session : {A, B, C, D})
+                    {
+                        Scheduler.Add(Session);
+                        TestTrueExpr(Scheduler.Enqueue(Session));
+                    }
+
+                    TestTrueExpr(Scheduler.StartNext() == A);
+                    TestTrueExpr(Scheduler.StartNext() == B);
+                    TestTrueExpr(Scheduler.StartNext().IsNone());
+                    TestTrueExpr(Scheduler.NumRunning() == 2);
+
+                    // the follow-up of A waits behind the sessions that asked before
+                    Scheduler.Complete(A);
+                    TestTrueExpr(Scheduler.Enqueue(A));
+                    TestTrueExpr(Scheduler.StartNext() == C);
+                    Scheduler.Complete(B);
+                    TestTrueExpr(Scheduler.StartNext() == D);
+                    Scheduler.Complete(C);
+                    TestTrueExpr(Scheduler.StartNext() == A);
+                    TestTrueExpr(Scheduler.NumQueued() == 0);
+                });
+
+            It("SessionShouldHaveOneRequestAtATime",
+                [this, A, B]()
+                {
+                    FChatSessionScheduler Scheduler;
+                    Scheduler.Add(A);
+                    TestTrueExpr(!Scheduler.Enqueue(B));
+                    TestTrueExpr(Scheduler.Enqueue(A));
+                    TestTrueExpr(!Scheduler.Enqueue(A));
+                    TestTrueExpr(Scheduler.StartNext() == A);
+                    TestTrueExpr(Scheduler.IsBusy(A));
+                    TestTrueExpr(!Scheduler.Enqueue(A));
+                    Scheduler.Complete(A);
+                    TestTrueExpr(!Scheduler.IsBusy(A));
+                });
+
+            It("LeastRecentlyUsedIdleSessionsShouldBeHibernated",
+                [this, A, B, C]()
+                {
+                    FChatSessionScheduler Scheduler;
+                    Scheduler.SetHistoryMemoryBudget(100);
+                    for (const FName Session : {A, B, C})
+                    {
+                        Scheduler.Add(Session);
+                        Scheduler.Touch(Session, 40);
+                    }
+                    TestTrueExpr(Scheduler.GetAwakeHistoryBytes() == 120);
+                    TestTrueExpr(Scheduler.FindSessionsToHibernate() == TArray<FName>{A});
+
+                    Scheduler.Touch(A, 40);
+                    TestTrueExpr(Scheduler.FindSessionsToHibernate() == TArray<FName>{B});
+
+                    // busy sessions stay in memory
+                    Scheduler.Enqueue(B);
+                    TestTrueExpr(Scheduler.FindSessionsToHibernate() == TArray<FName>{C});
+
+                    Scheduler.SetHibernated(C, true);
+                    TestTrueExpr(Scheduler.IsHibernated(C));
+                    TestTrueExpr(Scheduler.GetAwakeHistoryBytes() == 80);
+                    TestTrueExpr(Scheduler.FindSessionsToHibernate().IsEmpty());
+
+                    Scheduler.SetHibernated(C, false);
+                    Scheduler.SetHistoryMemoryBudget(0);
+                    TestTrueExpr(Scheduler.FindSessionsToHibernate().IsEmpty());
+                });
+
+            It("RemovedSessionShouldFreeItsTurnAndMemory",
+                [this, A, B]()
+                {
+                    FChatSessionScheduler Scheduler;
+                    Scheduler.SetMaxConcurrentRequests(1);
+                    Scheduler.Add(A);
+                    Scheduler.Add(B);
+                    Scheduler.Touch(A, 50);
+                    Scheduler.Enqueue(A);
+                    Scheduler.Enqueue(B);
+                    TestTrueExpr(Scheduler.StartNext() == A);
+
+                    Scheduler.Remove(A);
+                    TestTrueExpr(!Scheduler.Contains(A));
+                    TestTrueExpr(Scheduler.NumRunning() == 0);
+                    TestTrueExpr(Scheduler.GetAwakeHistoryBytes() == 0);
+                    TestTrueExpr(Scheduler.StartNext() == B);
+
+                    Scheduler.Remove(B);
+                    TestTrueExpr(Scheduler.Num() == 0);
+                    TestTrueExpr(Scheduler.StartNext().IsNone());
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,331 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/World.h"
+#include "UObject/UObjectHash.h"
+#include "ChatGPT/ChatSessionSubsystem.h"
+#include "Provider/ModelRegistry.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "OpenAIProviderFake.h"
+#include "OpenAIServiceFake.h"
+
+BEGIN_DEFINE_SPEC(FChatSessionSubsystemSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority)
+TObjectPtr<UWorld> World;
+TObjectPtr<UChatSessionSubsystem> Subsystem;
+TSharedPtr<const OpenAI::FModelRegistry> BuiltInRegistry;
+END_DEFINE_SPEC(FChatSessionSubsystemSpec)
+
+using namespace OpenAI;
+
+namespace
+{
+// the responses aren't streamed, so every response completes its request at once
+const FString Model = "session-test-model";
+
+FString MakeChatResponse(const FString& Content)
+{
+    return FString::Printf(TEXT("{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion\",\"created\":1686587980,\"model\":\"%s\","
+                                "\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"%s\"},"
+                                "\"finish_reason\":\"stop\"}]}"),
+        *Model, *Content);
+}
+
+FString MakeToolCallResponse(const FString& ToolID)
+{
+    return FString::Printf(TEXT("{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion\",\"created\":1686587980,\"model\":\"%s\","
+                                "\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"\",\"tool_calls\":"
+                                "[{\"id\":\"%s\",\"type\":\"function\",\"function\":{\"name\":\"fake_function\",\"arguments\":\"{}\"}}]},"
+                                "\"finish_reason\":\"tool_calls\"}]}"),
+        *Model, *ToolID);
+}
+
+const FString ErrorResponse = "{\"error\":{\"message\":\"Rate limit reached\",\"type\":\"requests\",\"code\":\"rate_limit_exceeded\"}}";
+
+FMessage MakeUserMessage(const FString& Content)
+{
+    FMessage Message;
+    Message.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::User);
+    Message.Content = Content;
+    return Message;
+}
+
+UOpenAIServiceFake* FindService(UChatSessionSubsystem* Subsystem)
+{
+    TArray<UObject*> Objects;
+    GetObjectsWithOuter(Subsystem, Objects, false);
+    for (UObject* Object : Objects)
+    {
+        if (auto* Service = Cast<UOpenAIServiceFake>(Object)) return Service;
+    }
+    return nullptr;
+}
+}  // namespace
+
+void FChatSessionSubsystemSpec::Define()
+{
+    Describe("ChatSessionSubsystem",
+        [this]()
+        {
+            const FName A = TEXT("A");
+            const FName B = TEXT("B");
+
+            BeforeEach(
+                [this]()
+                {
+                    FFakeHttpServer::Get().Reset();
+
+                    BuiltInRegistry = FModelRegistry::Get();
+                    const TSharedRef<FModelRegistry> Registry = MakeShared<FModelRegistry>();
+                    FModelCapabilities Capabilities;
+                    Capabilities.Name = Model;
+                    Capabilities.Streaming = false;
+                    Registry->Add(Capabilities);
+                    FModelRegistry::Set(Registry);
+
+                    World = UWorld::CreateWorld(EWorldType::Game, false);
+                    Subsystem = World->GetSubsystem<UChatSessionSubsystem>();
+                    Subsystem->SetProviderClass(UOpenAIProviderFake::StaticClass());
+                    Subsystem->SetLogEnabled(false);
+                });
+
+            AfterEach(
+                [this]()
+                {
+                    World->DestroyWorld(false);
+                    World = nullptr;
+                    Subsystem = nullptr;
+                    FModelRegistry::Set(BuiltInRegistry.ToSharedRef());
+                    FFakeHttpServer::Get().Reset();
+                });
+
+            It("HibernatedHistoryShouldBeLoadedBackWhenSessionIsUsed",
+                [this, A]()
+                {
+                    FFakeHttpServer::Get().AddRoute("/chat/completions", MakeChatResponse("swordfish"));
+                    Subsystem->SetHistoryMemoryBudget(1);
+                    TestTrueExpr(Subsystem->CreateSession(A, Model));
+
+                    TestTrueExpr(Subsystem->AddMessage(A, MakeUserMessage("The password is swordfish")));
+                    TestTrueExpr(Subsystem->IsHibernated(A));
+                    TestTrueExpr(Subsystem->GetScheduler().GetAwakeHistoryBytes() == 0);
+
+                    const FChatHistory History = Subsystem->GetHistory(A);
+                    TestTrueExpr(!Subsystem->IsHibernated(A));
+                    TestTrueExpr(History.Num() == 1);
+                    TestTrueExpr(History[0].Content.Equals("The password is swordfish"));
+
+                    // the request is sent with the woken history, the session goes back to disk when it's idle
+                    TestTrueExpr(Subsystem->MakeRequest(A, MakeUserMessage("What is the password?")));
+                    const TArray<TPair<FString, FString>>& Requests = FFakeHttpServer::Get().GetRequests();
+                    TestTrueExpr(Requests.Num() == 1);
+                    TestTrueExpr(Requests[0].Value.Contains("The password is swordfish"));
+                    TestTrueExpr(Subsystem->IsHibernated(A));
+                    TestTrueExpr(Subsystem->GetHistory(A).Num() == 3);
+                    TestTrueExpr(Subsystem->GetHistory(A).Last().Content.Equals("swordfish"));
+                });
+
+            It("SessionsWithSimilarNamesShouldHibernateToTheirOwnFiles",
+                [this]()
+                {
+                    // the names are the same after the invalid characters of a file name are dropped
+                    const FName Npc = TEXT("NPC1");
+                    const FName NpcWithColon = TEXT("NPC:1");
+                    Subsystem->SetHistoryMemoryBudget(1);
+                    TestTrueExpr(Subsystem->CreateSession(Npc, Model));
+                    TestTrueExpr(Subsystem->CreateSession(NpcWithColon, Model));
+
+                    TestTrueExpr(Subsystem->AddMessage(Npc, MakeUserMessage("Guard")));
+                    TestTrueExpr(Subsystem->AddMessage(NpcWithColon, MakeUserMessage("Smith")));
+                    TestTrueExpr(Subsystem->IsHibernated(Npc) && Subsystem->IsHibernated(NpcWithColon));
+
+                    const FChatHistory History = Subsystem->GetHistory(Npc);
+                    TestTrueExpr(History.Num() == 1 && History[0].Content.Equals("Guard"));
+                    const FChatHistory HistoryWithColon = Subsystem->GetHistory(NpcWithColon);
+                    TestTrueExpr(HistoryWithColon.Num() == 1 && HistoryWithColon[0].Content.Equals("Smith"));
+                });
+
+            It("SessionEventsShouldGoToTheirSessionOnly",
+                [this, A, B]()
+                {
+                    FFakeHttpServer::Get().AddRoute("/chat/completions", MakeChatResponse("Hello"));
+                    Subsystem->CreateSession(A, Model);
+                    Subsystem->CreateSession(B, Model);
+                    TestTrueExpr(!Subsystem->OnSessionMessageCompleted(TEXT("Unknown")));
+
+                    int32 NumCompletedA{0}, NumCompletedB{0};
+                    Subsystem->OnSessionMessageCompleted(A)->AddLambda([&NumCompletedA](const FMessage&) { ++NumCompletedA; });
+                    Subsystem->OnSessionMessageCompleted(B)->AddLambda([&NumCompletedB](const FMessage&) { ++NumCompletedB; });
+
+                    Subsystem->MakeRequest(A, MakeUserMessage("Hi"));
+                    TestTrueExpr(NumCompletedA == 1);
+                    TestTrueExpr(NumCompletedB == 0);
+
+                    Subsystem->MakeRequest(B, MakeUserMessage("Hi"));
+                    TestTrueExpr(NumCompletedA == 1);
+                    TestTrueExpr(NumCompletedB == 1);
+                });
+
+            It("RemovedSessionShouldKeepItsSlotUntilTheResponseComes",
+                [this, A, B]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.AddRoute("/chat/completions", MakeChatResponse("Hello"));
+                    Server.SetHoldRequests(true);
+                    Subsystem->SetMaxConcurrentRequests(1);
+                    Subsystem->CreateSession(A, Model);
+                    Subsystem->CreateSession(B, Model);
+
+                    FString CompletedB;
+                    Subsystem->OnSessionMessageCompleted(B)->AddLambda(
+                        [&CompletedB](const FMessage& Message) { CompletedB = Message.Content; });
+
+                    Subsystem->MakeRequest(A, MakeUserMessage("Hi"));
+                    Subsystem->RemoveSession(A);
+                    TestTrueExpr(!Subsystem->HasSession(A));
+                    TestTrueExpr(Subsystem->GetScheduler().NumRunning() == 0);
+
+                    // the provider of the slot still waits for the response of A
+                    Subsystem->MakeRequest(B, MakeUserMessage("Hi"));
+                    TestTrueExpr(Subsystem->IsInProgress(B));
+                    TestTrueExpr(Server.NumRequests("/chat/completions") == 1);
+
+                    // the response of A is dropped and frees the slot
+                    TestTrueExpr(Server.ReleaseRequests() == 1);
+                    TestTrueExpr(Server.NumRequests("/chat/completions") == 2);
+                    TestTrueExpr(CompletedB.IsEmpty());
+
+                    TestTrueExpr(Server.ReleaseRequests() == 1);
+                    TestTrueExpr(CompletedB.Equals("Hello"));
+                    TestTrueExpr(!Subsystem->IsInProgress(B));
+                    TestTrueExpr(Subsystem->GetScheduler().NumRunning() == 0);
+                });
+
+            It("ToolResultsShouldGoToTheSessionOfTheirToolCall",
+                [this, A, B]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.AddRoute("/chat/completions", MakeToolCallResponse("call_A"), true);
+                    Server.AddRoute("/chat/completions", MakeToolCallResponse("call_B"), true);
+                    Server.AddRoute("/chat/completions", MakeChatResponse("Done"));
+                    Server.SetHoldRequests(true);
+
+                    TestTrueExpr(Subsystem->RegisterService(UOpenAIServiceFake::StaticClass(), {}));
+                    UOpenAIServiceFake* Service = FindService(Subsystem);
+                    if (!TestTrueExpr(Service != nullptr)) return;
+
+                    Subsystem->CreateSession(A, Model);
+                    Subsystem->CreateSession(B, Model);
+                    Subsystem->MakeRequest(A, MakeUserMessage("Call it"));
+                    Subsystem->MakeRequest(B, MakeUserMessage("Call it"));
+                    TestTrueExpr(Server.ReleaseRequests() == 2);
+                    TestTrueExpr(Service->GetToolIDs() == TArray<FString>({"call_A", "call_B"}));
+                    TestTrueExpr(Subsystem->IsInProgress(A));
+                    TestTrueExpr(Subsystem->IsInProgress(B));
+
+                    // the results come in another order than the calls
+                    Service->Answer("call_B", "Result of B");
+                    Service->Answer("call_A", "Result of A");
+                    const FChatHistory HistoryA = Subsystem->GetHistory(A);
+                    const FChatHistory HistoryB = Subsystem->GetHistory(B);
+                    TestTrueExpr(HistoryA.Last().Content.Equals("Result of A"));
+                    TestTrueExpr(HistoryA.Last().Tool_Call_ID.Value.Equals("call_A"));
+                    TestTrueExpr(HistoryB.Last().Content.Equals("Result of B"));
+                    TestTrueExpr(HistoryB.Last().Tool_Call_ID.Value.Equals("call_B"));
+
+                    // the follow-ups with the results are sent
+                    TestTrueExpr(Server.ReleaseRequests() == 2);
+                    TestTrueExpr(Subsystem->GetAssistantMessage(A).Content.Equals("Done"));
+                    TestTrueExpr(Subsystem->GetAssistantMessage(B).Content.Equals("Done"));
+                    TestTrueExpr(!Subsystem->IsInProgress(A));
+                    TestTrueExpr(!Subsystem->IsInProgress(B));
+                });
+
+            Describe("Errors",
+                [this, A]()
+                {
+                    It("RequestErrorShouldCompleteTheSession",
+                        [this, A]()
+                        {
+                            FFakeHttpServer::Get().AddRoute("/chat/completions", ErrorResponse);
+                            Subsystem->CreateSession(A, Model);
+
+                            bool WasUpdatedWithError{false};
+                            FString Completed;
+                            Subsystem->OnSessionMessageUpdated(A)->AddLambda(
+                                [&WasUpdatedWithError](const FMessage&, bool WasError) { WasUpdatedWithError = WasError; });
+                            Subsystem->OnSessionMessageCompleted(A)->AddLambda(
+                                [&Completed](const FMessage& Message) { Completed = Message.Content; });
+
+                            TestTrueExpr(Subsystem->MakeRequest(A, MakeUserMessage("Hi")));
+                            TestTrueExpr(WasUpdatedWithError);
+                            TestTrueExpr(Completed.Equals("Rate limit reached"));
+                            TestTrueExpr(!Subsystem->IsInProgress(A));
+                            TestTrueExpr(Subsystem->GetScheduler().NumRunning() == 0);
+
+                            // the session can ask again
+                            TestTrueExpr(Subsystem->MakeRequest(A, MakeUserMessage("Hi")));
+                        });
+
+                    It("CallOfUnknownFunctionShouldCompleteTheSessionWithError",
+                        [this, A]()
+                        {
+                            FFakeHttpServer::Get().AddRoute("/chat/completions", MakeToolCallResponse("call_A"));
+                            Subsystem->CreateSession(A, Model);
+
+                            bool WasUpdatedWithError{false};
+                            Subsystem->OnSessionMessageUpdated(A)->AddLambda(
+                                [&WasUpdatedWithError](const FMessage&, bool WasError) { WasUpdatedWithError = WasError; });
+
+                            Subsystem->MakeRequest(A, MakeUserMessage("Call it"));
+                            TestTrueExpr(WasUpdatedWithError);
+                            TestTrueExpr(!Subsystem->IsInProgress(A));
+                        });
+
+                    It("ServiceErrorShouldCompleteTheSessionThatCalledIt",
+                        [this, A]()
+                        {
+                            FFakeHttpServer::Get().AddRoute("/chat/completions", MakeToolCallResponse("call_A"));
+                            Subsystem->RegisterService(UOpenAIServiceFake::StaticClass(), {});
+                            UOpenAIServiceFake* Service = FindService(Subsystem);
+                            if (!TestTrueExpr(Service != nullptr)) return;
+
+                            Subsystem->CreateSession(A, Model);
+                            FString Completed;
+                            Subsystem->OnSessionMessageCompleted(A)->AddLambda(
+                                [&Completed](const FMessage& Message) { Completed = Message.Content; });
+
+                            Subsystem->MakeRequest(A, MakeUserMessage("Call it"));
+                            TestTrueExpr(Subsystem->IsInProgress(A));
+
+                            Service->Fail("Service is down");
+                            TestTrueExpr(Completed.Equals("Service is down"));
+                            TestTrueExpr(!Subsystem->IsInProgress(A));
+                        });
+
+                    It("UnregisteredServiceShouldCompleteTheSessionsThatWaitForIt",
+                        [this, A]()
+                        {
+                            FFakeHttpServer::Get().AddRoute("/chat/completions", MakeToolCallResponse("call_A"));
+                            Subsystem->RegisterService(UOpenAIServiceFake::StaticClass(), {});
+                            Subsystem->CreateSession(A, Model);
+
+                            bool WasUpdatedWithError{false};
+                            Subsystem->OnSessionMessageUpdated(A)->AddLambda(
+                                [&WasUpdatedWithError](const FMessage&, bool WasError) { WasUpdatedWithError = WasError; });
+
+                            Subsystem->MakeRequest(A, MakeUserMessage("Call it"));
+                            TestTrueExpr(Subsystem->IsInProgress(A));
+
+                            Subsystem->UnRegisterService(UOpenAIServiceFake::StaticClass());
+                            TestTrueExpr(WasUpdatedWithError);
+                            TestTrueExpr(!Subsystem->IsInProgress(A));
+                        });
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,195 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Provider/ChatStream.h"
+#include "FuncLib/JsonFuncLib.h"
+
+DEFINE_SPEC(FChatStreamSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+const TArray<FString> TextChunks{
+    "{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"created\":1700000000,\"model\":\"gpt-4o\","
+    "\"system_fingerprint\":\"fp_1\",\"choices\":[{\"index\":0,\"delta\":{\"role\":\"assistant\",\"content\":\"\"},"
+    "\"logprobs\":null,\"finish_reason\":null}]}",
+    "{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"created\":1700000000,\"model\":\"gpt-4o\","
+    "\"system_fingerprint\":\"fp_1\",\"choices\":[{\"index\":0,\"delta\":{\"content\":\"Hello\"},\"logprobs\":null,"
+    "\"finish_reason\":null}]}",
+    "{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"created\":1700000000,\"model\":\"gpt-4o\","
+    "\"system_fingerprint\":\"fp_1\",\"choices\":[{\"delta\":{\"content\":\", \\\"world\\\"\"},\"index\":0,\"finish_reason\":null}]}",
+    "{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"created\":1700000000,\"model\":\"gpt-4o\","
+    "\"system_fingerprint\":\"fp_1\",\"choices\":[{\"index\":0,\"delta\":{},\"logprobs\":null,\"finish_reason\":\"stop\"}]}",
+    "{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"created\":1700000000,\"model\":\"gpt-4o\","
+    "\"system_fingerprint\":\"fp_1\",\"choices\":[],\"usage\":{\"prompt_tokens\":9,\"completion_tokens\":3,\"total_tokens\":12}}"};
+
+const TArray<FString> ToolCallChunks{
+    "{\"id\":\"chatcmpl-2\",\"object\":\"chat.completion.chunk\",\"created\":1700000001,\"model\":\"gpt-4o\",\"choices\":[{\"index\":0,"
+    "\"delta\":{\"role\":\"assistant\",\"content\":null,\"tool_calls\":[{\"index\":0,\"id\":\"call_1\",\"type\":\"function\","
+    "\"function\":{\"name\":\"get_weather\",\"arguments\":\"\"}}]},\"finish_reason\":null}]}",
+    "{\"id\":\"chatcmpl-2\",\"object\":\"chat.completion.chunk\",\"created\":1700000001,\"model\":\"gpt-4o\",\"choices\":[{\"index\":0,"
+    "\"delta\":{\"tool_calls\":[{\"index\":0,\"function\":{\"arguments\":\"{\\\"city\\\"\"}}]},\"finish_reason\":null}]}",
+    "{\"id\":\"chatcmpl-2\",\"object\":\"chat.completion.chunk\",\"created\":1700000001,\"model\":\"gpt-4o\",\"choices\":[{\"index\":0,"
+    "\"delta\":{\"tool_calls\":[{\"index\":0,\"function\":{\"arguments\":\":\\\"Paris\\\"}\"}}]},\"finish_reason\":null}]}",
+    "{\"id\":\"chatcmpl-2\",\"object\":\"chat.completion.chunk\",\"created\":1700000001,\"model\":\"gpt-4o\",\"choices\":[{\"index\":0,"
+    "\"delta\":{},\"finish_reason\":\"tool_calls\"}]}"};
+
+FString MakeEvents(const TArray<FString>& Chunks)
+{
+    FString Events;
+    for (const FString& Chunk : Chunks)
+    {
+        Events.Append(TEXT("data: ")).Append(Chunk).Append(TEXT("\n\n"));
+    }
+    return Events.Append(TEXT("data: [DONE]\n\n"));
+}
+}  // namespace
+
+void FChatStreamSpec::Define()
+{
+    Describe("ChatStream",
+        [this]()
+        {
+            It("ChunksShouldBeAccumulatedIntoTheMessage",
+                [this]()
+                {
+                    FChatStream Stream;
+                    TestTrueExpr(Stream.Parse(MakeEvents(TextChunks), true) == 5);
+                    TestTrueExpr(Stream.IsDone());
+                    TestTrueExpr(Stream.GetID().Equals(TEXT("chatcmpl-1")));
+                    TestTrueExpr(Stream.GetModel().Equals(TEXT("gpt-4o")));
+                    TestTrueExpr(Stream.GetUsage().Total_Tokens == 12);
+
+                    const FChatStreamMessage* Message = Stream.FindMessage();
+                    TestTrueExpr(Message != nullptr);
+                    TestTrueExpr(Stream.GetMessages().Num() == 1);
+                    TestTrueExpr(Message->Content.Equals(TEXT("Hello, \"world\"")));
+                    TestTrueExpr(Message->Role == ERole::Assistant);
+                    TestTrueExpr(Message->FinishReason == EOpenAIFinishReason::Stop);
+                });
+
+            It("OnlyCompleteLinesShouldBeParsed",
+                [this]()
+                {
+                    const FString Events = MakeEvents(TextChunks);
+                    FChatStream Stream;
+                    int32 NumChunks = 0;
+                    for (int32 Length = 0; Length <= Events.Len(); Length += 7)
+                    {
+                        NumChunks += Stream.Parse(FStringView(Events).Left(Length));
+                    }
+                    NumChunks += Stream.Parse(Events, true);
+
+                    TestTrueExpr(NumChunks == 5);
+                    TestTrueExpr(Stream.FindMessage()->Content.Equals(TEXT("Hello, \"world\"")));
+
+                    FChatStream LastLineStream;
+                    const FString LastLine = TEXT("data: ") + TextChunks[1];
+                    TestTrueExpr(LastLineStream.Parse(LastLine) == 0);
+                    TestTrueExpr(LastLineStream.Parse(LastLine, true) == 1);
+                });
+
+            It("Utf8BodyShouldBeConvertedOnlyOnce",
+                [this]()
+                {
+                    TArray<FString> Chunks = TextChunks;
+                    Chunks[1].ReplaceInline(TEXT("Hello"), TEXT("Grüße"));
+                    const FString Events = MakeEvents(Chunks);
+                    const FTCHARToUTF8 Utf8Events(*Events, Events.Len());
+                    const TConstArrayView<uint8> Body(reinterpret_cast<const uint8*>(Utf8Events.Get()), Utf8Events.Length());
+
+                    // 5-byte steps cut the multibyte characters, the converted lines add up to the body
+                    FChatStream Stream;
+                    FString AllLines, NewLines;
+                    int32 NumChunks = 0;
+                    for (int32 Length = 0; Length <= Body.Num(); Length += 5)
+                    {
+                        NewLines.Reset();
+                        NumChunks += Stream.ParseUtf8(Body.Left(Length), false, &NewLines);
+                        AllLines.Append(NewLines);
+                    }
+                    NewLines.Reset();
+                    NumChunks += Stream.ParseUtf8(Body, true, &NewLines);
+                    AllLines.Append(NewLines);
+
+                    TestTrueExpr(NumChunks == 5);
+                    TestTrueExpr(Stream.IsDone());
+                    TestTrueExpr(AllLines.Equals(Events, ESearchCase::CaseSensitive));
+                    TestTrueExpr(Stream.FindMessage()->Content.Equals(TEXT("Grüße, \"world\""), ESearchCase::CaseSensitive));
+                    TestTrueExpr(Stream.ParseUtf8(Body, true) == 0);
+                });
+
+            It("ToolCallsShouldBeAccumulated",
+                [this]()
+                {
+                    FChatStream Stream;
+                    Stream.Parse(MakeEvents(ToolCallChunks), true);
+
+                    const FChatStreamMessage* Message = Stream.FindMessage();
+                    TestTrueExpr(Message->FinishReason == EOpenAIFinishReason::Tool_Calls);
+                    TestTrueExpr(Message->Content.IsEmpty());
+                    TestTrueExpr(Message->ToolCalls.Num() == 1);
+                    TestTrueExpr(Message->ToolCalls[0].ID.Equals(TEXT("call_1")));
+                    TestTrueExpr(Message->ToolCalls[0].Function.Name.Equals(TEXT("get_weather")));
+                    TestTrueExpr(Message->ToolCalls[0].Function.Arguments.Equals(TEXT("{\"city\":\"Paris\"}")));
+                });
+
+            It("MalformedLinesShouldBeSkipped",
+                [this]()
+                {
+                    FChatStream Stream;
+                    const FString Events =
+                        TEXT(": keep-alive\n{\n\"error\": {\n}\n") + MakeEvents(TextChunks) + TEXT("data: {\"id\":\"late\"}\n");
+                    TestTrueExpr(Stream.Parse(Events, true) == 5);
+                    TestTrueExpr(Stream.FindMessage()->Content.Equals(TEXT("Hello, \"world\"")));
+                });
+
+            It("ResponsesShouldMatchTheBlueprintParser",
+                [this]()
+                {
+                    for (const TArray<FString>* Chunks : {&TextChunks, &ToolCallChunks})
+                    {
+                        FChatStream Stream;
+                        Stream.Parse(MakeEvents(*Chunks), true);
+                        const TArray<FChatCompletionStreamResponse> Responses = Stream.ToResponses();
+                        TestTrueExpr(Responses.Num() == Chunks->Num());
+
+                        for (int32 Index = 0; Index < Chunks->Num(); ++Index)
+                        {
+                            FChatCompletionStreamResponse Expected;
+                            TestTrueExpr(UJsonFuncLib::ParseJSONToStruct((*Chunks)[Index], &Expected));
+
+                            const FChatCompletionStreamResponse& Actual = Responses[Index];
+                            TestTrueExpr(Actual.ID.Equals(Expected.ID));
+                            TestTrueExpr(Actual.Model.Equals(Expected.Model));
+                            TestTrueExpr(Actual.Object.Equals(Expected.Object));
+                            TestTrueExpr(Actual.Created == Expected.Created);
+                            TestTrueExpr(Actual.Usage.Total_Tokens == Expected.Usage.Total_Tokens);
+                            TestTrueExpr(Actual.Choices.Num() == Expected.Choices.Num());
+                            for (int32 Choice = 0; Choice < FMath::Min(Actual.Choices.Num(), Expected.Choices.Num()); ++Choice)
+                            {
+                                const FChatStreamChoice& ActualChoice = Actual.Choices[Choice];
+                                const FChatStreamChoice& ExpectedChoice = Expected.Choices[Choice];
+                                TestTrueExpr(ActualChoice.Index == ExpectedChoice.Index);
+                                TestTrueExpr(ActualChoice.Finish_Reason.Equals(ExpectedChoice.Finish_Reason));
+                                TestTrueExpr(ActualChoice.Delta.Role.Equals(ExpectedChoice.Delta.Role));
+                                TestTrueExpr(ActualChoice.Delta.Content.Equals(ExpectedChoice.Delta.Content));
+                                TestTrueExpr(ActualChoice.Delta.Tool_Calls.ID.Equals(ExpectedChoice.Delta.Tool_Calls.ID));
+
+                                const FFunctionCommon& ActualFunction = ActualChoice.Delta.Tool_Calls.Function;
+                                const FFunctionCommon& ExpectedFunction = ExpectedChoice.Delta.Tool_Calls.Function;
+                                TestTrueExpr(ActualFunction.Name.Equals(ExpectedFunction.Name));
+                                TestTrueExpr(ActualFunction.Arguments.Equals(ExpectedFunction.Arguments));
+                            }
+                        }
+                    }
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,86 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "FineTuning/DatasetValidator.h"
+
+DEFINE_SPEC(FDatasetValidatorSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+const FString ValidExample =
+    "{\"messages\":[{\"role\":\"system\",\"content\":\"You are a blacksmith.\"},{\"role\":\"user\",\"content\":\"Hi\"},"
+    "{\"role\":\"assistant\",\"content\":\"Need a sword?\"}]}";
+
+const FString ToolCallExample =
+    "{\"messages\":[{\"role\":\"user\",\"content\":\"Weather?\"},"
+    "{\"role\":\"assistant\",\"tool_calls\":[{\"id\":\"call_1\",\"type\":\"function\","
+    "\"function\":{\"name\":\"get_weather\",\"arguments\":\"{}\"}}]},"
+    "{\"role\":\"tool\",\"tool_call_id\":\"call_1\",\"content\":\"sunny\"},"
+    "{\"role\":\"assistant\",\"content\":\"It's sunny.\"}]}";
+}  // namespace
+
+void FDatasetValidatorSpec::Define()
+{
+    Describe("DatasetValidator",
+        [this]()
+        {
+            It("ValidDatasetShouldPass",
+                [this]()
+                {
+                    FFineTuningDatasetValidator Validator;
+                    FDatasetReport Report;
+                    TestTrueExpr(Validator.ValidateString(ValidExample + "\n" + ToolCallExample + "\n", Report));
+                    TestTrueExpr(Report.NumExamples == 2);
+                    TestTrueExpr(Report.NumValid == 2);
+                    TestTrueExpr(Report.TrainingTokens > 0);
+                    TestTrueExpr(Report.EstimatedCost > 0.0);
+                    TestTrueExpr(Report.Issues.IsEmpty());
+                });
+
+            It("InvalidExamplesShouldBeReported",
+                [this]()
+                {
+                    const FString NoAssistant = "{\"messages\":[{\"role\":\"user\",\"content\":\"Hi\"}]}";
+                    const FString WrongRole = "{\"messages\":[{\"role\":\"npc\",\"content\":\"Hi\"},"
+                                              "{\"role\":\"assistant\",\"content\":\"Hi\"}]}";
+                    const FString UnansweredTool = "{\"messages\":[{\"role\":\"user\",\"content\":\"Hi\"},"
+                                                   "{\"role\":\"tool\",\"tool_call_id\":\"call_2\",\"content\":\"x\"},"
+                                                   "{\"role\":\"assistant\",\"content\":\"Hi\"}]}";
+                    const FString NotJson = "{\"messages\":[";
+
+                    FFineTuningDatasetValidator Validator;
+                    FDatasetReport Report;
+                    const TArray<FString> Examples{ValidExample, NoAssistant, WrongRole, UnansweredTool, NotJson};
+                    const FString Dataset = FString::Join(Examples, TEXT("\n"));
+                    TestTrueExpr(!Validator.ValidateString(Dataset, Report));
+                    TestTrueExpr(Report.NumValid == 1);
+                    TestTrueExpr(Report.NumInvalid == 4);
+                    TestTrueExpr(Report.Issues.Num() == 4);
+                    TestTrueExpr(Report.Issues[0].Example == 2);
+                });
+
+            It("DuplicatesAndLongExamplesShouldBeFound",
+                [this]()
+                {
+                    FDatasetValidationOptions Options;
+                    Options.MaxTokensPerExample = 30;
+                    FFineTuningDatasetValidator Validator(Options);
+                    Validator.SetTokenCounter([](FStringView Text) { return Text.Len(); });
+
+                    const FString ShortExample = "{\"messages\":[{\"role\":\"assistant\",\"content\":\"Hi\"}]}";
+                    FDatasetReport Report;
+                    Validator.ValidateString(ShortExample + "\n" + ShortExample + "\n" + ValidExample, Report);
+                    TestTrueExpr(Report.NumValid == 1);
+                    TestTrueExpr(Report.NumDuplicates == 1);
+                    TestTrueExpr(Report.NumTooLong == 1);
+                });
+        });
+}
+
+#endif
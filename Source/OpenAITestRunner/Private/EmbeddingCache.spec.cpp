@@ -0,0 +1,195 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Embeddings/EmbeddingCache.h"
+
+DEFINE_SPEC(FEmbeddingCacheSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+const FString Model = TEXT("text-embedding-3-small");
+
+TArray<float> MakeVector(int32 Seed)
+{
+    return {static_cast<float>(Seed), 0.5f, -1.0f};
+}
+
+FEmbeddingsResponse MakeMissResponse(const FEmbeddingCacheLookup& Lookup)
+{
+    FEmbeddingsResponse Response;
+    Response.Usage.Prompt_Tokens = Lookup.MissInput.Num();
+    for (int32 Index = 0; Index < Lookup.MissInput.Num(); ++Index)
+    {
+        FEmbeddingsData& Data = Response.Data.AddDefaulted_GetRef();
+        Data.Index = Index;
+        Data.Embedding = MakeVector(Lookup.MissInput[Index].Len());
+    }
+    return Response;
+}
+}  // namespace
+
+void FEmbeddingCacheSpec::Define()
+{
+    Describe("EmbeddingCache",
+        [this]()
+        {
+            const FString TestDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("EmbeddingCache"));
+            const FString FilePath = FPaths::Combine(TestDir, TEXT("EmbeddingCache.slab"));
+
+            AfterEach([TestDir]() { IFileManager::Get().DeleteDirectory(*TestDir, false, true); });
+
+            It("KeyShouldDependOnModelDimensionsAndNormalizedInput",
+                [this]()
+                {
+                    const FXxHash128 Key = FEmbeddingCache::MakeKey(Model, 0, TEXT("The dragon sleeps.\r\nQuietly."));
+                    TestTrueExpr(Key == FEmbeddingCache::MakeKey(Model, 0, TEXT("  The dragon sleeps.\nQuietly.\n")));
+                    TestTrueExpr(Key != FEmbeddingCache::MakeKey(Model, 256, TEXT("The dragon sleeps.\nQuietly.")));
+                    TestTrueExpr(Key != FEmbeddingCache::MakeKey(TEXT("text-embedding-3-large"), 0, TEXT("The dragon sleeps.\nQuietly.")));
+                    TestTrueExpr(Key != FEmbeddingCache::MakeKey(Model, 0, TEXT("The dragon sleeps. Quietly.")));
+                });
+
+            It("SavedVectorsShouldBeFoundAfterLoad",
+                [this, FilePath]()
+                {
+                    {
+                        FEmbeddingCache Cache(FilePath);
+                        for (int32 Index = 0; Index < 2000; ++Index)
+                        {
+                            Cache.Add(FEmbeddingCache::MakeKey(Model, 0, FString::FromInt(Index)), MakeVector(Index));
+                        }
+                        TestTrueExpr(Cache.Num() == 2000);
+                        TestTrueExpr(Cache.Save());
+
+                        // saved and pending vectors are found together
+                        Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("Pending")), MakeVector(-1));
+                        TArray<float> Vector;
+                        TestTrueExpr(Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("1999")), Vector) && Vector == MakeVector(1999));
+                        TestTrueExpr(Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("Pending")), Vector) && Vector == MakeVector(-1));
+                    }
+
+                    FEmbeddingCache Cache(FilePath);
+                    TestTrueExpr(Cache.Num() == 2001);
+                    TArray<float> Vector;
+                    TestTrueExpr(Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("42")), Vector) && Vector == MakeVector(42));
+                    TestTrueExpr(Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("Pending")), Vector) && Vector == MakeVector(-1));
+                    TestTrueExpr(!Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("2000")), Vector));
+                });
+
+            It("TornRecordAtTheEndShouldBeDropped",
+                [this, FilePath]()
+                {
+                    {
+                        FEmbeddingCache Cache(FilePath);
+                        Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("A")), MakeVector(1));
+                        Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("B")), MakeVector(2));
+                    }
+
+                    // a crash in the middle of a save
+                    TArray<uint8> Data;
+                    FFileHelper::LoadFileToArray(Data, *FilePath);
+                    Data.Append({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 64, 0, 0, 0});
+                    FFileHelper::SaveArrayToFile(Data, *FilePath);
+
+                    {
+                        FEmbeddingCache Cache(FilePath);
+                        TestTrueExpr(Cache.Num() == 2);
+                        Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("C")), MakeVector(3));
+                    }
+
+                    FEmbeddingCache Cache(FilePath);
+                    TestTrueExpr(Cache.Num() == 3);
+                    TArray<float> Vector;
+                    TestTrueExpr(Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("C")), Vector) && Vector == MakeVector(3));
+                });
+
+            It("SaveAfterFailedSaveShouldCutTornTail",
+                [this, FilePath]()
+                {
+                    {
+                        FEmbeddingCache Cache(FilePath);
+                        Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("A")), MakeVector(1));
+                        TestTrueExpr(Cache.Save());
+
+                        // a save that failed in the middle of a record
+                        const TArray<uint8> TornRecord{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 64, 0, 0, 0};
+                        FFileHelper::SaveArrayToFile(TornRecord, *FilePath, &IFileManager::Get(), FILEWRITE_Append);
+
+                        Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("B")), MakeVector(2));
+                        TestTrueExpr(Cache.Save());
+                    }
+
+                    FEmbeddingCache Cache(FilePath);
+                    TestTrueExpr(Cache.Num() == 2);
+                    TArray<float> Vector;
+                    TestTrueExpr(Cache.Find(FEmbeddingCache::MakeKey(Model, 0, TEXT("B")), Vector) && Vector == MakeVector(2));
+                });
+
+            It("FindAfterFailedSaveShouldMissUnmappedVectors",
+                [this, FilePath]()
+                {
+                    FEmbeddingCache Cache(FilePath);
+                    const FXxHash128 KeyA = FEmbeddingCache::MakeKey(Model, 0, TEXT("A"));
+                    const FXxHash128 KeyB = FEmbeddingCache::MakeKey(Model, 0, TEXT("B"));
+                    Cache.Add(KeyA, MakeVector(1));
+                    TestTrueExpr(Cache.Save());
+
+                    // the slab is replaced by a directory, so it can be neither written nor mapped
+                    TestTrueExpr(IFileManager::Get().Delete(*FilePath));
+                    TestTrueExpr(IFileManager::Get().MakeDirectory(*FilePath));
+                    Cache.Add(KeyB, MakeVector(2));
+                    TestTrueExpr(!Cache.Save());
+
+                    TArray<float> Vector;
+                    TestTrueExpr(!Cache.Find(KeyA, Vector));
+                    TestTrueExpr(Cache.Find(KeyB, Vector) && Vector == MakeVector(2));
+                    TestTrueExpr(Cache.Num() == 1);
+
+                    FEmbeddings Request;
+                    Request.Model = Model;
+                    Request.Input = {TEXT("A"), TEXT("B")};
+                    TestTrueExpr(Cache.Lookup(Request).MissInput == TArray<FString>({TEXT("A")}));
+                });
+
+            It("OnlyUniqueMissesShouldBeSentAndSplicedBackInOrder",
+                [this, FilePath]()
+                {
+                    FEmbeddingCache Cache(FilePath);
+                    Cache.Add(FEmbeddingCache::MakeKey(Model, 0, TEXT("cached")), MakeVector(100));
+
+                    FEmbeddings Request;
+                    Request.Model = Model;
+                    Request.Input = {TEXT("one"), TEXT("cached"), TEXT("three"), TEXT("one"), TEXT(" cached ")};
+
+                    FEmbeddingCacheLookup Lookup = Cache.Lookup(Request);
+                    TestTrueExpr(Lookup.MissInput == TArray<FString>({TEXT("one"), TEXT("three")}));
+
+                    const FEmbeddingsResponse MissResponse = MakeMissResponse(Lookup);
+                    TestTrueExpr(Cache.Resolve(Lookup, MissResponse));
+
+                    const FEmbeddingsResponse Response = FEmbeddingCache::MakeResponse(Lookup, MissResponse);
+                    TestTrueExpr(Response.Data.Num() == 5);
+                    TestTrueExpr(Response.Usage.Prompt_Tokens == 2);
+                    TestTrueExpr(Response.Model.Equals(Model));
+                    const TArray<int32> ExpectedSeeds{3, 100, 5, 3, 100};
+                    for (int32 Index = 0; Index < Response.Data.Num(); ++Index)
+                    {
+                        TestTrueExpr(Response.Data[Index].Index == Index);
+                        TestTrueExpr(Response.Data[Index].Embedding == MakeVector(ExpectedSeeds[Index]));
+                    }
+
+                    // the resolved misses are cached for the next request
+                    TestTrueExpr(!Cache.Lookup(Request).HasMisses());
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,169 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Embeddings/EmbeddingMatrix.h"
+#include "Embeddings/VectorMath.h"
+
+DEFINE_SPEC(FEmbeddingMatrixSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+TArray<float> MakeRandomVector(FRandomStream& Random, int32 Dimensions)
+{
+    TArray<float> Vector;
+    Vector.SetNumUninitialized(Dimensions);
+    for (float& Value : Vector)
+    {
+        Value = Random.FRandRange(-1.0f, 1.0f);
+    }
+    return Vector;
+}
+
+float NaiveDot(const TArray<float>& A, const TArray<float>& B)
+{
+    double Sum{0.0};
+    for (int32 Index = 0; Index < A.Num(); ++Index)
+    {
+        Sum += A[Index] * B[Index];
+    }
+    return static_cast<float>(Sum);
+}
+}  // namespace
+
+void FEmbeddingMatrixSpec::Define()
+{
+    Describe("VectorMath",
+        [this]()
+        {
+            It("KernelsShouldMatchNaiveLoopsForAnySize",
+                [this]()
+                {
+                    FRandomStream Random(42);
+                    for (const int32 Dimensions : {1, 3, 4, 15, 16, 17, 1536})
+                    {
+                        const TArray<float> A = MakeRandomVector(Random, Dimensions);
+                        const TArray<float> B = MakeRandomVector(Random, Dimensions);
+
+                        TArray<float> Difference;
+                        for (int32 Index = 0; Index < Dimensions; ++Index)
+                        {
+                            Difference.Add(A[Index] - B[Index]);
+                        }
+
+                        const float Dot = NaiveDot(A, B);
+                        const float Cosine = Dot / FMath::Sqrt(NaiveDot(A, A) * NaiveDot(B, B));
+                        TestTrueExpr(FMath::IsNearlyEqual(VectorMath::Dot(A.GetData(), B.GetData(), Dimensions), Dot, 1e-3f));
+                        TestTrueExpr(FMath::IsNearlyEqual(VectorMath::Cosine(A.GetData(), B.GetData(), Dimensions), Cosine, 1e-4f));
+                        TestTrueExpr(FMath::IsNearlyEqual(
+                            VectorMath::L2Squared(A.GetData(), B.GetData(), Dimensions), NaiveDot(Difference, Difference), 1e-3f));
+                    }
+                });
+
+            It("TruncatedVectorShouldBeNormalized",
+                [this]()
+                {
+                    const TArray<float> Vector{3.0f, 4.0f, 12.0f};
+                    const TArray<float> Truncated = VectorMath::Truncate(Vector, 2);
+                    TestTrueExpr(Truncated.Num() == 2);
+                    TestTrueExpr(FMath::IsNearlyEqual(Truncated[0], 0.6f));
+                    TestTrueExpr(FMath::IsNearlyEqual(Truncated[1], 0.8f));
+                });
+
+            It("HammingDistanceShouldCountDifferentSigns",
+                [this]()
+                {
+                    const TArray<float> A{1.0f, -1.0f, 1.0f, 1.0f};
+                    const TArray<float> B{1.0f, 1.0f, -1.0f, 1.0f};
+                    uint64 BitsA, BitsB;
+                    VectorMath::QuantizeBinary(A.GetData(), A.Num(), &BitsA);
+                    VectorMath::QuantizeBinary(B.GetData(), B.Num(), &BitsB);
+                    TestTrueExpr(VectorMath::HammingDistance(&BitsA, &BitsB, 1) == 2);
+                });
+        });
+
+    Describe("EmbeddingMatrix",
+        [this]()
+        {
+            It("TopKShouldReturnBestRowsInOrder",
+                [this]()
+                {
+                    FEmbeddingMatrix Matrix(2, EVectorMetric::Cosine);
+                    Matrix.Add(TArray<float>{0.0f, 1.0f});
+                    Matrix.Add(TArray<float>{1.0f, 0.0f});
+                    Matrix.Add(TArray<float>{2.0f, 2.1f});
+                    Matrix.Add(TArray<float>{-1.0f, 0.0f});
+
+                    const auto Results = Matrix.TopK(TArray<float>{1.0f, 0.9f}, 2);
+                    TestTrueExpr(Results.Num() == 2);
+                    TestTrueExpr(Results[0].Index == 2);
+                    TestTrueExpr(Results[1].Index == 1);
+                    TestTrueExpr(Results[0].Score >= Results[1].Score);
+                });
+
+            It("L2ScoresShouldBeNegatedSquaredDistances",
+                [this]()
+                {
+                    FEmbeddingMatrix Matrix(3, EVectorMetric::L2);
+                    Matrix.Add(TArray<float>{1.0f, 2.0f, 3.0f});
+
+                    TArray<float> Scores;
+                    Matrix.Score(TArray<float>{1.0f, 0.0f, 3.0f}, Scores);
+                    TestTrueExpr(Scores.Num() == 1);
+                    TestTrueExpr(FMath::IsNearlyEqual(Scores[0], -4.0f));
+                });
+
+            It("LongerVectorsShouldBeTruncatedAndShorterRejected",
+                [this]()
+                {
+                    FEmbeddingMatrix Matrix(2, EVectorMetric::Cosine);
+                    TestTrueExpr(Matrix.Add(TArray<float>{3.0f, 4.0f, 100.0f}) == 0);
+                    TestTrueExpr(Matrix.Add(TArray<float>{1.0f}) == INDEX_NONE);
+                    TestTrueExpr(FMath::IsNearlyEqual(Matrix.GetRow(0)[0], 0.6f));
+                    TestTrueExpr(FMath::IsNearlyEqual(Matrix.GetRow(0)[1], 0.8f));
+                });
+
+            It("QuantizedSearchShouldBeReRankedWithFullPrecision",
+                [this]()
+                {
+                    constexpr int32 Dimensions = 256;
+                    FRandomStream Random(7);
+                    FEmbeddingMatrix Matrix(Dimensions);
+                    for (int32 Index = 0; Index < 2000; ++Index)
+                    {
+                        Matrix.Add(MakeRandomVector(Random, Dimensions));
+                    }
+
+                    const TArray<float> Query = MakeRandomVector(Random, Dimensions);
+                    const auto Expected = Matrix.TopK(Query, 10);
+
+                    for (const auto Quantization : {EVectorQuantization::Int8, EVectorQuantization::Binary})
+                    {
+                        Matrix.SetQuantization(Quantization);
+                        const auto Results = Matrix.TopK(Query, 10, 10);
+                        TestTrueExpr(Results.Num() == 10);
+                        // the best row is found and the scores are the full precision ones
+                        TestTrueExpr(Results[0].Index == Expected[0].Index);
+                        TestTrueExpr(FMath::IsNearlyEqual(Results[0].Score, Expected[0].Score));
+                    }
+                });
+
+            It("SelectTopKShouldHandleSmallInputs",
+                [this]()
+                {
+                    TestTrueExpr(FEmbeddingMatrix::SelectTopK({}, 5).IsEmpty());
+
+                    const TArray<float> Scores{0.5f, 2.0f, -1.0f};
+                    const auto Results = FEmbeddingMatrix::SelectTopK(Scores, 5);
+                    TestTrueExpr(Results.Num() == 3);
+                    TestTrueExpr(Results[0].Index == 1 && Results[1].Index == 0 && Results[2].Index == 2);
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,233 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Embeddings/EmbeddingStore.h"
+
+DEFINE_SPEC(FEmbeddingStoreSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 Dimensions = 8;
+
+TArray<float> MakeVector(int64 Id)
+{
+    FRandomStream Random(static_cast<int32>(Id));
+    TArray<float> Vector;
+    for (int32 Index = 0; Index < Dimensions; ++Index)
+    {
+        Vector.Add(Random.FRandRange(-1.0f, 1.0f));
+    }
+    return Vector;
+}
+
+FMetadataRow MakeMetadata(const FString& Npc)
+{
+    FMetadataRow Metadata;
+    Metadata.Tags.Add("Npc", Npc);
+    return Metadata;
+}
+
+bool FindsItself(const FEmbeddingStore& Store, int64 Id)
+{
+    const TArray<FVectorSearchResult> Results = Store.Search(MakeVector(Id), 1);
+    return Results.Num() == 1 && Results[0].Id == Id;
+}
+}  // namespace
+
+void FEmbeddingStoreSpec::Define()
+{
+    Describe("EmbeddingStore",
+        [this]()
+        {
+            const FString TestDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("EmbeddingStore"));
+
+            AfterEach([TestDir]() { IFileManager::Get().DeleteDirectory(*TestDir, false, true); });
+
+            It("InsertedVectorsShouldBeFoundAndRemovedOnesShouldNot",
+                [this, TestDir]()
+                {
+                    FEmbeddingStore Store(TestDir, Dimensions);
+                    TestTrueExpr(Store.Open());
+
+                    for (int64 Id = 1; Id <= 100; ++Id)
+                    {
+                        TestTrueExpr(Store.Insert(Id, MakeVector(Id), MakeMetadata(Id % 2 ? "Smith" : "Guard")));
+                    }
+                    TestTrueExpr(Store.Num() == 100);
+                    TestTrueExpr(FindsItself(Store, 42));
+
+                    TestTrueExpr(Store.Remove(42));
+                    TestTrueExpr(!Store.Remove(42));
+                    TestTrueExpr(!Store.Contains(42));
+                    TestTrueExpr(Store.Num() == 99);
+                    TestTrueExpr(!FindsItself(Store, 42));
+
+                    const auto Results = Store.Search(MakeVector(3), 10, FMetadataFilter::TagEquals("Npc", "Guard"));
+                    TestTrueExpr(Results.Num() == 10);
+                    for (const FVectorSearchResult& Result : Results)
+                    {
+                        TestTrueExpr(Result.Id % 2 == 0);
+                    }
+
+                    // the id is replaced, not duplicated
+                    TestTrueExpr(Store.Insert(7, MakeVector(1007)));
+                    TestTrueExpr(Store.Num() == 99);
+                    TestTrueExpr(Store.Search(MakeVector(1007), 1)[0].Id == 7);
+                });
+
+            It("LoggedWritesShouldBeReplayedOnOpen",
+                [this, TestDir]()
+                {
+                    {
+                        FEmbeddingStore Store(TestDir, Dimensions);
+                        Store.Open();
+                        for (int64 Id = 1; Id <= 50; ++Id)
+                        {
+                            Store.Insert(Id, MakeVector(Id), MakeMetadata("Smith"));
+                        }
+                        Store.Remove(10);
+                    }
+
+                    FEmbeddingStore Store(TestDir, Dimensions);
+                    TestTrueExpr(Store.Open());
+                    TestTrueExpr(Store.Num() == 49);
+                    TestTrueExpr(!Store.Contains(10));
+                    TestTrueExpr(FindsItself(Store, 20));
+                    TestTrueExpr(Store.Search(MakeVector(20), 5, FMetadataFilter::TagEquals("Npc", "Smith")).Num() == 5);
+                });
+
+            It("CompactedSnapshotAndLaterWritesShouldBeRecovered",
+                [this, TestDir]()
+                {
+                    {
+                        FEmbeddingStore Store(TestDir, Dimensions);
+                        Store.Open();
+                        for (int64 Id = 1; Id <= 200; ++Id)
+                        {
+                            Store.Insert(Id, MakeVector(Id), MakeMetadata(Id <= 100 ? "Smith" : "Guard"));
+                        }
+                        Store.Remove(1);
+
+                        Store.Compact();
+                        // writes while the graph is rebuilt go to the next log
+                        Store.Remove(2);
+                        Store.Insert(201, MakeVector(201), MakeMetadata("Guard"));
+                        Store.WaitForCompaction();
+
+                        TestTrueExpr(Store.Num() == 199);
+                        TestTrueExpr(!Store.Contains(2));
+                        TestTrueExpr(FindsItself(Store, 150));
+                        Store.Remove(3);
+                    }
+
+                    TestTrueExpr(FPaths::FileExists(FPaths::Combine(TestDir, TEXT("Current"))));
+
+                    FEmbeddingStore Store(TestDir, Dimensions);
+                    TestTrueExpr(Store.Open());
+                    TestTrueExpr(Store.Num() == 198);
+                    for (const int64 Id : {1, 2, 3})
+                    {
+                        TestTrueExpr(!Store.Contains(Id));
+                    }
+                    TestTrueExpr(FindsItself(Store, 150));
+                    TestTrueExpr(FindsItself(Store, 201));
+
+                    const auto Results = Store.Search(MakeVector(50), 100, FMetadataFilter::TagEquals("Npc", "Smith"));
+                    TestTrueExpr(Results.Num() == 97);
+                });
+
+            It("LostCurrentShouldBeRecoveredFromNewestSnapshot",
+                [this, TestDir]()
+                {
+                    {
+                        FEmbeddingStore Store(TestDir, Dimensions);
+                        Store.Open();
+                        for (int64 Id = 1; Id <= 50; ++Id)
+                        {
+                            Store.Insert(Id, MakeVector(Id));
+                        }
+                        Store.Compact();
+                        Store.WaitForCompaction();
+                        Store.Insert(51, MakeVector(51));
+                    }
+
+                    // a crash while Current was replaced
+                    const FString CurrentPath = FPaths::Combine(TestDir, TEXT("Current"));
+                    TestTrueExpr(IFileManager::Get().Delete(*CurrentPath));
+
+                    FEmbeddingStore Store(TestDir, Dimensions);
+                    TestTrueExpr(Store.Open());
+                    TestTrueExpr(Store.Num() == 51);
+                    TestTrueExpr(FindsItself(Store, 25));
+                    TestTrueExpr(FindsItself(Store, 51));
+                    TestTrueExpr(FPaths::FileExists(CurrentPath));
+                });
+
+            It("TornRecordAtTheEndOfLogShouldBeSkipped",
+                [this, TestDir]()
+                {
+                    {
+                        FEmbeddingStore Store(TestDir, Dimensions);
+                        Store.Open();
+                        Store.Insert(1, MakeVector(1));
+                        Store.Insert(2, MakeVector(2));
+                    }
+
+                    // a crash in the middle of a write
+                    TArray<FString> LogFiles;
+                    IFileManager::Get().FindFiles(LogFiles, *FPaths::Combine(TestDir, TEXT("*.wal")), true, false);
+                    TestTrueExpr(LogFiles.Num() == 1);
+                    const FString LogPath = FPaths::Combine(TestDir, LogFiles[0]);
+                    TArray<uint8> Data;
+                    FFileHelper::LoadFileToArray(Data, *LogPath);
+                    Data.Append({64, 0, 0, 0, 1, 2, 3, 4, 0, 1});
+                    FFileHelper::SaveArrayToFile(Data, *LogPath);
+
+                    {
+                        FEmbeddingStore Store(TestDir, Dimensions);
+                        TestTrueExpr(Store.Open());
+                        TestTrueExpr(Store.Num() == 2);
+                        TestTrueExpr(Store.Insert(3, MakeVector(3)));
+                    }
+
+                    FEmbeddingStore Store(TestDir, Dimensions);
+                    TestTrueExpr(Store.Open());
+                    TestTrueExpr(Store.Num() == 3);
+                    TestTrueExpr(FindsItself(Store, 3));
+                });
+
+            It("DamagedRecordInTheMiddleOfLogShouldFailOpen",
+                [this, TestDir]()
+                {
+                    for (const int64 Id : {1, 3})
+                    {
+                        FEmbeddingStore Store(TestDir, Dimensions);
+                        Store.Open();
+                        Store.Insert(Id, MakeVector(Id));
+                        Store.Insert(Id + 1, MakeVector(Id + 1));
+                    }
+
+                    // the id of the first record is changed, its crc doesn't match
+                    const FString LogPath = FPaths::Combine(TestDir, TEXT("Log_1.wal"));
+                    TArray<uint8> Data;
+                    if (!TestTrueExpr(FFileHelper::LoadFileToArray(Data, *LogPath))) return;
+                    Data[2 * sizeof(uint32) + 1] ^= 0xFF;
+                    FFileHelper::SaveArrayToFile(Data, *LogPath);
+
+                    FEmbeddingStore Store(TestDir, Dimensions);
+                    TestTrueExpr(!Store.Open());
+                    TestTrueExpr(!Store.IsOpen());
+                });
+        });
+}
+
+#endif
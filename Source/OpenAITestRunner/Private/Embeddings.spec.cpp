@@ -0,0 +1,133 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Embeddings/EmbeddingsDriver.h"
+
+DEFINE_SPEC(FEmbeddingsSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FEmbeddingsSpec::Define()
+{
+    Describe("EmbeddingsDriver",
+        [this]()
+        {
+            It("InputShouldBeSplitByInputCount",
+                [this]()
+                {
+                    TArray<FString> Input;
+                    Input.Init("text", 5000);
+
+                    const auto Slices = UEmbeddingsDriver::SplitInput(Input, {}, &EstimateTokens);
+                    TestTrueExpr(Slices.Num() == 3);
+                    TestTrueExpr(Slices[0].First == 0 && Slices[0].Num == 2048);
+                    TestTrueExpr(Slices[1].First == 2048 && Slices[1].Num == 2048);
+                    TestTrueExpr(Slices[2].First == 4096 && Slices[2].Num == 904);
+                });
+
+            It("InputShouldBeSplitByTokenCount",
+                [this]()
+                {
+                    FEmbeddingsDriverOptions Options;
+                    Options.MaxTokensPerRequest = 10;
+                    const TArray<FString> Input{"aaaa", "aaaa", "aaaa", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "aaaa"};
+
+                    // one token per input except the fourth one that is over the limit and isn't sent
+                    TArray<int32> Rejected;
+                    const auto Slices = UEmbeddingsDriver::SplitInput(Input, Options, &EstimateTokens, &Rejected);
+                    TestTrueExpr(Slices.Num() == 2);
+                    TestTrueExpr(Slices[0].First == 0 && Slices[0].Num == 3);
+                    TestTrueExpr(Slices[1].First == 4 && Slices[1].Num == 1);
+                    TestTrueExpr(Rejected.Num() == 1 && Rejected[0] == 3);
+                });
+
+            It("InputOverPerInputLimitShouldBeRejected",
+                [this]()
+                {
+                    FEmbeddingsDriverOptions Options;
+                    Options.MaxTokensPerInput = 2;
+                    const TArray<FString> Input{"aaaaaaaaaaaa", "aaaa", "aaaa", "aaaaaaaaaaaa", "aaaaaaaaaaaa", "aaaa"};
+
+                    TArray<int32> Rejected;
+                    const auto Slices = UEmbeddingsDriver::SplitInput(Input, Options, &EstimateTokens, &Rejected);
+                    TestTrueExpr(Slices.Num() == 2);
+                    TestTrueExpr(Slices[0].First == 1 && Slices[0].Num == 2);
+                    TestTrueExpr(Slices[1].First == 5 && Slices[1].Num == 1);
+                    TestTrueExpr(Rejected == TArray<int32>({0, 3, 4}));
+                });
+
+            It("OnlyTransientErrorsShouldBeRetried",
+                [this]()
+                {
+                    TestTrueExpr(UEmbeddingsDriver::IsRetryable(
+                        R"({"error":{"message":"Rate limit reached","type":"requests","code":"rate_limit_exceeded"}})"));
+                    TestTrueExpr(UEmbeddingsDriver::IsRetryable(R"({"error":{"message":"Overloaded","type":"server_error","code":null}})"));
+                    TestTrueExpr(UEmbeddingsDriver::IsRetryable("<html>502 Bad Gateway</html>"));
+                    TestTrueExpr(UEmbeddingsDriver::IsRetryable("ConnectionError"));
+
+                    TestTrueExpr(!UEmbeddingsDriver::IsRetryable(
+                        R"({"error":{"message":"Too long","type":"invalid_request_error","code":null}})"));
+                    TestTrueExpr(!UEmbeddingsDriver::IsRetryable(
+                        R"({"error":{"message":"Quota","type":"insufficient_quota","code":"insufficient_quota"}})"));
+                    TestTrueExpr(!UEmbeddingsDriver::IsRetryable(
+                        R"({"error":{"message":"Bad key","type":"invalid_request_error","code":"invalid_api_key"}})"));
+                });
+
+            It("SlicesShouldBeMergedInOriginalOrder",
+                [this]()
+                {
+                    FEmbeddingsResponse Merged;
+                    Merged.Data.SetNum(4);
+
+                    FEmbeddingsResponse Second;
+                    Second.Model = "text-embedding-3-small";
+                    Second.Usage.Prompt_Tokens = Second.Usage.Total_Tokens = 2;
+                    Second.Data.SetNum(2);
+                    Second.Data[0].Index = 1;
+                    Second.Data[0].Embedding = {4.0f};
+                    Second.Data[1].Index = 0;
+                    Second.Data[1].Embedding = {3.0f};
+
+                    FEmbeddingsResponse First;
+                    First.Usage.Prompt_Tokens = First.Usage.Total_Tokens = 3;
+                    First.Data.SetNum(2);
+                    First.Data[0].Index = 0;
+                    First.Data[0].Embedding = {1.0f};
+                    First.Data[1].Index = 1;
+                    First.Data[1].Embedding = {2.0f};
+
+                    TestTrueExpr(UEmbeddingsDriver::MergeSlice(Merged, {2, 2}, Second));
+                    TestTrueExpr(UEmbeddingsDriver::MergeSlice(Merged, {0, 2}, First));
+
+                    for (int32 Index = 0; Index < 4; ++Index)
+                    {
+                        TestTrueExpr(Merged.Data[Index].Index == Index);
+                        TestTrueExpr(Merged.Data[Index].Embedding[0] == Index + 1.0f);
+                    }
+                    TestTrueExpr(Merged.Usage.Prompt_Tokens == 5);
+                    TestTrueExpr(Merged.Usage.Total_Tokens == 5);
+                    TestTrueExpr(Merged.Model.Equals("text-embedding-3-small"));
+                });
+
+            It("MismatchedResponseShouldBeRejected",
+                [this]()
+                {
+                    FEmbeddingsResponse Merged;
+                    Merged.Data.SetNum(2);
+
+                    FEmbeddingsResponse Response;
+                    Response.Data.SetNum(1);
+                    TestTrueExpr(!UEmbeddingsDriver::MergeSlice(Merged, {0, 2}, Response));
+
+                    Response.Data.SetNum(2);
+                    Response.Data[1].Index = 5;
+                    TestTrueExpr(!UEmbeddingsDriver::MergeSlice(Merged, {0, 2}, Response));
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,105 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "FuncLib/EnumNameTable.h"
+#include "FuncLib/OpenAIFuncLib.h"
+
+DEFINE_SPEC(FEnumNameTableSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+enum class ETestEnum : uint8
+{
+    Empty,
+    Unnamed,
+    Alias,
+    Last
+};
+
+constexpr TEnumName<ETestEnum> TestNames[]{
+    {ETestEnum::Empty, TEXT("")},
+    {ETestEnum::Alias, TEXT("alias")},
+    {ETestEnum::Alias, TEXT("other")},
+    {ETestEnum::Last, TEXT("Last-Name")}};
+
+using FTestTable = TEnumNameTable<TestNames>;
+using FTestTableIgnoreCase = TEnumNameTable<TestNames, ESearchCase::IgnoreCase>;
+}  // namespace
+
+void FEnumNameTableSpec::Define()
+{
+    Describe("EnumNameTable",
+        [this]()
+        {
+            It("EveryNameShouldBeFoundBothWays",
+                [this]()
+                {
+                    TestTrueExpr(FTestTable::Num() == 4);
+                    for (const TEnumName<ETestEnum>& Name : TestNames)
+                    {
+                        TestTrueExpr(FTestTable::FindValue(Name.Name).Get(ETestEnum::Unnamed) == Name.Value);
+                        TestTrueExpr(FTestTable::FindName(Name.Value).IsSet());
+                    }
+                    TestTrueExpr(FTestTable::FindName(ETestEnum::Empty).GetValue().IsEmpty());
+                    TestTrueExpr(FTestTable::FindName(ETestEnum::Last).GetValue().Equals(TEXT("Last-Name")));
+                });
+
+            It("FirstNameOfTheValueShouldBeUsed",
+                [this]() { TestTrueExpr(FTestTable::FindName(ETestEnum::Alias).GetValue().Equals(TEXT("alias"))); });
+
+            It("UnknownNamesAndValuesShouldNotBeFound",
+                [this]()
+                {
+                    TestTrueExpr(!FTestTable::FindName(ETestEnum::Unnamed).IsSet());
+                    TestTrueExpr(!FTestTable::FindName(static_cast<ETestEnum>(200)).IsSet());
+                    for (const TCHAR* Name : {TEXT("unnamed"), TEXT("alia"), TEXT("aliass"), TEXT(" "), TEXT("ALIAS")})
+                    {
+                        TestTrueExpr(!FTestTable::FindValue(Name).IsSet());
+                    }
+                });
+
+            It("CaseShouldBeIgnoredIfRequested",
+                [this]()
+                {
+                    TestTrueExpr(FTestTableIgnoreCase::FindValue(TEXT("ALIAS")).Get(ETestEnum::Unnamed) == ETestEnum::Alias);
+                    TestTrueExpr(FTestTableIgnoreCase::FindValue(TEXT("last-name")).Get(ETestEnum::Unnamed) == ETestEnum::Last);
+                    TestTrueExpr(!FTestTable::FindValue(TEXT("last-name")).IsSet());
+                });
+
+            It("ServerValuesShouldBeFoundWithoutAsserting",
+                [this]()
+                {
+                    TestTrueExpr(UOpenAIFuncLib::FindOpenAIRole(TEXT("Assistant")).Get(ERole::User) == ERole::Assistant);
+                    TestTrueExpr(!UOpenAIFuncLib::FindOpenAIRole(TEXT("developer")).IsSet());
+                    TestTrueExpr(UOpenAIFuncLib::FindOpenAIFinishReason(TEXT("tool_calls")).Get(EOpenAIFinishReason::Null) ==
+                                 EOpenAIFinishReason::Tool_Calls);
+                    TestTrueExpr(!UOpenAIFuncLib::FindOpenAIFinishReason(TEXT("function_call")).IsSet());
+                });
+
+            It("ImageEnumsShouldBeConvertedBothWays",
+                [this]()
+                {
+                    for (const EImageSizeDalle3 Size : {Size_1024x1024, Size_1792x1024, Size_1024x1792})
+                    {
+                        const FString Name = UOpenAIFuncLib::OpenAIImageSizeDalle3ToString(Size);
+                        TestTrueExpr(UOpenAIFuncLib::StringToOpenAIImageSizeDalle3(Name) == Size);
+                    }
+                    for (const EOpenAIImageStyle Style : {Vivid, Natural})
+                    {
+                        const FString Name = UOpenAIFuncLib::OpenAIImageStyleToString(Style);
+                        TestTrueExpr(UOpenAIFuncLib::StringToOpenAIImageStyle(Name) == Style);
+                    }
+                    TestTrueExpr(UOpenAIFuncLib::ModelSupportsVision(TEXT("gpt-4o")));
+                    TestTrueExpr(UOpenAIFuncLib::ModelSupportsVision(TEXT("gpt-4o-mini")));
+                    TestTrueExpr(UOpenAIFuncLib::ModelSupportsVision(TEXT("GPT-4O")));
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,97 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "IO/FileManifest.h"
+#include "Provider/Types/FileTypes.h"
+
+DEFINE_SPEC(FFileManifestSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FFileManifestSpec::Define()
+{
+    Describe("FileManifest",
+        [this]()
+        {
+            const FString TestDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("FileManifest"));
+            const FString ManifestPath = FPaths::Combine(TestDir, TEXT("FileManifest.json"));
+
+            AfterEach([TestDir]() { IFileManager::Get().DeleteDirectory(*TestDir, false, true); });
+
+            It("HashShouldDependOnContentOnly",
+                [this, TestDir]()
+                {
+                    const FString FirstFile = FPaths::Combine(TestDir, TEXT("first.jsonl"));
+                    const FString SecondFile = FPaths::Combine(TestDir, TEXT("second.jsonl"));
+                    const FString ThirdFile = FPaths::Combine(TestDir, TEXT("third.jsonl"));
+                    FFileHelper::SaveStringToFile(FString("{\"prompt\":\"hello\"}"), *FirstFile);
+                    FFileHelper::SaveStringToFile(FString("{\"prompt\":\"hello\"}"), *SecondFile);
+                    FFileHelper::SaveStringToFile(FString("{\"prompt\":\"world\"}"), *ThirdFile);
+
+                    const FString FirstHash = FFileManifest::HashFile(FirstFile);
+                    TestTrueExpr(!FirstHash.IsEmpty());
+                    TestTrueExpr(FirstHash.Equals(FFileManifest::HashFile(SecondFile)));
+                    TestTrueExpr(!FirstHash.Equals(FFileManifest::HashFile(ThirdFile)));
+                    TestTrueExpr(FFileManifest::HashFile(FPaths::Combine(TestDir, TEXT("missing.jsonl"))).IsEmpty());
+                });
+
+            It("EntriesShouldBeKeyedByHashAndPurpose",
+                [this, ManifestPath]()
+                {
+                    FFileManifest Manifest(ManifestPath);
+                    Manifest.Add("hash", "batch", "file-1");
+
+                    FString FileId;
+                    TestTrueExpr(Manifest.Find("hash", "batch", FileId));
+                    TestTrueExpr(FileId.Equals("file-1"));
+                    TestTrueExpr(!Manifest.Find("hash", "fine-tune", FileId));
+                });
+
+            It("EntriesShouldBePersisted",
+                [this, ManifestPath]()
+                {
+                    {
+                        FFileManifest Manifest(ManifestPath);
+                        Manifest.Add("hash-1", "batch", "file-1");
+                        Manifest.Add("hash-2", "vision", "file-2");
+                    }
+
+                    FFileManifest Manifest(ManifestPath);
+                    FString FileId;
+                    TestTrueExpr(Manifest.Num() == 2);
+                    TestTrueExpr(Manifest.Find("hash-2", "vision", FileId));
+                    TestTrueExpr(FileId.Equals("file-2"));
+                });
+
+            It("DeletedAndMissingFilesShouldBeEvicted",
+                [this, ManifestPath]()
+                {
+                    FFileManifest Manifest(ManifestPath);
+                    Manifest.Add("hash-1", "batch", "file-1");
+                    Manifest.Add("hash-2", "batch", "file-2");
+                    Manifest.Add("hash-3", "batch", "file-3");
+
+                    Manifest.RemoveFile("file-1");
+                    TestTrueExpr(Manifest.Num() == 2);
+
+                    FOpenAIFile RemoteFile;
+                    RemoteFile.ID = "file-2";
+                    RemoteFile.Status = "processed";
+                    Manifest.Reconcile({RemoteFile});
+
+                    FString FileId;
+                    TestTrueExpr(Manifest.Num() == 1);
+                    TestTrueExpr(Manifest.Find("hash-2", "batch", FileId));
+                    TestTrueExpr(!Manifest.Find("hash-3", "batch", FileId));
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,194 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Embeddings/HNSWIndex.h"
+#include "Embeddings/EmbeddingMatrix.h"
+
+DEFINE_SPEC(FHNSWIndexSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 Dimensions = 32;
+constexpr int32 NumVectors = 2000;
+constexpr int32 NumQueries = 50;
+constexpr int32 K = 10;
+
+TArray<float> MakeRandomVectors(FRandomStream& Random, int32 Num)
+{
+    TArray<float> Vectors;
+    Vectors.SetNumUninitialized(Num * Dimensions);
+    for (float& Value : Vectors)
+    {
+        Value = Random.FRandRange(-1.0f, 1.0f);
+    }
+    return Vectors;
+}
+
+TArray<int64> MakeIds(int32 Num, int64 FirstId)
+{
+    TArray<int64> Ids;
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        Ids.Add(FirstId + Index);
+    }
+    return Ids;
+}
+}  // namespace
+
+void FHNSWIndexSpec::Define()
+{
+    Describe("HNSWIndex",
+        [this]()
+        {
+            const FString TestDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("HNSWIndex"));
+
+            AfterEach([TestDir]() { IFileManager::Get().DeleteDirectory(*TestDir, false, true); });
+
+            It("RecallShouldBeCloseToBruteForce",
+                [this]()
+                {
+                    FRandomStream Random(7);
+                    const TArray<float> Vectors = MakeRandomVectors(Random, NumVectors);
+                    const TArray<float> Queries = MakeRandomVectors(Random, NumQueries);
+                    const int64 FirstId = 1000;
+
+                    FHNSWIndex Index(Dimensions);
+                    TestTrueExpr(Index.Build(MakeIds(NumVectors, FirstId), Vectors));
+                    TestTrueExpr(Index.Num() == NumVectors);
+
+                    FEmbeddingMatrix Matrix(Dimensions);
+                    for (int32 Row = 0; Row < NumVectors; ++Row)
+                    {
+                        Matrix.Add(MakeArrayView(Vectors.GetData() + Row * Dimensions, Dimensions));
+                    }
+
+                    int32 NumFound{0};
+                    for (int32 Query = 0; Query < NumQueries; ++Query)
+                    {
+                        const auto QueryView = MakeArrayView(Queries.GetData() + Query * Dimensions, Dimensions);
+                        const TArray<FVectorSearchResult> Results = Index.Search(QueryView, K, 128);
+                        TestTrueExpr(Results.Num() == K);
+
+                        for (const FScoredVector& Expected : Matrix.TopK(QueryView, K))
+                        {
+                            NumFound += Results.ContainsByPredicate(
+                                [&](const FVectorSearchResult& Result) { return Result.Id == FirstId + Expected.Index; }) ? 1 : 0;
+                        }
+                    }
+                    TestTrueExpr(NumFound >= NumQueries * K * 9 / 10);
+                });
+
+            It("ResultsShouldBeSortedBestFirst",
+                [this]()
+                {
+                    FRandomStream Random(11);
+                    FHNSWIndex Index(Dimensions);
+                    Index.Build(MakeIds(NumVectors, 0), MakeRandomVectors(Random, NumVectors));
+
+                    const TArray<FVectorSearchResult> Results = Index.Search(MakeRandomVectors(Random, 1), K);
+                    for (int32 Result = 1; Result < Results.Num(); ++Result)
+                    {
+                        TestTrueExpr(Results[Result - 1].Score >= Results[Result].Score);
+                    }
+                });
+
+            It("LoadedIndexShouldGiveTheSameResults",
+                [this, TestDir]()
+                {
+                    const FString FilePath = FPaths::Combine(TestDir, TEXT("index.hnsw"));
+                    FRandomStream Random(13);
+                    const TArray<float> Query = MakeRandomVectors(Random, 1);
+
+                    FHNSWParams Params;
+                    Params.M = 8;
+                    Params.Metric = EVectorMetric::L2;
+                    FHNSWIndex Index(Dimensions, Params);
+                    Index.Build(MakeIds(NumVectors, 0), MakeRandomVectors(Random, NumVectors));
+                    TestTrueExpr(Index.Save(FilePath));
+
+                    FHNSWIndex Loaded(1);
+                    TestTrueExpr(Loaded.Load(FilePath));
+                    TestTrueExpr(Loaded.Num() == NumVectors);
+                    TestTrueExpr(Loaded.GetDimensions() == Dimensions);
+                    TestTrueExpr(Loaded.GetParams().M == 8);
+
+                    const TArray<FVectorSearchResult> Expected = Index.Search(Query, K);
+                    const TArray<FVectorSearchResult> Actual = Loaded.Search(Query, K);
+                    TestTrueExpr(Expected.Num() == Actual.Num());
+                    for (int32 Result = 0; Result < Expected.Num() && Result < Actual.Num(); ++Result)
+                    {
+                        TestTrueExpr(Expected[Result].Id == Actual[Result].Id);
+                    }
+
+                    // the mapped data is copied on the first write
+                    TestTrueExpr(Loaded.Add(NumVectors, Query));
+                    const TArray<FVectorSearchResult> AfterAdd = Loaded.Search(Query, 1);
+                    TestTrueExpr(AfterAdd.Num() == 1 && AfterAdd[0].Id == NumVectors);
+                });
+
+            It("InvalidFileShouldNotBeLoaded",
+                [this, TestDir]()
+                {
+                    const FString FilePath = FPaths::Combine(TestDir, TEXT("missing.hnsw"));
+                    FHNSWIndex Index(Dimensions);
+                    TestTrueExpr(!Index.Load(FilePath));
+                    TestTrueExpr(Index.Num() == 0);
+                });
+
+            It("CorruptedFileShouldLeaveTheIndexAsItIs",
+                [this, TestDir]()
+                {
+                    const FString FilePath = FPaths::Combine(TestDir, TEXT("corrupted.hnsw"));
+                    FRandomStream Random(17);
+                    FHNSWIndex Saved(Dimensions * 2);
+                    Saved.Build(MakeIds(100, 1000), MakeRandomVectors(Random, 200));
+                    TestTrueExpr(Saved.Save(FilePath));
+                    TArray<uint8> Data;
+                    TestTrueExpr(FFileHelper::LoadFileToArray(Data, *FilePath));
+
+                    FHNSWIndex Index(Dimensions);
+                    Index.Build(MakeIds(NumVectors, 0), MakeRandomVectors(Random, NumVectors));
+                    const TArray<float> Query = MakeRandomVectors(Random, 1);
+                    const TArray<FVectorSearchResult> Expected = Index.Search(Query, K);
+                    const auto TestUnchanged = [&]()
+                    {
+                        TestTrueExpr(Index.Num() == NumVectors);
+                        TestTrueExpr(Index.GetDimensions() == Dimensions);
+                        const TArray<FVectorSearchResult> Actual = Index.Search(Query, K);
+                        TestTrueExpr(Actual.Num() == Expected.Num());
+                        for (int32 Result = 0; Result < Expected.Num() && Result < Actual.Num(); ++Result)
+                        {
+                            TestTrueExpr(Actual[Result].Id == Expected[Result].Id);
+                        }
+                    };
+
+                    // a crash in the middle of a write
+                    TArray<uint8> Truncated(Data.GetData(), Data.Num() / 2);
+                    FFileHelper::SaveArrayToFile(Truncated, *FilePath);
+                    TestTrueExpr(!Index.Load(FilePath));
+                    TestUnchanged();
+
+                    // the first base link block starts at the offset of the fourth section in the header,
+                    // its first link points past the nodes
+                    constexpr int32 BaseLinksOffsetInHeader = 80;
+                    int64 BaseLinksOffset{};
+                    FMemory::Memcpy(&BaseLinksOffset, Data.GetData() + BaseLinksOffsetInHeader, sizeof(int64));
+                    const int32 BadBlock[] = {1, 100};
+                    FMemory::Memcpy(Data.GetData() + BaseLinksOffset, BadBlock, sizeof(BadBlock));
+                    FFileHelper::SaveArrayToFile(Data, *FilePath);
+                    TestTrueExpr(!Index.Load(FilePath));
+                    TestUnchanged();
+                });
+        });
+}
+
+#endif
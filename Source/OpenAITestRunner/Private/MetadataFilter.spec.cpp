@@ -0,0 +1,265 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Embeddings/RoaringBitmap.h"
+#include "Embeddings/MetadataTable.h"
+#include "Embeddings/EmbeddingMatrix.h"
+#include "Embeddings/HNSWIndex.h"
+
+DEFINE_SPEC(FMetadataFilterSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+constexpr int32 Dimensions = 16;
+
+FRoaringBitmap MakeRandomBitmap(FRandomStream& Random, uint32 MaxValue, int32 Num, TSet<uint32>& Reference)
+{
+    FRoaringBitmap Bitmap;
+    for (int32 Index = 0; Index < Num; ++Index)
+    {
+        const uint32 Value = static_cast<uint32>(Random.RandRange(0, static_cast<int32>(MaxValue)));
+        Bitmap.Add(Value);
+        Reference.Add(Value);
+    }
+    return Bitmap;
+}
+
+bool Matches(const FRoaringBitmap& Bitmap, const TSet<uint32>& Reference)
+{
+    TArray<uint32> Expected = Reference.Array();
+    Expected.Sort();
+    return Bitmap.Num() == Reference.Num() && Bitmap.ToArray() == Expected;
+}
+
+TArray<float> MakeRandomVectors(FRandomStream& Random, int32 Num)
+{
+    TArray<float> Vectors;
+    Vectors.SetNumUninitialized(Num * Dimensions);
+    for (float& Value : Vectors)
+    {
+        Value = Random.FRandRange(-1.0f, 1.0f);
+    }
+    return Vectors;
+}
+}  // namespace
+
+void FMetadataFilterSpec::Define()
+{
+    Describe("RoaringBitmap",
+        [this]()
+        {
+            It("SetOperationsShouldMatchReferenceSetsForSparseAndDenseChunks",
+                [this]()
+                {
+                    FRandomStream Random(3);
+                    // 100 values per chunk stay arrays, 20000 values per chunk become bitmaps
+                    for (const int32 Num : {300, 60000})
+                    {
+                        TSet<uint32> ReferenceA, ReferenceB;
+                        const FRoaringBitmap A = MakeRandomBitmap(Random, 3 * 65536, Num, ReferenceA);
+                        const FRoaringBitmap B = MakeRandomBitmap(Random, 3 * 65536, Num, ReferenceB);
+                        TestTrueExpr(Matches(A, ReferenceA));
+
+                        TestTrueExpr(Matches(A & B, ReferenceA.Intersect(ReferenceB)));
+                        TestTrueExpr(Matches(A | B, ReferenceA.Union(ReferenceB)));
+                        TestTrueExpr(Matches(FRoaringBitmap(A).AndNot(B), ReferenceA.Difference(ReferenceB)));
+                        TestTrueExpr((A | B) == (B | A));
+                    }
+                });
+
+            It("RangesAndRemovalsShouldBeApplied",
+                [this]()
+                {
+                    FRoaringBitmap Bitmap = FRoaringBitmap::MakeRange(10, 200000);
+                    TestTrueExpr(Bitmap.Num() == 199990);
+                    TestTrueExpr(!Bitmap.Contains(9));
+                    TestTrueExpr(Bitmap.Contains(10));
+                    TestTrueExpr(Bitmap.Contains(65536));
+                    TestTrueExpr(Bitmap.Contains(199999));
+                    TestTrueExpr(!Bitmap.Contains(200000));
+
+                    for (uint32 Value = 0; Value < 200000; Value += 2)
+                    {
+                        Bitmap.Remove(Value);
+                    }
+                    TestTrueExpr(Bitmap.Num() == 99995);
+                    TestTrueExpr(!Bitmap.Contains(100));
+                    TestTrueExpr(Bitmap.Contains(101));
+
+                    Bitmap.AndNot(FRoaringBitmap::MakeRange(0, 200000));
+                    TestTrueExpr(Bitmap.IsEmpty());
+                });
+        });
+
+    Describe("MetadataTable",
+        [this]()
+        {
+            It("FiltersShouldBeCompiledIntoMatchingRows",
+                [this]()
+                {
+                    FMetadataTable Table;
+                    const TArray<FString> Regions{"North", "South", "East"};
+                    for (int32 Row = 0; Row < 1000; ++Row)
+                    {
+                        Table.SetTag(Row, "Region", Regions[Row % 3]);
+                        Table.SetInt(Row, "Chapter", Row % 10);
+                        Table.SetBool(Row, "Spoiler", Row % 7 == 0);
+                    }
+
+                    const FRoaringBitmap North = Table.Compile(FMetadataFilter::TagEquals("Region", "North"));
+                    TestTrueExpr(North.Num() == 334);
+
+                    const auto Filter = FMetadataFilter::TagIn("Region", {"North", "East"}) && FMetadataFilter::IntRange("Chapter", 2, 4) &&
+                                        !FMetadataFilter::IsTrue("Spoiler");
+                    const FRoaringBitmap Rows = Table.Compile(Filter);
+                    int32 Expected{0};
+                    for (int32 Row = 0; Row < 1000; ++Row)
+                    {
+                        const bool Match = Row % 3 != 1 && Row % 10 >= 2 && Row % 10 <= 4 && Row % 7 != 0;
+                        Expected += Match ? 1 : 0;
+                        TestTrueExpr(Rows.Contains(Row) == Match);
+                    }
+                    TestTrueExpr(Rows.Num() == Expected);
+
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Region", "West")).IsEmpty());
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Unknown", "North")).IsEmpty());
+                    TestTrueExpr(Table.Compile(FMetadataFilter::IntEquals("Region", 1)).IsEmpty());
+                    TestTrueExpr(Table.Compile({}).Num() == 1000);
+                    TestTrueExpr(Table.Compile({}, 1200).Num() == 1200);
+                });
+
+            It("OverwrittenAndRemovedValuesShouldNotMatch",
+                [this]()
+                {
+                    FMetadataTable Table;
+                    Table.SetTag(0, "Npc", "Smith");
+                    Table.SetTag(1, "Npc", "Smith");
+                    Table.SetTag(1, "Npc", "Guard");
+                    Table.SetInt(2, "Level", 5);
+                    TestTrueExpr(!Table.SetInt(2, "Npc", 5));
+
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Npc", "Smith")).ToArray() == TArray<uint32>{0});
+
+                    Table.RemoveRow(0);
+                    FString Npc;
+                    TestTrueExpr(!Table.GetTag(0, "Npc", Npc));
+                    TestTrueExpr(Table.GetTag(1, "Npc", Npc) && Npc.Equals("Guard"));
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Npc", "Smith")).IsEmpty());
+                    TestTrueExpr(Table.Compile(FMetadataFilter::Exists("Npc")).ToArray() == TArray<uint32>{1});
+                });
+
+            It("TagsThatDifferOnlyInCaseShouldBeDistinct",
+                [this]()
+                {
+                    FMetadataTable Table;
+                    Table.SetTag(0, "Npc", "Smith");
+                    Table.SetTag(1, "Npc", "smith");
+
+                    FString Npc;
+                    TestTrueExpr(Table.GetTag(0, "Npc", Npc) && Npc.Equals("Smith", ESearchCase::CaseSensitive));
+                    TestTrueExpr(Table.GetTag(1, "Npc", Npc) && Npc.Equals("smith", ESearchCase::CaseSensitive));
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Npc", "Smith")).ToArray() == TArray<uint32>{0});
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Npc", "smith")).ToArray() == TArray<uint32>{1});
+                    TestTrueExpr(Table.Compile(FMetadataFilter::TagEquals("Npc", "SMITH")).IsEmpty());
+                });
+        });
+
+    Describe("FilteredSearch",
+        [this]()
+        {
+            It("MatrixShouldScoreFilteredRowsOnly",
+                [this]()
+                {
+                    FRandomStream Random(5);
+                    const int32 NumVectors = 3000;
+                    const TArray<float> Vectors = MakeRandomVectors(Random, NumVectors);
+                    const TArray<float> Query = MakeRandomVectors(Random, 1);
+
+                    FEmbeddingMatrix Matrix(Dimensions);
+                    FRoaringBitmap Filter;
+                    for (int32 Row = 0; Row < NumVectors; ++Row)
+                    {
+                        Matrix.Add(MakeArrayView(Vectors.GetData() + Row * Dimensions, Dimensions));
+                        if (Row % 5 == 0) Filter.Add(Row);
+                    }
+
+                    TArray<float> Scores;
+                    Matrix.Score(Query, Scores);
+                    for (int32 Row = 0; Row < NumVectors; ++Row)
+                    {
+                        if (Row % 5 != 0) Scores[Row] = -MAX_flt;
+                    }
+                    const TArray<FScoredVector> Expected = FEmbeddingMatrix::SelectTopK(Scores, 10);
+
+                    for (const EVectorQuantization Quantization : {EVectorQuantization::None, EVectorQuantization::Int8})
+                    {
+                        Matrix.SetQuantization(Quantization);
+                        const TArray<FScoredVector> Results = Matrix.TopK(Query, 10, Filter, 8);
+                        TestTrueExpr(Results.Num() == 10);
+                        for (int32 Index = 0; Index < Results.Num(); ++Index)
+                        {
+                            TestTrueExpr(Results[Index].Index % 5 == 0);
+                            TestTrueExpr(Results[Index].Index == Expected[Index].Index);
+                        }
+                    }
+                });
+
+            It("IndexShouldReturnFilteredNodesForBroadAndSelectiveFilters",
+                [this]()
+                {
+                    FRandomStream Random(9);
+                    const int32 NumVectors = 5000;
+                    const TArray<float> Vectors = MakeRandomVectors(Random, NumVectors);
+                    TArray<int64> Ids;
+                    for (int32 Node = 0; Node < NumVectors; ++Node)
+                    {
+                        Ids.Add(Node);
+                    }
+
+                    FHNSWIndex Index(Dimensions);
+                    Index.Build(Ids, Vectors);
+
+                    FEmbeddingMatrix Matrix(Dimensions);
+                    for (int32 Row = 0; Row < NumVectors; ++Row)
+                    {
+                        Matrix.Add(MakeArrayView(Vectors.GetData() + Row * Dimensions, Dimensions));
+                    }
+
+                    // every 2nd node is traversed (2500 > 64 * 2M), every 500th is scanned
+                    for (const int32 Step : {2, 500})
+                    {
+                        FRoaringBitmap Filter;
+                        for (int32 Node = 0; Node < NumVectors; Node += Step)
+                        {
+                            Filter.Add(Node);
+                        }
+
+                        int32 NumFound{0};
+                        const int32 NumQueries = 20;
+                        for (int32 Query = 0; Query < NumQueries; ++Query)
+                        {
+                            const TArray<float> QueryVector = MakeRandomVectors(Random, 1);
+                            const TArray<FVectorSearchResult> Results = Index.Search(QueryVector, 10, Filter, 64);
+                            TestTrueExpr(Results.Num() == 10);
+
+                            const TArray<FScoredVector> Expected = Matrix.TopK(QueryVector, 10, Filter);
+                            for (const FVectorSearchResult& Result : Results)
+                            {
+                                TestTrueExpr(Result.Id % Step == 0);
+                                const auto IsExpected = [&](const FScoredVector& Row) { return Row.Index == Result.Id; };
+                                NumFound += Expected.ContainsByPredicate(IsExpected) ? 1 : 0;
+                            }
+                        }
+                        TestTrueExpr(NumFound >= NumQueries * 10 * 9 / 10);
+                    }
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,133 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Containers/Ticker.h"
+#include "Provider/MicroBatcher.h"
+#include "OpenAIProviderFake.h"
+
+DEFINE_SPEC(FMicroBatcherSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+// data isn't in the order of the inputs, every item is found by its index
+const FString EmbeddingsResponse =
+    "{\"object\":\"list\",\"data\":["
+    "{\"object\":\"embedding\",\"index\":2,\"embedding\":[2.0]},"
+    "{\"object\":\"embedding\",\"index\":0,\"embedding\":[0.0]},"
+    "{\"object\":\"embedding\",\"index\":1,\"embedding\":[1.0]}],"
+    "\"model\":\"text-embedding-3-small\",\"usage\":{\"prompt_tokens\":3,\"total_tokens\":3}}";
+
+UOpenAIMicroBatcher* MakeBatcher(int32 MaxItems, const FTimespan& Window)
+{
+    auto* Batcher = NewObject<UOpenAIMicroBatcher>();
+    Batcher->SetProviderClass(UOpenAIProviderFake::StaticClass());
+    FMicroBatchingOptions Options;
+    Options.MaxItems = MaxItems;
+    Options.Window = Window;
+    Batcher->SetOptions(Options);
+    return Batcher;
+}
+}  // namespace
+
+void FMicroBatcherSpec::Define()
+{
+    Describe("MicroBatcher",
+        [this]()
+        {
+            BeforeEach(
+                []()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.Reset();
+                    Server.AddRoute("/embeddings", EmbeddingsResponse);
+                });
+
+            AfterEach([]() { FFakeHttpServer::Get().Reset(); });
+
+            It("BatchShouldBeSentWhenItIsFull",
+                [this]()
+                {
+                    auto* Batcher = MakeBatcher(3, FTimespan::FromHours(1.0));
+
+                    TMap<FString, TArray<float>> Results;
+                    int32 NumSucceeded{0};
+                    const auto Embed = [&](const FString& Input)
+                    {
+                        Batcher->Embed(Input,
+                            [&Results, &NumSucceeded, Input](const FEmbeddingsData& Data, bool Succeeded)
+                            {
+                                Results.Add(Input, Data.Embedding);
+                                NumSucceeded += Succeeded ? 1 : 0;
+                            });
+                    };
+
+                    Embed("zero");
+                    Embed("one");
+                    TestTrueExpr(Batcher->NumPendingItems() == 2);
+                    TestTrueExpr(Batcher->NumRequestsSent() == 0);
+
+                    Embed("two");
+                    TestTrueExpr(Batcher->NumPendingItems() == 0);
+                    TestTrueExpr(Batcher->NumRequestsSent() == 1);
+                    TestTrueExpr(FFakeHttpServer::Get().NumRequests("/embeddings") == 1);
+
+                    // every caller gets the item of its own input
+                    TestTrueExpr(NumSucceeded == 3);
+                    TestTrueExpr(Results.FindRef("zero") == TArray<float>({0.0f}));
+                    TestTrueExpr(Results.FindRef("one") == TArray<float>({1.0f}));
+                    TestTrueExpr(Results.FindRef("two") == TArray<float>({2.0f}));
+                });
+
+            It("BatchShouldBeSentWhenWindowElapses",
+                [this]()
+                {
+                    auto* Batcher = MakeBatcher(256, FTimespan::FromMilliseconds(5.0));
+
+                    TArray<TArray<float>> Results;
+                    Results.SetNum(3);
+                    for (int32 Index = 0; Index < 3; ++Index)
+                    {
+                        // the same input within a window is sent once
+                        const FString Input = Index == 2 ? TEXT("input-0") : FString::Printf(TEXT("input-%d"), Index);
+                        Batcher->Embed(Input, [&Results, Index](const FEmbeddingsData& Data, bool) { Results[Index] = Data.Embedding; });
+                    }
+
+                    FTSTicker::GetCoreTicker().Tick(0.001f);
+                    TestTrueExpr(Batcher->NumRequestsSent() == 0);
+                    TestTrueExpr(Batcher->NumPendingItems() == 3);
+
+                    FTSTicker::GetCoreTicker().Tick(0.01f);
+                    TestTrueExpr(Batcher->NumRequestsSent() == 1);
+                    TestTrueExpr(Batcher->NumPendingItems() == 0);
+                    TestTrueExpr(Results[0] == TArray<float>({0.0f}));
+                    TestTrueExpr(Results[1] == TArray<float>({1.0f}));
+                    TestTrueExpr(Results[2] == TArray<float>({0.0f}));
+                });
+
+            It("EveryCallerShouldBeNotifiedAboutFailedRequest",
+                [this]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.AddRoute("/embeddings",
+                        "{\"error\":{\"message\":\"Rate limit\",\"type\":\"requests\",\"code\":\"rate_limit_exceeded\"}}", true);
+                    auto* Batcher = MakeBatcher(256, FTimespan::FromHours(1.0));
+
+                    int32 NumFailed{0};
+                    for (const FString Input : {"zero", "one"})
+                    {
+                        Batcher->Embed(Input, [&NumFailed](const FEmbeddingsData&, bool Succeeded) { NumFailed += Succeeded ? 0 : 1; });
+                    }
+                    Batcher->Flush();
+                    TestTrueExpr(Batcher->NumRequestsSent() == 1);
+                    TestTrueExpr(NumFailed == 2);
+                });
+        });
+}
+
+#endif
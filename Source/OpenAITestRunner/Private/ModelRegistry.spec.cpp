@@ -0,0 +1,114 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Provider/ModelRegistry.h"
+#include "FuncLib/OpenAIFuncLib.h"
+
+DEFINE_SPEC(FModelRegistrySpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FModelRegistrySpec::Define()
+{
+    Describe("ModelRegistry",
+        [this]()
+        {
+            It("SnapshotsAndFineTunesShouldResolveToTheBaseModel",
+                [this]()
+                {
+                    const FModelRegistry Registry;
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4o-mini-2024-07-18")).Name.Equals(TEXT("gpt-4o-mini")));
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4o-2024-08-06")).Name.Equals(TEXT("gpt-4o")));
+                    TestTrueExpr(Registry.Find(TEXT("ft:gpt-4o-mini-2024-07-18:org:npc:9abc")).Name.Equals(TEXT("gpt-4o-mini")));
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4-1106-vision-preview")).Name.Equals(TEXT("gpt-4-1106-vision")));
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4-32k-0613")).Context_Window == 32768);
+                    TestTrueExpr(Registry.Find(TEXT("GPT-4O")).Name.Equals(TEXT("gpt-4o")));
+                });
+
+            It("UnknownModelsShouldGetTheDefaults",
+                [this]()
+                {
+                    const FModelRegistry Registry;
+                    TestTrueExpr(!Registry.IsKnown(TEXT("my-local-model")));
+                    TestTrueExpr(!Registry.IsKnown(TEXT("")));
+                    TestTrueExpr(&Registry.Find(TEXT("my-local-model")) == &Registry.GetDefaults());
+                    TestTrueExpr(Registry.GetEncoding(TEXT("my-local-model")) == EBPEEncoding::Cl100kBase);
+                });
+
+            It("CapabilitiesShouldMatchTheModel",
+                [this]()
+                {
+                    const FModelRegistry Registry;
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4o")).Vision);
+                    TestTrueExpr(!Registry.Find(TEXT("gpt-3.5-turbo")).Vision);
+                    TestTrueExpr(!Registry.Find(TEXT("gpt-4-vision-preview")).Response_Format);
+                    TestTrueExpr(!Registry.Find(TEXT("gpt-4-vision-preview")).Tools);
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4o-mini")).Max_Output_Tokens == 16384);
+                    TestTrueExpr(Registry.GetEncoding(TEXT("o3-mini")) == EBPEEncoding::O200kBase);
+                    TestTrueExpr(Registry.GetEncoding(TEXT("gpt-4-turbo")) == EBPEEncoding::Cl100kBase);
+                    TestTrueExpr(UOpenAIFuncLib::ModelSupportsVision(TEXT("gpt-4-vision-preview")));
+
+                    // previews don't inherit the capabilities of the released model they'd resolve to
+                    TestTrueExpr(!Registry.Find(TEXT("gpt-4-turbo-preview")).Vision);
+                    TestTrueExpr(Registry.Find(TEXT("gpt-4-turbo-preview")).Tools);
+                    TestTrueExpr(!Registry.Find(TEXT("o1-preview-2024-09-12")).Tools);
+                    TestTrueExpr(!Registry.Find(TEXT("o1-preview")).Vision);
+                });
+
+            It("FileShouldOverrideOnlyItsFields",
+                [this]()
+                {
+                    FModelRegistry Registry;
+                    const int32 NumBuiltIn = Registry.Num();
+                    AddExpectedError(TEXT("Model without a name"), EAutomationExpectedErrorFlags::Contains, 1);
+                    TestTrueExpr(Registry.LoadFromString(TEXT(R"({"models": [
+                        {"name": "gpt-4o", "max_output_tokens": 1000, "input_price": 1.5},
+                        {"name": "gpt-4o-npc", "tools": false},
+                        {"name": "my-model", "context_window": 32768, "tokenizer": "o200k_base"},
+                        {"context_window": 1}]})")));
+
+                    TestTrueExpr(Registry.Num() == NumBuiltIn + 2);
+
+                    const FModelCapabilities& GPT4O = Registry.Find(TEXT("gpt-4o"));
+                    TestTrueExpr(GPT4O.Max_Output_Tokens == 1000);
+                    TestTrueExpr(FMath::IsNearlyEqual(GPT4O.Input_Price, 1.5f));
+                    TestTrueExpr(GPT4O.Context_Window == 128000);
+
+                    const FModelCapabilities& NPC = Registry.Find(TEXT("gpt-4o-npc-2025-01-01"));
+                    TestTrueExpr(NPC.Name.Equals(TEXT("gpt-4o-npc")));
+                    TestTrueExpr(!NPC.Tools);
+                    TestTrueExpr(NPC.Vision);
+                    TestTrueExpr(NPC.Max_Output_Tokens == 1000);
+
+                    TestTrueExpr(Registry.Find(TEXT("my-model")).Context_Window == 32768);
+                    TestTrueExpr(Registry.GetEncoding(TEXT("my-model")) == EBPEEncoding::O200kBase);
+
+                    AddExpectedError(TEXT("Models should be an array"), EAutomationExpectedErrorFlags::Contains, 1);
+                    TestTrueExpr(!Registry.LoadFromString(TEXT("{\"models\": {}}")));
+                });
+
+            It("SharedRegistryShouldBeReplaceable",
+                [this]()
+                {
+                    const TSharedRef<const FModelRegistry> BuiltIn = FModelRegistry::Get();
+
+                    const TSharedRef<FModelRegistry> Registry = MakeShared<FModelRegistry>();
+                    FModelCapabilities Model;
+                    Model.Name = TEXT("gpt-4o");
+                    Model.Context_Window = 1000;
+                    Registry->Add(Model);
+                    FModelRegistry::Set(Registry);
+
+                    TestTrueExpr(FModelRegistry::Get()->Find(TEXT("gpt-4o")).Context_Window == 1000);
+                    TestTrueExpr(BuiltIn->Find(TEXT("gpt-4o")).Context_Window != 1000);
+
+                    FModelRegistry::Set(BuiltIn);
+                });
+        });
+}
+
+#endif
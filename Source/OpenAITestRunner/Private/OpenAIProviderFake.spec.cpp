@@ -7,6 +7,7 @@
 #include "OpenAIProviderFake.h"
 #include "Provider/Types/ModelTypes.h"
 #include "Provider/Types/CommonTypes.h"
+#include "Provider/ChatStream.h"
 
 DEFINE_SPEC(FOpenAIProviderFake, "OpenAI.Provider",
     EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority)
@@ -164,7 +165,111 @@ void FOpenAIProviderFake::Define()
                         "customer service, virtual assistants, and language learning."));
                 });
 
-            xIt("ChatCompletionStreamShouldBeParsedCorrectly", [this]() { unimplemented(); });
+            It("ChatCompletionStreamShouldBeParsedCorrectly",
+                [this]()
+                {
+                    TArray<FChatCompletionStreamResponse> StreamResponses;
+                    FString StreamContent;
+                    bool StreamCompleted{false};
+                    auto* OpenAIProvider = NewObject<UOpenAIProviderFake>();
+                    OpenAIProvider->OnCreateChatCompletionStreamCompleted().AddLambda(
+                        [&](const TArray<FChatCompletionStreamResponse>& Responses) { StreamResponses = Responses; });
+                    OpenAIProvider->OnCreateChatCompletionStreamUpdated().AddLambda(
+                        [&](const OpenAI::FChatStream& Stream, bool Completed)
+                        {
+                            StreamContent = Stream.FindMessage() ? Stream.FindMessage()->Content : FString{};
+                            StreamCompleted = Completed;
+                        });
+                    OpenAIProvider->SetResponse(
+                        "data: {\"id\":\"chatcmpl-xxxxxxxxxxxxxxxxxx\",\"object\":\"chat.completion.chunk\",\"created\":1686587980,"
+                        "\"model\":\"gpt-4\",\"choices\":[{\"index\":0,\"delta\":{\"role\":\"assistant\",\"content\":\"\"},"
+                        "\"finish_reason\":null}]}\n\n"
+                        "data: {\"id\":\"chatcmpl-xxxxxxxxxxxxxxxxxx\",\"object\":\"chat.completion.chunk\",\"created\":1686587980,"
+                        "\"model\":\"gpt-4\",\"choices\":[{\"index\":0,\"delta\":{\"content\":\"Unreal \"},\"finish_reason\":null}]}\n\n"
+                        "data: {\"id\":\"chatcmpl-xxxxxxxxxxxxxxxxxx\",\"object\":\"chat.completion.chunk\",\"created\":1686587980,"
+                        "\"model\":\"gpt-4\",\"choices\":[{\"index\":0,\"delta\":{\"content\":\"Engine\"},\"finish_reason\":null}]}\n\n"
+                        "data: {\"id\":\"chatcmpl-xxxxxxxxxxxxxxxxxx\",\"object\":\"chat.completion.chunk\",\"created\":1686587980,"
+                        "\"model\":\"gpt-4\",\"choices\":[{\"index\":0,\"delta\":{},\"finish_reason\":\"stop\"}]}\n\n"
+                        "data: [DONE]\n\n");
+
+                    FChatCompletion ChatCompletion;
+                    FMessage Message;
+                    Message.Role = "user";
+                    Message.Content = "What is Unreal Engine?";
+                    ChatCompletion.Messages.Add(Message);
+                    ChatCompletion.Model = "gpt-4";
+                    ChatCompletion.Stream = true;
+                    OpenAIProvider->CreateChatCompletion(ChatCompletion, FOpenAIAuth{});
+
+                    TestTrueExpr(StreamCompleted);
+                    TestTrueExpr(StreamContent.Equals("Unreal Engine"));
+                    TestTrueExpr(StreamResponses.Num() == 4);
+                    TestTrueExpr(StreamResponses[0].ID.Equals("chatcmpl-xxxxxxxxxxxxxxxxxx"));
+                    TestTrueExpr(StreamResponses[0].Model.Equals("gpt-4"));
+                    TestTrueExpr(StreamResponses[0].Choices[0].Delta.Role.Equals("assistant"));
+                    TestTrueExpr(StreamResponses[1].Choices[0].Delta.Content.Equals("Unreal "));
+                    TestTrueExpr(StreamResponses[2].Choices[0].Delta.Content.Equals("Engine"));
+                    TestTrueExpr(StreamResponses[3].Choices[0].Finish_Reason.Equals("stop"));
+                });
+
+            It("Base64EmbeddingsShouldBeDecodedCorrectly",
+                [this]()
+                {
+                    FEmbeddingsResponse EmbeddingsResponse;
+                    auto* OpenAIProvider = NewObject<UOpenAIProviderFake>();
+                    OpenAIProvider->OnCreateEmbeddingsCompleted().AddLambda([&](const FEmbeddingsResponse& Response)  //
+                        {                                                                                             //
+                            EmbeddingsResponse = Response;
+                        });
+                    // [1.0, -2.5, 0.125] as little-endian float32
+                    OpenAIProvider->SetResponse(
+                        "{\"object\":\"list\",\"data\":[{\"object\":\"embedding\",\"index\":0,\"embedding\":\"AACAPwAAIMAAAAA+\"}],"
+                        "\"model\":\"text-embedding-3-small\",\"usage\":{\"prompt_tokens\":5,\"total_tokens\":5}}");
+
+                    FEmbeddings Embeddings;
+                    Embeddings.Input = {"Hello"};
+                    Embeddings.Model = "text-embedding-3-small";
+                    OpenAIProvider->CreateEmbeddings(Embeddings, FOpenAIAuth{});
+
+                    TestTrueExpr(EmbeddingsResponse.Object.Equals("list"));
+                    TestTrueExpr(EmbeddingsResponse.Model.Equals("text-embedding-3-small"));
+                    TestTrueExpr(EmbeddingsResponse.Usage.Prompt_Tokens == 5);
+                    TestTrueExpr(EmbeddingsResponse.Usage.Total_Tokens == 5);
+                    TestTrueExpr(EmbeddingsResponse.Data.Num() == 1);
+                    TestTrueExpr(EmbeddingsResponse.Data[0].Object.Equals("embedding"));
+                    TestTrueExpr(EmbeddingsResponse.Data[0].Index == 0);
+                    TestTrueExpr(EmbeddingsResponse.Data[0].Embedding == TArray<float>({1.0f, -2.5f, 0.125f}));
+                });
+
+            It("FloatEmbeddingsShouldBeParsedCorrectly",
+                [this]()
+                {
+                    FEmbeddingsResponse EmbeddingsResponse;
+                    auto* OpenAIProvider = NewObject<UOpenAIProviderFake>();
+                    OpenAIProvider->OnCreateEmbeddingsCompleted().AddLambda([&](const FEmbeddingsResponse& Response)  //
+                        {                                                                                             //
+                            EmbeddingsResponse = Response;
+                        });
+                    OpenAIProvider->SetResponse(
+                        "{\"object\": \"list\", \"data\": ["
+                        "{\"object\": \"embedding\", \"index\": 1, \"embedding\": [0.5, -1e-3]},"
+                        "{\"object\": \"embedding\", \"index\": 0, \"embedding\": [-0.0071574226, 12.25E+1]}],"
+                        "\"model\": \"text-embedding-ada-002\", \"usage\": {\"prompt_tokens\": 8, \"total_tokens\": 8},"
+                        "\"extra\": [{}, null]}");
+
+                    FEmbeddings Embeddings;
+                    Embeddings.Input = {"Hello", "World"};
+                    Embeddings.Model = "text-embedding-ada-002";
+                    Embeddings.Encoding_Format = "float";
+                    OpenAIProvider->CreateEmbeddings(Embeddings, FOpenAIAuth{});
+
+                    TestTrueExpr(EmbeddingsResponse.Data.Num() == 2);
+                    TestTrueExpr(EmbeddingsResponse.Data[0].Index == 1);
+                    TestTrueExpr(EmbeddingsResponse.Data[0].Embedding == TArray<float>({0.5f, -1e-3f}));
+                    TestTrueExpr(EmbeddingsResponse.Data[1].Index == 0);
+                    TestTrueExpr(EmbeddingsResponse.Data[1].Embedding == TArray<float>({-0.0071574226f, 122.5f}));
+                    TestTrueExpr(EmbeddingsResponse.Usage.Total_Tokens == 8);
+                });
         });
 }
 
@@ -0,0 +1,178 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Provider/Paginator.h"
+#include "OpenAIProviderFake.h"
+
+DEFINE_SPEC(FPaginatorSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+const FString FirstPage =
+    "{\"object\":\"list\",\"data\":[{\"object\":\"fine_tuning.job.event\",\"id\":\"ev-5\"},"
+    "{\"object\":\"fine_tuning.job.event\",\"id\":\"ev-4\"}],\"has_more\":true}";
+const FString LastPage = "{\"object\":\"list\",\"data\":[{\"object\":\"fine_tuning.job.event\",\"id\":\"ev-3\"}],\"has_more\":false}";
+const FString ErrorResponse = "{\"error\":{\"message\":\"Job not found\",\"type\":\"invalid_request_error\",\"code\":\"not_found\"}}";
+
+TArray<FString> GetIds(const TArray<FFineTuningJobEventResponse>& Events)
+{
+    TArray<FString> Ids;
+    for (const auto& Event : Events)
+    {
+        Ids.Add(Event.ID);
+    }
+    return Ids;
+}
+
+TSharedRef<FFineTuningEventsPaginator> MakePaginator()
+{
+    const auto Paginator = FFineTuningEventsPaginator::Create(FOpenAIAuth{}, "ftjob-1", 2, UOpenAIProviderFake::StaticClass());
+    Paginator->SetProviderLogEnabled(false);
+    return Paginator;
+}
+}  // namespace
+
+void FPaginatorSpec::Define()
+{
+    Describe("Paginator",
+        [this]()
+        {
+            BeforeEach(
+                []()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.Reset();
+                    Server.AddRoute("after=ev-4", LastPage);
+                    Server.AddRoute("/events", FirstPage);
+                });
+
+            AfterEach([]() { FFakeHttpServer::Get().Reset(); });
+
+            It("NextPageShouldBePrefetched",
+                [this]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.SetHoldRequests(true);
+                    const auto Paginator = MakePaginator();
+
+                    TArray<FString> Ids;
+                    bool HasMore{false};
+                    const auto OnPage = [&](const TArray<FFineTuningJobEventResponse>& Items, bool HasMorePages)
+                    {
+                        Ids = GetIds(Items);
+                        HasMore = HasMorePages;
+                    };
+
+                    Paginator->Next(OnPage);
+                    TestTrueExpr(Ids.IsEmpty());
+                    TestTrueExpr(Server.ReleaseRequests() == 1);
+                    TestTrueExpr(Ids == TArray<FString>({"ev-5", "ev-4"}));
+                    TestTrueExpr(HasMore);
+
+                    // the second page is requested before the caller asks for it
+                    TestTrueExpr(Paginator->IsRequestInFlight());
+                    TestTrueExpr(Server.ReleaseRequests() == 1);
+                    TestTrueExpr(!Paginator->IsRequestInFlight());
+
+                    Paginator->Next(OnPage);
+                    TestTrueExpr(Ids == TArray<FString>({"ev-3"}));
+                    TestTrueExpr(!HasMore);
+                    TestTrueExpr(!Paginator->HasMore());
+                    TestTrueExpr(Server.NumHeldRequests() == 0);
+
+                    Paginator->Next(OnPage);
+                    TestTrueExpr(Ids.IsEmpty());
+                    TestTrueExpr(Server.NumRequests("/events") == 2);
+                });
+
+            It("FetchAllShouldCollectEveryPage",
+                [this]()
+                {
+                    const auto Paginator = MakePaginator();
+
+                    TArray<FString> Ids;
+                    Paginator->FetchAll([&](const TArray<FFineTuningJobEventResponse>& Items) { Ids = GetIds(Items); });
+                    TestTrueExpr(Ids == TArray<FString>({"ev-5", "ev-4", "ev-3"}));
+                });
+
+            It("FetchNewShouldWaitForPrefetch",
+                [this]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.SetHoldRequests(true);
+                    const auto Paginator = MakePaginator();
+
+                    Paginator->Next([](const TArray<FFineTuningJobEventResponse>&, bool) {});
+                    Server.ReleaseRequests();
+                    TestTrueExpr(Paginator->IsRequestInFlight());
+
+                    TArray<FString> NewIds;
+                    bool Fetched{false};
+                    const auto OnNew = [&](const TArray<FFineTuningJobEventResponse>& Items)
+                    {
+                        NewIds = GetIds(Items);
+                        Fetched = true;
+                    };
+
+                    // the prefetch goes on, the top of the list is requested after it
+                    Paginator->FetchNew(OnNew);
+                    TestTrueExpr(Server.NumRequests("/events") == 2);
+                    Server.ReleaseRequests();
+                    TestTrueExpr(!Fetched);
+                    TestTrueExpr(Server.NumRequests("/events") == 3);
+                    Server.ReleaseRequests();
+                    TestTrueExpr(Fetched);
+                    TestTrueExpr(NewIds == TArray<FString>({"ev-5", "ev-4"}));
+                    TestTrueExpr(Paginator->GetNewestId().Equals("ev-5"));
+
+                    Server.AddRoute("/events",
+                        "{\"object\":\"list\",\"data\":[{\"id\":\"ev-6\"},{\"id\":\"ev-5\"},{\"id\":\"ev-4\"}],\"has_more\":true}", true);
+                    Paginator->FetchNew(OnNew);
+                    Server.ReleaseRequests();
+                    TestTrueExpr(NewIds == TArray<FString>({"ev-6"}));
+                    TestTrueExpr(Paginator->GetNewestId().Equals("ev-6"));
+
+                    // the prefetched page is still delivered in order
+                    TArray<FString> Ids;
+                    Paginator->Next([&](const TArray<FFineTuningJobEventResponse>& Items, bool) { Ids = GetIds(Items); });
+                    TestTrueExpr(Ids == TArray<FString>({"ev-3"}));
+                });
+
+            It("ErrorShouldBeReportedAndPaginationShouldContinue",
+                [this]()
+                {
+                    FFakeHttpServer& Server = FFakeHttpServer::Get();
+                    Server.AddRoute("/events", ErrorResponse, true);
+                    const auto Paginator = MakePaginator();
+
+                    FString Error;
+                    Paginator->SetOnError([&](const FString& Content) { Error = Content; });
+
+                    bool Delivered{false};
+                    const auto OnPage = [&](const TArray<FFineTuningJobEventResponse>&, bool) { Delivered = true; };
+                    Paginator->Next(OnPage);
+                    TestTrueExpr(!Delivered);
+                    TestTrueExpr(Error.Contains("Job not found"));
+                    TestTrueExpr(!Paginator->IsRequestInFlight());
+                    TestTrueExpr(Paginator->HasMore());
+
+                    Paginator->Next(OnPage);
+                    TestTrueExpr(Delivered);
+
+                    Error.Empty();
+                    Server.AddRoute("/events", ErrorResponse, true);
+                    bool Fetched{false};
+                    Paginator->FetchNew([&](const TArray<FFineTuningJobEventResponse>&) { Fetched = true; });
+                    TestTrueExpr(!Fetched);
+                    TestTrueExpr(!Error.IsEmpty());
+                });
+        });
+}
+
+#endif
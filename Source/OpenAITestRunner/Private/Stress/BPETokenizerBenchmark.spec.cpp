@@ -0,0 +1,58 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Tokenizer/BPETokenizer.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_SPEC(FBPETokenizerBenchmark, "OpenAI.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::StressFilter | EAutomationTestFlags::LowPriority);
+
+using namespace OpenAI;
+
+void FBPETokenizerBenchmark::Define()
+{
+    Describe("BPETokenizer",
+        [this]()
+        {
+            It("CountingOf32MBOfTextOnOneThread",
+                [this]()
+                {
+                    for (const EBPEEncoding Encoding : {EBPEEncoding::Cl100kBase, EBPEEncoding::O200kBase})
+                    {
+                        const FBPETokenizer* Tokenizer = FBPETokenizer::Get(Encoding);
+                        if (!Tokenizer)
+                        {
+                            AddInfo(FString::Printf(TEXT("%s isn't found"), *FBPETokenizer::GetDefaultFilePath(Encoding)));
+                            continue;
+                        }
+
+                        constexpr int32 TextLength = 32 * 1024 * 1024;
+                        FRandomStream Random(1);
+                        FString Text;
+                        Text.Reserve(TextLength);
+                        while (Text.Len() < TextLength)
+                        {
+                            Text.Append(FString::ChrN(Random.RandRange(2, 10), 'a' + Random.RandHelper(26)));
+                            Text.AppendChar(Random.RandHelper(12) == 0 ? '.' : ' ');
+                            if (Random.RandHelper(20) == 0)
+                            {
+                                Text.Append(FString::FromInt(Random.RandHelper(100000))).Append(TEXT("\n"));
+                            }
+                        }
+
+                        const double StartTime = FPlatformTime::Seconds();
+                        const int32 Tokens = Tokenizer->Count(Text);
+                        const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+                        TestTrueExpr(Tokens > 0);
+                        AddInfo(FString::Printf(TEXT("%d: %d tokens, %.2f s, %.0f MB/s"), static_cast<int32>(Encoding), Tokens, Seconds,
+                            Text.Len() / (1024.0 * 1024.0) / Seconds));
+                    }
+                });
+        });
+}
+
+#endif
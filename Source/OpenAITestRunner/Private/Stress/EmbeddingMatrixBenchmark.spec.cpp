@@ -0,0 +1,70 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Embeddings/EmbeddingMatrix.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_SPEC(FEmbeddingMatrixBenchmark, "OpenAI.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::StressFilter | EAutomationTestFlags::LowPriority);
+
+using namespace OpenAI;
+
+void FEmbeddingMatrixBenchmark::Define()
+{
+    Describe("EmbeddingMatrix",
+        [this]()
+        {
+            It("TopKOver100kVectorsOf1536Dimensions",
+                [this]()
+                {
+                    constexpr int32 NumVectors = 100000;
+                    constexpr int32 Dimensions = 1536;
+                    constexpr int32 NumQueries = 20;
+                    constexpr int32 K = 10;
+
+                    FRandomStream Random(1);
+                    TArray<float> Vector;
+                    Vector.SetNumUninitialized(Dimensions);
+
+                    FEmbeddingMatrix Matrix(Dimensions);
+                    Matrix.Reserve(NumVectors);
+                    for (int32 Index = 0; Index < NumVectors; ++Index)
+                    {
+                        for (float& Value : Vector)
+                        {
+                            Value = Random.FRandRange(-1.0f, 1.0f);
+                        }
+                        Matrix.Add(Vector);
+                    }
+
+                    TArray<TArray<float>> Queries;
+                    for (int32 Index = 0; Index < NumQueries; ++Index)
+                    {
+                        Queries.Emplace(Matrix.GetRow(Random.RandHelper(NumVectors)));
+                    }
+
+                    for (const auto Quantization : {EVectorQuantization::None, EVectorQuantization::Int8, EVectorQuantization::Binary})
+                    {
+                        Matrix.SetQuantization(Quantization);
+
+                        const double StartTime = FPlatformTime::Seconds();
+                        int32 NumFound{0};
+                        for (const TArray<float>& Query : Queries)
+                        {
+                            const auto Results = Matrix.TopK(Query, K);
+                            NumFound += Results.Num();
+                        }
+                        const double QueryMs = (FPlatformTime::Seconds() - StartTime) * 1000.0 / NumQueries;
+
+                        TestTrueExpr(NumFound == NumQueries * K);
+                        AddInfo(FString::Printf(TEXT("Quantization %d: %.2f ms per query, %.1f MB"), static_cast<int32>(Quantization),
+                            QueryMs, Matrix.GetAllocatedSize() / (1024.0 * 1024.0)));
+                    }
+                });
+        });
+}
+
+#endif
@@ -0,0 +1,55 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Embeddings/TextChunker.h"
+#include "HAL/PlatformTime.h"
+
+DEFINE_SPEC(FTextChunkerBenchmark, "OpenAI.Benchmark",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::StressFilter | EAutomationTestFlags::LowPriority);
+
+using namespace OpenAI;
+
+void FTextChunkerBenchmark::Define()
+{
+    Describe("TextChunker",
+        [this]()
+        {
+            It("ChunkingOf128MBOfText",
+                [this]()
+                {
+                    constexpr int32 NumDocuments = 64;
+                    constexpr int32 DocumentLength = 1024 * 1024;
+
+                    FRandomStream Random(1);
+                    TArray<FTextDocument> Documents;
+                    for (int32 Index = 0; Index < NumDocuments; ++Index)
+                    {
+                        FTextDocument& Document = Documents.AddDefaulted_GetRef();
+                        Document.Name = FString::Printf(TEXT("Document%d"), Index);
+                        Document.Text.Reserve(DocumentLength);
+                        while (Document.Text.Len() < DocumentLength)
+                        {
+                            Document.Text.Append(FString::ChrN(Random.RandRange(2, 10), 'a' + Random.RandHelper(26)));
+                            Document.Text.AppendChar(Random.RandHelper(12) == 0 ? '.' : ' ');
+                            if (Random.RandHelper(200) == 0)
+                            {
+                                Document.Text.Append(TEXT("\n\n"));
+                            }
+                        }
+                    }
+
+                    const double StartTime = FPlatformTime::Seconds();
+                    const TArray<FTextChunk> Chunks = FTextChunker().Chunk(Documents);
+                    const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+                    const double MegaBytes = NumDocuments * DocumentLength * sizeof(TCHAR) / (1024.0 * 1024.0);
+                    TestTrueExpr(!Chunks.IsEmpty());
+                    AddInfo(FString::Printf(TEXT("%d chunks, %.2f s, %.0f MB/s"), Chunks.Num(), Seconds, MegaBytes / Seconds));
+                });
+        });
+}
+
+#endif
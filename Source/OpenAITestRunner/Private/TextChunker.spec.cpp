@@ -0,0 +1,220 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Embeddings/TextChunker.h"
+
+DEFINE_SPEC(FTextChunkerSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+namespace
+{
+FString MakeParagraph(FRandomStream& Random)
+{
+    static const TCHAR* Words[] = {TEXT("dragon"), TEXT("sword"), TEXT("the"), TEXT("ancient"), TEXT("keep"), TEXT("river"), TEXT("of"),
+        TEXT("merchant"), TEXT("guard"), TEXT("whispers"), TEXT("under"), TEXT("mountain")};
+
+    FString Paragraph;
+    const int32 NumSentences = Random.RandRange(1, 6);
+    for (int32 Sentence = 0; Sentence < NumSentences; ++Sentence)
+    {
+        const int32 NumWords = Random.RandRange(4, 20);
+        for (int32 Word = 0; Word < NumWords; ++Word)
+        {
+            Paragraph.Append(Words[Random.RandHelper(UE_ARRAY_COUNT(Words))]).AppendChar(Word + 1 < NumWords ? ' ' : '.');
+        }
+        Paragraph.AppendChar(' ');
+    }
+    return Paragraph;
+}
+
+FString MakeText(int32 NumParagraphs, int32 Seed)
+{
+    FRandomStream Random(Seed);
+    FString Text;
+    for (int32 Index = 0; Index < NumParagraphs; ++Index)
+    {
+        Text.Append(MakeParagraph(Random)).Append(TEXT("\n\n"));
+    }
+    return Text;
+}
+
+TArray<FString> GetTexts(TArrayView<const FTextDocument> Documents, TArrayView<const FTextChunk> Chunks)
+{
+    return FTextChunker::MakeInput(Documents, Chunks);
+}
+}  // namespace
+
+void FTextChunkerSpec::Define()
+{
+    Describe("TextChunker",
+        [this]()
+        {
+            It("ChunksShouldFitTargetAndCoverTheText",
+                [this]()
+                {
+                    FTextChunkerOptions Options;
+                    Options.TargetTokens = 50;
+                    Options.OverlapTokens = 10;
+                    const TArray<FTextDocument> Documents{{TEXT("Lore"), MakeText(100, 1)}, {TEXT("Items"), MakeText(30, 2)}};
+
+                    const TArray<FTextChunk> Chunks = FTextChunker(Options).Chunk(Documents);
+                    TestTrueExpr(!Chunks.IsEmpty());
+
+                    TArray<TBitArray<>> Covered;
+                    for (const FTextDocument& Document : Documents)
+                    {
+                        Covered.Emplace(false, Document.Text.Len());
+                    }
+
+                    for (int32 Index = 0; Index < Chunks.Num(); ++Index)
+                    {
+                        const FTextChunk& Chunk = Chunks[Index];
+                        TestTrueExpr(Chunk.Tokens <= Options.TargetTokens);
+                        TestTrueExpr(Chunk.Length > 0);
+                        Covered[Chunk.Document].SetRange(Chunk.Offset, Chunk.Length, true);
+
+                        if (Index > 0 && Chunks[Index - 1].Document == Chunk.Document)
+                        {
+                            // chunks move forward, the overlap is shorter than the previous chunk
+                            const FTextChunk& Previous = Chunks[Index - 1];
+                            TestTrueExpr(Chunk.Offset > Previous.Offset);
+                            TestTrueExpr(Chunk.Offset + Chunk.Length > Previous.Offset + Previous.Length);
+                        }
+                    }
+
+                    for (int32 Document = 0; Document < Documents.Num(); ++Document)
+                    {
+                        for (int32 Char = 0; Char < Documents[Document].Text.Len(); ++Char)
+                        {
+                            if (!Covered[Document][Char] && !FChar::IsWhitespace(Documents[Document].Text[Char]))
+                            {
+                                AddError(FString::Printf(TEXT("Character %d of document %d isn't in any chunk"), Char, Document));
+                                return;
+                            }
+                        }
+                    }
+                });
+
+            It("ConsecutiveChunksShouldOverlap",
+                [this]()
+                {
+                    FTextChunkerOptions Options;
+                    Options.TargetTokens = 40;
+                    Options.OverlapTokens = 20;
+                    // one long paragraph is split into sentences
+                    FRandomStream Random(3);
+                    FString Text;
+                    for (int32 Index = 0; Index < 20; ++Index)
+                    {
+                        Text.Append(MakeParagraph(Random));
+                    }
+                    const TArray<FTextDocument> Documents{{TEXT("Dialogue"), Text}};
+
+                    const TArray<FTextChunk> Chunks = FTextChunker(Options).Chunk(Documents);
+                    int32 NumOverlaps = 0;
+                    for (int32 Index = 1; Index < Chunks.Num(); ++Index)
+                    {
+                        NumOverlaps += Chunks[Index].Offset < Chunks[Index - 1].Offset + Chunks[Index - 1].Length ? 1 : 0;
+                    }
+                    TestTrueExpr(Chunks.Num() > 2);
+                    TestTrueExpr(NumOverlaps > 0);
+                });
+
+            It("MarkdownSectionsShouldStartNewChunks",
+                [this]()
+                {
+                    FTextChunkerOptions Options;
+                    Options.TargetTokens = 1000;
+                    Options.Format = ETextFormat::Markdown;
+                    const FString Text =
+                        TEXT("# Dragons\nThey sleep.\n\nThey wake.\n\n## Code\n```\nint A;\n\nint B;\n```\n# Swords\nSharp.");
+                    const TArray<FTextDocument> Documents{{TEXT("Guide.md"), Text}};
+
+                    const TArray<FString> Texts = GetTexts(Documents, FTextChunker(Options).Chunk(Documents));
+                    TestTrueExpr(Texts.Num() == 3);
+                    TestTrueExpr(Texts[0].Equals(TEXT("# Dragons\nThey sleep.\n\nThey wake.")));
+                    TestTrueExpr(Texts[1].Equals(TEXT("## Code\n```\nint A;\n\nint B;\n```")));
+                    TestTrueExpr(Texts[2].Equals(TEXT("# Swords\nSharp.")));
+                });
+
+            It("JsonShouldBeSplitBetweenTopLevelElements",
+                [this]()
+                {
+                    // commas and brackets inside the strings and the nested array don't split the element
+                    const FString Element =
+                        TEXT("{\"name\": \"Item, with comma\", \"tags\": [\"a\", \"b\"], \"text\": \"quote \\\" inside ]\"}");
+                    FTextChunkerOptions Options;
+                    Options.TargetTokens = EstimateTokens(Element) + 2;
+                    Options.TokenCounter = &EstimateTokens;
+                    Options.OverlapTokens = 0;
+                    Options.Format = ETextFormat::Json;
+                    const FString Text = FString::Printf(TEXT("[%s,\n%s,\n%s]"), *Element, *Element, *Element);
+                    const TArray<FTextDocument> Documents{{TEXT("Items.json"), Text}};
+
+                    const TArray<FString> Texts = GetTexts(Documents, FTextChunker(Options).Chunk(Documents));
+                    TestTrueExpr(Texts.Num() == 3);
+                    for (const FString& ChunkText : Texts)
+                    {
+                        TestTrueExpr(ChunkText.Contains(Element));
+                    }
+                });
+
+            It("ChunkIdsAfterAnEditShouldMostlyStayTheSame",
+                [this]()
+                {
+                    FTextChunkerOptions Options;
+                    Options.TargetTokens = 100;
+                    Options.OverlapTokens = 10;
+                    const FString Text = MakeText(300, 4);
+                    const FString EditedText = TEXT("A new opening paragraph about the keep.\n\n") + Text;
+
+                    const TArray<FTextDocument> Documents{{TEXT("Lore"), Text}, {TEXT("Lore"), EditedText}};
+                    const TArray<FTextChunk> Chunks = FTextChunker(Options).Chunk(Documents);
+
+                    TSet<TTuple<uint64, uint64>> OriginalIds;
+                    int32 NumOriginal = 0;
+                    for (const FTextChunk& Chunk : Chunks)
+                    {
+                        if (Chunk.Document != 0) continue;
+                        OriginalIds.Add({Chunk.Id.HashLow, Chunk.Id.HashHigh});
+                        ++NumOriginal;
+                    }
+
+                    int32 NumReused = 0;
+                    for (const FTextChunk& Chunk : Chunks)
+                    {
+                        NumReused += Chunk.Document == 1 && OriginalIds.Contains({Chunk.Id.HashLow, Chunk.Id.HashHigh}) ? 1 : 0;
+                    }
+                    TestTrueExpr(NumReused * 10 >= NumOriginal * 8);
+                });
+
+            It("BigDocumentShouldBeChunkedInBlocksDeterministically",
+                [this]()
+                {
+                    FTextChunkerOptions Options;
+                    Options.TargetTokens = 200;
+                    const TArray<FTextDocument> Documents{{TEXT("Big"), MakeText(30000, 5)}};
+                    TestTrueExpr(Documents[0].Text.Len() > 2 * 1024 * 1024);
+
+                    const FTextChunker Chunker(Options);
+                    const TArray<FTextChunk> Chunks = Chunker.Chunk(Documents);
+                    const TArray<FTextChunk> ChunksAgain = Chunker.Chunk(Documents);
+                    TestTrueExpr(Chunks.Num() == ChunksAgain.Num());
+                    for (int32 Index = 0; Index < Chunks.Num(); ++Index)
+                    {
+                        TestTrueExpr(Chunks[Index].Id == ChunksAgain[Index].Id);
+                        if (Index > 0)
+                        {
+                            TestTrueExpr(Chunks[Index].Offset > Chunks[Index - 1].Offset);
+                        }
+                    }
+                });
+        });
+}
+
+#endif
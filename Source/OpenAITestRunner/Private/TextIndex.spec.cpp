@@ -0,0 +1,108 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#if WITH_AUTOMATION_TESTS
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Embeddings/TextIndex.h"
+
+DEFINE_SPEC(FTextIndexSpec, "OpenAI",
+    EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter | EAutomationTestFlags::HighPriority);
+
+using namespace OpenAI;
+
+void FTextIndexSpec::Define()
+{
+    Describe("TextIndex",
+        [this]()
+        {
+            const FString TestDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("OpenAITests"), TEXT("TextIndex"));
+            const FString BasePath = FPaths::Combine(TestDir, TEXT("TextIndex"));
+
+            AfterEach([TestDir]() { IFileManager::Get().DeleteDirectory(*TestDir, false, true); });
+
+            It("SavedTextsShouldBeLoadedAndSearchable",
+                [this, BasePath]()
+                {
+                    const TArray<FTextIndexEntry> Entries{
+                        {TEXT("/Game/Lore.Lore:Dragon"), TEXT("The dragon sleeps under the mountain.")},
+                        {TEXT("/Game/Items.Items:Sword.Description"), TEXT("Ein Schwert, geschmiedet im Drachenfeuer – ünd scharf.")},
+                        {TEXT("/Game/Lore.Lore:Empty"), TEXT("")},
+                    };
+                    const TArray<int64> Ids{0, 1, 2};
+                    const TArray<float> Vectors{1.0f, 0.0f, 0.0f, 1.0f, 0.7f, 0.7f};
+
+                    FHNSWIndex Index(2);
+                    TestTrueExpr(Index.Build(Ids, Vectors));
+                    TestTrueExpr(FTextIndex::Save(BasePath, TEXT("text-embedding-3-small"), Entries, Index));
+
+                    FTextIndex TextIndex;
+                    TestTrueExpr(TextIndex.Load(BasePath));
+                    TestTrueExpr(TextIndex.Num() == 3);
+                    TestTrueExpr(TextIndex.GetDimensions() == 2);
+                    TestTrueExpr(TextIndex.GetModel().Equals(TEXT("text-embedding-3-small")));
+                    for (int32 Entry = 0; Entry < Entries.Num(); ++Entry)
+                    {
+                        TestTrueExpr(TextIndex.GetText(Entry).Equals(Entries[Entry].Text));
+                        TestTrueExpr(TextIndex.GetSource(Entry).Equals(Entries[Entry].Source));
+                        TestTrueExpr(TextIndex.GetHash(Entry) == FTextIndex::HashText(Entries[Entry].Text));
+                    }
+                    TestTrueExpr(TextIndex.GetText(3).IsEmpty());
+
+                    const TArray<FVectorSearchResult> Results = TextIndex.Search({0.0f, 1.0f}, 1);
+                    TestTrueExpr(Results.Num() == 1 && Results[0].Id == 1);
+                });
+
+            It("MismatchedVectorsShouldNotBeSaved",
+                [this, BasePath]()
+                {
+                    FHNSWIndex Index(2);
+                    Index.Add(0, {1.0f, 0.0f});
+                    const TArray<FTextIndexEntry> Entries{{TEXT("A"), TEXT("a")}, {TEXT("B"), TEXT("b")}};
+                    TestTrueExpr(!FTextIndex::Save(BasePath, TEXT("model"), Entries, Index));
+
+                    FTextIndex TextIndex;
+                    TestTrueExpr(!TextIndex.Load(BasePath));
+                    TestTrueExpr(!TextIndex.IsLoaded());
+                });
+
+            It("CorruptedOrMismatchedFilesShouldNotBeLoaded",
+                [this, TestDir, BasePath]()
+                {
+                    const TArray<FTextIndexEntry> Entries{{TEXT("A"), TEXT("a")}, {TEXT("B"), TEXT("b")}};
+                    FHNSWIndex Index(2);
+                    TestTrueExpr(Index.Build({0, 1}, {1.0f, 0.0f, 0.0f, 1.0f}));
+                    TestTrueExpr(FTextIndex::Save(BasePath, TEXT("model"), Entries, Index));
+                    TestTrueExpr(!IFileManager::Get().FileExists(*(BasePath + TEXT(".chunks.tmp"))));
+                    TestTrueExpr(!IFileManager::Get().FileExists(*(BasePath + TEXT(".hnsw.tmp"))));
+
+                    // text size of the first entry, the entries follow the 64-byte aligned header
+                    const FString ChunksPath = BasePath + TEXT(".chunks");
+                    TArray<uint8> Data;
+                    if (!TestTrueExpr(FFileHelper::LoadFileToArray(Data, *ChunksPath))) return;
+                    TArray<uint8> Corrupted = Data;
+                    const int32 TextSize = MAX_int32;
+                    FMemory::Memcpy(Corrupted.GetData() + 64 + 3 * sizeof(int64), &TextSize, sizeof(int32));
+                    FFileHelper::SaveArrayToFile(Corrupted, *ChunksPath);
+
+                    FTextIndex TextIndex;
+                    TestTrueExpr(!TextIndex.Load(BasePath));
+                    TestTrueExpr(!TextIndex.IsLoaded());
+
+                    // graph of another save, e.g. after a crash between the two renames
+                    FFileHelper::SaveArrayToFile(Data, *ChunksPath);
+                    const FString OtherBasePath = FPaths::Combine(TestDir, TEXT("Other"));
+                    const TArray<FTextIndexEntry> OtherEntries{{TEXT("A"), TEXT("a")}};
+                    FHNSWIndex OtherIndex(2);
+                    TestTrueExpr(OtherIndex.Build({0}, {1.0f, 0.0f}));
+                    TestTrueExpr(FTextIndex::Save(OtherBasePath, TEXT("model"), OtherEntries, OtherIndex));
+                    TestTrueExpr(IFileManager::Get().Copy(*(BasePath + TEXT(".hnsw")), *(OtherBasePath + TEXT(".hnsw"))) == COPY_OK);
+                    TestTrueExpr(!TextIndex.Load(BasePath));
+                });
+        });
+}
+
+#endif
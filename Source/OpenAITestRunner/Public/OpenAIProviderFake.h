@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Provider/OpenAIProvider.h"
+#include "Algo/Count.h"
 #include "OpenAIProviderFake.generated.h"
 
 class FFakeHttpResponse : public IHttpResponse
@@ -32,11 +33,87 @@ private:
     FString EffectiveURL;
 };
 
+/**
+  Responses of the fake requests by URL, shared by all fake providers,
+  e.g. by the ones that are created inside of the router, the batcher or the session subsystem.
+  Requests without a matching route get the response of their provider.
+*/
+class FFakeHttpServer
+{
+public:
+    static FFakeHttpServer& Get()
+    {
+        static FFakeHttpServer Server;
+        return Server;
+    }
+
+    /**
+      Routes are matched in the order they were added, a route with Once is removed after its first use
+      and is matched before the permanent ones, e.g. to change the list once.
+    */
+    void AddRoute(const FString& URLPart, const FString& Response, bool Once = false) { Routes.Add({URLPart, Response, Once}); }
+
+    bool FindResponse(const FString& URL, FString& Response)
+    {
+        int32 Index = Routes.IndexOfByPredicate([&](const FRoute& Route) { return Route.Once && URL.Contains(Route.URLPart); });
+        if (Index == INDEX_NONE)
+        {
+            Index = Routes.IndexOfByPredicate([&](const FRoute& Route) { return URL.Contains(Route.URLPart); });
+        }
+        if (Index == INDEX_NONE) return false;
+
+        Response = Routes[Index].Response;
+        if (Routes[Index].Once)
+        {
+            Routes.RemoveAt(Index);
+        }
+        return true;
+    }
+
+    /**
+      Held requests are completed by ReleaseRequests, e.g. to act while they are in flight.
+    */
+    void SetHoldRequests(bool Hold) { bHoldRequests = Hold; }
+    bool IsHoldingRequests() const { return bHoldRequests; }
+    void Hold(const FHttpRequestRef& Request) { HeldRequests.Add(Request); }
+    int32 NumHeldRequests() const { return HeldRequests.Num(); }
+
+    int32 ReleaseRequests();
+
+    void LogRequest(const FString& URL, const FString& Content) { Requests.Add({URL, Content}); }
+    int32 NumRequests(const FString& URLPart) const
+    {
+        return Algo::CountIf(Requests, [&](const TPair<FString, FString>& Request) { return Request.Key.Contains(URLPart); });
+    }
+    const TArray<TPair<FString, FString>>& GetRequests() const { return Requests; }
+
+    void Reset()
+    {
+        Routes.Empty();
+        HeldRequests.Empty();
+        Requests.Empty();
+        bHoldRequests = false;
+    }
+
+private:
+    struct FRoute
+    {
+        FString URLPart;
+        FString Response;
+        bool Once{false};
+    };
+
+    TArray<FRoute> Routes;
+    TArray<FHttpRequestRef> HeldRequests;
+    TArray<TPair<FString, FString>> Requests;
+    bool bHoldRequests{false};
+};
+
 class FFakeHttpRequest : public IHttpRequest
 {
 public:
     FFakeHttpRequest(const FString& ResponseStr) : ReponseData(ResponseStr) {}
-    virtual FString GetURL() const override { return FString(); }
+    virtual FString GetURL() const override { return URL; }
     virtual FHttpRequestWillRetryDelegate& OnRequestWillRetry() override { return HttpRequestWillRetryDelegate; }
     virtual FString GetURLParameter(const FString& ParameterName) const override { return FString(); }
     virtual FString GetHeader(const FString& HeaderName) const override { return FString(); }
@@ -50,10 +127,10 @@ public:
     }
     virtual FString GetVerb() const override { return FString{}; }
     virtual void SetVerb(const FString& Verb) override {}
-    virtual void SetURL(const FString& URL) override {}
+    virtual void SetURL(const FString& InURL) override { URL = InURL; }
     virtual void SetContent(const TArray<uint8>& ContentPayload) override {}
     virtual void SetContent(TArray<uint8>&& ContentPayload) override {}
-    virtual void SetContentAsString(const FString& ContentString) override {}
+    virtual void SetContentAsString(const FString& ContentString) override { Content = ContentString; }
     virtual bool SetContentAsStreamedFile(const FString& Filename) override { return false; }
     virtual bool SetContentFromStream(TSharedRef<FArchive, ESPMode::ThreadSafe> Stream) override { return false; }
     virtual void SetHeader(const FString& HeaderName, const FString& HeaderValue) override {}
@@ -63,9 +140,18 @@ public:
     virtual TOptional<float> GetTimeout() const override { return TOptional<float>(); }
     virtual bool ProcessRequest() override
     {
-        HttpRequestCompleteDelegate.Execute(SharedThis(this), GetResponse(), true);
+        FFakeHttpServer& Server = FFakeHttpServer::Get();
+        Server.LogRequest(URL, Content);
+        Server.FindResponse(URL, ReponseData);
+        if (Server.IsHoldingRequests())
+        {
+            Server.Hold(SharedThis(this));
+            return true;
+        }
+        Complete();
         return true;
     }
+    void Complete() { HttpRequestCompleteDelegate.ExecuteIfBound(SharedThis(this), GetResponse(), true); }
     virtual FHttpRequestCompleteDelegate& OnProcessRequestComplete() override { return HttpRequestCompleteDelegate; }
     virtual FHttpRequestProgressDelegate& OnRequestProgress() override { return HttpRequestProgressDelegate; }
     virtual FHttpRequestHeaderReceivedDelegate& OnHeaderReceived() override { return HttpHeaderReceivedDelegate; }
@@ -98,8 +184,22 @@ public:
 private:
     FString ReponseData;
     FString EffectiveURL;
+    FString URL;
+    FString Content;
 };
 
+inline int32 FFakeHttpServer::ReleaseRequests()
+{
+    // completions can send new requests
+    const TArray<FHttpRequestRef> Released = MoveTemp(HeldRequests);
+    HeldRequests.Reset();
+    for (const FHttpRequestRef& Request : Released)
+    {
+        StaticCastSharedRef<FFakeHttpRequest>(Request)->Complete();
+    }
+    return Released.Num();
+}
+
 UCLASS()
 class OPENAITESTRUNNER_API UOpenAIProviderFake : public UOpenAIProvider
 {
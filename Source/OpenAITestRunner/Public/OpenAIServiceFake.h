@@ -0,0 +1,55 @@
+// OpenAI, Copyright LifeEXE. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ChatGPT/BaseService.h"
+#include "FuncLib/JsonFuncLib.h"
+#include "FuncLib/OpenAIFuncLib.h"
+#include "OpenAIServiceFake.generated.h"
+
+/**
+  Service whose calls wait until the test answers or fails them, e.g. to answer them in another order.
+*/
+UCLASS()
+class OPENAITESTRUNNER_API UOpenAIServiceFake : public UBaseService
+{
+    GENERATED_BODY()
+
+public:
+    virtual bool Init(const OpenAI::ServiceSecrets& Secrets) override { return true; }
+    virtual FString Name() const override { return "Fake"; }
+    virtual FString Description() const override { return "Fake function of the tests."; }
+    virtual FString FunctionName() const override { return "fake_function"; }
+
+    virtual void Call(const TSharedPtr<FJsonObject>& Args, const FString& InToolID) override
+    {
+        Super::Call(Args, InToolID);
+        ToolIDs.Add(InToolID);
+    }
+
+    void Answer(const FString& InToolID, const FString& Content)
+    {
+        FMessage Message;
+        Message.Tool_Call_ID.Set(InToolID);
+        Message.Role = UOpenAIFuncLib::OpenAIRoleToString(ERole::Tool);
+        Message.Content = Content;
+        ServiceDataRecieved.Broadcast(Message);
+    }
+
+    void Fail(const FString& Error) { ServiceDataError.Broadcast(Error); }
+
+    const TArray<FString>& GetToolIDs() const { return ToolIDs; }
+
+protected:
+    virtual FString MakeFunction() const override
+    {
+        TSharedPtr<FJsonObject> ParamsObj = MakeShareable(new FJsonObject());
+        ParamsObj->SetStringField("type", "object");
+        ParamsObj->SetObjectField("properties", MakeShareable(new FJsonObject()));
+        return UJsonFuncLib::MakeFunctionsString(ParamsObj);
+    }
+
+private:
+    TArray<FString> ToolIDs;
+};